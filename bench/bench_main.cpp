@@ -0,0 +1,543 @@
+// bench_main.cpp
+// Benchmark driver: generates deterministic synthetic corpora (once, cached
+// on disk) and times each pipeline stage against them.
+//
+// Usage:
+//   chatanalyzer_bench [--sizes 10k,100k,1m,10m] [--stages a,b,...]
+//                      [--work DIR] [--reps N] [--senders N]
+//                      [--report out.json] [--baseline old.json] [--tolerance 0.15]
+//                      [--generate-only] [--list]
+//
+// Stages:
+//   micro: tokenize, vader, nrc
+//   e2e:   convert_whatsapp, convert_discord, convert_sms, convert_imessage, analyze
+//
+// With --baseline, any stage whose throughput drops more than --tolerance
+// below the baseline makes the process exit with status 2.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+#include "synthetic_chat.hpp"
+#include "chat_analyzer.hpp"
+#include "vader_sentiment.hpp"
+#include "nrc_emotion.hpp"
+#include "whatsapp_convert.hpp"
+#include "discord_convert.hpp"
+#include "android_sms_convert.hpp"
+#include "imessage_convert.hpp"
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// -------------------------------------------------------------
+// Options
+// -------------------------------------------------------------
+
+struct BenchOptions
+{
+    std::vector<std::string> sizes  = { "10k", "100k" };
+    std::vector<std::string> stages;                 // empty = all
+    fs::path    workDir             = "bench_corpora";
+    int         reps                = 3;
+    int         senders             = 3;
+    std::string reportPath;
+    std::string baselinePath;
+    double      tolerance           = 0.15;
+    bool        generateOnly        = false;
+};
+
+static const char* const ALL_STAGES[] = {
+    "tokenize", "vader", "nrc",
+    "convert_whatsapp", "convert_discord", "convert_sms", "convert_imessage",
+    "analyze"
+};
+
+static std::vector<std::string> splitCsv(const std::string& s)
+{
+    std::vector<std::string> out;
+    std::string cur;
+    std::istringstream iss(s);
+    while (std::getline(iss, cur, ','))
+        if (!cur.empty()) out.push_back(cur);
+    return out;
+}
+
+static std::size_t parseSize(const std::string& s)
+{
+    std::string low;
+    for (char c : s) low.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+
+    std::size_t mult = 1;
+    if (!low.empty() && low.back() == 'k') { mult = 1000;    low.pop_back(); }
+    else if (!low.empty() && low.back() == 'm') { mult = 1000000; low.pop_back(); }
+
+    std::size_t n = static_cast<std::size_t>(std::stoull(low));
+    return n * mult;
+}
+
+static bool wantStage(const BenchOptions& opt, const std::string& stage)
+{
+    return opt.stages.empty() ||
+           std::find(opt.stages.begin(), opt.stages.end(), stage) != opt.stages.end();
+}
+
+// -------------------------------------------------------------
+// Corpus cache
+// -------------------------------------------------------------
+
+struct Corpus
+{
+    std::string label;
+    bench::SynthConfig cfg;
+    fs::path root;
+
+    fs::path unifiedDir()  const { return root / "unified"; }
+    fs::path whatsappTxt() const { return root / "whatsapp" / "_chat.txt"; }
+    fs::path discordDir()  const { return root / "discord"; }
+    fs::path smsXml()      const { return root / "android" / "sms.xml"; }
+    fs::path imessageDb()  const { return root / "imessage" / "chat.db"; }
+};
+
+static std::uintmax_t pathBytes(const fs::path& p)
+{
+    if (fs::is_regular_file(p))
+        return fs::file_size(p);
+
+    std::uintmax_t total = 0;
+    if (fs::is_directory(p))
+        for (const auto& e : fs::recursive_directory_iterator(p))
+            if (e.is_regular_file()) total += e.file_size();
+    return total;
+}
+
+// The stamp file records the generator inputs; a mismatch regenerates.
+static std::string corpusStamp(const bench::SynthConfig& cfg)
+{
+    std::ostringstream oss;
+    oss << "v1 seed=" << cfg.seed << " n=" << cfg.messageCount
+        << " senders=" << cfg.senderCount << " start=" << cfg.startMs;
+    return oss.str();
+}
+
+static void ensureCorpus(const Corpus& c)
+{
+    fs::path stampPath = c.root / "STAMP";
+    std::string want = corpusStamp(c.cfg);
+
+    {
+        std::ifstream in(stampPath);
+        std::string have;
+        if (in && std::getline(in, have) && have == want)
+            return;
+    }
+
+    std::cout << "Generating corpus " << c.label << " (" << c.cfg.messageCount
+              << " messages) in " << c.root.string() << " ...\n" << std::flush;
+
+    fs::remove_all(c.root);
+    fs::create_directories(c.root);
+
+    auto t0 = std::chrono::steady_clock::now();
+    bench::WriteUnifiedJsonCorpus(c.cfg, c.unifiedDir().string());
+    bench::WriteWhatsAppCorpus(c.cfg, c.whatsappTxt().string());
+    bench::WriteDiscordCorpus(c.cfg, c.discordDir().string());
+    bench::WriteAndroidSmsCorpus(c.cfg, c.smsXml().string());
+    bench::WriteImessageCorpus(c.cfg, c.imessageDb().string());
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::ofstream(stampPath) << want << "\n";
+    std::cout << "  done in " << std::fixed << std::setprecision(2) << secs << " s\n";
+}
+
+// -------------------------------------------------------------
+// Timing
+// -------------------------------------------------------------
+
+struct BenchResult
+{
+    std::string   stage;
+    std::string   corpus;
+    std::uint64_t items   = 0;   // messages
+    std::uint64_t bytes   = 0;   // input bytes
+    double        seconds = 0.0; // best of reps
+    bool          ok      = true;
+    std::string   error;
+
+    double itemsPerSec() const { return seconds > 0 ? items / seconds : 0.0; }
+    double mbPerSec()    const { return seconds > 0 ? (bytes / 1048576.0) / seconds : 0.0; }
+};
+
+// Silences std::cout (the analyzer logs every processed file).
+class CoutSilencer
+{
+public:
+    CoutSilencer() : m_old(std::cout.rdbuf(m_sink.rdbuf())) {}
+    ~CoutSilencer() { std::cout.rdbuf(m_old); }
+private:
+    std::ostringstream m_sink;
+    std::streambuf*    m_old;
+};
+
+static BenchResult timeStage(const std::string& stage, const Corpus& c, int reps,
+                             std::uint64_t items, std::uint64_t bytes,
+                             const std::function<void()>& body)
+{
+    BenchResult r;
+    r.stage  = stage;
+    r.corpus = c.label;
+    r.items  = items;
+    r.bytes  = bytes;
+    r.seconds = 0.0;
+
+    for (int i = 0; i < reps; ++i)
+    {
+        try
+        {
+            CoutSilencer quiet;
+            auto t0 = std::chrono::steady_clock::now();
+            body();
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            if (i == 0 || s < r.seconds) r.seconds = s;
+        }
+        catch (const std::exception& ex)
+        {
+            r.ok    = false;
+            r.error = ex.what();
+            break;
+        }
+    }
+    return r;
+}
+
+static void requireOk(bool ok, const std::string& error)
+{
+    if (!ok)
+        throw std::runtime_error(error);
+}
+
+// -------------------------------------------------------------
+// Stages
+// -------------------------------------------------------------
+
+// Micro benchmarks run on an in-memory sample so they measure the stage,
+// not the disk. The sample is capped to keep 10M runs sane.
+static std::vector<std::string> loadSample(const Corpus& c, std::size_t cap, std::uint64_t& bytes)
+{
+    bench::SynthConfig cfg = c.cfg;
+    cfg.messageCount = std::min(cfg.messageCount, cap);
+
+    bench::SyntheticChatGenerator gen(cfg);
+    bench::SynthMessage m;
+    std::vector<std::string> out;
+    bytes = 0;
+    while (gen.next(m))
+    {
+        if (m.content.empty()) continue;
+        bytes += m.content.size();
+        out.push_back(std::move(m.content));
+    }
+    return out;
+}
+
+static fs::path findLexicon(const char* name)
+{
+    fs::path p = name;
+    if (fs::exists(p)) return p;
+    p = fs::path("dist") / name;
+    if (fs::exists(p)) return p;
+    return fs::path("..") / "dist" / name;
+}
+
+static void runCorpus(const BenchOptions& opt, const Corpus& c, std::vector<BenchResult>& results)
+{
+    const std::uint64_t n = c.cfg.messageCount;
+    fs::path outRoot = c.root / "out";
+
+    std::uint64_t sampleBytes = 0;
+    std::vector<std::string> sample;
+    if (wantStage(opt, "tokenize") || wantStage(opt, "vader") || wantStage(opt, "nrc"))
+        sample = loadSample(c, 1000000, sampleBytes);
+
+    if (wantStage(opt, "tokenize"))
+    {
+        results.push_back(timeStage("tokenize", c, opt.reps, sample.size(), sampleBytes, [&] {
+            std::size_t words = 0;
+            for (const auto& s : sample)
+                words += extractWordsLower(normalizeContractions(s)).size();
+            if (words == 0) throw std::runtime_error("tokenizer produced no words");
+        }));
+    }
+
+    if (wantStage(opt, "vader"))
+    {
+        VaderSentiment vader;
+        bool loaded = vader.loadLexicon(findLexicon("vader_lexicon.txt").string());
+        results.push_back(timeStage("vader", c, opt.reps, sample.size(), sampleBytes, [&] {
+            requireOk(loaded, "vader_lexicon.txt not found");
+            double neg, neu, pos, compound, acc = 0.0;
+            for (const auto& s : sample)
+            {
+                vader.polarityScores(s, neg, neu, pos, compound);
+                acc += compound;
+            }
+            if (acc != acc) throw std::runtime_error("NaN compound");
+        }));
+    }
+
+    if (wantStage(opt, "nrc"))
+    {
+        NrcEmotionLexicon nrc;
+        bool loaded = nrc.loadFromFile(findLexicon("nrc_emotion_lexicon.txt").string());
+        std::vector<std::vector<std::string>> tokenized;
+        if (loaded)
+        {
+            tokenized.reserve(sample.size());
+            for (const auto& s : sample)
+                tokenized.push_back(extractWordsLower(s));
+        }
+        results.push_back(timeStage("nrc", c, opt.reps, sample.size(), sampleBytes, [&] {
+            requireOk(loaded, "nrc_emotion_lexicon.txt not found");
+            NrcEmotionLexicon::Scores scores;
+            for (const auto& words : tokenized)
+                nrc.scoreWords(words, scores);
+        }));
+    }
+
+    if (wantStage(opt, "convert_whatsapp"))
+    {
+        results.push_back(timeStage("convert_whatsapp", c, opt.reps, n, pathBytes(c.whatsappTxt()), [&] {
+            fs::remove_all(outRoot / "whatsapp");
+            std::string err;
+            requireOk(ConvertWhatsAppToInstagramFolder(c.whatsappTxt().string(),
+                          (outRoot / "whatsapp").string(), "Synthetic", err), err);
+        }));
+    }
+
+    if (wantStage(opt, "convert_discord"))
+    {
+        results.push_back(timeStage("convert_discord", c, opt.reps, n, pathBytes(c.discordDir()), [&] {
+            fs::remove_all(outRoot / "discord");
+            std::string err;
+            requireOk(ConvertDiscordToInstagramFolder(c.discordDir().string(),
+                          (outRoot / "discord").string(), "Synthetic", err), err);
+        }));
+    }
+
+    if (wantStage(opt, "convert_sms"))
+    {
+        results.push_back(timeStage("convert_sms", c, opt.reps, n, pathBytes(c.smsXml()), [&] {
+            fs::remove_all(outRoot / "android");
+            std::string err;
+            requireOk(ConvertAndroidSmsXmlToInstagramFolder(c.smsXml().string(), "",
+                          (outRoot / "android").string(), err), err);
+        }));
+    }
+
+    if (wantStage(opt, "convert_imessage"))
+    {
+        results.push_back(timeStage("convert_imessage", c, opt.reps, n, pathBytes(c.imessageDb()), [&] {
+            fs::remove_all(outRoot / "imessage");
+            std::string err;
+            requireOk(ConvertImessageChatToInstagramFolder(c.imessageDb().string(),
+                          bench::SyntheticImessageChatGuid(),
+                          (outRoot / "imessage").string(), err), err);
+        }));
+    }
+
+    if (wantStage(opt, "analyze"))
+    {
+        results.push_back(timeStage("analyze", c, opt.reps, n, pathBytes(c.unifiedDir()), [&] {
+            std::string report = runAnalysisToString(c.unifiedDir().string());
+            if (report.empty()) throw std::runtime_error("empty report");
+        }));
+    }
+}
+
+// -------------------------------------------------------------
+// Reporting
+// -------------------------------------------------------------
+
+static void printResults(const std::vector<BenchResult>& results)
+{
+    std::cout << "\n"
+              << std::left  << std::setw(18) << "stage"
+              << std::setw(8)  << "corpus"
+              << std::right << std::setw(12) << "items"
+              << std::setw(12) << "MB"
+              << std::setw(12) << "best s"
+              << std::setw(14) << "items/s"
+              << std::setw(10) << "MB/s" << "\n";
+
+    for (const auto& r : results)
+    {
+        std::cout << std::left << std::setw(18) << r.stage << std::setw(8) << r.corpus;
+        if (!r.ok)
+        {
+            std::cout << "  FAILED: " << r.error << "\n";
+            continue;
+        }
+        std::cout << std::right << std::fixed
+                  << std::setw(12) << r.items
+                  << std::setw(12) << std::setprecision(1) << (r.bytes / 1048576.0)
+                  << std::setw(12) << std::setprecision(4) << r.seconds
+                  << std::setw(14) << std::setprecision(0) << r.itemsPerSec()
+                  << std::setw(10) << std::setprecision(1) << r.mbPerSec() << "\n";
+    }
+}
+
+static json resultsToJson(const std::vector<BenchResult>& results)
+{
+    json arr = json::array();
+    for (const auto& r : results)
+    {
+        json j;
+        j["stage"]   = r.stage;
+        j["corpus"]  = r.corpus;
+        j["items"]   = r.items;
+        j["bytes"]   = r.bytes;
+        j["seconds"] = r.seconds;
+        j["items_per_sec"] = r.itemsPerSec();
+        j["ok"]      = r.ok;
+        if (!r.ok) j["error"] = r.error;
+        arr.push_back(std::move(j));
+    }
+    json out;
+    out["results"] = std::move(arr);
+    return out;
+}
+
+// Returns the number of regressions found.
+static int compareWithBaseline(const std::vector<BenchResult>& results,
+                               const std::string& baselinePath, double tolerance)
+{
+    std::ifstream in(baselinePath);
+    if (!in)
+        throw std::runtime_error("Could not open baseline: " + baselinePath);
+
+    json base = json::parse(in);
+    std::map<std::string, double> baseRate;
+    for (const auto& j : base["results"])
+        if (j.value("ok", false))
+            baseRate[j["stage"].get<std::string>() + "@" + j["corpus"].get<std::string>()] =
+                j["items_per_sec"].get<double>();
+
+    int regressions = 0;
+    std::cout << "\nComparison with " << baselinePath << " (tolerance "
+              << std::setprecision(0) << tolerance * 100 << "%):\n";
+    for (const auto& r : results)
+    {
+        auto it = baseRate.find(r.stage + "@" + r.corpus);
+        if (it == baseRate.end() || !r.ok || it->second <= 0)
+            continue;
+
+        double ratio = r.itemsPerSec() / it->second;
+        bool regressed = ratio < 1.0 - tolerance;
+        regressions += regressed ? 1 : 0;
+        std::cout << "  " << std::left << std::setw(18) << r.stage << std::setw(8) << r.corpus
+                  << std::right << std::setprecision(2) << std::setw(8) << ratio << "x"
+                  << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return regressions;
+}
+
+// -------------------------------------------------------------
+// Entry point
+// -------------------------------------------------------------
+
+static void printUsage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0
+              << " [--sizes 10k,100k,1m,10m] [--stages a,b] [--work DIR] [--reps N]\n"
+                 "       [--senders N] [--report out.json] [--baseline old.json]\n"
+                 "       [--tolerance 0.15] [--generate-only] [--list]\n";
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions opt;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string a = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("Missing value for " + a);
+                return argv[++i];
+            };
+
+            if      (a == "--sizes")         opt.sizes = splitCsv(value());
+            else if (a == "--stages")        opt.stages = splitCsv(value());
+            else if (a == "--work")          opt.workDir = fs::u8path(value());
+            else if (a == "--reps")          opt.reps = std::max(1, std::stoi(value()));
+            else if (a == "--senders")       opt.senders = std::stoi(value());
+            else if (a == "--report")        opt.reportPath = value();
+            else if (a == "--baseline")      opt.baselinePath = value();
+            else if (a == "--tolerance")     opt.tolerance = std::stod(value());
+            else if (a == "--generate-only") opt.generateOnly = true;
+            else if (a == "--list")
+            {
+                for (const char* s : ALL_STAGES) std::cout << s << "\n";
+                return 0;
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        std::vector<BenchResult> results;
+        for (const auto& label : opt.sizes)
+        {
+            Corpus c;
+            c.label = label;
+            c.cfg.messageCount = parseSize(label);
+            c.cfg.senderCount  = opt.senders;
+            c.root = opt.workDir / label;
+
+            ensureCorpus(c);
+            if (!opt.generateOnly)
+                runCorpus(opt, c, results);
+        }
+
+        if (opt.generateOnly)
+            return 0;
+
+        printResults(results);
+
+        if (!opt.reportPath.empty())
+        {
+            std::ofstream out(opt.reportPath);
+            out << resultsToJson(results).dump(2) << "\n";
+        }
+
+        bool anyFailed = std::any_of(results.begin(), results.end(),
+                                     [](const BenchResult& r) { return !r.ok; });
+
+        if (!opt.baselinePath.empty() &&
+            compareWithBaseline(results, opt.baselinePath, opt.tolerance) > 0)
+            return 2;
+
+        return anyFailed ? 1 : 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
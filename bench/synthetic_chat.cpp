@@ -0,0 +1,792 @@
+// synthetic_chat.cpp
+// Deterministic synthetic corpora for the benchmark suite.
+
+#include "synthetic_chat.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sqlite3.h"
+
+namespace fs = std::filesystem;
+
+namespace bench
+{
+
+// -------------------------------------------------------------
+// Vocabulary
+// -------------------------------------------------------------
+//
+// Ordered roughly by frequency: the generator picks low indices far more
+// often than high ones, which gives a Zipf-like word distribution.
+static const char* const WORDS[] = {
+    "i","you","the","to","a","and","it","that","is","so","lol","me","my","of",
+    "in","like","just","was","for","what","do","but","on","have","no","yeah",
+    "not","be","we","are","this","with","can","okay","oh","get","its","go",
+    "if","know","at","all","he","she","they","haha","too","now","how","one",
+    "good","want","think","time","really","gonna","about","out","up","when",
+    "there","got","why","did","see","going","would","love","day","here","back",
+    "tonight","work","home","tomorrow","sleep","food","call","later","maybe",
+    "sorry","thanks","wait","right","omg","idk","literally","actually","pretty",
+    "need","feel","today","still","make","tell","said","well","never","people",
+    "always","night","miss","hope","happy","sad","tired","hungry","bored",
+    "funny","weird","cute","nice","great","amazing","terrible","awful","best",
+    "worst","friend","friends","movie","show","game","music","song","class",
+    "school","weekend","dinner","lunch","coffee","drive","car","phone","text",
+    "picture","video","party","birthday","plans","remember","forget","promise",
+    "exactly","definitely","probably","honestly","seriously","whatever",
+    "anyway","because","though","again","already","almost","enough","ever",
+    "hate","angry","scared","excited","worried","proud","calm","stressed",
+    "beautiful","perfect","crazy","stupid","annoying","wonderful","horrible",
+    "laugh","cry","smile","hug","kiss","talk","listen","wish","wonder","trust",
+    "dog","cat","rain","sun","snow","beach","city","train","flight","trip",
+    "don't","i'm","can't","you're","it's","that's","didn't","won't","i've",
+    "we're","they're","isn't","wasn't","i'll","you'll","let's","what's",
+    "there's","i'd","couldn't","shouldn't","wouldn't","aren't","doesn't",
+    "café","naïve","jalapeño","über","señor","résumé","déjà","vu",
+    "absolutely","barely","kinda","sort","extremely","totally","incredibly"
+};
+static constexpr std::size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+static const char* const EMOJI[] = {
+    "\xF0\x9F\x98\x82",                         // 😂
+    "\xE2\x9D\xA4\xEF\xB8\x8F",                 // ❤️
+    "\xF0\x9F\x98\xAD",                         // 😭
+    "\xF0\x9F\x91\x8D",                         // 👍
+    "\xF0\x9F\x94\xA5",                         // 🔥
+    "\xF0\x9F\xA5\xBA",                         // 🥺
+    "\xF0\x9F\x98\x8D",                         // 😍
+    "\xF0\x9F\x99\x8F",                         // 🙏
+    "\xE2\x9C\xA8",                             // ✨
+    "\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD",         // 👍🏽
+    "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7", // 👨‍👩‍👧
+    "\xF0\x9F\x98\x8A",                         // 😊
+    "\xF0\x9F\x98\xA1",                         // 😡
+    ":)", ":(", "<3", ":D"
+};
+static constexpr std::size_t EMOJI_COUNT = sizeof(EMOJI) / sizeof(EMOJI[0]);
+
+static const char* const PHRASES[] = {
+    "love you", "miss you", "my love", "thinking of you", "wish you were here",
+    "kind of", "the bomb", "not bad", "no way", "at least"
+};
+static constexpr std::size_t PHRASE_COUNT = sizeof(PHRASES) / sizeof(PHRASES[0]);
+
+const std::vector<std::string>& SyntheticSenderNames()
+{
+    static const std::vector<std::string> NAMES = {
+        "Me", "Alex Rivera", "Sam Chen", "Priya Patel", "Mateo Garc\xC3\xAD" "a",
+        "Zo\xC3\xAB M\xC3\xBCller", "Jordan Lee", "Kai Nakamura"
+    };
+    return NAMES;
+}
+
+std::string SyntheticSenderAddress(int sender)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "+1555010%04d", sender);
+    return buf;
+}
+
+const char* SyntheticImessageChatGuid()
+{
+    return "iMessage;+;chat-synthetic-0001";
+}
+
+// -------------------------------------------------------------
+// Generator
+// -------------------------------------------------------------
+
+SyntheticChatGenerator::SyntheticChatGenerator(const SynthConfig& cfg)
+    : m_cfg(cfg), m_state(cfg.seed), m_clockMs(cfg.startMs)
+{
+    const auto& all = SyntheticSenderNames();
+    int n = m_cfg.senderCount;
+    if (n < 2) n = 2;
+    if (n > static_cast<int>(all.size())) n = static_cast<int>(all.size());
+    m_cfg.senderCount = n;
+    m_names.assign(all.begin(), all.begin() + n);
+}
+
+// SplitMix64: tiny, fast and identical on every compiler.
+std::uint64_t SyntheticChatGenerator::nextU64()
+{
+    std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double SyntheticChatGenerator::nextUnit()
+{
+    return static_cast<double>(nextU64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+std::size_t SyntheticChatGenerator::nextBelow(std::size_t n)
+{
+    return n == 0 ? 0 : static_cast<std::size_t>(nextU64() % n);
+}
+
+void SyntheticChatGenerator::appendWord(std::string& out)
+{
+    // u^2.2 skews toward the front of WORDS (the common words).
+    double u = nextUnit();
+    std::size_t idx = static_cast<std::size_t>(static_cast<double>(WORD_COUNT) * (u * u * std::sqrt(u)));
+    if (idx >= WORD_COUNT) idx = WORD_COUNT - 1;
+
+    std::string w = WORDS[idx];
+
+    // iOS keyboards insert curly apostrophes; keep a share of them.
+    std::size_t apos = w.find('\'');
+    if (apos != std::string::npos && nextUnit() < 0.15)
+        w.replace(apos, 1, "\xE2\x80\x99");
+
+    double style = nextUnit();
+    if (style < 0.01)
+    {
+        for (char& c : w)
+            if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    else if (out.empty() && style < 0.5 && !w.empty() && w[0] >= 'a' && w[0] <= 'z')
+    {
+        w[0] = static_cast<char>(w[0] - 'a' + 'A');
+    }
+
+    if (!out.empty())
+        out.push_back(' ');
+    out += w;
+}
+
+void SyntheticChatGenerator::buildContent(std::string& out)
+{
+    out.clear();
+
+    // Message length: lots of one-liners, a geometric body, a long tail.
+    std::size_t words;
+    double r = nextUnit();
+    if (r < 0.35)
+        words = 1 + nextBelow(3);
+    else if (r < 0.97)
+    {
+        words = 4;
+        while (words < 30 && nextUnit() < 0.875) ++words;
+    }
+    else
+        words = 30 + nextBelow(91);
+
+    std::size_t breakAt = (words > 12 && nextUnit() < 0.2) ? words / 2 : 0;
+
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        if (breakAt != 0 && i == breakAt)
+        {
+            out.push_back('\n');
+            std::string next;
+            appendWord(next);
+            out += next;
+            continue;
+        }
+
+        double t = nextUnit();
+        if (t < 0.05)
+        {
+            if (!out.empty()) out.push_back(' ');
+            out += EMOJI[nextBelow(EMOJI_COUNT)];
+        }
+        else if (t < 0.065)
+        {
+            if (!out.empty()) out.push_back(' ');
+            out += PHRASES[nextBelow(PHRASE_COUNT)];
+        }
+        else
+        {
+            appendWord(out);
+        }
+
+        if (i + 1 < words && nextUnit() < 0.04)
+            out.push_back(',');
+    }
+
+    double p = nextUnit();
+    if      (p < 0.20) out.push_back('.');
+    else if (p < 0.28) out.push_back('!');
+    else if (p < 0.30) out += "!!!";
+    else if (p < 0.40) out.push_back('?');
+    else if (p < 0.43) out += " " + std::string(EMOJI[nextBelow(EMOJI_COUNT)]);
+}
+
+bool SyntheticChatGenerator::next(SynthMessage& out)
+{
+    if (m_produced >= m_cfg.messageCount)
+        return false;
+
+    // Sender: sticky runs produce double/triple texting, otherwise hand over.
+    if (m_produced == 0 || nextUnit() >= 0.35)
+    {
+        int other = static_cast<int>(nextBelow(static_cast<std::size_t>(m_cfg.senderCount - 1)));
+        if (other >= m_lastSender) ++other;
+        m_lastSender = (m_produced == 0) ? 0 : other;
+    }
+
+    // Gaps: bursts of quick replies, breaks, and the occasional quiet day.
+    double g = nextUnit();
+    long long gapSec;
+    if      (g < 0.70) gapSec = 3 + static_cast<long long>(nextBelow(118));
+    else if (g < 0.90) gapSec = 120 + static_cast<long long>(nextBelow(1680));
+    else if (g < 0.98) gapSec = 3600 + static_cast<long long>(nextBelow(5 * 3600));
+    else               gapSec = 6 * 3600 + static_cast<long long>(nextBelow(42 * 3600));
+    if (m_produced > 0)
+        m_clockMs += gapSec * 1000LL + static_cast<long long>(nextBelow(1000));
+
+    out.sender        = m_lastSender;
+    out.timestampMs   = m_clockMs;
+    out.hasAttachment = nextUnit() < 0.01;
+    if (out.hasAttachment)
+        out.content.clear();
+    else
+        buildContent(out.content);
+
+    ++m_produced;
+    return true;
+}
+
+// -------------------------------------------------------------
+// Formatting helpers
+// -------------------------------------------------------------
+
+// Howard Hinnant's civil_from_days (inverse of daysFromCivil in the converters).
+static void civilFromDays(long long z, int& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    const long long era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const long long yy = static_cast<long long>(yoe) + era * 400;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp  = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yy + (m <= 2));
+}
+
+struct UtcParts
+{
+    int year; unsigned month, day; int hour, minute, second, millis;
+};
+
+static UtcParts splitUtc(long long ms)
+{
+    UtcParts p{};
+    long long secs = ms / 1000;
+    p.millis = static_cast<int>(ms % 1000);
+    long long days = secs / 86400;
+    long long rem  = secs % 86400;
+    civilFromDays(days, p.year, p.month, p.day);
+    p.hour   = static_cast<int>(rem / 3600);
+    p.minute = static_cast<int>((rem % 3600) / 60);
+    p.second = static_cast<int>(rem % 60);
+    return p;
+}
+
+static void appendJsonEscaped(std::string& out, const std::string& s)
+{
+    out.push_back('"');
+    for (unsigned char c : s)
+    {
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            }
+            else
+                out.push_back(static_cast<char>(c));
+        }
+    }
+    out.push_back('"');
+}
+
+// XML attribute escaping as done by SMS Backup & Restore: the five named
+// entities, newlines as &#10;, and astral code points as UTF-16 surrogates.
+static void appendXmlEscaped(std::string& out, const std::string& s)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    std::size_t n = s.size();
+    char buf[32];
+
+    for (std::size_t i = 0; i < n; )
+    {
+        unsigned char c = p[i];
+        if (c < 0x80)
+        {
+            switch (c)
+            {
+            case '&':  out += "&amp;";  break;
+            case '<':  out += "&lt;";   break;
+            case '>':  out += "&gt;";   break;
+            case '"':  out += "&quot;"; break;
+            case '\'': out += "&apos;"; break;
+            case '\n': out += "&#10;";  break;
+            default:   out.push_back(static_cast<char>(c));
+            }
+            ++i;
+        }
+        else if (c >= 0xF0 && i + 3 < n)
+        {
+            unsigned cp = ((c & 0x07u) << 18) | ((p[i+1] & 0x3Fu) << 12) |
+                          ((p[i+2] & 0x3Fu) << 6) | (p[i+3] & 0x3Fu);
+            cp -= 0x10000;
+            std::snprintf(buf, sizeof(buf), "&#%u;&#%u;",
+                          0xD800u + (cp >> 10), 0xDC00u + (cp & 0x3FFu));
+            out += buf;
+            i += 4;
+        }
+        else
+        {
+            out.push_back(static_cast<char>(c));
+            ++i;
+        }
+    }
+}
+
+static void ensureParentDir(const std::string& file)
+{
+    fs::path parent = fs::u8path(file).parent_path();
+    if (!parent.empty())
+        fs::create_directories(parent);
+}
+
+static std::ofstream openOut(const fs::path& p)
+{
+    std::ofstream ofs(p, std::ios::binary);
+    if (!ofs)
+        throw std::runtime_error("Could not open output file: " + p.string());
+    return ofs;
+}
+
+// -------------------------------------------------------------
+// Unified JSON
+// -------------------------------------------------------------
+
+void WriteUnifiedJsonCorpus(const SynthConfig& cfg, const std::string& outDir,
+                            std::size_t chunkSize)
+{
+    fs::path dir = fs::u8path(outDir);
+    fs::create_directories(dir);
+
+    SyntheticChatGenerator gen(cfg);
+    const auto& names = gen.senderNames();
+
+    std::string header = "{\n  \"participants\": [";
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        if (i) header += ", ";
+        header += "{\"name\": ";
+        appendJsonEscaped(header, names[i]);
+        header += "}";
+    }
+    header += "],\n  \"messages\": [\n";
+
+    const std::string footer =
+        "\n  ],\n  \"title\": \"Synthetic\",\n"
+        "  \"is_still_participant\": true,\n"
+        "  \"thread_path\": \"synthetic/converted\"\n}\n";
+
+    SynthMessage msg;
+    std::string buf;
+    std::size_t fileIndex = 0;
+    bool more = gen.next(msg);
+
+    while (more)
+    {
+        buf.clear();
+        buf += header;
+        std::size_t inChunk = 0;
+
+        while (more && inChunk < chunkSize)
+        {
+            if (inChunk) buf += ",\n";
+            buf += "    {\"sender_name\": ";
+            appendJsonEscaped(buf, names[static_cast<std::size_t>(msg.sender)]);
+            buf += ", \"timestamp_ms\": ";
+            buf += std::to_string(msg.timestampMs);
+            if (msg.hasAttachment)
+            {
+                buf += ", \"photos\": [{\"uri\": \"photos/";
+                buf += std::to_string(gen.produced());
+                buf += ".jpg\"}]";
+            }
+            else
+            {
+                buf += ", \"content\": ";
+                appendJsonEscaped(buf, msg.content);
+            }
+            // Every ~20th message carries a reaction from the other side.
+            if (gen.produced() % 20 == 0)
+            {
+                std::size_t actor = (static_cast<std::size_t>(msg.sender) + 1) % names.size();
+                buf += ", \"reactions\": [{\"reaction\": \"\xE2\x9D\xA4\", \"actor\": ";
+                appendJsonEscaped(buf, names[actor]);
+                buf += "}]";
+            }
+            buf += "}";
+
+            ++inChunk;
+            more = gen.next(msg);
+        }
+
+        buf += footer;
+        std::ofstream ofs = openOut(dir / ("message_" + std::to_string(++fileIndex) + ".json"));
+        ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    }
+}
+
+// -------------------------------------------------------------
+// WhatsApp _chat.txt
+// -------------------------------------------------------------
+
+static void appendWhatsAppStamp(std::string& out, long long ms)
+{
+    UtcParts t = splitUtc(ms);
+    int h12 = t.hour % 12;
+    if (h12 == 0) h12 = 12;
+
+    char buf[64];
+    // Newer iOS exports put U+202F (narrow no-break space) before AM/PM.
+    std::snprintf(buf, sizeof(buf), "[%u/%u/%02d, %d:%02d:%02d\xE2\x80\xAF%s] ",
+                  t.month, t.day, t.year % 100, h12, t.minute, t.second,
+                  t.hour < 12 ? "AM" : "PM");
+    out += buf;
+}
+
+void WriteWhatsAppCorpus(const SynthConfig& cfg, const std::string& outFile)
+{
+    ensureParentDir(outFile);
+    std::ofstream ofs = openOut(fs::u8path(outFile));
+
+    SyntheticChatGenerator gen(cfg);
+    const auto& names = gen.senderNames();
+
+    std::string buf;
+    buf.reserve(1 << 20);
+
+    appendWhatsAppStamp(buf, cfg.startMs);
+    buf += names[1];
+    buf += ": \xE2\x80\x8EMessages and calls are end-to-end encrypted. No one outside "
+           "of this chat, not even WhatsApp, can read or listen to them.\n";
+
+    SynthMessage msg;
+    while (gen.next(msg))
+    {
+        appendWhatsAppStamp(buf, msg.timestampMs);
+        buf += names[static_cast<std::size_t>(msg.sender)];
+        buf += ": ";
+        if (msg.hasAttachment)
+            buf += "\xE2\x80\x8Eimage omitted";
+        else
+            buf += msg.content;
+        buf.push_back('\n');
+
+        if (buf.size() >= (1u << 20))
+        {
+            ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            buf.clear();
+        }
+    }
+    ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+// -------------------------------------------------------------
+// Discrub JSON pages
+// -------------------------------------------------------------
+
+static std::string makeSnowflake(long long ms, std::size_t seq)
+{
+    const long long DISCORD_EPOCH_MS = 1420070400000LL;
+    unsigned long long id =
+        (static_cast<unsigned long long>(ms - DISCORD_EPOCH_MS) << 22) |
+        (static_cast<unsigned long long>(seq) & 0xFFFULL);
+    return std::to_string(id);
+}
+
+static std::string discordUsername(const std::string& display)
+{
+    std::string u;
+    for (unsigned char c : display)
+    {
+        if (c >= 'A' && c <= 'Z') u.push_back(static_cast<char>(c - 'A' + 'a'));
+        else if (c >= 'a' && c <= 'z') u.push_back(static_cast<char>(c));
+        else if (c == ' ') u.push_back('.');
+    }
+    return u.empty() ? std::string("user") : u;
+}
+
+void WriteDiscordCorpus(const SynthConfig& cfg, const std::string& outDir,
+                        std::size_t pageSize)
+{
+    fs::path dir = fs::u8path(outDir);
+    fs::create_directories(dir);
+
+    SyntheticChatGenerator gen(cfg);
+    const auto& names = gen.senderNames();
+
+    std::vector<std::string> usernames;
+    for (const auto& n : names)
+        usernames.push_back(discordUsername(n));
+
+    const std::string channelId = "1100000000000000001";
+
+    SynthMessage msg;
+    std::string buf;
+    std::string prevId;
+    int prevSender = -1;
+    std::size_t page = 0;
+    bool more = gen.next(msg);
+
+    while (more)
+    {
+        buf.clear();
+        buf += "[\n";
+        std::size_t inPage = 0;
+
+        while (more && inPage < pageSize)
+        {
+            UtcParts t = splitUtc(msg.timestampMs);
+            char ts[64];
+            std::snprintf(ts, sizeof(ts), "%04d-%02u-%02uT%02d:%02d:%02d.%03d000+00:00",
+                          t.year, t.month, t.day, t.hour, t.minute, t.second, t.millis);
+
+            std::string id = makeSnowflake(msg.timestampMs, gen.produced());
+            std::size_t s  = static_cast<std::size_t>(msg.sender);
+
+            if (inPage) buf += ",\n";
+            buf += "  {\"id\": \"" + id + "\", \"type\": 0, \"content\": ";
+            appendJsonEscaped(buf, msg.content);
+            buf += ", \"channel_id\": \"" + channelId + "\", \"author\": {\"id\": \"";
+            buf += std::to_string(200000000000000000ULL + s);
+            buf += "\", \"username\": ";
+            appendJsonEscaped(buf, usernames[s]);
+            buf += ", \"global_name\": ";
+            appendJsonEscaped(buf, names[s]);
+            buf += "}, \"attachments\": [";
+            if (msg.hasAttachment)
+                buf += "{\"id\": \"" + id + "\", \"filename\": \"image.png\", \"size\": 48213}";
+            buf += "], \"timestamp\": \"";
+            buf += ts;
+            buf += "\"";
+            // Replies to the other side's previous message, as a busy channel would.
+            if (!prevId.empty() && prevSender != msg.sender && gen.produced() % 12 == 0)
+                buf += ", \"message_reference\": {\"channel_id\": \"" + channelId +
+                       "\", \"message_id\": \"" + prevId + "\"}";
+            buf += ", \"userName\": ";
+            appendJsonEscaped(buf, usernames[s]);
+            buf += "}";
+
+            prevId     = id;
+            prevSender = msg.sender;
+            ++inPage;
+            more = gen.next(msg);
+        }
+
+        buf += "\n]\n";
+        std::ofstream ofs = openOut(dir / ("page_" + std::to_string(++page) + ".json"));
+        ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    }
+}
+
+// -------------------------------------------------------------
+// SMS Backup & Restore XML
+// -------------------------------------------------------------
+
+void WriteAndroidSmsCorpus(const SynthConfig& cfg, const std::string& outFile)
+{
+    ensureParentDir(outFile);
+    std::ofstream ofs = openOut(fs::u8path(outFile));
+
+    SyntheticChatGenerator gen(cfg);
+    const auto& names = gen.senderNames();
+
+    std::string buf;
+    buf.reserve(1 << 20);
+    buf += "<?xml version='1.0' encoding='UTF-8' standalone='yes' ?>\n";
+    buf += "<!--File Created By SMS Backup & Restore v10.20.002-->\n";
+    buf += "<smses count=\"" + std::to_string(cfg.messageCount) +
+           "\" backup_set=\"synthetic\" backup_date=\"" + std::to_string(cfg.startMs) + "\" type=\"full\">\n";
+
+    SynthMessage msg;
+    int lastContact = 1;
+    while (gen.next(msg))
+    {
+        if (msg.hasAttachment)
+            continue; // media arrives as <mms>, which the SMS converter does not read
+
+        int contact = (msg.sender == 0) ? lastContact : msg.sender;
+        if (msg.sender != 0) lastContact = msg.sender;
+
+        buf += "  <sms protocol=\"0\" address=\"";
+        buf += SyntheticSenderAddress(contact);
+        buf += "\" date=\"";
+        buf += std::to_string(msg.timestampMs);
+        buf += msg.sender == 0 ? "\" type=\"2\"" : "\" type=\"1\"";
+        buf += " subject=\"null\" body=\"";
+        appendXmlEscaped(buf, msg.content);
+        buf += "\" toa=\"null\" sc_toa=\"null\" service_center=\"null\" read=\"1\" status=\"-1\" locked=\"0\" date_sent=\"";
+        buf += std::to_string(msg.timestampMs - 1500);
+        buf += "\" sub_id=\"1\" readable_date=\"\" contact_name=\"";
+        appendXmlEscaped(buf, names[static_cast<std::size_t>(contact)]);
+        buf += "\" />\n";
+
+        if (buf.size() >= (1u << 20))
+        {
+            ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            buf.clear();
+        }
+    }
+    buf += "</smses>\n";
+    ofs.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+}
+
+// -------------------------------------------------------------
+// iMessage chat.db
+// -------------------------------------------------------------
+
+static void execOrThrow(sqlite3* db, const char* sql)
+{
+    char* err = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK)
+    {
+        std::string msg = "SQLite error: ";
+        msg += err ? err : "unknown";
+        sqlite3_free(err);
+        throw std::runtime_error(msg);
+    }
+}
+
+void WriteImessageCorpus(const SynthConfig& cfg, const std::string& outFile)
+{
+    ensureParentDir(outFile);
+    fs::path p = fs::u8path(outFile);
+    if (fs::exists(p))
+        fs::remove(p);
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(p.string().c_str(), &db) != SQLITE_OK)
+    {
+        sqlite3_close(db);
+        throw std::runtime_error("Could not create SQLite DB: " + p.string());
+    }
+
+    try
+    {
+        execOrThrow(db, "PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF;");
+        execOrThrow(db, R"SQL(
+            CREATE TABLE handle (ROWID INTEGER PRIMARY KEY AUTOINCREMENT, id TEXT NOT NULL, service TEXT);
+            CREATE TABLE chat (ROWID INTEGER PRIMARY KEY AUTOINCREMENT, guid TEXT UNIQUE NOT NULL,
+                               chat_identifier TEXT, display_name TEXT, service_name TEXT);
+            CREATE TABLE chat_handle_join (chat_id INTEGER, handle_id INTEGER, UNIQUE(chat_id, handle_id));
+            CREATE TABLE message (ROWID INTEGER PRIMARY KEY AUTOINCREMENT, guid TEXT UNIQUE NOT NULL,
+                                  text TEXT, attributedBody BLOB, handle_id INTEGER DEFAULT 0,
+                                  service TEXT, date INTEGER, is_from_me INTEGER DEFAULT 0,
+                                  associated_message_guid TEXT, associated_message_type INTEGER DEFAULT 0);
+            CREATE TABLE chat_message_join (chat_id INTEGER, message_id INTEGER, message_date INTEGER DEFAULT 0,
+                                            PRIMARY KEY (chat_id, message_id));
+            CREATE INDEX message_idx_date ON message(date);
+            CREATE INDEX chat_message_join_idx_message_date_id_chat_id ON chat_message_join(chat_id, message_date, message_id);
+        )SQL");
+
+        SyntheticChatGenerator gen(cfg);
+        const auto& names = gen.senderNames();
+
+        execOrThrow(db, "BEGIN");
+
+        for (std::size_t i = 1; i < names.size(); ++i)
+        {
+            std::string sql = "INSERT INTO handle (ROWID, id, service) VALUES (" +
+                              std::to_string(i) + ", '" +
+                              SyntheticSenderAddress(static_cast<int>(i)) + "', 'iMessage')";
+            execOrThrow(db, sql.c_str());
+            sql = "INSERT INTO chat_handle_join (chat_id, handle_id) VALUES (1, " + std::to_string(i) + ")";
+            execOrThrow(db, sql.c_str());
+        }
+
+        {
+            std::string sql = std::string("INSERT INTO chat (ROWID, guid, chat_identifier, display_name, service_name) "
+                                          "VALUES (1, '") + SyntheticImessageChatGuid() +
+                              "', 'chat-synthetic-0001', '" +
+                              (names.size() > 2 ? "Synthetic Group" : "") + "', 'iMessage')";
+            execOrThrow(db, sql.c_str());
+        }
+
+        sqlite3_stmt* insMsg  = nullptr;
+        sqlite3_stmt* insJoin = nullptr;
+        if (sqlite3_prepare_v2(db,
+                "INSERT INTO message (ROWID, guid, text, handle_id, service, date, is_from_me) "
+                "VALUES (?, ?, ?, ?, 'iMessage', ?, ?)", -1, &insMsg, nullptr) != SQLITE_OK ||
+            sqlite3_prepare_v2(db,
+                "INSERT INTO chat_message_join (chat_id, message_id, message_date) VALUES (1, ?, ?)",
+                -1, &insJoin, nullptr) != SQLITE_OK)
+        {
+            sqlite3_finalize(insMsg);
+            throw std::runtime_error(std::string("Failed to prepare SQL: ") + sqlite3_errmsg(db));
+        }
+
+        const long long APPLE_EPOCH_MS = 978307200000LL;
+        SynthMessage msg;
+        while (gen.next(msg))
+        {
+            long long rowid    = static_cast<long long>(gen.produced());
+            long long appleNs  = (msg.timestampMs - APPLE_EPOCH_MS) * 1000000LL;
+            std::string guid   = "SYNTH-" + std::to_string(rowid);
+
+            sqlite3_bind_int64(insMsg, 1, rowid);
+            sqlite3_bind_text(insMsg, 2, guid.c_str(), -1, SQLITE_TRANSIENT);
+            if (msg.hasAttachment)
+                sqlite3_bind_text(insMsg, 3, "\xEF\xBF\xBC", -1, SQLITE_STATIC); // U+FFFC object replacement
+            else
+                sqlite3_bind_text(insMsg, 3, msg.content.c_str(),
+                                  static_cast<int>(msg.content.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int64(insMsg, 4, msg.sender == 0 ? 0 : msg.sender);
+            sqlite3_bind_int64(insMsg, 5, appleNs);
+            sqlite3_bind_int(insMsg, 6, msg.sender == 0 ? 1 : 0);
+
+            sqlite3_bind_int64(insJoin, 1, rowid);
+            sqlite3_bind_int64(insJoin, 2, appleNs);
+
+            if (sqlite3_step(insMsg) != SQLITE_DONE || sqlite3_step(insJoin) != SQLITE_DONE)
+            {
+                std::string err = sqlite3_errmsg(db);
+                sqlite3_finalize(insMsg);
+                sqlite3_finalize(insJoin);
+                throw std::runtime_error("SQLite insert failed: " + err);
+            }
+            sqlite3_reset(insMsg);
+            sqlite3_reset(insJoin);
+        }
+
+        sqlite3_finalize(insMsg);
+        sqlite3_finalize(insJoin);
+        execOrThrow(db, "COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_close(db);
+        throw;
+    }
+
+    sqlite3_close(db);
+}
+
+} // namespace bench
@@ -0,0 +1,91 @@
+// synthetic_chat.hpp
+// Deterministic synthetic chat generator used by the benchmark suite.
+//
+// The same (seed, messageCount, senderCount) always produces the same byte
+// stream on every platform: we use our own SplitMix64 PRNG and never touch
+// std:: distributions (their output is implementation-defined).
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+struct SynthConfig
+{
+    std::uint64_t seed         = 0xC4A7A11A5EEDULL;
+    std::size_t   messageCount = 10000;
+    int           senderCount  = 3;          // sender 0 is always the exporting user ("Me")
+    long long     startMs      = 1510089604000LL; // 2017-11-07 21:20:04 UTC
+};
+
+struct SynthMessage
+{
+    int         sender        = 0;
+    long long   timestampMs   = 0;
+    std::string content;                     // may contain '\n', emoji, curly quotes
+    bool        hasAttachment = false;       // media-only message (content empty)
+};
+
+// Streaming generator: call next() messageCount times.
+// Nothing is buffered, so 10M-message corpora cost O(1) memory to produce.
+class SyntheticChatGenerator
+{
+public:
+    explicit SyntheticChatGenerator(const SynthConfig& cfg);
+
+    bool next(SynthMessage& out);
+
+    const std::vector<std::string>& senderNames() const { return m_names; }
+    std::size_t produced() const { return m_produced; }
+
+private:
+    std::uint64_t nextU64();
+    double        nextUnit();                 // [0, 1)
+    std::size_t   nextBelow(std::size_t n);   // [0, n)
+
+    void buildContent(std::string& out);
+    void appendWord(std::string& out);
+
+    SynthConfig              m_cfg;
+    std::uint64_t            m_state;
+    std::vector<std::string> m_names;
+    std::size_t              m_produced   = 0;
+    long long                m_clockMs    = 0;
+    int                      m_lastSender = 0;
+};
+
+// Names used for senders; index 0 is the exporting user.
+const std::vector<std::string>& SyntheticSenderNames();
+
+// Phone number / handle used for sender i in SMS and iMessage corpora.
+std::string SyntheticSenderAddress(int sender);
+
+// -------------------------------------------------------------
+// Corpus writers (one per input format the converters accept)
+// -------------------------------------------------------------
+
+// Unified Instagram-style schema: outDir/message_1.json, message_2.json, ...
+void WriteUnifiedJsonCorpus(const SynthConfig& cfg, const std::string& outDir,
+                            std::size_t chunkSize = 5000);
+
+// WhatsApp "Export chat" text file (_chat.txt), iOS style timestamps.
+void WriteWhatsAppCorpus(const SynthConfig& cfg, const std::string& outFile);
+
+// Discrub JSON pages: outDir/page_1.json, page_2.json, ...
+void WriteDiscordCorpus(const SynthConfig& cfg, const std::string& outDir,
+                        std::size_t pageSize = 1000);
+
+// SMS Backup & Restore XML. Emoji are written as UTF-16 surrogate-pair
+// numeric entities, exactly like the real app does.
+void WriteAndroidSmsCorpus(const SynthConfig& cfg, const std::string& outFile);
+
+// Minimal iMessage chat.db (chat / handle / message / *_join tables).
+// All messages land in one chat with GUID SyntheticImessageChatGuid().
+void WriteImessageCorpus(const SynthConfig& cfg, const std::string& outFile);
+
+const char* SyntheticImessageChatGuid();
+
+} // namespace bench
@@ -7,17 +7,21 @@
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
-#include <iomanip>
-#include <sstream>
+#include <cstdlib>
 #include <stdexcept>
 #include <map>
 #include <ctime>
-#include <shobjidl.h> 
-#include <objbase.h>    
+#include <memory>
+#include <sstream>
 
 #include "json.hpp"
+#include "chat_analyzer.hpp"
 #include "vader_sentiment.hpp"
 #include "nrc_emotion.hpp"
+#include "message_scores.hpp"
+#include "mojibake.hpp"
+#include "utf8_text.hpp"
+#include "static_lexicon.hpp"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -27,69 +31,8 @@ using json = nlohmann::json;
 namespace fs = std::filesystem;
 
 // -------------------------------------------------------------
-// Shared structs & globals (for gui)
+// Shared globals (for gui)
 // -------------------------------------------------------------
-struct MonthlyEmotionPoint {
-    int year;
-    int month;
-    double avgCompound;
-};
-
-struct MonthlyCountPoint {
-    int year;
-    int month;
-    long long totalMessages;
-};
-
-struct MonthlyResponsePoint {
-    int year;
-    int month;
-    double avgMinutes;
-};
-
-struct MonthlyRomanticPoint {
-    int year;
-    int month;
-    long long romanticMessages;
-};
-
-struct MonthlyAvgLengthPoint {
-    int year;
-    int month;
-    double avgWords;
-};
-
-// Per-user series for charts
-struct UserMonthlyCountPoint {
-    int year;
-    int month;
-    long long totalMessages;
-};
-
-struct UserMonthlyEmotionPoint {
-    int year;
-    int month;
-    double avgCompound;
-};
-
-struct UserMonthlyResponsePoint {
-    int year;
-    int month;
-    double avgMinutes;
-};
-
-struct UserMonthlyRomanticPoint {
-    int year;
-    int month;
-    long long romanticMessages;
-};
-
-struct UserMonthlyAvgLengthPoint {
-    int year;
-    int month;
-    double avgWords;
-};
-
 int  g_heatmapCounts[7][24] = { 0 };
 bool g_heatmapReady = false;
 
@@ -123,34 +66,62 @@ struct MonthlyResponseAgg {
     long long count  = 0;
 };
 
-// Monthly total message counts (for "Messages per Month" chart)
-static std::map<std::pair<int,int>, MonthlyAggregate> g_monthlyAggregates;
-static std::map<std::pair<int,int>, long long>        g_monthlyMessageCounts;
+struct MonthlyEmojiAgg {
+    long long count = 0;
+    std::unordered_map<std::string, long long> frequency;
+};
 
-// Per-user monthly totals and emotion aggregates
-static std::map<std::string, std::map<std::pair<int,int>, long long>>      g_perUserMonthlyMessageCounts;
-static std::map<std::string, std::map<std::pair<int,int>, MonthlyAggregate>> g_perUserMonthlyEmotion;
+// Per-run accumulators. Every analysis owns one, so concurrent analyses
+// (batch mode) never share anything; runAnalysisToString publishes the
+// finished chart series into the g_* globals above for the GUI.
+struct AnalysisState {
+    int  heatmapCounts[7][24] = {};
+    bool heatmapReady = false;
 
-// New monthly accumulators
-static std::map<std::pair<int,int>, MonthlyResponseAgg>                               g_monthlyResponseAgg;
-static std::map<std::string, std::map<std::pair<int,int>, MonthlyResponseAgg>>       g_perUserMonthlyResponseAgg;
+    // Monthly total message counts (for "Messages per Month" chart)
+    std::map<std::pair<int,int>, MonthlyAggregate> monthlyAggregates;
+    std::map<std::pair<int,int>, long long>        monthlyMessageCounts;
 
-static std::map<std::pair<int,int>, long long>                                       g_monthlyRomanticCounts;
-static std::map<std::string, std::map<std::pair<int,int>, long long>>               g_perUserMonthlyRomanticCounts;
+    // Per-user monthly totals and emotion aggregates
+    std::map<std::string, std::map<std::pair<int,int>, long long>>        perUserMonthlyMessageCounts;
+    std::map<std::string, std::map<std::pair<int,int>, MonthlyAggregate>> perUserMonthlyEmotion;
 
-static std::map<std::pair<int,int>, MonthlyLengthAgg>                                g_monthlyLengthAgg;
-static std::map<std::string, std::map<std::pair<int,int>, MonthlyLengthAgg>>        g_perUserMonthlyLengthAgg;
+    std::map<std::pair<int,int>, MonthlyResponseAgg>                          monthlyResponseAgg;
+    std::map<std::string, std::map<std::pair<int,int>, MonthlyResponseAgg>>  perUserMonthlyResponseAgg;
 
-// -------------------------------------------------------------
-// NRC helper: category names
-// -------------------------------------------------------------
+    std::map<std::pair<int,int>, long long>                                   monthlyRomanticCounts;
+    std::map<std::string, std::map<std::pair<int,int>, long long>>           perUserMonthlyRomanticCounts;
 
-static constexpr int NRC_DIM = NrcEmotionLexicon::DIMENSIONS;
-static const char* NRC_CATEGORY_NAMES[NRC_DIM] = {
-    "anger", "anticipation", "disgust", "fear", "joy",
-    "sadness", "surprise", "trust", "negative", "positive"
+    std::map<std::pair<int,int>, MonthlyLengthAgg>                            monthlyLengthAgg;
+    std::map<std::string, std::map<std::pair<int,int>, MonthlyLengthAgg>>    perUserMonthlyLengthAgg;
+
+    std::map<std::pair<int,int>, MonthlyEmojiAgg>                             monthlyEmojiAgg;
+    std::map<std::string, std::map<std::pair<int,int>, MonthlyEmojiAgg>>     perUserMonthlyEmojiAgg;
+
+    // Explicit replies (exports with message_id / reply_to). Every message
+    // with an id is indexed by it; replies are kept aside and resolved against
+    // the index once all files are read, since a reply and the message it
+    // answers can sit in different chunks. Senders point at userStats keys.
+    struct ReplyTarget {
+        long long          timestampMs = 0;
+        const std::string* sender      = nullptr;
+    };
+    struct PendingReply {
+        std::size_t        index       = 0;   // score file row
+        long long          timestampMs = 0;
+        const std::string* sender      = nullptr;
+        std::string        replyTo;
+    };
+    std::unordered_map<std::string, ReplyTarget> messagesById;
+    std::vector<PendingReply>                    pendingReplies;
+
+    // Rough bytes held by the message timeline and word tables, checked
+    // against AnalysisOptions::memoryCapBytes.
+    std::size_t retainedBytes = 0;
 };
 
+static constexpr int NRC_DIM = NrcEmotionLexicon::DIMENSIONS;
+
 // -------------------------------------------------------------
 // Helper structs
 // -------------------------------------------------------------
@@ -162,6 +133,9 @@ struct UserStats {
 
     std::unordered_map<std::string, long long> wordFrequency;
 
+    long long emojiCount = 0;
+    std::unordered_map<std::string, long long> emojiFrequency;
+
     long long romanticMessages     = 0;
     long long conversationsStarted = 0;
 
@@ -174,6 +148,10 @@ struct UserStats {
 
     long long reactionsSent        = 0;
 
+    long long replyCount           = 0;   // replies matched to their target
+    long long totalReplyLatencyMs  = 0;
+    std::map<std::string, long long> repliesTo;   // replied-to sender -> count
+
     double vaderPosSum       = 0.0;
     double vaderNegSum       = 0.0;
     double vaderNeuSum       = 0.0;
@@ -191,17 +169,18 @@ struct Message {
     std::string sender;
     long long   timestampMs = 0;
     std::string content;
+    std::size_t index = 0;      // position in input order (score file row)
 };
 
-static std::string TrimLower(std::string s)
+static std::string TrimLower(const std::string& s)
 {
-    auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+    auto isSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
 
-    while (!s.empty() && isSpace((unsigned char)s.front())) s.erase(s.begin());
-    while (!s.empty() && isSpace((unsigned char)s.back()))  s.pop_back();
+    std::size_t begin = 0, end = s.size();
+    while (begin < end && isSpace(s[begin]))  ++begin;
+    while (end > begin && isSpace(s[end - 1])) --end;
 
-    for (char& c : s) c = (char)std::tolower((unsigned char)c);
-    return s;
+    return Utf8ToLower(std::string_view(s).substr(begin, end - begin));
 }
 
 static bool IsSystemPlaceholderMessage(const std::string& content)
@@ -219,7 +198,9 @@ static bool IsSystemPlaceholderMessage(const std::string& content)
 // -------------------------------------------------------------
 // Stop words
 // -------------------------------------------------------------
-const std::unordered_set<std::string> STOP_WORDS = {
+// Built at compile time; stop_words.txt next to the executable can add
+// and remove words at runtime (see LoadAnalysisLexicons).
+static constexpr auto STOP_WORDS = MakeStaticStringSet({
       "a","about","after","again","against","all","also","am","an","and","any",
     "are","as","at","be","because","been","before","being","below","between",
     "both","but","by","can","come","could","did","do","does","doing","down",
@@ -243,22 +224,22 @@ const std::unordered_set<std::string> STOP_WORDS = {
     "alright","anyway","aww","bc","bet","brb","bro","bruh","btw","cool","cuz",
     "dude","eh","fine","gonna","hah","haha","hahaha","hehe","hey","hi",
     "hmm","idc","idk","idek","im","jk","k","kk","lmao","lmfao","lol","loll",
-    "lolol","man","maybe","nah","nice","now","ok","okay","omg","oof","oop",
+    "lolol","man","maybe","nah","nice","ok","okay","omg","oof","oop",
     "pls","plz","pretty","prob","probably","really","right","rn","sure",
-    "thanks","thank","thx","true","uh","uhh","ugh","um","well","whoa",
+    "thanks","thank","thx","true","uh","uhh","ugh","um","whoa",
     "wow","wtf","yall","yup","ur",
 
     // Export noise (to avoid polluting analytics)
-    "attachment","attachments","message","messages","reacted","sent","still"
-};
+    "attachment","attachments","message","messages","reacted","sent"
+});
 
 // -------------------------------------------------------------
 // Junk tokens
 // -------------------------------------------------------------
-const std::unordered_set<std::string> JUNK_TOKENS = {
+static constexpr auto JUNK_TOKENS = MakeStaticStringSet({
     "don","t","ll","ve","re","im","id","ill","youre","youd",
     "attachment","attachments","sent","send"
-};
+});
 
 // -------------------------------------------------------------
 // Helpers
@@ -286,6 +267,12 @@ static fs::path GetExecutableDir()
         return fs::current_path();
     fs::path exePath(buf);
     return exePath.parent_path();
+#elif defined(__linux__)
+    std::error_code ec;
+    fs::path exePath = fs::read_symlink("/proc/self/exe", ec);
+    if (ec || exePath.empty())
+        return fs::current_path();
+    return exePath.parent_path();
 #else
     return fs::current_path();
 #endif
@@ -293,41 +280,6 @@ static fs::path GetExecutableDir()
 
 
 
-static std::string PadNumberSuffix(const std::string& number,
-                                   const std::string& suffix,
-                                   int numberWidth)
-{
-    std::ostringstream oss;
-    oss << std::right << std::setw(numberWidth) << number;
-    if (!suffix.empty())
-        oss << " " << suffix;
-    return oss.str();
-}
-
-static std::string FormatFixed(double v, int precision)
-{
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(precision) << v;
-    return oss.str();
-}
-
-std::string abbreviateContent(const std::string& input, std::size_t maxLen) {
-    std::string s = input;
-    for (char& c : s) {
-        if (c == '\n' || c == '\r') c = ' ';
-    }
-    if (s.size() <= maxLen) return s;
-    if (maxLen <= 3) return std::string(maxLen, '.');
-    return s.substr(0, maxLen - 3) + "...";
-}
-
-std::string toLower(const std::string& input) {
-    std::string result = input;
-    for (char &ch : result)
-        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-    return result;
-}
-
 void replaceAll(std::string& s, const std::string& from, const std::string& to) {
     if (from.empty()) return;
     std::size_t startPos = 0;
@@ -338,12 +290,22 @@ void replaceAll(std::string& s, const std::string& from, const std::string& to)
 }
 
 std::string normalizeContractions(const std::string& input) {
-    std::string s = toLower(input);
+    std::string s = Utf8ToLower(input);
     // normalize apostrophes
     replaceAll(s, "’", "'");
     replaceAll(s, "‘", "'");
     replaceAll(s, "",  "'");
 
+    // Only four patterns below lack an apostrophe and no replacement adds
+    // one, so a message without any skips the rest of the list.
+    if (s.find('\'') == std::string::npos) {
+        replaceAll(s, "cannot", "can not");
+        replaceAll(s, "im ",    "i am ");
+        replaceAll(s, "youre",  "you are");
+        replaceAll(s, "thats",  "that is");
+        return s;
+    }
+
     // negatives
     replaceAll(s, "don't",   "do not");
     replaceAll(s, "doesn't", "does not");
@@ -402,36 +364,64 @@ std::string normalizeContractions(const std::string& input) {
 
 std::vector<std::string> extractWordsLower(const std::string& text) {
     std::vector<std::string> words;
-    std::string current;
-    for (char ch : text) {
-        unsigned char uch = static_cast<unsigned char>(ch);
-        if (std::isalnum(uch))
-            current.push_back(static_cast<char>(std::tolower(uch)));
-        else {
-            if (!current.empty()) {
-                words.push_back(current);
-                current.clear();
-            }
-        }
+    Utf8ExtractWords(text, words);
+
+    // Filter in place; the kept words move down over the dropped ones.
+    auto dropped = [](const std::string& w) {
+        if (w == "i") return false;
+        if (w.size() == 1) return true;
+        if (w == "ll" || w == "re" || w == "ve") return true;
+        return JUNK_TOKENS.contains(w);
+    };
+    words.erase(std::remove_if(words.begin(), words.end(), dropped), words.end());
+    return words;
+}
+
+// The n most frequent keys, most frequent first; ties go by key so the
+// order does not depend on hashing.
+static std::vector<std::pair<std::string, long long>> TopCounts(
+    const std::unordered_map<std::string, long long>& frequency, std::size_t n) {
+    std::vector<std::pair<std::string, long long>> top(frequency.begin(), frequency.end());
+    auto byCount = [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    };
+    if (top.size() > n) {
+        std::partial_sort(top.begin(), top.begin() + n, top.end(), byCount);
+        top.resize(n);
+    } else {
+        std::sort(top.begin(), top.end(), byCount);
     }
-    if (!current.empty())
-        words.push_back(current);
-
-    std::vector<std::string> filtered;
-    filtered.reserve(words.size());
-    for (const std::string& w : words) {
-        if (w == "i") {
-            filtered.push_back(w);
-            continue;
-        }
-        if (w.size() == 1) continue;
-        if (w == "m" || w == "s" || w == "t" || w == "d" || w == "ll" || w == "re" || w == "ve")
-            continue;
-        if (JUNK_TOKENS.find(w) != JUNK_TOKENS.end())
-            continue;
-        filtered.push_back(w);
+    return top;
+}
+
+// Thread-safe localtime (batch mode analyzes several chats at once).
+static bool ToLocalTm(long long timestampMs, std::tm& out) {
+    std::time_t t = static_cast<std::time_t>(timestampMs / 1000);
+#ifdef _WIN32
+    return localtime_s(&out, &t) == 0;
+#else
+    return localtime_r(&t, &out) != nullptr;
+#endif
+}
+
+// Per-chat memory cap. Parsing a file builds a JSON DOM several times the
+// size of the raw text, so that is charged up front, on top of what earlier
+// files already left behind.
+static constexpr std::size_t JSON_DOM_BYTES_PER_INPUT_BYTE = 8;
+
+static void CheckMemoryCap(const AnalysisState& state,
+                           const AnalysisOptions& options,
+                           std::size_t pendingBytes,
+                           const std::string& what) {
+    if (options.memoryCapBytes == 0)
+        return;
+    if (state.retainedBytes + pendingBytes > options.memoryCapBytes) {
+        throw std::runtime_error(
+            "Memory cap exceeded while processing " + what + " (~" +
+            formatWithCommas(static_cast<long long>((state.retainedBytes + pendingBytes + (1u << 20) - 1) >> 20)) +
+            " MB needed, cap " +
+            formatWithCommas(static_cast<long long>(options.memoryCapBytes >> 20)) + " MB)");
     }
-    return filtered;
 }
 
 std::string readFileToString(const std::string& filename) {
@@ -454,16 +444,38 @@ void processJsonFile(
     const std::vector<std::string>& romanticPhrasesLower,
     std::unordered_set<std::string>& nameWordsStop,
     const VaderSentiment& analyzer,
-    const NrcEmotionLexicon& nrcLexicon
+    const NrcEmotionLexicon& nrcLexicon,
+    const AnalysisOptions& options,
+    AnalysisState& state,
+    MessageScoreWriter* scores
 ) {
-    json j = json::parse(readFileToString(filename));
+    std::string fileName = fs::path(filename).filename().string();
+    if (options.memoryCapBytes != 0) {
+        std::error_code ec;
+        auto fileSize = fs::file_size(filename, ec);
+        if (!ec)
+            CheckMemoryCap(state, options,
+                           static_cast<std::size_t>(fileSize) * JSON_DOM_BYTES_PER_INPUT_BYTE,
+                           fileName);
+    }
+
+    // Instagram / Messenger exports spell UTF-8 as Latin-1; decided once per
+    // file, then every string that is analyzed is repaired on the way in.
+    json j;
+    bool metaMojibake = false;
+    {
+        std::string raw = readFileToString(filename);
+        metaMojibake = LooksLikeMetaMojibake(raw);
+        j = json::parse(raw);
+    }
 
     // Collect participant name tokens (so we can drop them from "top words")
     if (j.contains("participants") && j["participants"].is_array()) {
         for (const auto& p : j["participants"]) {
             if (p.contains("name") && p["name"].is_string()) {
                 std::string name    = p["name"];
-                std::string lowered = toLower(name);
+                if (metaMojibake) RepairMetaMojibake(name);
+                std::string lowered = Utf8ToLower(name);
                 std::vector<std::string> nameTokens = extractWordsLower(lowered);
                 for (const std::string& w : nameTokens)
                     nameWordsStop.insert(w);
@@ -472,7 +484,7 @@ void processJsonFile(
     }
 
     if (!j.contains("messages") || !j["messages"].is_array()) {
-        std::cerr << "Warning: '" << fs::path(filename).filename().string()
+        std::cerr << "Warning: '" << fileName
                   << "' does not contain a valid 'messages' array.\n";
         return;
     }
@@ -482,6 +494,7 @@ void processJsonFile(
             continue;
 
         std::string sender = msg["sender_name"];
+        if (metaMojibake) RepairMetaMojibake(sender);
 
         // Skip Meta AI entirely
         if (sender == "Meta AI")
@@ -494,42 +507,31 @@ void processJsonFile(
         std::string content;
         if (msg.contains("content") && msg["content"].is_string())
             content = msg["content"];
+        if (metaMojibake) RepairMetaMojibake(content);
 
-        if (!content.empty()) {
-            std::string lowerContent = toLower(content);
-            if (IsSystemPlaceholderMessage(content)) continue;
-        }
+        if (!content.empty() && IsSystemPlaceholderMessage(content))
+            continue;
 
         // --- Time breakdown for heatmap / monthly sentiment / monthly volume ----
         std::tm localTm{};
         bool haveLocalTm = false;
         if (timestampMs > 0) {
-            std::time_t t = static_cast<std::time_t>(timestampMs / 1000);
-#ifdef _WIN32
-            if (localtime_s(&localTm, &t) == 0)
-                haveLocalTm = true;
-#else
-            std::tm* ptm = std::localtime(&t);
-            if (ptm) {
-                localTm = *ptm;
-                haveLocalTm = true;
-            }
-#endif
+            haveLocalTm = ToLocalTm(timestampMs, localTm);
             if (haveLocalTm) {
                 int hour = localTm.tm_hour; // 0..23
                 int wday = localTm.tm_wday; // 0=Sunday
                 int row  = (wday + 6) % 7;  // 0=Mon ... 6=Sun
                 if (row >= 0 && row < 7 && hour >= 0 && hour < 24) {
-                    g_heatmapCounts[row][hour]++;
-                    g_heatmapReady = true;
+                    state.heatmapCounts[row][hour]++;
+                    state.heatmapReady = true;
                 }
 
                 // Monthly total messages (count every message w/ timestamp)
                 int year  = localTm.tm_year + 1900;
                 int month = localTm.tm_mon + 1;
                 auto key  = std::make_pair(year, month);
-                g_monthlyMessageCounts[key]++;
-                g_perUserMonthlyMessageCounts[sender][key]++;
+                state.monthlyMessageCounts[key]++;
+                state.perUserMonthlyMessageCounts[sender][key]++;
             }
         }
 
@@ -538,16 +540,41 @@ void processJsonFile(
         m.sender      = sender;
         m.timestampMs = timestampMs;
         m.content     = content;
+        m.index       = allMessages.size();
         allMessages.push_back(m);
+        state.retainedBytes += sizeof(Message) + sender.size() + content.size();
 
-        UserStats& stats = userStats[sender];
+        auto statsIt = userStats.try_emplace(sender).first;
+        UserStats& stats = statsIt->second;
         stats.totalMessages++;
 
+        // Reply links
+        if (msg.contains("message_id") && msg["message_id"].is_string()) {
+            const std::string& id = msg["message_id"].get_ref<const std::string&>();
+            AnalysisState::ReplyTarget target{ timestampMs, &statsIt->first };
+            if (state.messagesById.emplace(id, target).second)
+                state.retainedBytes += id.size() + 64; // node + key
+        }
+        if (msg.contains("reply_to") && msg["reply_to"].is_string()) {
+            AnalysisState::PendingReply reply;
+            reply.index       = m.index;
+            reply.timestampMs = timestampMs;
+            reply.sender      = &statsIt->first;
+            reply.replyTo     = msg["reply_to"].get<std::string>();
+            state.retainedBytes += sizeof(reply) + reply.replyTo.size();
+            state.pendingReplies.push_back(std::move(reply));
+        }
+
+        MessageScoreRow scoreRow;
+        scoreRow.timestampMs = timestampMs;
+        scoreRow.sender      = &sender;
+
         // Reactions
         if (msg.contains("reactions") && msg["reactions"].is_array()) {
             for (const auto& r : msg["reactions"]) {
                 if (r.contains("actor") && r["actor"].is_string()) {
                     std::string actor = r["actor"];
+                    if (metaMojibake) RepairMetaMojibake(actor);
                     if (actor == "Meta AI") continue;
                     UserStats& aStats = userStats[actor];
                     aStats.reactionsSent++;
@@ -558,6 +585,34 @@ void processJsonFile(
         if (!content.empty()) {
             std::string normalized = normalizeContractions(content);
             std::vector<std::string> words = extractWordsLower(normalized);
+
+            // Emoji come out of the same split; tally them and keep only
+            // the words.
+            std::size_t keptWords = 0;
+            for (std::size_t k = 0; k < words.size(); ++k) {
+                if (!Utf8IsEmoji(words[k])) {
+                    if (keptWords != k)
+                        words[keptWords] = std::move(words[k]);
+                    ++keptWords;
+                    continue;
+                }
+                const std::string& e = words[k];
+                stats.emojiCount++;
+                if (stats.emojiFrequency[e]++ == 0)
+                    state.retainedBytes += e.size() + 64; // node + key
+                if (haveLocalTm) {
+                    auto key = std::make_pair(localTm.tm_year + 1900, localTm.tm_mon + 1);
+                    MonthlyEmojiAgg& agg  = state.monthlyEmojiAgg[key];
+                    MonthlyEmojiAgg& uAgg = state.perUserMonthlyEmojiAgg[sender][key];
+                    agg.count++;
+                    uAgg.count++;
+                    if (agg.frequency[e]++ == 0)
+                        state.retainedBytes += e.size() + 64;
+                    if (uAgg.frequency[e]++ == 0)
+                        state.retainedBytes += e.size() + 64;
+                }
+            }
+            words.resize(keptWords);
             long long wordCount = static_cast<long long>(words.size());
 
             if (wordCount > 0) {
@@ -571,17 +626,21 @@ void processJsonFile(
                     int month = localTm.tm_mon + 1;
                     auto key  = std::make_pair(year, month);
 
-                    MonthlyLengthAgg& agg = g_monthlyLengthAgg[key];
+                    MonthlyLengthAgg& agg = state.monthlyLengthAgg[key];
                     agg.sumWords += wordCount;
                     agg.msgCount += 1;
 
-                    MonthlyLengthAgg& uAgg = g_perUserMonthlyLengthAgg[sender][key];
+                    MonthlyLengthAgg& uAgg = state.perUserMonthlyLengthAgg[sender][key];
                     uAgg.sumWords += wordCount;
                     uAgg.msgCount += 1;
                 }
 
-                for (const std::string& w : words)
-                    stats.wordFrequency[w]++;
+                for (const std::string& w : words) {
+                    long long& freq = stats.wordFrequency[w];
+                    if (freq++ == 0)
+                        state.retainedBytes += w.size() + 64; // node + key
+                }
+                state.retainedBytes += sizeof(long long);    // messageWordLengths
 
                 if (wordCount > stats.longestMessageWords) {
                     stats.longestMessageWords   = wordCount;
@@ -591,6 +650,9 @@ void processJsonFile(
                 // NRC
                 NrcEmotionLexicon::Scores nrcScores;
                 nrcLexicon.scoreWords(words, nrcScores);
+                scoreRow.wordCount = wordCount;
+                if (scores)
+                    std::copy(nrcScores.values, nrcScores.values + NRC_DIM, scoreRow.nrc);
                 double tokenTaggedHere = 0.0;
                 for (int i = 0; i < NRC_DIM; ++i) {
                     stats.nrcEmotionSums[i] += nrcScores.values[i];
@@ -601,7 +663,7 @@ void processJsonFile(
 
             // Romantic phrases
             if (!romanticPhrasesLower.empty()) {
-                std::string contentLower = toLower(content);
+                std::string contentLower = Utf8ToLower(content);
                 bool foundRomantic = false;
                 for (const std::string& phraseLower : romanticPhrasesLower) {
                     if (!phraseLower.empty() &&
@@ -612,12 +674,13 @@ void processJsonFile(
                 }
                 if (foundRomantic) {
                     stats.romanticMessages++;
+                    scoreRow.romantic = true;
                     if (haveLocalTm) {
                         int year  = localTm.tm_year + 1900;
                         int month = localTm.tm_mon + 1;
                         auto key  = std::make_pair(year, month);
-                        g_monthlyRomanticCounts[key]++;
-                        g_perUserMonthlyRomanticCounts[sender][key]++;
+                        state.monthlyRomanticCounts[key]++;
+                        state.perUserMonthlyRomanticCounts[sender][key]++;
                     }
                 }
             }
@@ -631,6 +694,11 @@ void processJsonFile(
             stats.vaderCompoundSum += compound;
             stats.vaderSamples++;
 
+            scoreRow.vaderNeg      = neg;
+            scoreRow.vaderNeu      = neu;
+            scoreRow.vaderPos      = pos;
+            scoreRow.vaderCompound = compound;
+
             // Monthly sentiment aggregate (only if given time)
             if (haveLocalTm) {
                 int year  = localTm.tm_year + 1900;
@@ -638,19 +706,25 @@ void processJsonFile(
                 auto key  = std::make_pair(year, month);
 
                 // Global aggregate
-                MonthlyAggregate& agg = g_monthlyAggregates[key];
+                MonthlyAggregate& agg = state.monthlyAggregates[key];
                 agg.sumCompound += compound;
                 agg.count       += 1;
 
                 // Per-user aggregate
-                MonthlyAggregate& userAgg = g_perUserMonthlyEmotion[sender][key];
+                MonthlyAggregate& userAgg = state.perUserMonthlyEmotion[sender][key];
                 userAgg.sumCompound += compound;
                 userAgg.count       += 1;
             }
         }
+
+        if (scores)
+            scores->append(scoreRow);
+
+        CheckMemoryCap(state, options, 0, fileName);
     }
 
-    std::cout << "Processed: " << fs::path(filename).filename().string() << "\n";
+    if (options.verbose)
+        std::cout << "Processed: " << fileName << "\n";
 }
 
 // -------------------------------------------------------------
@@ -658,7 +732,9 @@ void processJsonFile(
 // -------------------------------------------------------------
 void analyzeTimeline(
     const std::vector<Message>& allMessagesIn,
-    std::unordered_map<std::string, UserStats>& userStats
+    std::unordered_map<std::string, UserStats>& userStats,
+    AnalysisState& state,
+    std::vector<long long>* replyLatencyMs
 ) {
     if (allMessagesIn.size() < 2)
         return;
@@ -687,35 +763,24 @@ void analyzeTimeline(
             UserStats& replyStats = userStats[msg.sender];
             replyStats.totalResponseTimeMs += gap;
             replyStats.responseCount += 1;
+            if (replyLatencyMs)
+                (*replyLatencyMs)[msg.index] = gap;
 
             // monthly response time aggregates (global + per user)
-            if (msg.timestampMs > 0) {
-                std::time_t t = static_cast<std::time_t>(msg.timestampMs / 1000);
-                std::tm localTm{};
-#ifdef _WIN32
-                if (localtime_s(&localTm, &t) == 0) {
-#else
-                std::tm* ptm = std::localtime(&t);
-                if (ptm) {
-                    localTm = *ptm;
-#endif
-                    int year  = localTm.tm_year + 1900;
-                    int month = localTm.tm_mon + 1;
-                    auto key  = std::make_pair(year, month);
+            std::tm localTm{};
+            if (msg.timestampMs > 0 && ToLocalTm(msg.timestampMs, localTm)) {
+                int year  = localTm.tm_year + 1900;
+                int month = localTm.tm_mon + 1;
+                auto key  = std::make_pair(year, month);
 
-                    MonthlyResponseAgg& gAgg = g_monthlyResponseAgg[key];
-                    gAgg.sumMs += gap;
-                    gAgg.count += 1;
+                MonthlyResponseAgg& gAgg = state.monthlyResponseAgg[key];
+                gAgg.sumMs += gap;
+                gAgg.count += 1;
 
-                    MonthlyResponseAgg& uAgg =
-                        g_perUserMonthlyResponseAgg[msg.sender][key];
-                    uAgg.sumMs += gap;
-                    uAgg.count += 1;
-#ifdef _WIN32
-                }
-#else
-                }
-#endif
+                MonthlyResponseAgg& uAgg =
+                    state.perUserMonthlyResponseAgg[msg.sender][key];
+                uAgg.sumMs += gap;
+                uAgg.count += 1;
             }
         }
 
@@ -745,74 +810,145 @@ void analyzeTimeline(
 }
 
 // -------------------------------------------------------------
-// Core analysis function used by GUI & console
+// Explicit replies: one pass over the pending replies, each looked up in
+// the id index. Latency is the exact gap to the message answered, and it
+// replaces the adjacency estimate in the score file for that row.
 // -------------------------------------------------------------
-std::string runAnalysisToString(const std::string& inputPathStr) {
-    // Reset global analytics every run
-    std::fill(&g_heatmapCounts[0][0], &g_heatmapCounts[0][0] + 7 * 24, 0);
-    g_heatmapReady = false;
-
-    g_monthlyEmotionPoints.clear();
-    g_monthlyAggregates.clear();
-
-    g_monthlyMessageCounts.clear();
-    g_monthlyCountPoints.clear();
+void resolveReplies(
+    std::unordered_map<std::string, UserStats>& userStats,
+    AnalysisState& state,
+    std::vector<long long>* replyLatencyMs
+) {
+    for (const AnalysisState::PendingReply& reply : state.pendingReplies) {
+        auto it = state.messagesById.find(reply.replyTo);
+        if (it == state.messagesById.end())
+            continue;   // answers a message outside the export
+        const AnalysisState::ReplyTarget& target = it->second;
+        if (reply.timestampMs <= 0 || target.timestampMs <= 0)
+            continue;
 
-    g_monthlyResponseAgg.clear();
-    g_monthlyResponsePoints.clear();
+        const long long latency = std::max(0LL, reply.timestampMs - target.timestampMs);
+        UserStats& stats = userStats[*reply.sender];
+        stats.repliesTo[*target.sender]++;
+        stats.replyCount++;
+        stats.totalReplyLatencyMs += latency;
+        if (replyLatencyMs)
+            (*replyLatencyMs)[reply.index] = latency;
+    }
+}
 
-    g_monthlyRomanticCounts.clear();
-    g_monthlyRomanticPoints.clear();
+// -------------------------------------------------------------
+// Lexicons
+// -------------------------------------------------------------
+// Stop-word overrides, one word per line: "word" adds it to the built-in
+// list, "-word" takes it out. Blank lines and # comments are skipped.
+// Returns false if the file cannot be opened.
+static bool LoadStopWordOverrides(const fs::path& path, WordSetOverrides& out) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
 
-    g_monthlyLengthAgg.clear();
-    g_monthlyAvgLengthPoints.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string word = TrimLower(line);
+        if (word.empty() || word[0] == '#')
+            continue;
+        if (word[0] == '-') {
+            word.erase(0, 1);
+            if (!word.empty())
+                out.remove(std::move(word));
+        } else {
+            out.add(std::move(word));
+        }
+    }
+    return true;
+}
 
-    g_chartUserNames.clear();
+// VADER overrides, one entry per line; blank lines and # comments are
+// skipped, malformed lines are reported and skipped:
+//   booster  <word or phrase> <scalar>    e.g. "booster mega 0.293"
+//   negation <word>                       e.g. "negation nevah"
+//   idiom    <phrase> <valence>           e.g. "idiom dumb luck 2"
+// Returns false if the file cannot be opened.
+static bool LoadVaderOverrides(const fs::path& path, VaderSentiment& vader) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
 
-    g_userMonthlyCountSeries.clear();
-    g_userMonthlyEmotionSeries.clear();
-    g_userMonthlyResponseSeries.clear();
-    g_userMonthlyRomanticSeries.clear();
-    g_userMonthlyAvgLengthSeries.clear();
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        std::string entry = TrimLower(line);
+        if (entry.empty() || entry[0] == '#')
+            continue;
 
-    g_perUserMonthlyMessageCounts.clear();
-    g_perUserMonthlyEmotion.clear();
-    g_perUserMonthlyResponseAgg.clear();
-    g_perUserMonthlyRomanticCounts.clear();
-    g_perUserMonthlyLengthAgg.clear();
+        std::istringstream fields(entry);
+        std::string kind;
+        std::vector<std::string> words;
+        fields >> kind;
+        for (std::string w; fields >> w; )
+            words.push_back(std::move(w));
+
+        bool ok = false;
+        if (kind == "negation") {
+            ok = words.size() == 1;
+            if (ok)
+                vader.addNegationWord(words[0]);
+        } else if ((kind == "booster" || kind == "idiom") && words.size() >= 2) {
+            const std::string& number = words.back();
+            char* end = nullptr;
+            const double value = std::strtod(number.c_str(), &end);
+            ok = end == number.c_str() + number.size();
+            if (ok) {
+                std::string phrase = words[0];
+                for (std::size_t i = 1; i + 1 < words.size(); ++i)
+                    phrase += ' ' + words[i];
+                if (kind == "booster")
+                    vader.setBooster(phrase, value);
+                else
+                    vader.setSpecialCase(phrase, value);
+            }
+        }
+        if (!ok)
+            std::cerr << "Warning: " << path.filename().string() << " line " << lineNo
+                      << " ignored: \"" << line << "\"\n";
+    }
+    return true;
+}
 
-    // Load sentiment resources
+std::shared_ptr<const AnalysisLexicons> LoadAnalysisLexicons() {
     fs::path exeDir = GetExecutableDir();
+    auto lex = std::make_shared<AnalysisLexicons>();
 
-    VaderSentiment analyzer;
     {
         fs::path vaderPath = exeDir / "vader_lexicon.txt";
-        if (!analyzer.loadLexicon(vaderPath.string()))
+        if (!lex->vader.loadLexicon(vaderPath.string()))
         {
             // dev fallback (if running from a different working dir)
-            if (!analyzer.loadLexicon("vader_lexicon.txt"))
+            if (!lex->vader.loadLexicon("vader_lexicon.txt"))
                 throw std::runtime_error("Failed to load vader_lexicon.txt");
         }
     }
 
-    NrcEmotionLexicon nrc;
     {
         fs::path nrcPath = exeDir / "nrc_emotion_lexicon.txt";
-        if (!nrc.loadFromFile(nrcPath.string()))
+        if (!lex->nrc.loadFromFile(nrcPath.string()))
         {
-            if (!nrc.loadFromFile("nrc_emotion_lexicon.txt"))
+            if (!lex->nrc.loadFromFile("nrc_emotion_lexicon.txt"))
                 throw std::runtime_error("Failed to load nrc_emotion_lexicon.txt");
         }
     }
 
+    // Optional: without them the built-in tables are used as they are.
+    if (!LoadStopWordOverrides(exeDir / "stop_words.txt", lex->stopWordOverrides))
+        LoadStopWordOverrides("stop_words.txt", lex->stopWordOverrides);
+    if (!LoadVaderOverrides(exeDir / "vader_overrides.txt", lex->vader))
+        LoadVaderOverrides("vader_overrides.txt", lex->vader);
 
-    fs::path inputPath = inputPathStr;
-
-    std::unordered_map<std::string, UserStats> userStats;
-    std::vector<Message> allMessages;
-    std::unordered_set<std::string> nameWordsStop;
+    return lex;
+}
 
-    std::vector<std::string> romanticPhrasesLower = {
+static const std::vector<std::string>& RomanticPhrasesLower() {
+    static const std::vector<std::string> phrases = {
     // affection / love
     "love you",
     "love u",
@@ -922,6 +1058,41 @@ std::string runAnalysisToString(const std::string& inputPathStr) {
     "you complete me",
     "we belong together",
     };
+    return phrases;
+}
+
+// -------------------------------------------------------------
+// Core analysis: accumulates into `state`, then builds the results model
+// -------------------------------------------------------------
+static AnalysisResults runAnalysisCore(
+    const std::string& inputPathStr,
+    const AnalysisLexicons& lexicons,
+    const AnalysisOptions& options,
+    AnalysisState& state
+) {
+    const VaderSentiment&    analyzer = lexicons.vader;
+    const NrcEmotionLexicon& nrc      = lexicons.nrc;
+    const std::vector<std::string>& romanticPhrasesLower = RomanticPhrasesLower();
+
+    fs::path inputPath = inputPathStr;
+
+    // Optional per-message score sink. A CSV-only request still goes through
+    // the columnar writer (to a temporary file) so rows are never held in memory.
+    std::unique_ptr<MessageScoreWriter> scores;
+    std::string scoresPath = options.messageScoresPath;
+    if (!options.messageScoresPath.empty() || !options.messageScoresCsvPath.empty()) {
+        if (scoresPath.empty())
+            scoresPath = options.messageScoresCsvPath + ".cols.tmp";
+        scores = std::make_unique<MessageScoreWriter>();
+        std::string error;
+        if (!scores->open(scoresPath, error))
+            throw std::runtime_error(error);
+    }
+
+    std::unordered_map<std::string, UserStats> userStats;
+    std::vector<Message> allMessages;
+    std::unordered_set<std::string> nameWordsStop;
+
 
     if (fs::is_regular_file(inputPath)) {
         processJsonFile(
@@ -931,7 +1102,10 @@ std::string runAnalysisToString(const std::string& inputPathStr) {
             romanticPhrasesLower,
             nameWordsStop,
             analyzer,
-            nrc
+            nrc,
+            options,
+            state,
+            scores.get()
         );
     } else if (fs::is_directory(inputPath)) {
         for (const auto& entry : fs::directory_iterator(inputPath)) {
@@ -943,7 +1117,10 @@ std::string runAnalysisToString(const std::string& inputPathStr) {
                     romanticPhrasesLower,
                     nameWordsStop,
                     analyzer,
-                    nrc
+                    nrc,
+                    options,
+                    state,
+                    scores.get()
                 );
             }
         }
@@ -951,132 +1128,71 @@ std::string runAnalysisToString(const std::string& inputPathStr) {
         throw std::runtime_error("Invalid path: " + inputPathStr);
     }
 
-    analyzeTimeline(allMessages, userStats);
+    std::vector<long long> replyLatencyMs;
+    if (scores)
+        replyLatencyMs.assign(allMessages.size(), -1);
+
+    analyzeTimeline(allMessages, userStats, state, scores ? &replyLatencyMs : nullptr);
+    resolveReplies(userStats, state, scores ? &replyLatencyMs : nullptr);
+
+    if (scores) {
+        std::string error;
+        bool ok = scores->finish(replyLatencyMs, error);
+        if (ok && !options.messageScoresCsvPath.empty())
+            ok = ConvertMessageScoresToCsv(scoresPath, options.messageScoresCsvPath, error);
+        if (options.messageScoresPath.empty()) {
+            std::error_code ec;
+            fs::remove(scoresPath, ec);
+        }
+        if (!ok)
+            throw std::runtime_error(error);
+    }
+
+    AnalysisResults results;
+    results.totalMessages = static_cast<long long>(allMessages.size());
 
-    // Finalize monthly emotion points from aggregates
-    g_monthlyEmotionPoints.clear();
-    for (const auto& kv : g_monthlyAggregates) {
-        const auto& key = kv.first;
+    std::copy(&state.heatmapCounts[0][0], &state.heatmapCounts[0][0] + 7 * 24,
+              &results.heatmapCounts[0][0]);
+    results.heatmapReady = state.heatmapReady;
+
+    // Finalize monthly series. The aggregates are std::maps keyed by
+    // (year, month), so iteration order is already chronological.
+    for (const auto& kv : state.monthlyAggregates) {
         const auto& agg = kv.second;
         if (agg.count <= 0) continue;
-        MonthlyEmotionPoint p;
-        p.year        = key.first;
-        p.month       = key.second;
-        p.avgCompound = agg.sumCompound / static_cast<double>(agg.count);
-        g_monthlyEmotionPoints.push_back(p);
-    }
-    std::sort(
-        g_monthlyEmotionPoints.begin(),
-        g_monthlyEmotionPoints.end(),
-        [](const MonthlyEmotionPoint& a, const MonthlyEmotionPoint& b) {
-            if (a.year != b.year) return a.year < b.year;
-            return a.month < b.month;
-        }
-    );
-
-    // Finalize monthly total message counts
-    g_monthlyCountPoints.clear();
-    for (const auto& kv : g_monthlyMessageCounts) {
-        MonthlyCountPoint p;
-        p.year          = kv.first.first;
-        p.month         = kv.first.second;
-        p.totalMessages = kv.second;
-        g_monthlyCountPoints.push_back(p);
+        results.monthlyEmotion.push_back({ kv.first.first, kv.first.second,
+            agg.sumCompound / static_cast<double>(agg.count) });
     }
-    std::sort(
-        g_monthlyCountPoints.begin(),
-        g_monthlyCountPoints.end(),
-        [](const MonthlyCountPoint& a, const MonthlyCountPoint& b) {
-            if (a.year != b.year) return a.year < b.year;
-            return a.month < b.month;
-        }
-    );
-
-    // Finalize monthly average response time (global)
-    g_monthlyResponsePoints.clear();
-    for (const auto& kv : g_monthlyResponseAgg) {
-        const auto& key = kv.first;
+    for (const auto& kv : state.monthlyMessageCounts)
+        results.monthlyCounts.push_back({ kv.first.first, kv.first.second, kv.second });
+    for (const auto& kv : state.monthlyResponseAgg) {
         const auto& agg = kv.second;
         if (agg.count <= 0) continue;
-        MonthlyResponsePoint p;
-        p.year       = key.first;
-        p.month      = key.second;
         double avgMs = static_cast<double>(agg.sumMs) / static_cast<double>(agg.count);
-        p.avgMinutes = (avgMs / 1000.0) / 60.0;
-        g_monthlyResponsePoints.push_back(p);
+        results.monthlyResponse.push_back({ kv.first.first, kv.first.second,
+            (avgMs / 1000.0) / 60.0 });
     }
-    std::sort(
-        g_monthlyResponsePoints.begin(),
-        g_monthlyResponsePoints.end(),
-        [](const MonthlyResponsePoint& a, const MonthlyResponsePoint& b) {
-            if (a.year != b.year) return a.year < b.year;
-            return a.month < b.month;
-        }
-    );
-
-    // Finalize monthly romantic counts (global)
-    g_monthlyRomanticPoints.clear();
-    for (const auto& kv : g_monthlyRomanticCounts) {
-        MonthlyRomanticPoint p;
-        p.year             = kv.first.first;
-        p.month            = kv.first.second;
-        p.romanticMessages = kv.second;
-        g_monthlyRomanticPoints.push_back(p);
-    }
-    std::sort(
-        g_monthlyRomanticPoints.begin(),
-        g_monthlyRomanticPoints.end(),
-        [](const MonthlyRomanticPoint& a, const MonthlyRomanticPoint& b) {
-            if (a.year != b.year) return a.year < b.year;
-            return a.month < b.month;
-        }
-    );
-
-    // Finalize monthly average message length (global)
-    g_monthlyAvgLengthPoints.clear();
-    for (const auto& kv : g_monthlyLengthAgg) {
-        const auto& key = kv.first;
+    for (const auto& kv : state.monthlyRomanticCounts)
+        results.monthlyRomantic.push_back({ kv.first.first, kv.first.second, kv.second });
+    for (const auto& kv : state.monthlyLengthAgg) {
         const auto& agg = kv.second;
         if (agg.msgCount <= 0) continue;
-        MonthlyAvgLengthPoint p;
-        p.year     = key.first;
-        p.month    = key.second;
-        p.avgWords = static_cast<double>(agg.sumWords) /
-                     static_cast<double>(agg.msgCount);
-        g_monthlyAvgLengthPoints.push_back(p);
+        results.monthlyAvgLength.push_back({ kv.first.first, kv.first.second,
+            static_cast<double>(agg.sumWords) / static_cast<double>(agg.msgCount) });
     }
-    std::sort(
-        g_monthlyAvgLengthPoints.begin(),
-        g_monthlyAvgLengthPoints.end(),
-        [](const MonthlyAvgLengthPoint& a, const MonthlyAvgLengthPoint& b) {
-            if (a.year != b.year) return a.year < b.year;
-            return a.month < b.month;
+    for (const auto& kv : state.monthlyMessageCounts) {
+        MonthlyEmojiPoint p{ kv.first.first, kv.first.second, 0, 0.0, {}, 0 };
+        auto it = state.monthlyEmojiAgg.find(kv.first);
+        if (it != state.monthlyEmojiAgg.end()) {
+            p.emojiCount      = it->second.count;
+            p.emojiPerMessage = static_cast<double>(it->second.count) /
+                                static_cast<double>(kv.second);
+            auto top = TopCounts(it->second.frequency, 1);
+            p.topEmoji      = top[0].first;
+            p.topEmojiCount = top[0].second;
         }
-    );
-
-    // ---------------- Build report string ----------------
-    std::ostringstream out;
-
-    const int LABEL_WIDTH = 40;
-    const int COL_WIDTH   = 26;
-    const int NUM_WIDTH = 12;
-
-    // Helper: comparative row
-    auto printRow = [&](const std::string& label,
-                    const std::vector<std::string>& values) {
-    out << " " << std::left << std::setw(LABEL_WIDTH) << (label + ":");
-    for (const auto& v : values)
-        out << " " << std::right << std::setw(COL_WIDTH) << v;
-    out << "\n";
-    };
-
-
-    // Helper: single-user stat
-    auto printSingle = [&](const std::string& label,
-                           const std::string& value) {
-        out << " " << std::left << std::setw(LABEL_WIDTH)
-            << (label + ":") << " " << value << "\n";
-    };
+        results.monthlyEmoji.push_back(std::move(p));
+    }
 
     // Sorted list of user names
     std::vector<std::string> userNames;
@@ -1085,468 +1201,209 @@ std::string runAnalysisToString(const std::string& inputPathStr) {
         userNames.push_back(p.first);
     std::sort(userNames.begin(), userNames.end());
 
-    // Build per-user chart series (counts, emotion, response, romantic, avg length)
-    g_chartUserNames.clear();
-    g_userMonthlyCountSeries.clear();
-    g_userMonthlyEmotionSeries.clear();
-    g_userMonthlyResponseSeries.clear();
-    g_userMonthlyRomanticSeries.clear();
-    g_userMonthlyAvgLengthSeries.clear();
-
+    results.users.reserve(userNames.size());
     for (const auto& name : userNames) {
-        // --- never treat any synthetic "Total" user as a chart series --- (Got Bugs - Might be able to delete now) 
-        if (name == "Total (all users)" || name == "Total" || name == "All users")
-            continue;
+        const UserStats& s = userStats[name];
+        UserResults u;
+        u.name = name;
+
+        u.totalMessages        = s.totalMessages;
+        u.totalWords           = s.totalWords;
+        u.wordMessages         = s.wordMessages;
+        if (s.wordMessages > 0)
+            u.avgWords = static_cast<double>(s.totalWords) /
+                         static_cast<double>(s.wordMessages);
+        u.romanticMessages     = s.romanticMessages;
+        u.conversationsStarted = s.conversationsStarted;
+        u.reactionsSent        = s.reactionsSent;
+
+        u.responseCount = s.responseCount;
+        if (s.responseCount > 0)
+            u.avgResponseMs = static_cast<double>(s.totalResponseTimeMs) /
+                              static_cast<double>(s.responseCount);
+
+        u.replyCount = s.replyCount;
+        if (s.replyCount > 0)
+            u.avgReplyLatencyMs = static_cast<double>(s.totalReplyLatencyMs) /
+                                  static_cast<double>(s.replyCount);
+        u.repliesTo.assign(s.repliesTo.begin(), s.repliesTo.end());
+
+        u.doubleTextRuns = s.doubleTextRuns;
+        u.tripleTextRuns = s.tripleTextRuns;
+        u.yappingRuns    = s.yappingRuns;
+
+        u.vaderSamples = s.vaderSamples;
+        if (s.vaderSamples > 0) {
+            double samples  = static_cast<double>(s.vaderSamples);
+            u.vaderPos      = s.vaderPosSum / samples;
+            u.vaderNeg      = s.vaderNegSum / samples;
+            u.vaderNeu      = s.vaderNeuSum / samples;
+            u.vaderCompound = s.vaderCompoundSum / samples;
+        }
 
-        g_chartUserNames.push_back(name);
+        u.nrcTaggedTokens = s.nrcTaggedTokens;
+        if (s.nrcTaggedTokens > 0) {
+            double denom = static_cast<double>(s.nrcTaggedTokens);
+            for (int dim = 0; dim < NRC_DIM; ++dim)
+                u.nrcEmotion[dim] = s.nrcEmotionSums[dim] / denom;
+        }
 
-        std::vector<UserMonthlyCountPoint>     countSeries;
-        std::vector<UserMonthlyEmotionPoint>   emoSeries;
-        std::vector<UserMonthlyResponsePoint>  respSeries;
-        std::vector<UserMonthlyRomanticPoint>  romanticSeries;
-        std::vector<UserMonthlyAvgLengthPoint> lenSeries;
+        u.longestMessageWords   = s.longestMessageWords;
+        u.longestMessageContent = s.longestMessageContent;
 
-        // Per-user counts
-        auto itCounts = g_perUserMonthlyMessageCounts.find(name);
-        if (itCounts != g_perUserMonthlyMessageCounts.end()) {
-            for (const auto& kv : itCounts->second) {
-                UserMonthlyCountPoint p;
-                p.year          = kv.first.first;
-                p.month         = kv.first.second;
-                p.totalMessages = kv.second;
-                countSeries.push_back(p);
+        // Top 10 words
+        std::vector<std::pair<std::string,long long>> wordsVec;
+        wordsVec.reserve(s.wordFrequency.size());
+        for (const auto& wc : s.wordFrequency) {
+            const std::string& word  = wc.first;
+            long long          count = wc.second;
+
+            if (lexicons.stopWordOverrides.contains(STOP_WORDS, word)) continue;
+            if (JUNK_TOKENS.contains(word)) continue;
+            if (word.size() < 3) continue;
+            if (nameWordsStop.find(word) != nameWordsStop.end()) continue;
+
+            wordsVec.emplace_back(word, count);
+        }
+        std::sort(
+            wordsVec.begin(), wordsVec.end(),
+            [](const auto& a, const auto& b) {
+                return a.second > b.second;
             }
-            std::sort(
-                countSeries.begin(), countSeries.end(),
-                [](const UserMonthlyCountPoint& a, const UserMonthlyCountPoint& b) {
-                    if (a.year != b.year) return a.year < b.year;
-                    return a.month < b.month;
-                }
-            );
+        );
+        if (wordsVec.size() > 10)
+            wordsVec.resize(10);
+        u.topWords = std::move(wordsVec);
+
+        u.emojiCount = s.emojiCount;
+        if (s.totalMessages > 0)
+            u.emojiPerMessage = static_cast<double>(s.emojiCount) /
+                                static_cast<double>(s.totalMessages);
+        u.topEmoji = TopCounts(s.emojiFrequency, 10);
+
+        // Per-user monthly series
+        auto itCounts = state.perUserMonthlyMessageCounts.find(name);
+        if (itCounts != state.perUserMonthlyMessageCounts.end()) {
+            for (const auto& kv : itCounts->second)
+                u.monthlyCounts.push_back({ kv.first.first, kv.first.second, kv.second });
         }
 
-        // Per-user emotion
-        auto itEmo = g_perUserMonthlyEmotion.find(name);
-        if (itEmo != g_perUserMonthlyEmotion.end()) {
+        auto itEmo = state.perUserMonthlyEmotion.find(name);
+        if (itEmo != state.perUserMonthlyEmotion.end()) {
             for (const auto& kv : itEmo->second) {
                 const MonthlyAggregate& agg = kv.second;
                 if (agg.count <= 0) continue;
-                UserMonthlyEmotionPoint p;
-                p.year        = kv.first.first;
-                p.month       = kv.first.second;
-                p.avgCompound = agg.sumCompound /
-                                static_cast<double>(agg.count);
-                emoSeries.push_back(p);
+                u.monthlyEmotion.push_back({ kv.first.first, kv.first.second,
+                    agg.sumCompound / static_cast<double>(agg.count) });
             }
-            std::sort(
-                emoSeries.begin(), emoSeries.end(),
-                [](const UserMonthlyEmotionPoint& a, const UserMonthlyEmotionPoint& b) {
-                    if (a.year != b.year) return a.year < b.year;
-                    return a.month < b.month;
-                }
-            );
         }
 
-        // Per-user response time
-        auto itResp = g_perUserMonthlyResponseAgg.find(name);
-        if (itResp != g_perUserMonthlyResponseAgg.end()) {
+        auto itResp = state.perUserMonthlyResponseAgg.find(name);
+        if (itResp != state.perUserMonthlyResponseAgg.end()) {
             for (const auto& kv : itResp->second) {
                 const MonthlyResponseAgg& agg = kv.second;
                 if (agg.count <= 0) continue;
-                UserMonthlyResponsePoint p;
-                p.year       = kv.first.first;
-                p.month      = kv.first.second;
                 double avgMs = static_cast<double>(agg.sumMs) /
                                static_cast<double>(agg.count);
-                p.avgMinutes = (avgMs / 1000.0) / 60.0;
-                respSeries.push_back(p);
+                u.monthlyResponse.push_back({ kv.first.first, kv.first.second,
+                    (avgMs / 1000.0) / 60.0 });
             }
-            std::sort(
-                respSeries.begin(), respSeries.end(),
-                [](const UserMonthlyResponsePoint& a, const UserMonthlyResponsePoint& b) {
-                    if (a.year != b.year) return a.year < b.year;
-                    return a.month < b.month;
-                }
-            );
         }
 
-        // Per-user romantic counts
-        auto itRom = g_perUserMonthlyRomanticCounts.find(name);
-        if (itRom != g_perUserMonthlyRomanticCounts.end()) {
-            for (const auto& kv : itRom->second) {
-                UserMonthlyRomanticPoint p;
-                p.year             = kv.first.first;
-                p.month            = kv.first.second;
-                p.romanticMessages = kv.second;
-                romanticSeries.push_back(p);
-            }
-            std::sort(
-                romanticSeries.begin(), romanticSeries.end(),
-                [](const UserMonthlyRomanticPoint& a, const UserMonthlyRomanticPoint& b) {
-                    if (a.year != b.year) return a.year < b.year;
-                    return a.month < b.month;
-                }
-            );
+        auto itRom = state.perUserMonthlyRomanticCounts.find(name);
+        if (itRom != state.perUserMonthlyRomanticCounts.end()) {
+            for (const auto& kv : itRom->second)
+                u.monthlyRomantic.push_back({ kv.first.first, kv.first.second, kv.second });
         }
 
-        // Per-user average message length
-        auto itLen = g_perUserMonthlyLengthAgg.find(name);
-        if (itLen != g_perUserMonthlyLengthAgg.end()) {
+        auto itLen = state.perUserMonthlyLengthAgg.find(name);
+        if (itLen != state.perUserMonthlyLengthAgg.end()) {
             for (const auto& kv : itLen->second) {
                 const MonthlyLengthAgg& agg = kv.second;
                 if (agg.msgCount <= 0) continue;
-                UserMonthlyAvgLengthPoint p;
-                p.year     = kv.first.first;
-                p.month    = kv.first.second;
-                p.avgWords = static_cast<double>(agg.sumWords) /
-                             static_cast<double>(agg.msgCount);
-                lenSeries.push_back(p);
-            }
-            std::sort(
-                lenSeries.begin(), lenSeries.end(),
-                [](const UserMonthlyAvgLengthPoint& a, const UserMonthlyAvgLengthPoint& b) {
-                    if (a.year != b.year) return a.year < b.year;
-                    return a.month < b.month;
-                }
-            );
-        }
-
-        g_userMonthlyCountSeries.push_back(std::move(countSeries));
-        g_userMonthlyEmotionSeries.push_back(std::move(emoSeries));
-        g_userMonthlyResponseSeries.push_back(std::move(respSeries));
-        g_userMonthlyRomanticSeries.push_back(std::move(romanticSeries));
-        g_userMonthlyAvgLengthSeries.push_back(std::move(lenSeries));
-    }
-    out << "=== Message Stats ===\n\n";
-    if (userNames.empty()) {
-        out << "No messages found.\n";
-        return out.str();
-    }
-
-    // -----------------------------------------------------
-    // General comparative section
-    // -----------------------------------------------------
-    out << "[General Message Data & Conversation Dynamics]\n";
-
-    // Header row with user names
-    out << " " << std::left << std::setw(LABEL_WIDTH) << "";
-    for (const auto& name : userNames)
-        out << " " << std::left << std::setw(COL_WIDTH) << name;
-    out << "\n";
-
-    // Total messages
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.totalMessages), "messages", NUM_WIDTH));
-        }
-        printRow("Total messages", vals);
-    }
-
-    // Average message length
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            double avgWords = 0.0;
-            if (s.wordMessages > 0) {
-                avgWords = static_cast<double>(s.totalWords) /
-                           static_cast<double>(s.wordMessages);
-            }
-            std::string num = FormatFixed(avgWords, 2);
-            vals.push_back(PadNumberSuffix(num, "words", NUM_WIDTH));
-        }
-        printRow("Average message length", vals);
-    }
-
-    // Romantic messages
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.romanticMessages), "messages", NUM_WIDTH));
-        }
-        printRow("Romantic messages", vals);
-    }
-
-    // Conversations started
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.conversationsStarted), "conversations", NUM_WIDTH));
-        }
-        printRow("Conversations started (>= 6h)", vals);
-    }
-
-    // Average response time
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.responseCount > 0) {
-                double avgMs      = static_cast<double>(s.totalResponseTimeMs) /
-                                    static_cast<double>(s.responseCount);
-                double avgSeconds = avgMs / 1000.0;
-                double avgMinutes = avgSeconds / 60.0;
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(2)
-                    << avgMinutes << " min ("
-                    << std::setprecision(2) << avgSeconds << " s)";
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
+                u.monthlyAvgLength.push_back({ kv.first.first, kv.first.second,
+                    static_cast<double>(agg.sumWords) /
+                    static_cast<double>(agg.msgCount) });
             }
         }
-        printRow("Average response time", vals);
-    }
 
-    // Double / triple / yapping runs
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.doubleTextRuns), "occurrences", NUM_WIDTH));
-        }
-        printRow("Double-text runs (==2 in a row)", vals);
-    }
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.tripleTextRuns), "occurrences", NUM_WIDTH));
-        }
-        printRow("Triple-text runs (==3 in a row)", vals);
-    }
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.yappingRuns), "occurrences", NUM_WIDTH));
-        }
-        printRow("Yapping runs (>=4 in a row)", vals);
-    }
-
-    out << "\n";
-
-    // -----------------------------------------------------
-    // Reactions comparative section
-    // -----------------------------------------------------
-    out << "[Reactions]\n";
-    out << " " << std::left << std::setw(LABEL_WIDTH) << "";
-    for (const auto& name : userNames)
-        out << " " << std::left << std::setw(COL_WIDTH) << name;
-    out << "\n";
-
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            vals.push_back(PadNumberSuffix(formatWithCommas(s.reactionsSent), "reactions", NUM_WIDTH));
-        }
-        printRow("Reactions sent", vals);
-    }
-    out << "\n";
-
-    // -----------------------------------------------------
-    // VADER comparative section
-    // -----------------------------------------------------
-    out << "[VADER Sentiment Analysis]\n";
-    out << " "
-        << "VADER scores how positive, negative, or neutral each message feels "
-        << "using a sentiment lexicon. These values are averages across all of "
-        << "your messages.\n\n";
-
-    out << " " << std::left << std::setw(LABEL_WIDTH) << "";
-    for (const auto& name : userNames)
-        out << " " << std::left << std::setw(COL_WIDTH) << name;
-    out << "\n";
-
-    // % positive
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.vaderSamples > 0) {
-                double v = static_cast<double>(s.vaderPosSum) / static_cast<double>(s.vaderSamples);
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(3) << v;
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
-            }
-        }
-        printRow("% Positive messages", vals);
-    }
-
-    // % negative
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.vaderSamples > 0) {
-                double v = static_cast<double>(s.vaderNegSum) / static_cast<double>(s.vaderSamples);
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(3) << v;
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
-            }
-        }
-        printRow("% Negative messages", vals);
-    }
-
-    // % neutral
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.vaderSamples > 0) {
-                double v = static_cast<double>(s.vaderNeuSum) / static_cast<double>(s.vaderSamples);
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(3) << v;
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
-            }
-        }
-        printRow("% Neutral messages", vals);
-    }
-
-    // avg compound
-    {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.vaderSamples > 0) {
-                double v = static_cast<double>(s.vaderCompoundSum) / static_cast<double>(s.vaderSamples);
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(4) << v;
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
+        if (itCounts != state.perUserMonthlyMessageCounts.end()) {
+            auto itEmoji = state.perUserMonthlyEmojiAgg.find(name);
+            for (const auto& kv : itCounts->second) {
+                UserMonthlyEmojiPoint p{ kv.first.first, kv.first.second, 0, 0.0, {}, 0 };
+                if (itEmoji != state.perUserMonthlyEmojiAgg.end()) {
+                    auto it = itEmoji->second.find(kv.first);
+                    if (it != itEmoji->second.end()) {
+                        p.emojiCount      = it->second.count;
+                        p.emojiPerMessage = static_cast<double>(it->second.count) /
+                                            static_cast<double>(kv.second);
+                        auto top = TopCounts(it->second.frequency, 1);
+                        p.topEmoji      = top[0].first;
+                        p.topEmojiCount = top[0].second;
+                    }
+                }
+                u.monthlyEmoji.push_back(std::move(p));
             }
         }
-        printRow("Average compound score", vals);
-    }
 
-    out << "\n";
-
-    // -----------------------------------------------------
-    // NRC comparative section
-    // -----------------------------------------------------
-    out << "[NRC Emotion Profile]\n";
-    out << " "
-        << "The NRC Emotion Lexicon measures how often your words align with "
-        << "each emotion (0–1 scale). Higher values mean that emotion shows up "
-        << "more in your language.\n\n";
-
-    out << " " << std::left << std::setw(LABEL_WIDTH) << "";
-    for (const auto& name : userNames)
-        out << " " << std::left << std::setw(COL_WIDTH) << name;
-    out << "\n";
-
-    for (int dim = 0; dim < NRC_DIM; ++dim) {
-        std::vector<std::string> vals;
-        for (const auto& name : userNames) {
-            const UserStats& s = userStats[name];
-            if (s.nrcTaggedTokens > 0) {
-                double denom = static_cast<double>(s.nrcTaggedTokens);
-                double value = s.nrcEmotionSums[dim] / denom;
-                std::ostringstream tmp;
-                tmp << std::fixed << std::setprecision(3) << value;
-                vals.push_back(tmp.str());
-            } else {
-                vals.push_back("N/A");
-            }
-        }
-        printRow(NRC_CATEGORY_NAMES[dim], vals);
+        results.users.push_back(std::move(u));
     }
 
-    out << "\n";
-
-    // -----------------------------------------------------
-    // Word usage & longest messages (per user) – LAST section
-    // -----------------------------------------------------
-    out << "[Word Usage & Longest Messages]\n";
-    for (const auto& name : userNames) {
-        const UserStats& stats = userStats[name];
-
-        out << "User: " << name << "\n";
+    return results;
+}
 
-        if (stats.longestMessageWords > 0) {
-            std::ostringstream tmp;
-            tmp << formatWithCommas(stats.longestMessageWords) << " words"
-                << " | Preview: "
-                << abbreviateContent(stats.longestMessageContent, 80);
-            printSingle("Longest message", tmp.str());
-        } else {
-            printSingle("Longest message", "(no textual messages)");
-        }
+// -------------------------------------------------------------
+// Public entry points
+// -------------------------------------------------------------
+static void PublishToGlobals(const AnalysisResults& results) {
+    std::copy(&results.heatmapCounts[0][0], &results.heatmapCounts[0][0] + 7 * 24,
+              &g_heatmapCounts[0][0]);
+    g_heatmapReady = results.heatmapReady;
 
-        // Top 10 words
-        std::vector<std::pair<std::string,long long>> wordsVec;
-        wordsVec.reserve(stats.wordFrequency.size());
-        for (const auto& wc : stats.wordFrequency) {
-            const std::string& word  = wc.first;
-            long long          count = wc.second;
+    g_monthlyEmotionPoints   = results.monthlyEmotion;
+    g_monthlyCountPoints     = results.monthlyCounts;
+    g_monthlyResponsePoints  = results.monthlyResponse;
+    g_monthlyRomanticPoints  = results.monthlyRomantic;
+    g_monthlyAvgLengthPoints = results.monthlyAvgLength;
 
-            if (STOP_WORDS.find(word) != STOP_WORDS.end()) continue;
-            if (JUNK_TOKENS.find(word) != JUNK_TOKENS.end()) continue;
-            if (word.size() < 3) continue;
-            if (nameWordsStop.find(word) != nameWordsStop.end()) continue;
-
-            wordsVec.emplace_back(word, count);
-        }
-        std::sort(
-            wordsVec.begin(), wordsVec.end(),
-            [](const auto& a, const auto& b) {
-                return a.second > b.second;
-            }
-        );
+    g_chartUserNames.clear();
+    g_userMonthlyCountSeries.clear();
+    g_userMonthlyEmotionSeries.clear();
+    g_userMonthlyResponseSeries.clear();
+    g_userMonthlyRomanticSeries.clear();
+    g_userMonthlyAvgLengthSeries.clear();
 
-        if (!wordsVec.empty()) {
-            std::ostringstream tmp;
-            int printed = 0;
-            for (const auto& p2 : wordsVec) {
-                if (printed > 0) tmp << ", ";
-                tmp << p2.first << ": " << formatWithCommas(p2.second);
-                printed++;
-                if (printed >= 10 ||
-                    printed >= static_cast<int>(wordsVec.size()))
-                    break;
-            }
-            printSingle("Top 10 most used words", tmp.str());
-        } else {
-            printSingle("Top 10 most used words", "(no words recorded)");
-        }
+    for (const UserResults& u : results.users) {
+        // --- never treat any synthetic "Total" user as a chart series --- (Got Bugs - Might be able to delete now) 
+        if (u.name == "Total (all users)" || u.name == "Total" || u.name == "All users")
+            continue;
 
-        out << "\n";
+        g_chartUserNames.push_back(u.name);
+        g_userMonthlyCountSeries.push_back(u.monthlyCounts);
+        g_userMonthlyEmotionSeries.push_back(u.monthlyEmotion);
+        g_userMonthlyResponseSeries.push_back(u.monthlyResponse);
+        g_userMonthlyRomanticSeries.push_back(u.monthlyRomantic);
+        g_userMonthlyAvgLengthSeries.push_back(u.monthlyAvgLength);
     }
-
-    return out.str();
 }
 
-// -------------------------------------------------------------
-// Console entry point (unchanged)
-// -------------------------------------------------------------
-int console_main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <file_or_directory>\n";
-        return 1;
-    }
+// Used by the GUI & console: one chat at a time, results mirrored into g_*.
+std::string runAnalysisToString(const std::string& inputPathStr) {
+    // Reset global analytics every run
+    PublishToGlobals(AnalysisResults{});
 
-    try {
-        std::string report = runAnalysisToString(argv[1]);
-        std::cout << report;
-        return 0;
-    } catch (const std::exception& ex) {
-        std::cerr << "Error: " << ex.what() << "\n";
-        return 1;
-    }
+    std::shared_ptr<const AnalysisLexicons> lexicons = LoadAnalysisLexicons();
+
+    AnalysisResults results = analyzeChat(inputPathStr, *lexicons, AnalysisOptions{});
+    PublishToGlobals(results);
+    return renderTextReport(results);
 }
 
-int main(int argc, char* argv[]) {
-    return console_main(argc, argv);
+AnalysisResults analyzeChat(
+    const std::string& inputPathStr,
+    const AnalysisLexicons& lexicons,
+    const AnalysisOptions& options
+) {
+    AnalysisState state;
+    return runAnalysisCore(inputPathStr, lexicons, options, state);
 }
@@ -0,0 +1,626 @@
+// analysis_report.cpp
+// Renderers for AnalysisResults: the text report, JSON and CSV.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "chat_analyzer.hpp"
+#include "json_writer.hpp"
+
+static constexpr int NRC_DIM = NrcEmotionLexicon::DIMENSIONS;
+
+static const char* WEEKDAY_NAMES[7] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+
+// -------------------------------------------------------------
+// Formatting helpers
+// -------------------------------------------------------------
+static std::string PadNumberSuffix(const std::string& number,
+                                   const std::string& suffix,
+                                   int numberWidth)
+{
+    std::ostringstream oss;
+    oss << std::right << std::setw(numberWidth) << number;
+    if (!suffix.empty())
+        oss << " " << suffix;
+    return oss.str();
+}
+
+static std::string FormatFixed(double v, int precision)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << v;
+    return oss.str();
+}
+
+static std::string abbreviateContent(const std::string& input, std::size_t maxLen) {
+    std::string s = input;
+    for (char& c : s) {
+        if (c == '\n' || c == '\r') c = ' ';
+    }
+    if (s.size() <= maxLen) return s;
+    if (maxLen <= 3) return std::string(maxLen, '.');
+    return s.substr(0, maxLen - 3) + "...";
+}
+
+static std::string FormatPeriod(int year, int month) {
+    char tmp[16];
+    std::snprintf(tmp, sizeof(tmp), "%04d-%02d", year, month);
+    return tmp;
+}
+
+// Shortest of %.15g / %.17g that round-trips (same rule as JsonWriter).
+static std::string FormatDouble(double v) {
+    if (!std::isfinite(v)) return "";
+    char tmp[40];
+    std::snprintf(tmp, sizeof(tmp), "%.15g", v);
+    if (std::strtod(tmp, nullptr) != v)
+        std::snprintf(tmp, sizeof(tmp), "%.17g", v);
+    return tmp;
+}
+
+// -------------------------------------------------------------
+// Text report
+// -------------------------------------------------------------
+std::string renderTextReport(const AnalysisResults& results) {
+    std::ostringstream out;
+
+    const int LABEL_WIDTH = 40;
+    const int COL_WIDTH   = 26;
+    const int NUM_WIDTH = 12;
+
+    // Helper: comparative row
+    auto printRow = [&](const std::string& label,
+                    const std::vector<std::string>& values) {
+    out << " " << std::left << std::setw(LABEL_WIDTH) << (label + ":");
+    for (const auto& v : values)
+        out << " " << std::right << std::setw(COL_WIDTH) << v;
+    out << "\n";
+    };
+
+
+    // Helper: single-user stat
+    auto printSingle = [&](const std::string& label,
+                           const std::string& value) {
+        out << " " << std::left << std::setw(LABEL_WIDTH)
+            << (label + ":") << " " << value << "\n";
+    };
+
+    // Helper: header row with user names
+    auto printHeader = [&]() {
+        out << " " << std::left << std::setw(LABEL_WIDTH) << "";
+        for (const auto& u : results.users)
+            out << " " << std::left << std::setw(COL_WIDTH) << u.name;
+        out << "\n";
+    };
+
+    // Helper: one value per user
+    auto perUser = [&](auto&& format) {
+        std::vector<std::string> vals;
+        vals.reserve(results.users.size());
+        for (const auto& u : results.users)
+            vals.push_back(format(u));
+        return vals;
+    };
+
+    out << "=== Message Stats ===\n\n";
+    if (results.users.empty()) {
+        out << "No messages found.\n";
+        return out.str();
+    }
+
+    // -----------------------------------------------------
+    // General comparative section
+    // -----------------------------------------------------
+    out << "[General Message Data & Conversation Dynamics]\n";
+    printHeader();
+
+    printRow("Total messages", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.totalMessages), "messages", NUM_WIDTH);
+    }));
+    printRow("Average message length", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(FormatFixed(u.avgWords, 2), "words", NUM_WIDTH);
+    }));
+    printRow("Romantic messages", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.romanticMessages), "messages", NUM_WIDTH);
+    }));
+    printRow("Conversations started (>= 6h)", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.conversationsStarted), "conversations", NUM_WIDTH);
+    }));
+    printRow("Average response time", perUser([&](const UserResults& u) -> std::string {
+        if (u.responseCount <= 0)
+            return "N/A";
+        double avgSeconds = u.avgResponseMs / 1000.0;
+        double avgMinutes = avgSeconds / 60.0;
+        std::ostringstream tmp;
+        tmp << std::fixed << std::setprecision(2)
+            << avgMinutes << " min ("
+            << std::setprecision(2) << avgSeconds << " s)";
+        return tmp.str();
+    }));
+    printRow("Double-text runs (==2 in a row)", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.doubleTextRuns), "occurrences", NUM_WIDTH);
+    }));
+    printRow("Triple-text runs (==3 in a row)", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.tripleTextRuns), "occurrences", NUM_WIDTH);
+    }));
+    printRow("Yapping runs (>=4 in a row)", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.yappingRuns), "occurrences", NUM_WIDTH);
+    }));
+
+    out << "\n";
+
+    // -----------------------------------------------------
+    // Reactions comparative section
+    // -----------------------------------------------------
+    out << "[Reactions]\n";
+    printHeader();
+
+    printRow("Reactions sent", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.reactionsSent), "reactions", NUM_WIDTH);
+    }));
+    out << "\n";
+
+    // -----------------------------------------------------
+    // Emoji comparative section
+    // -----------------------------------------------------
+    out << "[Emoji]\n";
+    printHeader();
+
+    printRow("Emoji sent", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(formatWithCommas(u.emojiCount), "emoji", NUM_WIDTH);
+    }));
+    printRow("Emoji per message", perUser([&](const UserResults& u) {
+        return PadNumberSuffix(FormatFixed(u.emojiPerMessage, 2), "emoji", NUM_WIDTH);
+    }));
+    out << "\n";
+
+    // -----------------------------------------------------
+    // Replies comparative section (only for exports that link replies)
+    // -----------------------------------------------------
+    bool haveReplies = false;
+    for (const auto& u : results.users)
+        haveReplies = haveReplies || u.replyCount > 0;
+
+    if (haveReplies) {
+        out << "[Replies]\n";
+        printHeader();
+
+        printRow("Replies", perUser([&](const UserResults& u) {
+            return PadNumberSuffix(formatWithCommas(u.replyCount), "replies", NUM_WIDTH);
+        }));
+        printRow("Average reply latency", perUser([&](const UserResults& u) -> std::string {
+            if (u.replyCount <= 0)
+                return "N/A";
+            double avgSeconds = u.avgReplyLatencyMs / 1000.0;
+            double avgMinutes = avgSeconds / 60.0;
+            std::ostringstream tmp;
+            tmp << std::fixed << std::setprecision(2)
+                << avgMinutes << " min ("
+                << std::setprecision(2) << avgSeconds << " s)";
+            return tmp.str();
+        }));
+
+        // Who replies to whom: one row per user that was replied to
+        std::map<std::string, std::vector<long long>> matrix;
+        for (std::size_t col = 0; col < results.users.size(); ++col) {
+            for (const auto& r : results.users[col].repliesTo) {
+                auto& row = matrix[r.first];
+                row.resize(results.users.size(), 0);
+                row[col] = r.second;
+            }
+        }
+        for (const auto& row : matrix) {
+            std::vector<std::string> vals;
+            vals.reserve(row.second.size());
+            for (long long count : row.second)
+                vals.push_back(PadNumberSuffix(formatWithCommas(count), "replies", NUM_WIDTH));
+            printRow("Replies to " + row.first, vals);
+        }
+        out << "\n";
+    }
+
+    // -----------------------------------------------------
+    // VADER comparative section
+    // -----------------------------------------------------
+    out << "[VADER Sentiment Analysis]\n";
+    out << " "
+        << "VADER scores how positive, negative, or neutral each message feels "
+        << "using a sentiment lexicon. These values are averages across all of "
+        << "your messages.\n\n";
+    printHeader();
+
+    auto vaderRow = [&](const std::string& label, double UserResults::* field, int precision) {
+        printRow(label, perUser([&](const UserResults& u) {
+            return u.vaderSamples > 0 ? FormatFixed(u.*field, precision) : std::string("N/A");
+        }));
+    };
+    vaderRow("% Positive messages",    &UserResults::vaderPos,      3);
+    vaderRow("% Negative messages",    &UserResults::vaderNeg,      3);
+    vaderRow("% Neutral messages",     &UserResults::vaderNeu,      3);
+    vaderRow("Average compound score", &UserResults::vaderCompound, 4);
+
+    out << "\n";
+
+    // -----------------------------------------------------
+    // NRC comparative section
+    // -----------------------------------------------------
+    out << "[NRC Emotion Profile]\n";
+    out << " "
+        << "The NRC Emotion Lexicon measures how often your words align with "
+        << "each emotion (0–1 scale). Higher values mean that emotion shows up "
+        << "more in your language.\n\n";
+    printHeader();
+
+    for (int dim = 0; dim < NRC_DIM; ++dim) {
+        printRow(NrcEmotionLexicon::CATEGORY_NAMES[dim], perUser([&](const UserResults& u) {
+            return u.nrcTaggedTokens > 0 ? FormatFixed(u.nrcEmotion[dim], 3) : std::string("N/A");
+        }));
+    }
+
+    out << "\n";
+
+    // -----------------------------------------------------
+    // Word usage & longest messages (per user) – LAST section
+    // -----------------------------------------------------
+    out << "[Word Usage & Longest Messages]\n";
+    for (const auto& u : results.users) {
+        out << "User: " << u.name << "\n";
+
+        if (u.longestMessageWords > 0) {
+            std::ostringstream tmp;
+            tmp << formatWithCommas(u.longestMessageWords) << " words"
+                << " | Preview: "
+                << abbreviateContent(u.longestMessageContent, 80);
+            printSingle("Longest message", tmp.str());
+        } else {
+            printSingle("Longest message", "(no textual messages)");
+        }
+
+        if (!u.topWords.empty()) {
+            std::ostringstream tmp;
+            for (std::size_t i = 0; i < u.topWords.size(); ++i) {
+                if (i > 0) tmp << ", ";
+                tmp << u.topWords[i].first << ": " << formatWithCommas(u.topWords[i].second);
+            }
+            printSingle("Top 10 most used words", tmp.str());
+        } else {
+            printSingle("Top 10 most used words", "(no words recorded)");
+        }
+
+        if (!u.topEmoji.empty()) {
+            std::ostringstream tmp;
+            for (std::size_t i = 0; i < u.topEmoji.size(); ++i) {
+                if (i > 0) tmp << ", ";
+                tmp << u.topEmoji[i].first << ": " << formatWithCommas(u.topEmoji[i].second);
+            }
+            printSingle("Top 10 most used emoji", tmp.str());
+        }
+
+        out << "\n";
+    }
+
+    return out.str();
+}
+
+// -------------------------------------------------------------
+// JSON
+// -------------------------------------------------------------
+template <typename Point, typename Value>
+static void WriteSeriesJson(JsonWriter& w, const char* name,
+                            const std::vector<Point>& series, Value Point::* field) {
+    w.key(name);
+    w.beginArray();
+    for (const Point& p : series) {
+        w.beginObject();
+        w.field("period", FormatPeriod(p.year, p.month));
+        w.field("value", p.*field);
+        w.endObject();
+    }
+    w.endArray();
+}
+
+template <typename Count, typename Emotion, typename Response, typename Romantic, typename Length,
+          typename Emoji>
+static void WriteMonthlyJson(JsonWriter& w,
+                             const std::vector<Count>& counts,
+                             const std::vector<Emotion>& emotion,
+                             const std::vector<Response>& response,
+                             const std::vector<Romantic>& romantic,
+                             const std::vector<Length>& length,
+                             const std::vector<Emoji>& emoji) {
+    w.key("monthly");
+    w.beginObject();
+    WriteSeriesJson(w, "messages",             counts,   &Count::totalMessages);
+    WriteSeriesJson(w, "avg_compound",         emotion,  &Emotion::avgCompound);
+    WriteSeriesJson(w, "avg_response_minutes", response, &Response::avgMinutes);
+    WriteSeriesJson(w, "romantic_messages",    romantic, &Romantic::romanticMessages);
+    WriteSeriesJson(w, "avg_words",            length,   &Length::avgWords);
+    WriteSeriesJson(w, "emoji",                emoji,    &Emoji::emojiCount);
+    WriteSeriesJson(w, "emoji_per_message",    emoji,    &Emoji::emojiPerMessage);
+
+    w.key("top_emoji");
+    w.beginArray();
+    for (const Emoji& p : emoji) {
+        if (p.topEmoji.empty()) continue;
+        w.beginObject();
+        w.field("period", FormatPeriod(p.year, p.month));
+        w.field("emoji",  p.topEmoji);
+        w.field("count",  p.topEmojiCount);
+        w.endObject();
+    }
+    w.endArray();
+    w.endObject();
+}
+
+void writeResultsJson(const AnalysisResults& results, JsonWriter& w) {
+    w.beginObject();
+    w.field("total_messages", results.totalMessages);
+
+    w.key("users");
+    w.beginArray();
+    for (const UserResults& u : results.users) {
+        w.beginObject();
+        w.field("name",                  u.name);
+        w.field("total_messages",        u.totalMessages);
+        w.field("total_words",           u.totalWords);
+        w.field("word_messages",         u.wordMessages);
+        w.field("avg_words",             u.avgWords);
+        w.field("romantic_messages",     u.romanticMessages);
+        w.field("conversations_started", u.conversationsStarted);
+        w.field("reactions_sent",        u.reactionsSent);
+        w.field("response_count",        u.responseCount);
+        w.key("avg_response_ms");
+        if (u.responseCount > 0) w.value(u.avgResponseMs); else w.null();
+        w.field("reply_count",           u.replyCount);
+        w.key("avg_reply_latency_ms");
+        if (u.replyCount > 0) w.value(u.avgReplyLatencyMs); else w.null();
+        w.key("replies_to");
+        w.beginObject();
+        for (const auto& r : u.repliesTo)
+            w.field(r.first, r.second);
+        w.endObject();
+        w.field("double_text_runs",      u.doubleTextRuns);
+        w.field("triple_text_runs",      u.tripleTextRuns);
+        w.field("yapping_runs",          u.yappingRuns);
+
+        w.key("vader");
+        w.beginObject();
+        w.field("samples", u.vaderSamples);
+        if (u.vaderSamples > 0) {
+            w.field("pos",      u.vaderPos);
+            w.field("neg",      u.vaderNeg);
+            w.field("neu",      u.vaderNeu);
+            w.field("compound", u.vaderCompound);
+        }
+        w.endObject();
+
+        w.key("nrc");
+        w.beginObject();
+        w.field("tagged_tokens", u.nrcTaggedTokens);
+        if (u.nrcTaggedTokens > 0) {
+            for (int dim = 0; dim < NRC_DIM; ++dim)
+                w.field(NrcEmotionLexicon::CATEGORY_NAMES[dim], u.nrcEmotion[dim]);
+        }
+        w.endObject();
+
+        w.key("longest_message");
+        w.beginObject();
+        w.field("words",   u.longestMessageWords);
+        w.field("content", u.longestMessageContent);
+        w.endObject();
+
+        w.key("top_words");
+        w.beginArray();
+        for (const auto& wc : u.topWords) {
+            w.beginObject();
+            w.field("word",  wc.first);
+            w.field("count", wc.second);
+            w.endObject();
+        }
+        w.endArray();
+
+        w.field("emoji_count",       u.emojiCount);
+        w.field("emoji_per_message", u.emojiPerMessage);
+        w.key("top_emoji");
+        w.beginArray();
+        for (const auto& ec : u.topEmoji) {
+            w.beginObject();
+            w.field("emoji", ec.first);
+            w.field("count", ec.second);
+            w.endObject();
+        }
+        w.endArray();
+
+        WriteMonthlyJson(w, u.monthlyCounts, u.monthlyEmotion, u.monthlyResponse,
+                         u.monthlyRomantic, u.monthlyAvgLength, u.monthlyEmoji);
+        w.endObject();
+    }
+    w.endArray();
+
+    w.key("heatmap");
+    w.beginObject();
+    w.field("ready", results.heatmapReady);
+    w.key("rows");
+    w.beginArray();
+    for (const char* day : WEEKDAY_NAMES)
+        w.value(day);
+    w.endArray();
+    w.key("counts");
+    w.beginArray();
+    for (int row = 0; row < 7; ++row) {
+        w.beginArray();
+        for (int hour = 0; hour < 24; ++hour)
+            w.value(results.heatmapCounts[row][hour]);
+        w.endArray();
+    }
+    w.endArray();
+    w.endObject();
+
+    WriteMonthlyJson(w, results.monthlyCounts, results.monthlyEmotion, results.monthlyResponse,
+                     results.monthlyRomantic, results.monthlyAvgLength, results.monthlyEmoji);
+
+    w.endObject();
+}
+
+void writeResultsJson(const AnalysisResults& results, std::ostream& out, int indent) {
+    JsonWriter w(out, indent);
+    writeResultsJson(results, w);
+    w.flush();
+}
+
+// -------------------------------------------------------------
+// CSV
+// -------------------------------------------------------------
+static void AppendCsvField(std::string& line, const std::string& field) {
+    if (field.find_first_of(",\"\r\n") == std::string::npos) {
+        line += field;
+        return;
+    }
+    line.push_back('"');
+    for (char c : field) {
+        if (c == '"') line.push_back('"');
+        line.push_back(c);
+    }
+    line.push_back('"');
+}
+
+namespace {
+    // Buffers rows and hands them to the stream in large blocks.
+    class CsvRows {
+    public:
+        explicit CsvRows(std::ostream& out) : m_out(out) {}
+        ~CsvRows() { flush(); }
+
+        void row(const std::string& section, const std::string& user,
+                 const std::string& metric, const std::string& period,
+                 const std::string& value) {
+            AppendCsvField(m_buf, section); m_buf.push_back(',');
+            AppendCsvField(m_buf, user);    m_buf.push_back(',');
+            AppendCsvField(m_buf, metric);  m_buf.push_back(',');
+            AppendCsvField(m_buf, period);  m_buf.push_back(',');
+            AppendCsvField(m_buf, value);   m_buf += "\r\n";
+            if (m_buf.size() >= 64 * 1024)
+                flush();
+        }
+
+        void flush() {
+            m_out.write(m_buf.data(), static_cast<std::streamsize>(m_buf.size()));
+            m_buf.clear();
+        }
+
+    private:
+        std::ostream& m_out;
+        std::string   m_buf;
+    };
+}
+
+static std::string CsvValue(long long v) { return std::to_string(v); }
+static std::string CsvValue(double v)    { return FormatDouble(v); }
+
+template <typename Count, typename Emotion, typename Response, typename Romantic, typename Length,
+          typename Emoji>
+static void WriteMonthlyCsv(CsvRows& csv, const std::string& user,
+                            const std::vector<Count>& counts,
+                            const std::vector<Emotion>& emotion,
+                            const std::vector<Response>& response,
+                            const std::vector<Romantic>& romantic,
+                            const std::vector<Length>& length,
+                            const std::vector<Emoji>& emoji) {
+    for (const auto& p : counts)
+        csv.row("monthly", user, "messages", FormatPeriod(p.year, p.month), CsvValue(p.totalMessages));
+    for (const auto& p : emotion)
+        csv.row("monthly", user, "avg_compound", FormatPeriod(p.year, p.month), CsvValue(p.avgCompound));
+    for (const auto& p : response)
+        csv.row("monthly", user, "avg_response_minutes", FormatPeriod(p.year, p.month), CsvValue(p.avgMinutes));
+    for (const auto& p : romantic)
+        csv.row("monthly", user, "romantic_messages", FormatPeriod(p.year, p.month), CsvValue(p.romanticMessages));
+    for (const auto& p : length)
+        csv.row("monthly", user, "avg_words", FormatPeriod(p.year, p.month), CsvValue(p.avgWords));
+    for (const auto& p : emoji)
+        csv.row("monthly", user, "emoji", FormatPeriod(p.year, p.month), CsvValue(p.emojiCount));
+    for (const auto& p : emoji)
+        csv.row("monthly", user, "emoji_per_message", FormatPeriod(p.year, p.month), CsvValue(p.emojiPerMessage));
+    for (const auto& p : emoji) {
+        if (!p.topEmoji.empty())
+            csv.row("top_emoji", user, p.topEmoji, FormatPeriod(p.year, p.month), CsvValue(p.topEmojiCount));
+    }
+}
+
+void writeResultsCsv(const AnalysisResults& results, std::ostream& out) {
+    CsvRows csv(out);
+    csv.row("section", "user", "metric", "period", "value");
+
+    for (const UserResults& u : results.users) {
+        auto stat = [&](const char* metric, const std::string& value) {
+            csv.row("user", u.name, metric, "", value);
+        };
+
+        stat("total_messages",        CsvValue(u.totalMessages));
+        stat("total_words",           CsvValue(u.totalWords));
+        stat("word_messages",         CsvValue(u.wordMessages));
+        stat("avg_words",             CsvValue(u.avgWords));
+        stat("romantic_messages",     CsvValue(u.romanticMessages));
+        stat("conversations_started", CsvValue(u.conversationsStarted));
+        stat("reactions_sent",        CsvValue(u.reactionsSent));
+        stat("response_count",        CsvValue(u.responseCount));
+        if (u.responseCount > 0)
+            stat("avg_response_ms",   CsvValue(u.avgResponseMs));
+        stat("reply_count",           CsvValue(u.replyCount));
+        if (u.replyCount > 0)
+            stat("avg_reply_latency_ms", CsvValue(u.avgReplyLatencyMs));
+        stat("double_text_runs",      CsvValue(u.doubleTextRuns));
+        stat("triple_text_runs",      CsvValue(u.tripleTextRuns));
+        stat("yapping_runs",          CsvValue(u.yappingRuns));
+        stat("vader_samples",         CsvValue(u.vaderSamples));
+        if (u.vaderSamples > 0) {
+            stat("vader_pos",         CsvValue(u.vaderPos));
+            stat("vader_neg",         CsvValue(u.vaderNeg));
+            stat("vader_neu",         CsvValue(u.vaderNeu));
+            stat("vader_compound",    CsvValue(u.vaderCompound));
+        }
+        stat("nrc_tagged_tokens",     CsvValue(u.nrcTaggedTokens));
+        if (u.nrcTaggedTokens > 0) {
+            for (int dim = 0; dim < NRC_DIM; ++dim)
+                stat((std::string("nrc_") + NrcEmotionLexicon::CATEGORY_NAMES[dim]).c_str(),
+                     CsvValue(u.nrcEmotion[dim]));
+        }
+        stat("longest_message_words", CsvValue(u.longestMessageWords));
+        stat("longest_message",       u.longestMessageContent);
+        stat("emoji_count",           CsvValue(u.emojiCount));
+        stat("emoji_per_message",     CsvValue(u.emojiPerMessage));
+
+        for (const auto& wc : u.topWords)
+            csv.row("top_word", u.name, wc.first, "", CsvValue(wc.second));
+        for (const auto& ec : u.topEmoji)
+            csv.row("top_emoji", u.name, ec.first, "", CsvValue(ec.second));
+        for (const auto& r : u.repliesTo)
+            csv.row("reply", u.name, r.first, "", CsvValue(r.second));
+    }
+
+    for (int row = 0; row < 7; ++row) {
+        for (int hour = 0; hour < 24; ++hour) {
+            char period[16];
+            std::snprintf(period, sizeof(period), "%s %02d", WEEKDAY_NAMES[row], hour);
+            csv.row("heatmap", "", "messages", period,
+                    CsvValue(static_cast<long long>(results.heatmapCounts[row][hour])));
+        }
+    }
+
+    WriteMonthlyCsv(csv, "", results.monthlyCounts, results.monthlyEmotion,
+                    results.monthlyResponse, results.monthlyRomantic, results.monthlyAvgLength,
+                    results.monthlyEmoji);
+    for (const UserResults& u : results.users) {
+        WriteMonthlyCsv(csv, u.name, u.monthlyCounts, u.monthlyEmotion,
+                        u.monthlyResponse, u.monthlyRomantic, u.monthlyAvgLength,
+                        u.monthlyEmoji);
+    }
+
+    csv.flush();
+}
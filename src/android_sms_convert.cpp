@@ -1,241 +1,727 @@
 
 // Convert Android "SMS Backup & Restore" XML exports into Instagram-style JSON
 // Notes:
-// - We parse the XML file line-by-line and extract <sms .../> blocks.
-// - We still keep messages in memory to sort chronologically before writing output.
+// - The XML is memory-mapped and scanned once for <sms> and <mms> elements
+//   (xml_scanner.hpp). MMS text comes from the text/plain parts, the sender
+//   from <addr type="137">, media becomes typed attachments; the base64
+//   payloads are skipped, never decoded.
+// - Messages are written to the chunk files as they are scanned. Only a backup
+//   that is not in date order is collected in memory and sorted first.
+// - A per-contact index (message counts, time range, byte ranges) is built in
+//   one pass and cached next to the backup, so exporting one contact only
+//   reads that contact's bytes.
+// - The all-threads export groups the backup by normalized address in the
+//   same single scan.
 // 
 
 #include "android_sms_convert.hpp"
 
 #include <algorithm>
-#include <cctype>
+#include <charconv>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <set>
-#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#include "json.hpp"
+#include "export_writer.hpp"
+#include "mapped_file.hpp"
+#include "xml_scanner.hpp"
 
 namespace fs = std::filesystem;
-using json = nlohmann::json;
-
-struct InstaMessage
-{
-    std::string sender_name;
-    long long   timestamp_ms = 0;
-    std::string content;
-};
 
 // -----------------------------------------------------------------------------
 // Small helpers
 // -----------------------------------------------------------------------------
 
-static bool extractXmlAttribute(const std::string& src,
-                                const std::string& attrName,
-                                std::string&       out)
+static bool isNullOrEmpty(std::string_view s)
 {
-    const std::string pattern = attrName + "=\"";
-    std::size_t pos = src.find(pattern);
-    if (pos == std::string::npos)
-        return false;
+    return s.empty() || s == "null";
+}
 
-    pos += pattern.size();
-    std::size_t end = src.find('"', pos);
-    if (end == std::string::npos)
-        return false;
+// The <sms> attributes the converter uses (raw, still XML-escaped).
+struct SmsAttributes
+{
+    std::string_view address;
+    std::string_view contactName;
+    std::string_view date;
+    std::string_view type;
+    std::string_view body;
+    bool             hasBody = false;
+};
 
-    out.assign(src.begin() + static_cast<std::ptrdiff_t>(pos),
-               src.begin() + static_cast<std::ptrdiff_t>(end));
-    return true;
+// Milliseconds since the epoch from a "date" attribute.
+static bool parseSmsDate(std::string_view date, long long& tsMs)
+{
+    if (isNullOrEmpty(date))
+        return false;
+    return std::from_chars(date.data(), date.data() + date.size(), tsMs).ec == std::errc();
 }
 
-static bool isNullOrEmpty(const std::string& s)
+static void readSmsAttributes(const XmlElementScanner& scan, SmsAttributes& out)
 {
-    return s.empty() || s == "null";
+    out = SmsAttributes{};
+    for (const auto& a : scan.attributes())
+    {
+        const std::string_view n = a.name;
+        if (n == "address")           out.address     = a.value;
+        else if (n == "contact_name") out.contactName = a.value;
+        else if (n == "date")         out.date        = a.value;
+        else if (n == "type")         out.type        = a.value;
+        else if (n == "body")       { out.body        = a.value; out.hasBody = true; }
+    }
 }
 
-static int hexValue(char c)
+// -----------------------------------------------------------------------------
+// Message reader (<sms>, and <mms> with its <part>/<addr> children)
+// -----------------------------------------------------------------------------
+
+// One message of a backup. Views are valid until the next call to
+// BackupMessageReader::next().
+struct BackupMessage
 {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
-    if (c >= 'A' && c <= 'F') return 10 + (c - 'A');
-    return -1;
-}
+    std::size_t      begin = 0;        // start of the <sms>/<mms> tag
+    std::size_t      end   = 0;        // past the last tag that belongs to it
+    bool             isMms    = false;
+    bool             outgoing = false; // sms type="2" / mms msg_box="2"
+    std::string_view address;          // decoded; "a~b~c" for group MMS
+    std::string_view contactName;      // decoded; "A, B, C" for group MMS
+    std::string_view date;             // raw
+    bool             hasText = false;  // sms: has a body attribute
+    std::string_view text;             // decoded body / text/plain parts
+    std::string_view from;             // mms: the type-137 <addr>, decoded
+    const std::vector<InstaAttachment>* attachments = nullptr;   // mms only
+
+    bool isGroup() const { return address.find('~') != std::string_view::npos; }
+};
 
-// Decodes XML escapes used by SMS Backup & Restore
-// including numeric entities like &#10; and &#xA;.
-static std::string xmlUnescape(const std::string& s)
+// Pulls messages out of the backup in file order. An <mms> is complete when
+// the next start tag that is not one of its children shows up, so the file is
+// still read in one forward pass; <part data="..."> payloads are passed over
+// by the scanner without being decoded or copied.
+class BackupMessageReader
 {
-    std::string out;
-    out.reserve(s.size());
+public:
+    BackupMessageReader(std::string_view text, std::size_t begin, std::size_t end)
+        : m_scan(text.substr(0, end), begin) {}
+
+    bool next(BackupMessage& out);
+
+private:
+    void readSms(BackupMessage& out);
+    void startMms();
+    void addPart();
+    void addAddr();
+    void finishMms(BackupMessage& out);
 
-    for (std::size_t i = 0; i < s.size(); ++i)
+    XmlElementScanner m_scan;
+    bool              m_haveTag = false;   // m_scan sits on an unhandled tag
+    SmsAttributes     m_attrs;
+    std::string       m_addressBuf, m_contactBuf, m_bodyBuf, m_scratch;
+
+    // <mms> being assembled.
+    bool             m_inMms = false;
+    std::size_t      m_mmsBegin = 0, m_mmsEnd = 0;
+    std::string_view m_mmsDate, m_mmsBox;
+    std::string      m_mmsAddress, m_mmsContact, m_mmsText, m_mmsFrom;
+    bool             m_mmsHasText = false;
+    std::vector<InstaAttachment> m_attachments;
+};
+
+bool BackupMessageReader::next(BackupMessage& out)
+{
+    for (;;)
     {
-        if (s[i] != '&')
+        if (!m_haveTag)
         {
-            out.push_back(s[i]);
-            continue;
+            if (!m_scan.next())
+            {
+                if (!m_inMms)
+                    return false;
+                finishMms(out);
+                return true;
+            }
+            m_haveTag = true;
         }
 
-        // Look for the next ';'
-        std::size_t semi = s.find(';', i + 1);
-        if (semi == std::string::npos)
+        const std::string_view name = m_scan.name();
+        if (m_inMms)
         {
-            out.push_back(s[i]);
-            continue;
+            if (name == "part" || name == "addr" || name == "parts" || name == "addrs")
+            {
+                if (name == "part")
+                    addPart();
+                else if (name == "addr")
+                    addAddr();
+                m_mmsEnd  = m_scan.tagEnd();
+                m_haveTag = false;
+                continue;
+            }
+
+            // Anything else starts the next element; hand it out next time.
+            finishMms(out);
+            return true;
         }
 
-        const std::string token = s.substr(i + 1, semi - (i + 1));
+        m_haveTag = false;
+        if (name == "sms")
+        {
+            readSms(out);
+            return true;
+        }
+        if (name == "mms")
+            startMms();
+    }
+}
+
+void BackupMessageReader::readSms(BackupMessage& out)
+{
+    readSmsAttributes(m_scan, m_attrs);
+
+    out = BackupMessage{};
+    out.begin       = m_scan.tagBegin();
+    out.end         = m_scan.tagEnd();
+    out.outgoing    = m_attrs.type == "2";
+    out.address     = XmlUnescapedView(m_attrs.address, m_addressBuf);
+    out.contactName = XmlUnescapedView(m_attrs.contactName, m_contactBuf);
+    out.date        = m_attrs.date;
+    out.hasText     = m_attrs.hasBody;
+    if (m_attrs.hasBody)
+        out.text = XmlUnescapedView(m_attrs.body, m_bodyBuf);
+}
+
+void BackupMessageReader::startMms()
+{
+    m_inMms    = true;
+    m_mmsBegin = m_scan.tagBegin();
+    m_mmsEnd   = m_scan.tagEnd();
+    m_mmsDate  = {};
+    m_mmsBox   = {};
+    m_mmsAddress.clear();
+    m_mmsContact.clear();
+    m_mmsText.clear();
+    m_mmsFrom.clear();
+    m_mmsHasText = false;
+    m_attachments.clear();
+
+    for (const auto& a : m_scan.attributes())
+    {
+        if (a.name == "date")              m_mmsDate = a.value;
+        else if (a.name == "msg_box")      m_mmsBox  = a.value;
+        else if (a.name == "address")      AppendXmlUnescaped(m_mmsAddress, a.value);
+        else if (a.name == "contact_name") AppendXmlUnescaped(m_mmsContact, a.value);
+    }
+}
+
+static bool startsWith(std::string_view s, std::string_view prefix)
+{
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+void BackupMessageReader::addPart()
+{
+    std::string_view ct, text, uri;
+    for (const auto& a : m_scan.attributes())
+    {
+        if (a.name == "ct")
+            ct = a.value;
+        else if (a.name == "text")
+            text = a.value;
+        else if ((a.name == "cl" || a.name == "name" || a.name == "fn") &&
+                 uri.empty() && !isNullOrEmpty(a.value))
+            uri = a.value;
+    }
+
+    if (ct == "application/smil")
+        return;   // layout only
+
+    if (ct == "text/plain")
+    {
+        const std::string_view decoded = XmlUnescapedView(text, m_scratch);
+        if (isNullOrEmpty(decoded))
+            return;
+        if (!m_mmsText.empty())
+            m_mmsText.push_back('\n');
+        m_mmsText.append(decoded.data(), decoded.size());
+        m_mmsHasText = true;
+        return;
+    }
+
+    InstaAttachment att;
+    if (startsWith(ct, "image/"))      att.kind = InstaAttachment::Photo;
+    else if (startsWith(ct, "video/")) att.kind = InstaAttachment::Video;
+    else if (startsWith(ct, "audio/")) att.kind = InstaAttachment::Audio;
+    else                               att.kind = InstaAttachment::File;
+    AppendXmlUnescaped(att.uri, uri);
+    m_attachments.push_back(std::move(att));
+}
+
+void BackupMessageReader::addAddr()
+{
+    // type 137 is PduHeaders.FROM; 151 (TO) and 130 (CC) are the recipients.
+    if (m_scan.attribute("type") != "137")
+        return;
+    m_mmsFrom.clear();
+    AppendXmlUnescaped(m_mmsFrom, m_scan.attribute("address"));
+}
+
+void BackupMessageReader::finishMms(BackupMessage& out)
+{
+    m_inMms = false;
+
+    out = BackupMessage{};
+    out.begin       = m_mmsBegin;
+    out.end         = m_mmsEnd;
+    out.isMms       = true;
+    out.outgoing    = m_mmsBox == "2";
+    out.address     = m_mmsAddress;
+    out.contactName = m_mmsContact;
+    out.date        = m_mmsDate;
+    out.hasText     = m_mmsHasText;
+    out.text        = m_mmsText;
+    out.from        = m_mmsFrom;
+    out.attachments = &m_attachments;
+}
+
+// Worth exporting: some text, or at least one attachment.
+static bool hasContent(const BackupMessage& m)
+{
+    if (m.isMms)
+        return m.hasText || (m.attachments && !m.attachments->empty());
+    return m.hasText && !isNullOrEmpty(m.text);
+}
+
+// -----------------------------------------------------------------------------
+// Group MMS members
+// -----------------------------------------------------------------------------
+
+// Group messages list their members as address="a~b~c" and, when all of them
+// are contacts, contact_name="A, B, C" in the same order.
+static void splitList(std::string_view s, std::string_view sep, std::vector<std::string_view>& out)
+{
+    out.clear();
+    std::size_t pos = 0;
+    for (;;)
+    {
+        const std::size_t hit = s.find(sep, pos);
+        out.push_back(s.substr(pos, hit == std::string_view::npos ? std::string_view::npos : hit - pos));
+        if (hit == std::string_view::npos)
+            return;
+        pos = hit + sep.size();
+    }
+}
+
+static bool isUsableName(std::string_view name)
+{
+    return !isNullOrEmpty(name) && name != "(Unknown)";
+}
+
+// (address, display name) for every member of a group message.
+static void groupMembers(const BackupMessage& m,
+                         std::vector<std::pair<std::string_view, std::string_view>>& out)
+{
+    std::vector<std::string_view> addresses, names;
+    splitList(m.address, "~", addresses);
+    splitList(m.contactName, ", ", names);
+    const bool namesLineUp = names.size() == addresses.size();
+
+    out.clear();
+    for (std::size_t i = 0; i < addresses.size(); ++i)
+    {
+        const std::string_view name = (namesLineUp && isUsableName(names[i])) ? names[i] : addresses[i];
+        out.emplace_back(addresses[i], name);
+    }
+}
+
+// Display name for the sender of an incoming message.
+static std::string_view incomingSenderName(const BackupMessage& m)
+{
+    if (!m.isGroup())
+    {
+        if (isUsableName(m.contactName))
+            return m.contactName;
+        return m.address.empty() ? std::string_view("(Unknown)") : m.address;
+    }
+
+    if (m.from.empty())
+        return "(Unknown)";
 
-        if (token == "amp")      { out.push_back('&'); i = semi; continue; }
-        if (token == "lt")       { out.push_back('<'); i = semi; continue; }
-        if (token == "gt")       { out.push_back('>'); i = semi; continue; }
-        if (token == "quot")     { out.push_back('"'); i = semi; continue; }
-        if (token == "apos")     { out.push_back('\''); i = semi; continue; }
+    std::vector<std::pair<std::string_view, std::string_view>> members;
+    groupMembers(m, members);
+    const std::string fromKey = NormalizeAndroidAddress(m.from);
+    for (const auto& member : members)
+    {
+        if (NormalizeAndroidAddress(member.first) == fromKey)
+            return member.second;
+    }
+    return m.from;
+}
+
+// -----------------------------------------------------------------------------
+// Message scan (whole file or selected byte ranges)
+// -----------------------------------------------------------------------------
+
+struct SmsScanState
+{
+    std::vector<InstaMessage> messages;
+    std::set<std::string>     participants;
+
+    // When set, messages go straight into the writer instead of `messages`,
+    // until one is older than the one before it (then `outOfOrder` is set
+    // and the scan stops).
+    ChunkedExportWriter* writer     = nullptr;
+    long long            lastTs     = std::numeric_limits<long long>::min();
+    bool                 outOfOrder = false;
+
+    std::string   lastRemote;
+    std::string   lastGroup;   // address list whose members were last added
+    BackupMessage message;
+};
+
+static void addScanParticipant(SmsScanState& st, const std::string& name)
+{
+    if (st.participants.insert(name).second && st.writer)
+        st.writer->addParticipant(name);
+}
+
+// Collect the messages whose start tags begin in [begin, end).
+static void scanSmsMessages(std::string_view           text,
+                            std::size_t                begin,
+                            std::size_t                end,
+                            const std::string&         targetAddressOrName,
+                            SmsScanState&              st)
+{
+    const bool hasFilter = !targetAddressOrName.empty();
+    if (st.outOfOrder)
+        return;
+
+    BackupMessageReader reader(text, begin, end);
+    BackupMessage& m = st.message;
+    while (reader.next(m))
+    {
+        if (!hasContent(m))
+            continue;
 
-        // Numeric: &#123; or &#x1A;
-        if (!token.empty() && token[0] == '#')
+        if (hasFilter)
         {
-            long long codePoint = -1;
+            // Exact match behavior (your original intent).
+            if (m.address != targetAddressOrName &&
+                m.contactName != targetAddressOrName)
+            {
+                continue;
+            }
+        }
 
-            if (token.size() >= 2 && (token[1] == 'x' || token[1] == 'X'))
+        if (m.isGroup())
+        {
+            if (m.address != st.lastGroup)
             {
-                // Hex
-                long long value = 0;
-                bool ok = true;
-                for (std::size_t k = 2; k < token.size(); ++k)
-                {
-                    int hv = hexValue(token[k]);
-                    if (hv < 0) { ok = false; break; }
-                    value = (value * 16) + hv;
-                }
-                if (ok) codePoint = value;
+                st.lastGroup.assign(m.address.data(), m.address.size());
+                std::vector<std::pair<std::string_view, std::string_view>> members;
+                groupMembers(m, members);
+                for (const auto& member : members)
+                    addScanParticipant(st, std::string(member.second));
             }
-            else
+        }
+        else
+        {
+            const std::string_view remoteName = incomingSenderName(m);
+            if (remoteName != st.lastRemote)
             {
-                // Decimal
-                long long value = 0;
-                bool ok = true;
-                for (std::size_t k = 1; k < token.size(); ++k)
-                {
-                    if (!std::isdigit(static_cast<unsigned char>(token[k])))
-                    {
-                        ok = false;
-                        break;
-                    }
-                    value = (value * 10) + (token[k] - '0');
-                }
-                if (ok) codePoint = value;
+                st.lastRemote.assign(remoteName.data(), remoteName.size());
+                addScanParticipant(st, st.lastRemote);
             }
+        }
 
-            // Basic UTF-8 encode for BMP + a bit beyond (enough for typical SMS).
-            if (codePoint >= 0 && codePoint <= 0x10FFFF)
-            {
-                if (codePoint <= 0x7F)
-                {
-                    out.push_back(static_cast<char>(codePoint));
-                }
-                else if (codePoint <= 0x7FF)
-                {
-                    out.push_back(static_cast<char>(0xC0 | ((codePoint >> 6) & 0x1F)));
-                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
-                }
-                else if (codePoint <= 0xFFFF)
-                {
-                    out.push_back(static_cast<char>(0xE0 | ((codePoint >> 12) & 0x0F)));
-                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
-                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
-                }
-                else
-                {
-                    out.push_back(static_cast<char>(0xF0 | ((codePoint >> 18) & 0x07)));
-                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
-                    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
-                    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
-                }
+        long long tsMs = 0;
+        if (!parseSmsDate(m.date, tsMs))
+            continue;
 
-                i = semi;
-                continue;
-            }
+        InstaMessage im;
+        if (m.outgoing)
+        {
+            im.sender_name = "Me";          // outgoing
+        }
+        else if (m.isGroup())
+        {
+            im.sender_name = std::string(incomingSenderName(m));
+            addScanParticipant(st, im.sender_name);
+        }
+        else
+        {
+            im.sender_name = st.lastRemote; // incoming
         }
 
-        // Unknown entity; keep original text
-        out.append(s, i, (semi - i + 1));
-        i = semi;
-    }
+        im.timestamp_ms = tsMs;
+        im.content.assign(m.text.data(), m.text.size());
+        if (m.attachments)
+            im.attachments = *m.attachments;
 
-    return out;
+        if (!st.writer)
+        {
+            st.messages.push_back(std::move(im));
+            continue;
+        }
+        if (tsMs < st.lastTs)
+        {
+            st.outOfOrder = true;
+            return;
+        }
+        st.lastTs = tsMs;
+        std::string error;
+        if (!st.writer->add(im, error))
+            throw std::runtime_error(error);
+    }
 }
 
 // -----------------------------------------------------------------------------
-// Write messages + participants to Instagram-style JSON chunks
+// Contact index
 // -----------------------------------------------------------------------------
 
-static bool writeInstagramStyleJson(const std::vector<InstaMessage>& allMessages,
-                                   const std::set<std::string>&     participants,
-                                   const std::string&               outFolder,
-                                   std::string&                     errorOut)
+static const char INDEX_MAGIC[8] = { 'S','M','S','I','D','X','0','2' };
+
+// Neighbouring elements of one contact closer than this are kept as a single
+// range; the few foreign messages in between are filtered out on export.
+static constexpr std::uint64_t RANGE_MERGE_GAP = 4096;
+
+static std::string indexSidecarPath(const std::string& xmlPath)
 {
-    try
+    return xmlPath + ".contacts.idx";
+}
+
+static bool statXmlFile(const std::string& xmlPath, std::uint64_t& size, std::int64_t& mtime)
+{
+    std::error_code ec;
+    const fs::path path = fs::u8path(xmlPath);
+    size = static_cast<std::uint64_t>(fs::file_size(path, ec));
+    if (ec)
+        return false;
+    mtime = static_cast<std::int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return !ec;
+}
+
+static void buildSmsIndex(std::string_view text, AndroidSmsIndex& index)
+{
+    std::unordered_map<std::string, std::size_t> slots;
+    std::string key;
+    std::size_t lastSlot = static_cast<std::size_t>(-1);
+
+    BackupMessageReader reader(text, 0, text.size());
+    BackupMessage m;
+    while (reader.next(m))
     {
-        fs::path outDir = fs::u8path(outFolder);
-        if (!fs::exists(outDir))
-            fs::create_directories(outDir);
+        if (!m.isMms && !m.hasText)
+            continue;
 
-        json participantsJson = json::array();
-        for (const auto& name : participants)
+        // Backups tend to run in conversations; reuse the previous slot when
+        // the pair has not changed.
+        std::size_t slot = lastSlot;
+        if (slot == static_cast<std::size_t>(-1) ||
+            index.contacts[slot].address != m.address ||
+            index.contacts[slot].contactName != m.contactName)
         {
-            json p;
-            p["name"] = name;
-            participantsJson.push_back(std::move(p));
+            key.assign(m.address.data(), m.address.size());
+            key.push_back('\0');
+            key.append(m.contactName.data(), m.contactName.size());
+
+            auto it = slots.find(key);
+            if (it == slots.end())
+            {
+                AndroidSmsContact c;
+                c.address.assign(m.address.data(), m.address.size());
+                c.contactName.assign(m.contactName.data(), m.contactName.size());
+                index.contacts.push_back(std::move(c));
+                it = slots.emplace(key, index.contacts.size() - 1).first;
+            }
+            slot = it->second;
+            lastSlot = slot;
         }
 
-        const std::size_t CHUNK_SIZE = 5000;
-        const std::size_t total      = allMessages.size();
-        std::size_t chunks           = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (chunks == 0) chunks = 1;
+        AndroidSmsContact& c = index.contacts[slot];
+        const std::uint64_t begin = m.begin;
+        const std::uint64_t end   = m.end;
+        if (!c.ranges.empty() && begin - c.ranges.back().second <= RANGE_MERGE_GAP)
+            c.ranges.back().second = end;
+        else
+            c.ranges.emplace_back(begin, end);
+
+        long long tsMs = 0;
+        if (!hasContent(m) || !parseSmsDate(m.date, tsMs))
+            continue;
+
+        if (c.messageCount == 0 || tsMs < c.firstMs) c.firstMs = tsMs;
+        if (c.messageCount == 0 || tsMs > c.lastMs)  c.lastMs  = tsMs;
+        ++c.messageCount;
+    }
+}
+
+// Little-endian encoding for the sidecar file.
+static void putU64(std::string& out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
 
-        for (std::size_t c = 0; c < chunks; ++c)
+static void putString(std::string& out, const std::string& s)
+{
+    putU64(out, s.size());
+    out.append(s);
+}
+
+struct IndexReader
+{
+    const std::string& data;
+    std::size_t        pos = 0;
+    bool               ok  = true;
+
+    std::uint64_t u64()
+    {
+        if (data.size() - pos < 8) { ok = false; return 0; }
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+        pos += 8;
+        return v;
+    }
+
+    std::string str()
+    {
+        const std::uint64_t n = u64();
+        if (!ok || data.size() - pos < n) { ok = false; return {}; }
+        std::string s = data.substr(pos, static_cast<std::size_t>(n));
+        pos += static_cast<std::size_t>(n);
+        return s;
+    }
+};
+
+static bool saveSmsIndex(const std::string& path, const AndroidSmsIndex& index)
+{
+    std::string out(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    putU64(out, index.fileSize);
+    putU64(out, static_cast<std::uint64_t>(index.fileTime));
+    putU64(out, index.contacts.size());
+    for (const auto& c : index.contacts)
+    {
+        putString(out, c.address);
+        putString(out, c.contactName);
+        putU64(out, c.messageCount);
+        putU64(out, static_cast<std::uint64_t>(c.firstMs));
+        putU64(out, static_cast<std::uint64_t>(c.lastMs));
+        putU64(out, c.ranges.size());
+        for (const auto& r : c.ranges)
         {
-            const std::size_t start = c * CHUNK_SIZE;
-            const std::size_t end   = std::min(start + CHUNK_SIZE, total);
+            putU64(out, r.first);
+            putU64(out, r.second);
+        }
+    }
 
-            json out;
-            out["participants"]         = participantsJson;
-            out["messages"]             = json::array();
-            out["title"]                = "";
-            out["is_still_participant"] = true;
-            out["thread_type"]          = "Regular";
-            out["thread_path"]          = "android_sms/converted";
-            out["magic_words"]          = json::array();
+    // Write-then-rename, so a reader never sees half an index.
+    const fs::path finalPath = fs::u8path(path);
+    const fs::path tmpPath   = fs::u8path(path + ".tmp");
+    {
+        std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!ofs.write(out.data(), static_cast<std::streamsize>(out.size())))
+            return false;
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, finalPath, ec);
+    if (ec)
+        fs::remove(tmpPath, ec);
+    return !ec;
+}
 
-            for (std::size_t i = start; i < end; ++i)
-            {
-                const auto& im = allMessages[i];
-                json m;
-                m["sender_name"]  = im.sender_name;
-                m["timestamp_ms"] = im.timestamp_ms;
-                m["content"]      = im.content;
-                out["messages"].push_back(std::move(m));
-            }
+static bool loadSmsIndex(const std::string& path, std::uint64_t fileSize, std::int64_t fileTime,
+                         AndroidSmsIndex& index)
+{
+    std::ifstream in(fs::u8path(path), std::ios::binary);
+    if (!in)
+        return false;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(INDEX_MAGIC) ||
+        data.compare(0, sizeof(INDEX_MAGIC), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0)
+        return false;
 
-            std::ostringstream filename;
-            filename << "message_" << (c + 1) << ".json";
-            fs::path outPath = outDir / fs::u8path(filename.str());
+    IndexReader rd{ data, sizeof(INDEX_MAGIC) };
+    if (rd.u64() != fileSize || static_cast<std::int64_t>(rd.u64()) != fileTime || !rd.ok)
+        return false;
 
-            std::ofstream ofs(outPath, std::ios::binary);
-            if (!ofs)
-            {
-                errorOut = "Failed to open output file: " + outPath.string();
+    AndroidSmsIndex loaded;
+    loaded.fileSize = fileSize;
+    loaded.fileTime = fileTime;
+    const std::uint64_t count = rd.u64();
+    for (std::uint64_t i = 0; i < count && rd.ok; ++i)
+    {
+        AndroidSmsContact c;
+        c.address      = rd.str();
+        c.contactName  = rd.str();
+        c.messageCount = rd.u64();
+        c.firstMs      = static_cast<long long>(rd.u64());
+        c.lastMs       = static_cast<long long>(rd.u64());
+        const std::uint64_t ranges = rd.u64();
+        if (!rd.ok || ranges > (data.size() - rd.pos) / 16)
+            return false;
+        c.ranges.reserve(static_cast<std::size_t>(ranges));
+        for (std::uint64_t r = 0; r < ranges; ++r)
+        {
+            const std::uint64_t b = rd.u64();
+            const std::uint64_t e = rd.u64();
+            if (b > e || e > fileSize)
                 return false;
-            }
+            c.ranges.emplace_back(b, e);
+        }
+        loaded.contacts.push_back(std::move(c));
+    }
+    if (!rd.ok || rd.pos != data.size())
+        return false;
+
+    index = std::move(loaded);
+    return true;
+}
 
-            ofs << out.dump(2);
+bool LoadAndroidSmsIndex(const std::string& xmlPath,
+                         AndroidSmsIndex&   indexOut,
+                         std::string&       errorOut)
+{
+    try
+    {
+        std::uint64_t size = 0;
+        std::int64_t  mtime = 0;
+        if (!statXmlFile(xmlPath, size, mtime))
+        {
+            errorOut = "Android SMS XML file does not exist: " + xmlPath;
+            return false;
+        }
+
+        const std::string sidecar = indexSidecarPath(xmlPath);
+        if (loadSmsIndex(sidecar, size, mtime, indexOut))
+        {
+            errorOut.clear();
+            return true;
+        }
+
+        MappedFile file;
+        if (!file.open(xmlPath, errorOut))
+        {
+            errorOut = "Failed to open Android SMS XML file: " + xmlPath;
+            return false;
         }
 
+        AndroidSmsIndex index;
+        index.fileSize = size;
+        index.fileTime = mtime;
+        buildSmsIndex(file.view(), index);
+
+        // Best effort: a read-only folder just means the next call rescans.
+        saveSmsIndex(sidecar, index);
+
+        indexOut = std::move(index);
         errorOut.clear();
         return true;
     }
@@ -253,7 +739,8 @@ static bool writeInstagramStyleJson(const std::vector<InstaMessage>& allMessages
 bool ConvertAndroidSmsXmlToInstagramFolder(const std::string& xmlPath,
                                           const std::string& targetAddressOrName,
                                           const std::string& outFolder,
-                                          std::string&       errorOut)
+                                          std::string&       errorOut,
+                                          std::size_t        chunkSize)
 {
     try
     {
@@ -264,140 +751,410 @@ bool ConvertAndroidSmsXmlToInstagramFolder(const std::string& xmlPath,
             return false;
         }
 
-        std::ifstream in(inPath, std::ios::binary);
-        if (!in)
+        // With a filter, only the byte ranges of the matching contacts are
+        // read; the index comes from the sidecar file when it is current.
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges;
+        const bool hasFilter = !targetAddressOrName.empty();
+        if (hasFilter)
+        {
+            AndroidSmsIndex index;
+            if (!LoadAndroidSmsIndex(xmlPath, index, errorOut))
+                return false;
+            for (const auto& c : index.contacts)
+            {
+                if (c.address == targetAddressOrName || c.contactName == targetAddressOrName)
+                    ranges.insert(ranges.end(), c.ranges.begin(), c.ranges.end());
+            }
+            std::sort(ranges.begin(), ranges.end());
+        }
+
+        MappedFile file;
+        if (!file.open(xmlPath, errorOut))
         {
             errorOut = "Failed to open Android SMS XML file: " + xmlPath;
             return false;
         }
+        const std::string_view text = file.view();
 
-        std::vector<InstaMessage> allMessages;
-        std::set<std::string>     participants;
-        participants.insert("Me");
-
-        const bool hasFilter = !targetAddressOrName.empty();
-
-        std::string line;
-        bool        inSms = false;
-        std::string smsChunk;
-
-        while (std::getline(in, line))
+        auto scan = [&](SmsScanState& st)
         {
-            if (!line.empty() && line.back() == '\r')
-                line.pop_back();
+            st.participants.insert("Me");
+            if (st.writer)
+                st.writer->addParticipant("Me");
 
-            if (!inSms)
+            if (!hasFilter)
             {
-                std::size_t pos = line.find("<sms ");
-                if (pos == std::string::npos)
-                    continue;
-
-                inSms = true;
-                smsChunk.clear();
-                smsChunk.append(line.substr(pos));
-                smsChunk.push_back('\n');
-
-                if (smsChunk.find("/>") != std::string::npos)
-                    inSms = false;
-                else
+                scanSmsMessages(text, 0, text.size(), targetAddressOrName, st);
+                return;
+            }
+            std::uint64_t done = 0;   // ranges of several contacts may overlap
+            for (const auto& r : ranges)
+            {
+                const std::uint64_t begin = std::max(r.first, done);
+                if (begin >= r.second || r.second > text.size())
                     continue;
+                scanSmsMessages(text, static_cast<std::size_t>(begin),
+                                static_cast<std::size_t>(r.second), targetAddressOrName, st);
+                done = r.second;
+            }
+        };
+        auto noMessages = [&]()
+        {
+            if (hasFilter)
+            {
+                errorOut = "No SMS messages found matching address/contact: \"" +
+                           targetAddressOrName + "\".";
             }
             else
             {
-                smsChunk.append(line);
-                smsChunk.push_back('\n');
+                errorOut = "No SMS messages were found in the XML file.";
+            }
+            return false;
+        };
 
-                if (line.find("/>") == std::string::npos)
-                    continue;
+        ExportChunkOptions chunkOptions;
+        chunkOptions.threadPath = "android_sms/converted";
+        chunkOptions.threadType = "Regular";
+        chunkOptions.chunkSize  = chunkSize;
 
-                inSms = false;
+        // Backups are usually in date order already, so messages are
+        // streamed straight into the chunk files.
+        {
+            ChunkedExportWriter writer(outFolder, chunkOptions);
+            SmsScanState st;
+            st.writer = &writer;
+            scan(st);
+            if (!st.outOfOrder)
+            {
+                if (writer.messageCount() == 0)
+                    return noMessages();
+                if (!writer.finish(errorOut))
+                    return false;
+                errorOut.clear();
+                return true;
             }
+        }
 
-            std::string address;
-            std::string contactName;
-            std::string dateStr;
-            std::string typeStr;
-            std::string body;
+        // A message older than the one before it: collect them all, sort
+        // and rewrite every chunk. A stable sort keeps same-millisecond
+        // messages in file order.
+        SmsScanState st;
+        scan(st);
+        std::vector<InstaMessage>& allMessages = st.messages;
+        std::stable_sort(allMessages.begin(), allMessages.end(),
+                         [](const InstaMessage& a, const InstaMessage& b)
+                         {
+                             return a.timestamp_ms < b.timestamp_ms;
+                         });
+        return WriteInstagramChunks(outFolder, chunkOptions, st.participants, allMessages, errorOut);
+    }
+    catch (const std::exception& ex)
+    {
+        errorOut = ex.what();
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// All threads in one pass
+// -----------------------------------------------------------------------------
+
+// Numbers agreeing in this many trailing digits are treated as the same
+// person, which absorbs country codes and national trunk prefixes.
+static constexpr std::size_t SIGNIFICANT_PHONE_DIGITS = 10;
 
-            extractXmlAttribute(smsChunk, "address",      address);
-            extractXmlAttribute(smsChunk, "contact_name", contactName);
-            extractXmlAttribute(smsChunk, "date",         dateStr);
-            extractXmlAttribute(smsChunk, "type",         typeStr);
-            extractXmlAttribute(smsChunk, "body",         body);
+std::string NormalizeAndroidAddress(std::string_view address)
+{
+    if (isNullOrEmpty(address))
+        return {};
 
-            // XML-escaped attributes are common in SMS exports.
-            address     = xmlUnescape(address);
-            contactName = xmlUnescape(contactName);
-            body        = xmlUnescape(body);
+    if (address.find('~') != std::string_view::npos)
+    {
+        // Group: the same members in any order are the same conversation.
+        std::vector<std::string_view> parts;
+        splitList(address, "~", parts);
+        std::vector<std::string> keys;
+        for (const auto& part : parts)
+            keys.push_back(NormalizeAndroidAddress(part));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
 
-            if (isNullOrEmpty(body))
+        std::string out;
+        for (const auto& k : keys)
+        {
+            if (!out.empty())
+                out.push_back('~');
+            out += k;
+        }
+        return out;
+    }
+
+    bool hasLetter = false;
+    std::string digits;
+    for (char c : address)
+    {
+        if (c >= '0' && c <= '9')
+            digits.push_back(c);
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '@')
+            hasLetter = true;
+    }
+
+    if (hasLetter || digits.empty())
+    {
+        std::string out;
+        for (char c : address)
+        {
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
                 continue;
+            out.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+        }
+        return out;
+    }
 
-            if (hasFilter)
+    if (digits.size() > SIGNIFICANT_PHONE_DIGITS)
+        digits.erase(0, digits.size() - SIGNIFICANT_PHONE_DIGITS);
+    return digits;
+}
+
+// Portable folder name for a thread key.
+static std::string threadFolderName(const std::string& key)
+{
+    if (key.empty())
+        return "unknown";
+
+    std::string out;
+    for (char c : key)
+    {
+        const bool safe = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+                          (c >= 'A' && c <= 'Z') || c == '@' || c == '.' ||
+                          c == '-' || c == '_' || c == '+';
+        out.push_back(safe ? c : '_');
+    }
+    return out;
+}
+
+struct ThreadBuilder
+{
+    AndroidSmsThread thread;
+    bool              group = false;                            // MMS group chat
+    std::vector<bool> incoming;                                 // per message
+    std::vector<std::pair<std::string, std::size_t>> nameVotes; // usually 1 entry
+
+    void vote(std::string_view name)
+    {
+        for (auto& v : nameVotes)
+        {
+            if (v.first == name)
             {
-                // Exact match behavior (your original intent).
-                if (address != targetAddressOrName &&
-                    contactName != targetAddressOrName)
-                {
-                    continue;
-                }
+                ++v.second;
+                return;
             }
+        }
+        nameVotes.emplace_back(std::string(name), 1);
+    }
+};
 
-            std::string remoteName;
-            if (!isNullOrEmpty(contactName) && contactName != "(Unknown)")
-                remoteName = contactName;
-            else
-                remoteName = address.empty() ? "(Unknown)" : address;
+bool ReadAndroidSmsThreads(const std::string&             xmlPath,
+                           std::vector<AndroidSmsThread>& threadsOut,
+                           std::string&                   errorOut)
+{
+    try
+    {
+        if (!fs::exists(fs::u8path(xmlPath)))
+        {
+            errorOut = "Android SMS XML file does not exist: " + xmlPath;
+            return false;
+        }
+
+        MappedFile file;
+        if (!file.open(xmlPath, errorOut))
+        {
+            errorOut = "Failed to open Android SMS XML file: " + xmlPath;
+            return false;
+        }
+
+        std::vector<ThreadBuilder> builders;
+        std::unordered_map<std::string, std::size_t> byKey;
 
-            participants.insert(remoteName);
+        // Raw address -> thread, so normalization runs once per spelling.
+        std::unordered_map<std::string, std::size_t> byAddress;
+        std::string lastAddress;
+        std::size_t lastThread = static_cast<std::size_t>(-1);
 
-            if (isNullOrEmpty(dateStr))
+        const std::string_view text = file.view();
+        BackupMessageReader reader(text, 0, text.size());
+        BackupMessage m;
+        std::vector<std::pair<std::string_view, std::string_view>> members;
+        while (reader.next(m))
+        {
+            if (!hasContent(m))
                 continue;
 
             long long tsMs = 0;
-            try
-            {
-                tsMs = std::stoll(dateStr);
-            }
-            catch (...)
-            {
+            if (!parseSmsDate(m.date, tsMs))
                 continue;
+
+            std::size_t t = lastThread;
+            if (t == static_cast<std::size_t>(-1) || m.address != lastAddress)
+            {
+                lastAddress.assign(m.address.data(), m.address.size());
+                auto it = byAddress.find(lastAddress);
+                if (it == byAddress.end())
+                {
+                    std::string key = NormalizeAndroidAddress(m.address);
+                    auto kt = byKey.find(key);
+                    if (kt == byKey.end())
+                    {
+                        builders.emplace_back();
+                        builders.back().thread.key = key;
+                        builders.back().group = m.isGroup();
+                        kt = byKey.emplace(std::move(key), builders.size() - 1).first;
+                    }
+                    if (!isNullOrEmpty(m.address))
+                        builders[kt->second].thread.addresses.push_back(lastAddress);
+                    it = byAddress.emplace(lastAddress, kt->second).first;
+                }
+                t = it->second;
+                lastThread = t;
             }
 
+            ThreadBuilder& b = builders[t];
+            if (isUsableName(m.contactName))
+                b.vote(m.contactName);
+
             InstaMessage im;
-            if (typeStr == "2")
-                im.sender_name = "Me";       // outgoing
+            bool senderLater = false;
+            if (m.outgoing)
+            {
+                im.sender_name = "Me";
+            }
+            else if (b.group)
+            {
+                im.sender_name = std::string(incomingSenderName(m));
+                b.thread.participants.insert(im.sender_name);
+            }
             else
-                im.sender_name = remoteName; // incoming 
+            {
+                senderLater = true;   // the thread's display name, once known
+            }
+
+            if (b.group)
+            {
+                groupMembers(m, members);
+                for (const auto& member : members)
+                    b.thread.participants.insert(std::string(member.second));
+            }
 
             im.timestamp_ms = tsMs;
-            im.content      = body;
+            im.content.assign(m.text.data(), m.text.size());
+            if (m.attachments)
+                im.attachments = *m.attachments;
 
-            allMessages.push_back(std::move(im));
+            b.thread.messages.push_back(std::move(im));
+            b.incoming.push_back(senderLater);
         }
 
-        if (allMessages.empty())
+        std::vector<AndroidSmsThread> threads;
+        threads.reserve(builders.size());
+        for (auto& b : builders)
         {
-            if (hasFilter)
+            AndroidSmsThread& th = b.thread;
+
+            std::size_t best = 0;
+            for (const auto& v : b.nameVotes)
             {
-                errorOut = "No SMS messages found matching address/contact: \"" +
-                           targetAddressOrName + "\".";
+                if (v.second > best)
+                {
+                    best = v.second;
+                    th.displayName = v.first;
+                }
             }
-            else
+            if (th.displayName.empty())
+                th.displayName = th.addresses.empty() ? std::string("(Unknown)") : th.addresses.front();
+
+            for (std::size_t i = 0; i < th.messages.size(); ++i)
             {
-                errorOut = "No SMS messages were found in the XML file.";
+                if (b.incoming[i])
+                    th.messages[i].sender_name = th.displayName;
             }
+
+            th.participants.insert("Me");
+            if (!b.group)
+                th.participants.insert(th.displayName);
+
+            auto byTime = [](const InstaMessage& x, const InstaMessage& y)
+            {
+                return x.timestamp_ms < y.timestamp_ms;
+            };
+            if (!std::is_sorted(th.messages.begin(), th.messages.end(), byTime))
+                std::stable_sort(th.messages.begin(), th.messages.end(), byTime);
+
+            threads.push_back(std::move(th));
+        }
+
+        if (threads.empty())
+        {
+            errorOut = "No SMS messages were found in the XML file.";
             return false;
         }
 
-        std::sort(allMessages.begin(),
-                  allMessages.end(),
-                  [](const InstaMessage& a, const InstaMessage& b)
-                  {
-                      return a.timestamp_ms < b.timestamp_ms;
-                  });
+        threadsOut = std::move(threads);
+        errorOut.clear();
+        return true;
+    }
+    catch (const std::exception& ex)
+    {
+        errorOut = ex.what();
+        return false;
+    }
+}
+
+bool ConvertAndroidSmsXmlToInstagramFolders(const std::string&                    xmlPath,
+                                           const std::string&                    outRoot,
+                                           std::vector<AndroidSmsThreadSummary>& threadsOut,
+                                           std::string&                          errorOut,
+                                           std::size_t                           chunkSize)
+{
+    std::vector<AndroidSmsThread> threads;
+    if (!ReadAndroidSmsThreads(xmlPath, threads, errorOut))
+        return false;
 
-        return writeInstagramStyleJson(allMessages, participants, outFolder, errorOut);
+    try
+    {
+        std::vector<AndroidSmsThreadSummary> summaries;
+        std::set<std::string> usedFolders;
+
+        for (auto& th : threads)
+        {
+            // Distinct keys can only collide here after sanitizing.
+            std::string folder = threadFolderName(th.key);
+            for (int n = 2; !usedFolders.insert(folder).second; ++n)
+                folder = threadFolderName(th.key) + "_" + std::to_string(n);
+
+            ExportChunkOptions chunkOptions;
+            chunkOptions.title      = th.displayName;
+            chunkOptions.threadPath = "android_sms/" + folder;
+            chunkOptions.threadType = "Regular";
+            chunkOptions.chunkSize  = chunkSize;
+
+            const std::string outFolder = (fs::u8path(outRoot) / fs::u8path(folder)).u8string();
+            if (!WriteInstagramChunks(outFolder, chunkOptions, th.participants, th.messages, errorOut))
+                return false;
+
+            AndroidSmsThreadSummary summary;
+            summary.key          = th.key;
+            summary.displayName  = th.displayName;
+            summary.folder       = folder;
+            summary.messageCount = th.messages.size();
+            summaries.push_back(std::move(summary));
+
+            // Release each thread once written.
+            std::vector<InstaMessage>().swap(th.messages);
+        }
+
+        threadsOut = std::move(summaries);
+        errorOut.clear();
+        return true;
     }
     catch (const std::exception& ex)
     {
@@ -1,7 +1,15 @@
 // android_sms_convert.hpp
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "export_writer.hpp"
 
 // xmlPath:
 //   - Path to the SMS Backup & Restore XML file (e.g. sms-20251211110655.xml).
@@ -14,6 +22,9 @@
 // outFolder:
 //   - Destination folder where message_#.json files will be written.
 //
+// chunkSize:
+//   - Messages per output message_#.json file.
+//
 // errorOut:
 //   - On failure, filled with a human-readable error message.
 //
@@ -22,5 +33,100 @@ bool ConvertAndroidSmsXmlToInstagramFolder(
     const std::string& xmlPath,
     const std::string& targetAddressOrName,
     const std::string& outFolder,
+    std::string&       errorOut,
+    std::size_t        chunkSize = DEFAULT_EXPORT_CHUNK_SIZE
+);
+
+// One (address, contact_name) pair seen in a backup.
+struct AndroidSmsContact
+{
+    std::string address;       // entity-decoded, as stored in the backup
+    std::string contactName;   // ditto; may be "(Unknown)" or "null"
+
+    std::size_t messageCount = 0;   // <sms> elements with a body and a date
+    long long   firstMs      = 0;   // time range of those messages
+    long long   lastMs       = 0;
+
+    // Byte ranges [begin, end) of the file covering all of this pair's <sms>
+    // elements, in file order. Close neighbours are merged, so a range may
+    // also hold a few messages of other contacts.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges;
+};
+
+struct AndroidSmsIndex
+{
+    std::uint64_t fileSize = 0;   // the backup the index describes
+    std::int64_t  fileTime = 0;   // last write time (filesystem clock ticks)
+    std::vector<AndroidSmsContact> contacts;   // in order of first appearance
+};
+
+// Load the contact index of an SMS Backup & Restore file.
+//
+// The index is cached in a sidecar file ("<xmlPath>.contacts.idx"). It is
+// reused while the backup's size and modification time match; otherwise the
+// backup is scanned once and the sidecar rewritten (best effort).
+//
+// ConvertAndroidSmsXmlToInstagramFolder uses it whenever a filter is given,
+// so exporting one contact only reads that contact's byte ranges.
+bool LoadAndroidSmsIndex(
+    const std::string& xmlPath,
+    AndroidSmsIndex&   indexOut,
     std::string&       errorOut
 );
+
+// -----------------------------------------------------------------------------
+// All threads in one pass
+// -----------------------------------------------------------------------------
+
+// Canonical form of an <sms> address, used to group a backup into threads:
+//   - phone numbers keep only their digits, and numbers longer than 10 digits
+//     are compared on their last 10 ("+1 (555) 010-0002", "15550100002" and
+//     "555-010-0002" are one thread; so are "+44 7700 900123" and
+//     "07700 900123");
+//   - group MMS addresses ("a~b~c") normalize each member and sort them;
+//   - addresses with letters (e-mail, alphanumeric sender IDs such as
+//     "AMAZON") are lower-cased with whitespace removed;
+//   - an empty or "null" address gives "".
+std::string NormalizeAndroidAddress(std::string_view address);
+
+// One conversation of a backup.
+struct AndroidSmsThread
+{
+    std::string key;            // NormalizeAndroidAddress() of its addresses
+    std::string displayName;    // most used contact name, else first address
+    std::vector<std::string> addresses;   // every spelling seen, first-seen order
+
+    // Chronological; outgoing messages are sent by "Me", incoming ones by
+    // displayName (or, in group MMS threads, by the member who sent them).
+    std::vector<InstaMessage> messages;
+    std::set<std::string>     participants;   // "Me" plus the other side(s)
+};
+
+// Scan the backup once and split it into threads by normalized address, in
+// order of first appearance. This is the in-memory form of the all-threads
+// export, for callers that analyze the threads directly.
+bool ReadAndroidSmsThreads(
+    const std::string&             xmlPath,
+    std::vector<AndroidSmsThread>& threadsOut,
+    std::string&                   errorOut
+);
+
+struct AndroidSmsThreadSummary
+{
+    std::string key;
+    std::string displayName;
+    std::string folder;         // sub-folder of outRoot holding the chunks
+    std::size_t messageCount = 0;
+};
+
+// Export every thread of the backup with a single scan: one sub-folder of
+// outRoot per thread (named after its normalized address), each holding the
+// same message_#.json chunks a filtered ConvertAndroidSmsXmlToInstagramFolder
+// call would write.
+bool ConvertAndroidSmsXmlToInstagramFolders(
+    const std::string&                    xmlPath,
+    const std::string&                    outRoot,
+    std::vector<AndroidSmsThreadSummary>& threadsOut,
+    std::string&                          errorOut,
+    std::size_t                           chunkSize = DEFAULT_EXPORT_CHUNK_SIZE
+);
@@ -0,0 +1,384 @@
+// batch_runner.cpp
+// Analyze many chats in one process: inputs from manifests and/or globs,
+// scheduled largest-first on a work-stealing pool, results streamed as JSONL.
+
+#include "batch_runner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "chat_analyzer.hpp"
+#include "json_writer.hpp"
+#include "thread_pool.hpp"
+
+namespace fs = std::filesystem;
+
+// ------------------------------------------------------------
+// Helpers: input discovery
+// ------------------------------------------------------------
+static bool HasWildcard(const std::string& s)
+{
+    return s.find_first_of("*?") != std::string::npos;
+}
+
+// '*' matches any run of characters, '?' exactly one.
+static bool WildcardMatch(const std::string& pattern, const std::string& text)
+{
+    std::size_t p = 0, t = 0;
+    std::size_t starP = std::string::npos, starT = 0;
+
+    while (t < text.size())
+    {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]))
+        {
+            ++p;
+            ++t;
+        }
+        else if (p < pattern.size() && pattern[p] == '*')
+        {
+            starP = p++;
+            starT = t;
+        }
+        else if (starP != std::string::npos)
+        {
+            p = starP + 1;
+            t = ++starT;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*')
+        ++p;
+    return p == pattern.size();
+}
+
+// Expand one pattern component by component, so wildcards may appear at
+// any depth ("exports/*/inbox/*").
+static void ExpandGlob(const std::string& pattern, std::vector<std::string>& out)
+{
+    fs::path patternPath(pattern);
+
+    std::vector<fs::path> current;
+    current.push_back(patternPath.root_path());
+
+    for (const fs::path& component : patternPath.relative_path())
+    {
+        const std::string comp = component.string();
+        if (comp.empty())
+            continue;
+
+        std::vector<fs::path> next;
+        for (const fs::path& base : current)
+        {
+            if (!HasWildcard(comp))
+            {
+                next.push_back(base / component);
+                continue;
+            }
+
+            std::error_code ec;
+            fs::path dir = base.empty() ? fs::path(".") : base;
+            if (!fs::is_directory(dir, ec))
+                continue;
+
+            std::vector<fs::path> matches;
+            for (const auto& entry : fs::directory_iterator(dir, ec))
+            {
+                std::string name = entry.path().filename().string();
+                if (!name.empty() && name[0] == '.' && comp[0] != '.')
+                    continue; // like a shell: '*' does not match dotfiles
+                if (WildcardMatch(comp, name))
+                    matches.push_back(base / entry.path().filename());
+            }
+            std::sort(matches.begin(), matches.end());
+            next.insert(next.end(), matches.begin(), matches.end());
+        }
+        current.swap(next);
+    }
+
+    for (const fs::path& p : current)
+    {
+        std::error_code ec;
+        if (!p.empty() && fs::exists(p, ec))
+            out.push_back(p.string());
+    }
+}
+
+static bool ReadManifest(const std::string& manifestPath,
+                         std::vector<std::string>& out,
+                         std::string& errorOut)
+{
+    std::ifstream in(manifestPath);
+    if (!in)
+    {
+        errorOut = "Could not open manifest: " + manifestPath;
+        return false;
+    }
+
+    fs::path baseDir = fs::path(manifestPath).parent_path();
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+            line.pop_back();
+        std::size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#')
+            continue;
+        line.erase(0, start);
+
+        fs::path p(line);
+        if (p.is_relative())
+            p = baseDir / p;
+
+        if (HasWildcard(line))
+            ExpandGlob(p.string(), out);
+        else
+            out.push_back(p.string());
+    }
+    return true;
+}
+
+// Same selection the analyzer makes: the file itself, or the *.json files
+// directly inside a folder.
+static std::uint64_t ChatInputBytes(const std::string& path)
+{
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec))
+    {
+        auto size = fs::file_size(path, ec);
+        return ec ? 0 : static_cast<std::uint64_t>(size);
+    }
+
+    std::uint64_t total = 0;
+    if (fs::is_directory(path, ec))
+    {
+        for (const auto& entry : fs::directory_iterator(path, ec))
+        {
+            if (entry.path().extension() != ".json")
+                continue;
+            auto size = entry.file_size(ec);
+            if (!ec)
+                total += static_cast<std::uint64_t>(size);
+        }
+    }
+    return total;
+}
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+bool CollectBatchInputs(
+    const BatchOptions&       options,
+    std::vector<std::string>& pathsOut,
+    std::string&              errorOut)
+{
+    std::vector<std::string> raw;
+
+    for (const auto& manifest : options.manifests)
+    {
+        if (!ReadManifest(manifest, raw, errorOut))
+            return false;
+    }
+    for (const auto& pattern : options.globs)
+    {
+        if (HasWildcard(pattern))
+            ExpandGlob(pattern, raw);
+        else
+            raw.push_back(pattern);
+    }
+
+    // Keep first occurrence order; drop repeats of the same chat.
+    std::set<std::string> seen;
+    pathsOut.clear();
+    for (auto& p : raw)
+    {
+        std::error_code ec;
+        fs::path canon = fs::weakly_canonical(p, ec);
+        std::string key = ec ? p : canon.string();
+        if (seen.insert(key).second)
+            pathsOut.push_back(std::move(p));
+    }
+    return true;
+}
+
+bool RunBatchAnalysis(
+    const BatchOptions& options,
+    BatchResult&        resultOut,
+    std::string&        errorOut)
+{
+    using Clock = std::chrono::steady_clock;
+
+    resultOut = BatchResult{};
+
+    std::vector<std::string> paths;
+    if (!CollectBatchInputs(options, paths, errorOut))
+        return false;
+    if (paths.empty())
+    {
+        errorOut = "No chats matched the given manifests/globs.";
+        return false;
+    }
+
+    std::shared_ptr<const AnalysisLexicons> lexicons;
+    try
+    {
+        lexicons = LoadAnalysisLexicons();
+    }
+    catch (const std::exception& ex)
+    {
+        errorOut = ex.what();
+        return false;
+    }
+
+    std::ofstream outFile;
+    if (!options.outputPath.empty())
+    {
+        outFile.open(options.outputPath, std::ios::binary | std::ios::trunc);
+        if (!outFile)
+        {
+            errorOut = "Could not open output file: " + options.outputPath;
+            return false;
+        }
+    }
+    std::ostream& out = options.outputPath.empty() ? std::cout : outFile;
+
+    struct Job
+    {
+        std::size_t   index;
+        std::string   path;
+        std::uint64_t bytes;
+    };
+
+    std::vector<Job> jobs;
+    jobs.reserve(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i)
+        jobs.push_back({ i, paths[i], ChatInputBytes(paths[i]) });
+
+    // Largest first: long chats start early instead of becoming the tail.
+    std::stable_sort(jobs.begin(), jobs.end(),
+        [](const Job& a, const Job& b) { return a.bytes > b.bytes; });
+
+    AnalysisOptions analysisOptions;
+    analysisOptions.memoryCapBytes = options.memoryCapBytes;
+    analysisOptions.verbose        = false;
+
+    std::mutex outMutex;
+    const auto batchStart = Clock::now();
+
+    {
+        WorkStealingPool pool(options.threads);
+
+        for (const Job& job : jobs)
+        {
+            pool.submit([&, job]
+            {
+                const auto start = Clock::now();
+
+                AnalysisResults results;
+                std::string     error;
+                bool ok = false;
+                try
+                {
+                    results = analyzeChat(job.path, *lexicons, analysisOptions);
+                    ok = true;
+                }
+                catch (const std::exception& ex)
+                {
+                    error = ex.what();
+                }
+
+                const double seconds =
+                    std::chrono::duration<double>(Clock::now() - start).count();
+
+                std::ostringstream line;
+                {
+                    JsonWriter w(line);
+                    w.beginObject();
+                    w.field("index",       static_cast<unsigned long long>(job.index));
+                    w.field("path",        job.path);
+                    w.field("status",      ok ? "ok" : "error");
+                    if (!ok)
+                        w.field("error",   error);
+                    w.field("input_bytes", static_cast<unsigned long long>(job.bytes));
+                    w.field("seconds",     seconds);
+
+                    if (ok)
+                    {
+                        w.field("messages", results.totalMessages);
+
+                        w.key("users");
+                        w.beginArray();
+                        for (const UserResults& u : results.users)
+                        {
+                            w.beginObject();
+                            w.field("name",         u.name);
+                            w.field("messages",     u.totalMessages);
+                            w.field("words",        u.totalWords);
+                            w.field("avg_compound", u.vaderCompound);
+                            w.endObject();
+                        }
+                        w.endArray();
+
+                        if (options.fullResults)
+                        {
+                            w.key("results");
+                            writeResultsJson(results, w);
+                        }
+                    }
+                    w.endObject();
+                }
+                line << '\n';
+                const std::string text = line.str();
+
+                std::lock_guard<std::mutex> lk(outMutex);
+                out << text;
+                out.flush();
+
+                resultOut.chats++;
+                resultOut.inputBytes += job.bytes;
+                if (ok)
+                    resultOut.totalMessages += results.totalMessages;
+                else
+                    resultOut.failed++;
+            });
+        }
+
+        pool.wait();
+
+        resultOut.seconds =
+            std::chrono::duration<double>(Clock::now() - batchStart).count();
+
+        const double secs = resultOut.seconds > 0.0 ? resultOut.seconds : 1e-9;
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(2)
+                << "Batch: " << resultOut.chats << " chats ("
+                << resultOut.failed << " failed), "
+                << formatWithCommas(resultOut.totalMessages) << " messages, "
+                << (resultOut.inputBytes / (1024.0 * 1024.0)) << " MB in "
+                << resultOut.seconds << " s on " << pool.size() << " threads | "
+                << (resultOut.chats / secs) << " chats/s, "
+                << formatWithCommas(static_cast<long long>(resultOut.totalMessages / secs))
+                << " msgs/s, "
+                << (resultOut.inputBytes / (1024.0 * 1024.0) / secs) << " MB/s\n";
+        std::cerr << summary.str();
+    }
+
+    if (outFile.is_open() && !outFile)
+    {
+        errorOut = "Failed while writing " + options.outputPath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,66 @@
+// batch_runner.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BatchOptions
+{
+    // Text files listing one chat path per line (a message_#.json file or a
+    // folder of them). Blank lines and lines starting with '#' are ignored;
+    // relative paths are resolved against the manifest's folder.
+    std::vector<std::string> manifests;
+
+    // Path patterns; '*' and '?' may appear in any component, e.g.
+    //   exports/*/messages/inbox/*
+    std::vector<std::string> globs;
+
+    // JSONL output, one record per chat. Empty = stdout.
+    std::string outputPath;
+
+    // Embed the complete results model (see writeResultsJson) in every
+    // record as "results".
+    bool fullResults = false;
+
+    // Worker threads (0 = all hardware threads).
+    unsigned threads = 0;
+
+    // Per-chat working-set cap in bytes (0 = unlimited). A chat that would
+    // exceed it is recorded as failed; the rest of the batch carries on.
+    std::size_t memoryCapBytes = 0;
+};
+
+struct BatchResult
+{
+    std::size_t   chats         = 0;
+    std::size_t   failed        = 0;
+    long long     totalMessages = 0;
+    std::uint64_t inputBytes    = 0;
+    double        seconds       = 0.0;
+};
+
+// Expand manifests and globs into a de-duplicated list of chat paths.
+// Returns false (and fills errorOut) if a manifest cannot be read.
+bool CollectBatchInputs(
+    const BatchOptions&       options,
+    std::vector<std::string>& pathsOut,
+    std::string&              errorOut
+);
+
+// Analyze every chat on a work-stealing pool that shares one copy of the
+// lexicons. Records are written to the JSONL output as chats finish:
+//   {"index":N,"path":"...","status":"ok"|"error","error":"...",
+//    "input_bytes":N,"seconds":S,"messages":N,
+//    "users":[{"name":"...","messages":N,"words":N,"avg_compound":X}],
+//    "results":{...}}                        (with fullResults)
+// Throughput is summarised on stderr.
+//
+// Returns true if the batch ran (even if individual chats failed); false with
+// errorOut set if inputs, lexicons or the output file could not be opened.
+bool RunBatchAnalysis(
+    const BatchOptions& options,
+    BatchResult&        resultOut,
+    std::string&        errorOut
+);
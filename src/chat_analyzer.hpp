@@ -0,0 +1,271 @@
+// chat_analyzer.hpp
+// Public interface of the analysis engine (Count_Messages.cpp).
+// Platform-neutral: used by the Win32 GUI, the console CLI and the benchmarks.
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vader_sentiment.hpp"
+#include "nrc_emotion.hpp"
+#include "static_lexicon.hpp"
+
+class JsonWriter;
+
+// -------------------------------------------------------------
+// Chart series (filled by runAnalysisToString, read by the GUI)
+// -------------------------------------------------------------
+struct MonthlyEmotionPoint {
+    int year;
+    int month;
+    double avgCompound;
+};
+
+struct MonthlyCountPoint {
+    int year;
+    int month;
+    long long totalMessages;
+};
+
+struct MonthlyResponsePoint {
+    int year;
+    int month;
+    double avgMinutes;
+};
+
+struct MonthlyRomanticPoint {
+    int year;
+    int month;
+    long long romanticMessages;
+};
+
+struct MonthlyAvgLengthPoint {
+    int year;
+    int month;
+    double avgWords;
+};
+
+struct MonthlyEmojiPoint {
+    int year;
+    int month;
+    long long   emojiCount;
+    double      emojiPerMessage;
+    std::string topEmoji;        // empty when the month has no emoji
+    long long   topEmojiCount;
+};
+
+// Per-user series for charts
+struct UserMonthlyCountPoint {
+    int year;
+    int month;
+    long long totalMessages;
+};
+
+struct UserMonthlyEmotionPoint {
+    int year;
+    int month;
+    double avgCompound;
+};
+
+struct UserMonthlyResponsePoint {
+    int year;
+    int month;
+    double avgMinutes;
+};
+
+struct UserMonthlyRomanticPoint {
+    int year;
+    int month;
+    long long romanticMessages;
+};
+
+struct UserMonthlyAvgLengthPoint {
+    int year;
+    int month;
+    double avgWords;
+};
+
+struct UserMonthlyEmojiPoint {
+    int year;
+    int month;
+    long long   emojiCount;
+    double      emojiPerMessage;
+    std::string topEmoji;        // empty when the month has no emoji
+    long long   topEmojiCount;
+};
+
+// Results of the most recent runAnalysisToString call.
+extern int  g_heatmapCounts[7][24];
+extern bool g_heatmapReady;
+
+extern std::vector<MonthlyEmotionPoint>      g_monthlyEmotionPoints;
+extern std::vector<MonthlyCountPoint>        g_monthlyCountPoints;
+extern std::vector<MonthlyResponsePoint>     g_monthlyResponsePoints;
+extern std::vector<MonthlyRomanticPoint>     g_monthlyRomanticPoints;
+extern std::vector<MonthlyAvgLengthPoint>    g_monthlyAvgLengthPoints;
+
+extern std::vector<std::string> g_chartUserNames;
+
+extern std::vector<std::vector<UserMonthlyCountPoint>>      g_userMonthlyCountSeries;
+extern std::vector<std::vector<UserMonthlyEmotionPoint>>    g_userMonthlyEmotionSeries;
+extern std::vector<std::vector<UserMonthlyResponsePoint>>   g_userMonthlyResponseSeries;
+extern std::vector<std::vector<UserMonthlyRomanticPoint>>   g_userMonthlyRomanticSeries;
+extern std::vector<std::vector<UserMonthlyAvgLengthPoint>>  g_userMonthlyAvgLengthSeries;
+
+// -------------------------------------------------------------
+// Entry points
+// -------------------------------------------------------------
+
+// Analyze a single Instagram-style JSON file or a folder of message_#.json
+// files and return the formatted text report. Throws std::runtime_error on
+// invalid input or missing lexicons.
+std::string runAnalysisToString(const std::string& inputPathStr);
+
+// Lexicons are read-only after loading, so one copy can be shared by any
+// number of concurrent analyses.
+struct AnalysisLexicons {
+    VaderSentiment    vader;
+    NrcEmotionLexicon nrc;
+
+    // Changes to the built-in stop words (kept out of the top words).
+    WordSetOverrides  stopWordOverrides;
+};
+
+// Load both lexicons from the executable's folder (falling back to the CWD).
+// Throws std::runtime_error if either file is missing. An optional
+// stop_words.txt there adds stop words, one per line; "-word" removes one.
+// An optional vader_overrides.txt adds VADER boosters, negation words and
+// idioms ("booster mega 0.293", "negation nevah", "idiom dumb luck 2").
+std::shared_ptr<const AnalysisLexicons> LoadAnalysisLexicons();
+
+struct AnalysisOptions {
+    // Abort the chat with std::runtime_error once its estimated working set
+    // (parsed JSON + retained messages and word tables) would exceed this.
+    // 0 = unlimited.
+    std::size_t memoryCapBytes = 0;
+
+    // Print a "Processed: <file>" line per input file to stdout.
+    bool verbose = true;
+
+    // Per-message scores (VADER, NRC, word count, romantic hit, reply
+    // latency). Columnar binary file (see message_scores.hpp) and/or CSV;
+    // empty = not written.
+    std::string messageScoresPath;
+    std::string messageScoresCsvPath;
+};
+
+// -------------------------------------------------------------
+// Results model
+// -------------------------------------------------------------
+struct UserResults {
+    std::string name;
+
+    long long totalMessages        = 0;
+    long long totalWords           = 0;
+    long long wordMessages         = 0;     // messages with at least one word
+    double    avgWords             = 0.0;   // totalWords / wordMessages
+    long long romanticMessages     = 0;
+    long long conversationsStarted = 0;     // first message after a >= 6h gap
+    long long reactionsSent        = 0;
+
+    long long responseCount        = 0;
+    double    avgResponseMs        = 0.0;   // valid when responseCount > 0
+
+    // Explicit replies (reply_to matched to a message_id in the chat)
+    long long replyCount           = 0;
+    double    avgReplyLatencyMs    = 0.0;   // valid when replyCount > 0
+    std::vector<std::pair<std::string, long long>> repliesTo;   // replied-to user -> count, by name
+
+    long long doubleTextRuns       = 0;
+    long long tripleTextRuns       = 0;
+    long long yappingRuns          = 0;
+
+    // VADER averages; valid when vaderSamples > 0
+    long long vaderSamples         = 0;
+    double    vaderPos             = 0.0;
+    double    vaderNeg             = 0.0;
+    double    vaderNeu             = 0.0;
+    double    vaderCompound        = 0.0;
+
+    // NRC emotion shares (NrcEmotionLexicon::CATEGORY_NAMES order);
+    // valid when nrcTaggedTokens > 0
+    long long nrcTaggedTokens      = 0;
+    double    nrcEmotion[NrcEmotionLexicon::DIMENSIONS] = {};
+
+    long long   longestMessageWords = 0;
+    std::string longestMessageContent;
+
+    // Ten most used words (stop words, junk tokens and participant names removed)
+    std::vector<std::pair<std::string, long long>> topWords;
+
+    // Emoji are counted here, not as words. Skin tones and ZWJ sequences
+    // are kept ("👍🏽" and "👍" are different emoji).
+    long long emojiCount           = 0;
+    double    emojiPerMessage      = 0.0;   // emojiCount / totalMessages
+    std::vector<std::pair<std::string, long long>> topEmoji;   // ten most used
+
+    // Monthly series, sorted by (year, month)
+    std::vector<UserMonthlyCountPoint>     monthlyCounts;
+    std::vector<UserMonthlyEmotionPoint>   monthlyEmotion;
+    std::vector<UserMonthlyResponsePoint>  monthlyResponse;
+    std::vector<UserMonthlyRomanticPoint>  monthlyRomantic;
+    std::vector<UserMonthlyAvgLengthPoint> monthlyAvgLength;
+    std::vector<UserMonthlyEmojiPoint>     monthlyEmoji;
+};
+
+struct AnalysisResults {
+    long long totalMessages = 0;
+    std::vector<UserResults> users;        // sorted by name
+
+    // Messages by local weekday (0 = Monday) and hour
+    int  heatmapCounts[7][24] = {};
+    bool heatmapReady = false;
+
+    // Whole-chat monthly series, sorted by (year, month)
+    std::vector<MonthlyCountPoint>     monthlyCounts;
+    std::vector<MonthlyEmotionPoint>   monthlyEmotion;
+    std::vector<MonthlyResponsePoint>  monthlyResponse;
+    std::vector<MonthlyRomanticPoint>  monthlyRomantic;
+    std::vector<MonthlyAvgLengthPoint> monthlyAvgLength;
+    std::vector<MonthlyEmojiPoint>     monthlyEmoji;
+};
+
+// Thread-safe analysis: uses caller-supplied lexicons and touches no globals.
+// Throws std::runtime_error on invalid input or when the memory cap is hit.
+AnalysisResults analyzeChat(
+    const std::string&      inputPathStr,
+    const AnalysisLexicons& lexicons,
+    const AnalysisOptions&  options
+);
+
+// -------------------------------------------------------------
+// Renderers (analysis_report.cpp)
+// -------------------------------------------------------------
+
+// The human-readable report shown by the GUI and the CLI.
+std::string renderTextReport(const AnalysisResults& results);
+
+// Whole model as one JSON object. indent == 0 writes a single line.
+void writeResultsJson(const AnalysisResults& results, std::ostream& out, int indent = 2);
+
+// Same, as the next value of an existing writer (e.g. nested in a record).
+void writeResultsJson(const AnalysisResults& results, JsonWriter& writer);
+
+// Whole model as long-format CSV: section,user,metric,period,value
+//   user     -> per-user totals and averages
+//   top_word -> metric = word, value = count
+//   top_emoji -> metric = emoji, value = count; period empty for the
+//               user's top ten, "YYYY-MM" for the most used of that month
+//   reply    -> user = who replied, metric = who was replied to, value = count
+//   heatmap  -> period = "Mon 13" (weekday, hour)
+//   monthly  -> period = "YYYY-MM"; user empty for whole-chat series
+void writeResultsCsv(const AnalysisResults& results, std::ostream& out);
+
+// Text helpers used by the analyzer (exposed for tools and benchmarks).
+std::string normalizeContractions(const std::string& input);
+std::vector<std::string> extractWordsLower(const std::string& text);
+std::string formatWithCommas(long long value);
@@ -0,0 +1,376 @@
+// cli_main.cpp
+// Headless command-line front end for the analysis engine.
+//
+//   chatanalyzer-cli [--format text|json|csv] [--scores <file>] [--scores-csv <file>] <file_or_directory>
+//       Analyze Instagram-style JSON (a message_#.json file or a folder of them)
+//       and print the report (text by default, or the full results model).
+//       --scores / --scores-csv also write one scored row per message.
+//
+//   chatanalyzer-cli convert [--chunk-size N] [--all] [--incremental] [--from YYYY-MM-DD] [--to YYYY-MM-DD]
+//                            <whatsapp|discord|android|imessage> <input> <output_dir> [extra]
+//       Convert an export into Instagram-style JSON without the GUI.
+//       extra: chat title (whatsapp/discord), contact filter (android),
+//              chat GUID (imessage; omit to list the chats in the database).
+//       --chunk-size: messages per message_#.json file (default 5000).
+//       --all: export every conversation in one pass into sub-folders of
+//              <output_dir>: one per normalized phone number (android) or
+//              per chat GUID (imessage). For imessage, GUIDs listed after
+//              <output_dir> limit the export to those chats.
+//       --incremental: (imessage) append only messages newer than the last
+//              export into the same folder (see imessage_export.state).
+//       --from / --to: (imessage) only messages from the start of --from up
+//              to the start of --to (UTC dates; either may be omitted).
+//
+//   chatanalyzer-cli batch (--manifest <file> | --glob <pattern>)... [--out <results.jsonl>]
+//                          [--threads N] [--memory-cap-mb N] [--full]
+//       Analyze many chats in parallel and write one JSON record per chat.
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "chat_analyzer.hpp"
+#include "whatsapp_convert.hpp"
+#include "discord_convert.hpp"
+#include "android_sms_convert.hpp"
+#include "imessage_convert.hpp"
+#include "batch_runner.hpp"
+
+static void printUsage(const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [--format text|json|csv] [--scores <file>] [--scores-csv <file>]\n"
+              << "              <file_or_directory>\n"
+              << "       " << argv0 << " convert [--chunk-size N] [--all] [--incremental]\n"
+              << "              [--from YYYY-MM-DD] [--to YYYY-MM-DD]\n"
+              << "              <whatsapp|discord|android|imessage> <input> <output_dir> [extra]\n"
+              << "       " << argv0 << " batch (--manifest <file> | --glob <pattern>)... [--out <results.jsonl>]\n"
+              << "              [--threads N] [--memory-cap-mb N] [--full]\n";
+}
+
+// Convert a UTC calendar date to days since Unix epoch (1970-01-01).
+// Implementation based on Howard Hinnant's days_from_civil.
+static long long daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);          // [0, 399]
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1; // [0, 365]
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;         // [0, 146096]
+    return static_cast<long long>(era * 146097 + static_cast<int>(doe) - 719468);
+}
+
+static unsigned daysInMonth(int y, unsigned m)
+{
+    static const unsigned DAYS[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : DAYS[m - 1];
+}
+
+// "YYYY-MM-DD" -> Unix ms at 00:00 UTC that day. Returns false if malformed
+// or if the day does not exist (2024-02-30).
+static bool parseUtcDateMs(const std::string& text, long long& msOut)
+{
+    int y = 0;
+    unsigned m = 0, d = 0;
+    char dash1 = 0, dash2 = 0;
+    int end = 0;
+    if (std::sscanf(text.c_str(), "%4d%c%2u%c%2u%n", &y, &dash1, &m, &dash2, &d, &end) != 5 ||
+        static_cast<std::size_t>(end) != text.size() ||
+        dash1 != '-' || dash2 != '-' || y < 1970 || m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m))
+        return false;
+    msOut = daysFromCivil(y, m, d) * 86400000LL;
+    return true;
+}
+
+static int listImessageChats(const std::string& input)
+{
+    std::vector<ImessageChatInfo> chats;
+    std::string error;
+    if (!GetImessageChats(input, chats, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    for (const auto& c : chats)
+    {
+        std::cout << c.guid << "\t" << c.displayName
+                  << "\t" << (c.isGroup ? "group" : "1:1") << "\t";
+        for (std::size_t i = 0; i < c.participants.size(); ++i)
+            std::cout << (i ? "," : "") << c.participants[i];
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+static int convertAllAndroidThreads(const std::string& input, const std::string& output,
+                                    std::size_t chunkSize)
+{
+    std::vector<AndroidSmsThreadSummary> threads;
+    std::string error;
+    if (!ConvertAndroidSmsXmlToInstagramFolders(input, output, threads, error, chunkSize))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    for (const auto& t : threads)
+        std::cout << t.folder << "\t" << t.displayName << "\t" << t.messageCount << "\n";
+    std::cout << "Converted " << threads.size() << " android threads into " << output << "\n";
+    return 0;
+}
+
+static int convertAllImessageChats(const std::string& input, const std::string& output,
+                                   const std::vector<std::string>& guids,
+                                   std::size_t chunkSize, bool incremental,
+                                   const ImessageTimeRange& range)
+{
+    std::vector<ImessageExportSummary> chats;
+    std::string error;
+    const bool ok = guids.empty()
+        ? ConvertImessageChatsToInstagramFolders(input, output, chats, error, chunkSize, incremental, range)
+        : ConvertImessageChatsToInstagramFolders(input, guids, output, chats, error, chunkSize,
+                                                 incremental, range);
+    if (!ok)
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    for (const auto& c : chats)
+        std::cout << c.folder << "\t" << c.displayName << "\t" << c.messageCount << "\n";
+    std::cout << "Converted " << chats.size() << " imessage chats into " << output << "\n";
+    return 0;
+}
+
+static int runConvert(int argc, char* argv[])
+{
+    std::size_t chunkSize = DEFAULT_EXPORT_CHUNK_SIZE;
+    bool allThreads = false;
+    bool incremental = false;
+    ImessageTimeRange range;
+    std::vector<std::string> args;
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--chunk-size" && i + 1 < argc)
+            chunkSize = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--all")
+            allThreads = true;
+        else if (arg == "--incremental")
+            incremental = true;
+        else if ((arg == "--from" || arg == "--to") && i + 1 < argc)
+        {
+            const bool from = (arg == "--from");
+            if (!parseUtcDateMs(argv[++i], from ? range.fromMs : range.toMs))
+            {
+                std::cerr << "Error: " << arg << " expects a date as YYYY-MM-DD.\n";
+                return 1;
+            }
+            (from ? range.hasFrom : range.hasTo) = true;
+        }
+        else
+            args.push_back(arg);
+    }
+
+    if (args.size() < 2 || chunkSize == 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (range.hasFrom && range.hasTo && range.fromMs >= range.toMs)
+    {
+        std::cerr << "Error: --from must be an earlier date than --to.\n";
+        return 1;
+    }
+
+    const std::string kind  = args[0];
+    const std::string input = args[1];
+
+    if (kind != "imessage" && (incremental || range.bounded()))
+    {
+        const char* flag = incremental ? "--incremental" : (range.hasFrom ? "--from" : "--to");
+        std::cerr << "Error: " << flag << " is only supported for imessage conversions.\n";
+        return 1;
+    }
+
+    if (kind == "imessage" && args.size() == 2)
+        return listImessageChats(input);
+
+    if (args.size() < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string output = args[2];
+    const std::string extra  = (args.size() >= 4) ? args[3] : "";
+
+    if (allThreads)
+    {
+        if (kind == "imessage")
+        {
+            const std::vector<std::string> guids(args.begin() + 3, args.end());
+            return convertAllImessageChats(input, output, guids, chunkSize, incremental, range);
+        }
+        if (kind == "android" && extra.empty())
+            return convertAllAndroidThreads(input, output, chunkSize);
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string error;
+    bool ok = false;
+
+    if (kind == "whatsapp")
+        ok = ConvertWhatsAppToInstagramFolder(input, output, extra, error, chunkSize);
+    else if (kind == "discord")
+        ok = ConvertDiscordToInstagramFolder(input, output, extra, error, chunkSize);
+    else if (kind == "android")
+        ok = ConvertAndroidSmsXmlToInstagramFolder(input, extra, output, error, chunkSize);
+    else if (kind == "imessage")
+    {
+        if (extra.empty())
+        {
+            std::cerr << "Error: imessage conversion needs a chat GUID "
+                         "(run without <output_dir> to list them).\n";
+            return 1;
+        }
+        ok = ConvertImessageChatToInstagramFolder(input, extra, output, error, chunkSize, incremental, range);
+    }
+    else
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::cout << "Converted " << kind << " export into " << output << "\n";
+    return 0;
+}
+
+static int runBatch(int argc, char* argv[])
+{
+    BatchOptions options;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--full")
+        {
+            options.fullResults = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const std::string value = argv[++i];
+
+        if (arg == "--manifest")
+            options.manifests.push_back(value);
+        else if (arg == "--glob")
+            options.globs.push_back(value);
+        else if (arg == "--out")
+            options.outputPath = value;
+        else if (arg == "--threads")
+            options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--memory-cap-mb")
+            options.memoryCapBytes = static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10)) << 20;
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.manifests.empty() && options.globs.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    BatchResult result;
+    std::string error;
+    if (!RunBatchAnalysis(options, result, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    return result.failed == 0 ? 0 : 2;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && std::string(argv[1]) == "convert")
+        return runConvert(argc, argv);
+
+    if (argc >= 2 && std::string(argv[1]) == "batch")
+        return runBatch(argc, argv);
+
+    std::string format = "text";
+    AnalysisOptions options;
+    int argi = 1;
+    for (; argi + 1 < argc; argi += 2)
+    {
+        const std::string arg = argv[argi];
+        if (arg == "--format")
+            format = argv[argi + 1];
+        else if (arg == "--scores")
+            options.messageScoresPath = argv[argi + 1];
+        else if (arg == "--scores-csv")
+            options.messageScoresCsvPath = argv[argi + 1];
+        else
+            break;
+    }
+
+    if (argc != argi + 1 || (format != "text" && format != "json" && format != "csv"))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        const bool plainReport = options.messageScoresPath.empty() &&
+                                 options.messageScoresCsvPath.empty();
+        if (format == "text" && plainReport)
+        {
+            std::string report = runAnalysisToString(argv[argi]);
+            std::cout << report;
+            return 0;
+        }
+
+        // Machine-readable output: keep stdout free of progress lines.
+        if (format != "text")
+            options.verbose = false;
+
+        auto lexicons = LoadAnalysisLexicons();
+        AnalysisResults results = analyzeChat(argv[argi], *lexicons, options);
+
+        if (format == "text")
+            std::cout << renderTextReport(results);
+        else if (format == "json")
+            writeResultsJson(results, std::cout);
+        else
+            writeResultsCsv(results, std::cout);
+        std::cout.flush();
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -1,10 +1,22 @@
 // discord_convert.cpp
 // Convert Discrub-style Discord JSON exports into Instagram-style
 // message_X.json files that the analyzer can consume.
+//
+// Pages are parsed in parallel by a SAX handler (no DOM) into compact runs
+// sorted by message id. Discord ids are "snowflakes" that start with their
+// creation time, so merging the runs by id puts the whole channel in
+// chronological order without a global sort, and the copies of a message
+// that overlapping page exports repeat meet in the merge and are dropped.
+//
+// Replies keep their link: a message's message_reference becomes "reply_to",
+// and every message that is replied to gets its "message_id", so the
+// analyzer can pair each reply with the exact message it answers.
+
+#include "discord_convert.hpp"
 
 #include <iostream>
-#include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <filesystem>
@@ -12,33 +24,24 @@
 #include <iomanip>
 #include <ctime>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "json.hpp"
+#include "export_writer.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include "zip_reader.hpp"
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-// Simple representation of an Instagram-style message.
-struct InstaMessage
-{
-    std::string sender_name;
-    long long   timestamp_ms = 0;
-    std::string content;
-};
-
-// Read a whole file into a string.
-static std::string readFileToString(const std::string& filename)
-{
-    std::ifstream in(filename);
-    if (!in)
-    {
-        throw std::runtime_error("Could not open file: " + filename);
-    }
-    std::ostringstream ss;
-    ss << in.rdbuf();
-    return ss.str();
-}
-
 // Convert a UTC calendar date to days since Unix epoch (1970-01-01).
 // Implementation based on Howard Hinnant's days_from_civil.
 static long long daysFromCivil(int y, unsigned m, unsigned d)
@@ -90,114 +93,595 @@ static long long parseDiscordTimestampMs(const std::string& ts)
     return seconds * 1000LL;
 }
 
-// Process a single Discord JSON page (file) and append InstaMessage objects.
-// Also collects the set of participant names.
-static void processDiscordPage(
-    const std::string& filename,
-    std::vector<InstaMessage>& outMessages,
-    std::set<std::string>&     participants)
+// -------------------------------------------------------------
+// Snowflakes
+// -------------------------------------------------------------
+
+// A snowflake's top 42 bits are milliseconds since the Discord epoch
+// (2015-01-01 UTC); the low 22 bits tell ids of the same millisecond apart.
+constexpr long long DISCORD_EPOCH_MS          = 1420070400000LL;
+constexpr int       SNOWFLAKE_TIMESTAMP_SHIFT = 22;
+
+// Sort key for a message without an id: the smallest snowflake of its time.
+static std::uint64_t snowflakeFromTimeMs(long long ms)
 {
-    try
+    return ms > DISCORD_EPOCH_MS
+        ? static_cast<std::uint64_t>(ms - DISCORD_EPOCH_MS) << SNOWFLAKE_TIMESTAMP_SHIFT
+        : 0;
+}
+
+// Ids are JSON strings of up to 19 digits (a number in older exports).
+static bool parseSnowflake(std::string_view text, std::uint64_t& out)
+{
+    if (text.empty() || text.size() > 19)
+        return false;
+    std::uint64_t value = 0;
+    for (char c : text)
     {
-        std::string contents = readFileToString(filename);
-        if (contents.empty())
-            return;
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + static_cast<std::uint64_t>(c - '0');
+    }
+    out = value;
+    return value != 0;
+}
+
+// -------------------------------------------------------------
+// Page parsing
+// -------------------------------------------------------------
+
+struct DiscordRecord
+{
+    std::uint64_t key = 0;             // snowflake id, or snowflakeFromTimeMs()
+    long long     timestampMs = 0;
+    std::uint32_t sender = 0;          // index into DiscordPage::senders
+    std::uint32_t contentOffset = 0;   // into DiscordPage::text
+    std::uint32_t contentSize = 0;
+    std::uint64_t replyTo = 0;         // id of the message answered, 0 if none
+    bool          hasId = false;
+};
+
+// One page's messages, sorted by key, with their text in a single arena.
+struct DiscordPage
+{
+    std::vector<DiscordRecord> records;
+    std::vector<std::string>   senders;
+    std::string                text;
+
+    std::size_t footprint() const
+    {
+        return records.capacity() * sizeof(DiscordRecord) + text.capacity();
+    }
+
+    void release()
+    {
+        std::vector<DiscordRecord>().swap(records);
+        std::string().swap(text);
+    }
+};
+
+// Where a page comes from: a file on disk, or an entry of an open archive.
+struct DiscordPageSource
+{
+    std::string       label;   // file path, or "archive.zip:entry.json"
+    const ZipArchive* archive = nullptr;
+    const ZipEntry*   entry   = nullptr;
+};
+
+// SAX handler that picks the messages out of a page as it is tokenized.
+// A page is either an array of messages or an object with a "messages"
+// array. Per message it keeps id, timestamp, content, whether attachments
+// is non-empty, the sender: "userName", else author.global_name (when
+// not empty), else author.username, and the id it replies to:
+// message_reference.message_id, else referenced_message.id.
+class DiscordPageHandler : public nlohmann::json_sax<json>
+{
+public:
+    explicit DiscordPageHandler(DiscordPage& page) : m_page(page) {}
 
-        json j = json::parse(contents);
+    bool foundMessages() const { return m_messagesDepth != 0; }
+    const std::string& error() const { return m_error; }
 
-        // Accept either a top-level array of messages or an object with "messages".
-        json messagesJson;
-        if (j.is_array())
+    bool null() override                                   { value(); return true; }
+    bool boolean(bool) override                            { value(); return true; }
+    bool number_float(number_float_t, const string_t&) override { value(); return true; }
+    bool binary(binary_t&) override                        { value(); return true; }
+
+    bool number_integer(number_integer_t val) override
+    {
+        value();
+        if (val > 0)
+            snowflake(static_cast<std::uint64_t>(val));
+        return true;
+    }
+
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        value();
+        if (val > 0)
+            snowflake(val);
+        return true;
+    }
+
+    bool string(string_t& val) override
+    {
+        value();
+        if (atMessageLevel())
         {
-            messagesJson = j;
+            if (m_key == "content")
+            {
+                m_content.swap(val);
+            }
+            else if (m_key == "timestamp")
+            {
+                m_timestamp.swap(val);
+            }
+            else if (m_key == "userName")
+            {
+                m_userName.swap(val);
+                m_hasUserName = true;
+            }
+            else if (m_key == "id")
+            {
+                m_hasId = parseSnowflake(val, m_id);
+            }
         }
-        else if (j.is_object() && j.contains("messages") && j["messages"].is_array())
+        else if (inReference())
         {
-            messagesJson = j["messages"];
+            std::uint64_t id = 0;
+            if (parseSnowflake(val, id))
+                snowflake(id);
         }
-        else
+        else if (m_inAuthor && depth() == m_messageDepth + 1)
         {
-            std::cerr << "Warning: " << filename
-                      << " is not a recognized Discord JSON structure (skipping).\n";
-            return;
+            if (m_key == "global_name")
+            {
+                m_globalName.swap(val);
+            }
+            else if (m_key == "username")
+            {
+                m_username.swap(val);
+                m_hasUsername = true;
+            }
         }
+        return true;
+    }
 
-        for (const auto& msg : messagesJson)
+    bool key(string_t& val) override
+    {
+        m_key.swap(val);
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        value();
+        m_stack.push_back('o');
+        const std::size_t d = depth();
+        if (m_messageDepth == 0)
+        {
+            if (m_messagesDepth != 0 && d == m_messagesDepth + 1)
+                beginMessage(d);
+        }
+        else if (d == m_messageDepth + 1)
         {
-            if (!msg.is_object())
-                continue;
+            if (m_key == "author")
+                m_inAuthor = true;
+            else if (m_key == "message_reference")
+                m_reference = MESSAGE_REFERENCE;
+            else if (m_key == "referenced_message")
+                m_reference = REFERENCED_MESSAGE;
+        }
+        return true;
+    }
 
-            // ---------------- Sender name ----------------
-            std::string senderName;
+    bool end_object() override
+    {
+        const std::size_t d = depth();
+        if (m_messageDepth != 0 && d == m_messageDepth)
+            finishMessage();
+        else if (m_messageDepth != 0 && d == m_messageDepth + 1)
+        {
+            m_inAuthor  = false;
+            m_reference = NO_REFERENCE;
+        }
+        m_stack.pop_back();
+        return true;
+    }
 
-            // Discrub often exposes "userName" on each message.
-            if (msg.contains("userName") && msg["userName"].is_string())
-            {
-                senderName = msg["userName"].get<std::string>();
-            }
-            // Otherwise, fall back to "author" object, checking global_name then username.
-            else if (msg.contains("author") && msg["author"].is_object())
+    bool start_array(std::size_t) override
+    {
+        value();
+        m_stack.push_back('a');
+        const std::size_t d = depth();
+        if (m_messagesDepth == 0)
+        {
+            if (d == 1 || (d == 2 && m_stack[0] == 'o' && m_key == "messages"))
+                m_messagesDepth = d;
+        }
+        else if (m_messageDepth != 0 && d == m_messageDepth + 1 && m_key == "attachments")
+        {
+            m_inAttachments = true;
+        }
+        return true;
+    }
+
+    bool end_array() override
+    {
+        if (m_inAttachments && depth() == m_messageDepth + 1)
+            m_inAttachments = false;
+        m_stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+    {
+        m_error = ex.what();
+        return false;
+    }
+
+private:
+    enum Reference { NO_REFERENCE, MESSAGE_REFERENCE, REFERENCED_MESSAGE };
+
+    std::size_t depth() const { return m_stack.size(); }
+    bool atMessageLevel() const { return m_messageDepth != 0 && depth() == m_messageDepth; }
+
+    // A direct member of the open message's reference object.
+    bool inReference() const
+    {
+        return m_reference != NO_REFERENCE && depth() == m_messageDepth + 1;
+    }
+
+    // A numeric id: the message's own, or the one it replies to.
+    void snowflake(std::uint64_t id)
+    {
+        if (atMessageLevel() && m_key == "id")
+        {
+            m_id    = id;
+            m_hasId = true;
+        }
+        else if (inReference())
+        {
+            if (m_reference == MESSAGE_REFERENCE && m_key == "message_id")
+                m_replyTo = id;
+            else if (m_reference == REFERENCED_MESSAGE && m_key == "id" && m_replyTo == 0)
+                m_replyTo = id;
+        }
+    }
+
+    // Any value directly inside a message's "attachments" array.
+    void value()
+    {
+        if (m_inAttachments && depth() == m_messageDepth + 1)
+            m_hasAttachment = true;
+    }
+
+    void beginMessage(std::size_t d)
+    {
+        m_messageDepth = d;
+        m_id = m_replyTo = 0;
+        m_reference = NO_REFERENCE;
+        m_hasId = m_hasUserName = m_hasUsername = m_hasAttachment = false;
+        m_inAuthor = m_inAttachments = false;
+        m_userName.clear();
+        m_globalName.clear();
+        m_username.clear();
+        m_timestamp.clear();
+        m_content.clear();
+    }
+
+    void finishMessage()
+    {
+        m_messageDepth = 0;
+
+        const std::string* sender = &m_userName;
+        if (!m_hasUserName)
+            sender = !m_globalName.empty() ? &m_globalName : &m_username;
+        static const std::string UNKNOWN = "Unknown";
+        if (sender->empty())
+            sender = &UNKNOWN;
+
+        std::string_view content = m_content;
+        if (content.empty() && m_hasAttachment)
+            content = "[Attachment]";
+
+        DiscordRecord r;
+        r.timestampMs   = parseDiscordTimestampMs(m_timestamp);
+        r.hasId         = m_hasId;
+        r.key           = m_hasId ? m_id : snowflakeFromTimeMs(r.timestampMs);
+        r.replyTo       = m_replyTo;
+        r.sender        = senderIndex(*sender);
+        r.contentOffset = static_cast<std::uint32_t>(m_page.text.size());
+        r.contentSize   = static_cast<std::uint32_t>(content.size());
+        m_page.text.append(content.data(), content.size());
+        m_page.records.push_back(r);
+    }
+
+    std::uint32_t senderIndex(const std::string& name)
+    {
+        auto it = m_senderIndex.find(name);
+        if (it != m_senderIndex.end())
+            return it->second;
+        const auto index = static_cast<std::uint32_t>(m_page.senders.size());
+        m_page.senders.push_back(name);
+        m_senderIndex.emplace(name, index);
+        return index;
+    }
+
+    DiscordPage&      m_page;
+    std::vector<char> m_stack;               // 'o' / 'a' per open container
+    std::string       m_key;                 // most recent object key
+    std::size_t       m_messagesDepth = 0;   // depth of the messages array
+    std::size_t       m_messageDepth  = 0;   // depth of the open message, 0 if none
+    std::string       m_error;
+
+    std::uint64_t m_id = 0;
+    std::uint64_t m_replyTo = 0;
+    Reference     m_reference = NO_REFERENCE;
+    bool          m_hasId = false;
+    bool          m_hasUserName = false;
+    bool          m_hasUsername = false;
+    bool          m_hasAttachment = false;
+    bool          m_inAuthor = false;
+    bool          m_inAttachments = false;
+    std::string   m_userName, m_globalName, m_username, m_timestamp, m_content;
+
+    std::unordered_map<std::string, std::uint32_t> m_senderIndex;
+};
+
+// Parse one page into `page` (records sorted by key). Problems are reported
+// on stderr and leave the page empty, as a skipped page.
+static void parseDiscordPage(const DiscordPageSource& source, DiscordPage& page)
+{
+    page = DiscordPage();
+
+    MappedFile  file;
+    std::string extracted;
+    std::string error;
+    std::string_view contents;
+    if (source.archive)
+    {
+        if (!source.archive->extract(*source.entry, extracted, error))
+        {
+            std::cerr << "Error processing Discord JSON page '" << source.label
+                      << "': " << error << "\n";
+            return;
+        }
+        contents = extracted;
+    }
+    else
+    {
+        if (!file.open(source.label, error))
+        {
+            std::cerr << "Error processing Discord JSON page '" << source.label
+                      << "': " << error << "\n";
+            return;
+        }
+        contents = file.view();
+    }
+
+    if (contents.empty())
+        return;
+
+    DiscordPageHandler handler(page);
+    const bool ok = json::sax_parse(contents.data(), contents.data() + contents.size(), &handler);
+    if (!ok)
+    {
+        std::cerr << "Error processing Discord JSON page '" << source.label
+                  << "': " << handler.error() << "\n";
+        page = DiscordPage();
+        return;
+    }
+    if (!handler.foundMessages())
+    {
+        std::cerr << "Warning: " << source.label
+                  << " is not a recognized Discord JSON structure (skipping).\n";
+        page = DiscordPage();
+        return;
+    }
+
+    // Discord lists a channel newest first; a page is sorted once here so
+    // the merge can treat it as a run.
+    std::stable_sort(page.records.begin(), page.records.end(),
+                     [](const DiscordRecord& a, const DiscordRecord& b) { return a.key < b.key; });
+}
+
+// -------------------------------------------------------------
+// Page discovery
+// -------------------------------------------------------------
+
+// Queue every *.json page inside a zip archive. Attachments and other
+// entries are skipped without being inflated.
+static void addArchivePages(
+    const std::string&                        filename,
+    std::vector<std::unique_ptr<ZipArchive>>& archives,
+    std::vector<DiscordPageSource>&           sources)
+{
+    std::unique_ptr<ZipArchive> archive(new ZipArchive());
+    std::string error;
+    if (!archive->open(filename, error))
+    {
+        std::cerr << "Error opening Discord archive '" << filename
+                  << "': " << error << "\n";
+        return;
+    }
+
+    for (const auto& entry : archive->entries())
+    {
+        if (entry.isDirectory() || !entry.hasExtension(".json") ||
+            entry.name.rfind("__MACOSX/", 0) == 0)
+            continue;
+
+        DiscordPageSource source;
+        source.label   = filename + ":" + entry.name;
+        source.archive = archive.get();
+        source.entry   = &entry;
+        std::cout << "Processing Discord JSON: " << source.label << "\n";
+        sources.push_back(std::move(source));
+    }
+    archives.push_back(std::move(archive));
+}
+
+// -------------------------------------------------------------
+// Parallel parse + merge
+// -------------------------------------------------------------
+
+// Parsed pages kept in memory after the parallel pass. Pages beyond it
+// keep only their key range and are parsed again when the merge reaches
+// them, so a channel with millions of messages converts in bounded memory.
+static constexpr std::size_t DISCORD_RESIDENT_BYTES = std::size_t(256) << 20;
+
+struct DiscordPageSlot
+{
+    DiscordPage   page;
+    std::uint64_t minKey = 0;
+    std::size_t   count = 0;
+    bool          resident = false;
+};
+
+// Parse every page in parallel. Fills each slot's key range and count, keeps
+// the page itself while under DISCORD_RESIDENT_BYTES, collects every
+// sender into `participants` and every replied-to id into `replyTargets`.
+static void parseDiscordPages(const std::vector<DiscordPageSource>& sources,
+                              std::vector<DiscordPageSlot>&         slots,
+                              std::set<std::string>&                participants,
+                              std::unordered_set<std::uint64_t>&    replyTargets)
+{
+    slots.clear();
+    slots.resize(sources.size());
+
+    std::atomic<std::size_t> resident{ 0 };
+    std::mutex               participantsMutex;
+
+    WorkStealingPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        pool.submit([&, i]
+        {
+            DiscordPageSlot& slot = slots[i];
+            parseDiscordPage(sources[i], slot.page);
+            if (slot.page.records.empty())
+                return;
+
+            slot.minKey = slot.page.records.front().key;
+            slot.count  = slot.page.records.size();
             {
-                const auto& a = msg["author"];
-                if (a.contains("global_name") && a["global_name"].is_string() &&
-                    !a["global_name"].get<std::string>().empty())
-                {
-                    senderName = a["global_name"].get<std::string>();
-                }
-                else if (a.contains("username") && a["username"].is_string())
+                std::lock_guard<std::mutex> lk(participantsMutex);
+                participants.insert(slot.page.senders.begin(), slot.page.senders.end());
+                for (const DiscordRecord& r : slot.page.records)
                 {
-                    senderName = a["username"].get<std::string>();
+                    if (r.replyTo != 0)
+                        replyTargets.insert(r.replyTo);
                 }
             }
 
-            if (senderName.empty())
+            const std::size_t bytes = slot.page.footprint();
+            if (resident.fetch_add(bytes) + bytes <= DISCORD_RESIDENT_BYTES)
             {
-                senderName = "Unknown";
+                slot.resident = true;
             }
-
-            participants.insert(senderName);
-
-            // ---------------- Timestamp ----------------
-            long long timestampMs = 0;
-            if (msg.contains("timestamp") && msg["timestamp"].is_string())
+            else
             {
-                timestampMs = parseDiscordTimestampMs(
-                    msg["timestamp"].get<std::string>());
+                resident.fetch_sub(bytes);
+                slot.page.release();
             }
+        });
+    }
+    pool.wait();
+}
 
-            // ---------------- Content ----------------
-            std::string content;
-            if (msg.contains("content") && msg["content"].is_string())
-            {
-                content = msg["content"].get<std::string>();
-            }
+// k-way merge of the page runs by key into the writer. A page joins the
+// merge once the smallest pending key reaches its first key, and is freed
+// as soon as it is drained. Copies of one message share its id, so they
+// come out of the merge back to back; only the first is written.
+// message_id is written only for the messages in `replyTargets`.
+static bool mergeDiscordPages(const std::vector<DiscordPageSource>&    sources,
+                              std::vector<DiscordPageSlot>&            slots,
+                              const std::unordered_set<std::uint64_t>& replyTargets,
+                              ChunkedExportWriter&                     writer,
+                              std::string&                             errorOut)
+{
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        if (slots[i].count > 0)
+            order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+    {
+        return slots[a].minKey < slots[b].minKey;
+    });
 
-            bool hasAttachment = false;
-            if (msg.contains("attachments") && msg["attachments"].is_array())
-            {
-                if (!msg["attachments"].empty())
-                {
-                    hasAttachment = true;
-                }
-            }
-            if (content.empty() && hasAttachment)
+    struct Cursor
+    {
+        std::uint64_t key;
+        std::size_t   rank;   // position in `order`: earlier pages win ties
+        std::size_t   slot;
+        std::size_t   pos;
+    };
+    auto later = [](const Cursor& a, const Cursor& b)
+    {
+        return a.key != b.key ? a.key > b.key : a.rank > b.rank;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+
+    std::size_t   next = 0;
+    std::uint64_t lastId = 0;
+    bool          haveLastId = false;
+
+    for (;;)
+    {
+        while (next < order.size() && (heap.empty() || slots[order[next]].minKey <= heap.top().key))
+        {
+            DiscordPageSlot& slot = slots[order[next]];
+            if (!slot.resident)
             {
-                content = "[Attachment]";
+                parseDiscordPage(sources[order[next]], slot.page);
+                slot.resident = true;
             }
+            if (!slot.page.records.empty())
+                heap.push({ slot.page.records.front().key, next, order[next], 0 });
+            ++next;
+        }
+        if (heap.empty())
+            break;
 
-            InstaMessage im;
-            im.sender_name = senderName;
-            im.timestamp_ms = timestampMs;
-            im.content      = content;
+        Cursor c = heap.top();
+        heap.pop();
 
-            outMessages.push_back(std::move(im));
+        DiscordPage& page = slots[c.slot].page;
+        const DiscordRecord& r = page.records[c.pos];
+        const bool duplicate = r.hasId && haveLastId && r.key == lastId;
+        if (r.hasId)
+        {
+            lastId     = r.key;
+            haveLastId = true;
+        }
+
+        if (!duplicate)
+        {
+            const std::string_view content(page.text.data() + r.contentOffset, r.contentSize);
+            std::string messageId, replyTo;
+            if (r.hasId && !replyTargets.empty() && replyTargets.count(r.key))
+                messageId = std::to_string(r.key);
+            if (r.replyTo != 0)
+                replyTo = std::to_string(r.replyTo);
+            if (!writer.add(page.senders[r.sender], r.timestampMs, content,
+                            nullptr, nullptr, messageId, replyTo, errorOut))
+                return false;
+        }
+
+        if (++c.pos < page.records.size())
+        {
+            c.key = page.records[c.pos].key;
+            heap.push(c);
+        }
+        else
+        {
+            page.release();
         }
     }
-    catch (const std::exception& ex)
-    {
-        std::cerr << "Error processing Discord JSON page '" << filename
-                  << "': " << ex.what() << "\n";
-    }
+    return true;
 }
 
 // Public function used by the GUI.
@@ -205,7 +689,8 @@ bool ConvertDiscordToInstagramFolder(
     const std::string& inputPathStr,
     const std::string& outputPathStr,
     const std::string& chatTitle,
-    std::string&       errorOut
+    std::string&       errorOut,
+    std::size_t        chunkSize
 )
 {
     try
@@ -227,25 +712,40 @@ bool ConvertDiscordToInstagramFolder(
 
         fs::create_directories(outputDir);
 
-        std::vector<InstaMessage> allMessages;
-        std::set<std::string>     participants;
+        std::vector<std::unique_ptr<ZipArchive>> archives;   // own the zip entries
+        std::vector<DiscordPageSource>           sources;
 
         if (fs::is_regular_file(inputPath))
         {
-            processDiscordPage(inputPath.string(), allMessages, participants);
+            if (IsZipArchive(inputPath.string()))
+            {
+                addArchivePages(inputPath.string(), archives, sources);
+            }
+            else
+            {
+                DiscordPageSource source;
+                source.label = inputPath.string();
+                sources.push_back(std::move(source));
+            }
         }
         else if (fs::is_directory(inputPath))
         {
             for (const auto& entry : fs::directory_iterator(inputPath))
             {
-                if (entry.is_regular_file() &&
-                    entry.path().extension() == ".json")
+                if (!entry.is_regular_file())
+                    continue;
+
+                if (entry.path().extension() == ".json")
                 {
                     std::cout << "Processing Discord JSON: "
                               << entry.path().string() << "\n";
-                    processDiscordPage(entry.path().string(),
-                                       allMessages,
-                                       participants);
+                    DiscordPageSource source;
+                    source.label = entry.path().string();
+                    sources.push_back(std::move(source));
+                }
+                else if (entry.path().extension() == ".zip")
+                {
+                    addArchivePages(entry.path().string(), archives, sources);
                 }
             }
         }
@@ -256,77 +756,35 @@ bool ConvertDiscordToInstagramFolder(
             return false;
         }
 
-        if (allMessages.empty())
-        {
-            errorOut = "No messages found in Discord JSON.";
-            return false;
-        }
+        std::vector<DiscordPageSlot>      slots;
+        std::set<std::string>             participants;
+        std::unordered_set<std::uint64_t> replyTargets;
+        parseDiscordPages(sources, slots, participants, replyTargets);
 
-        // Sort messages chronologically.
-        std::sort(allMessages.begin(), allMessages.end(),
-                  [](const InstaMessage& a, const InstaMessage& b)
-                  {
-                      return a.timestamp_ms < b.timestamp_ms;
-                  });
+        ExportChunkOptions chunkOptions;
+        chunkOptions.title       = chatTitle;
+        chunkOptions.threadPath  = "discord/converted";
+        chunkOptions.viewerFlags = true;
+        chunkOptions.chunkSize   = chunkSize;
+        ChunkedExportWriter writer(outputPathStr, chunkOptions);
 
-        // Build participants array.
-        json participantsJson = json::array();
+        // Every sender is known once the pages are parsed, so every chunk
+        // lists all of them.
         for (const auto& name : participants)
-        {
-            json p;
-            p["name"] = name;
-            participantsJson.push_back(p);
-        }
+            writer.addParticipant(name);
 
-        const std::size_t CHUNK_SIZE = 5000;
-        std::size_t total  = allMessages.size();
-        std::size_t chunks = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (chunks == 0) chunks = 1;
+        if (!mergeDiscordPages(sources, slots, replyTargets, writer, errorOut))
+            return false;
 
-        for (std::size_t c = 0; c < chunks; ++c)
+        if (writer.messageCount() == 0)
         {
-            std::size_t start = c * CHUNK_SIZE;
-            std::size_t end   = std::min(start + CHUNK_SIZE, total);
-
-            json out;
-            out["participants"] = participantsJson;
-
-            json msgs = json::array();
-            for (std::size_t i = start; i < end; ++i)
-            {
-                const auto& im = allMessages[i];
-                json m;
-                m["sender_name"]  = im.sender_name;
-                m["timestamp_ms"] = im.timestamp_ms;
-                m["content"]      = im.content;
-                m["is_geoblocked_for_viewer"]                = false;
-                m["is_unsent_image_by_messenger_kid_parent"] = false;
-                msgs.push_back(std::move(m));
-            }
-
-            out["messages"]             = std::move(msgs);
-            out["title"]                = chatTitle;
-            out["is_still_participant"] = true;
-            out["thread_path"]          = "discord/converted";
-            out["magic_words"]          = json::array();
-
-            std::size_t fileIndex = c + 1;
-            std::ostringstream ossName;
-            ossName << "message_" << fileIndex << ".json";
-            std::string fileName = ossName.str();
-
-            fs::path outFilePath = outputDir / fs::u8path(fileName);
-
-            std::ofstream ofs(outFilePath.string(), std::ios::binary);
-            if (!ofs)
-            {
-                errorOut = "Failed to open output file: " +
-                           outFilePath.string();
-                return false;
-            }
-            ofs << out.dump(2);
+            errorOut = "No messages found in Discord JSON.";
+            return false;
         }
 
+        if (!writer.finish(errorOut))
+            return false;
+
         errorOut.clear();
         return true;
     }
@@ -0,0 +1,30 @@
+// discord_convert.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "export_writer.hpp"
+
+// inputPathStr:
+//   - A single Discrub JSON page, a .zip archive of pages, or a folder of
+//     either (every *.json and *.zip is read). Archive entries are
+//     decompressed in memory; non-JSON entries are skipped.
+//
+// outputPathStr:
+//   - Destination folder where message_#.json files will be written.
+//
+// chatTitle:
+//   - Stored as "title" in every output chunk.
+//
+// chunkSize:
+//   - Messages per output message_#.json file.
+//
+// Returns true on success; on failure returns false and fills errorOut.
+bool ConvertDiscordToInstagramFolder(
+    const std::string& inputPathStr,
+    const std::string& outputPathStr,
+    const std::string& chatTitle,
+    std::string&       errorOut,
+    std::size_t        chunkSize = DEFAULT_EXPORT_CHUNK_SIZE
+);
@@ -0,0 +1,375 @@
+// export_writer.cpp
+#include "export_writer.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <utility>
+
+#include "json_writer.hpp"
+#include "thread_pool.hpp"
+
+namespace fs = std::filesystem;
+
+// -------------------------------------------------------------
+// Chunk layout, shared by the streaming and the parallel writer
+// -------------------------------------------------------------
+
+static void beginChunk(JsonWriter& w)
+{
+    w.beginObject();
+    w.field("is_still_participant", true);
+    w.key("magic_words");
+    w.beginArray();
+    w.endArray();
+    w.key("messages");
+    w.beginArray();
+}
+
+// "photos": [{"uri": ...}, ...] for the attachments of one kind, if any.
+static void writeAttachments(JsonWriter& w, const char* key,
+                             const std::vector<InstaAttachment>* attachments,
+                             InstaAttachment::Kind kind)
+{
+    if (!attachments)
+        return;
+
+    bool open = false;
+    for (const auto& a : *attachments)
+    {
+        if (a.kind != kind)
+            continue;
+        if (!open)
+        {
+            w.key(key);
+            w.beginArray();
+            open = true;
+        }
+        w.beginObject();
+        w.field("uri", a.uri);
+        w.endObject();
+    }
+    if (open)
+        w.endArray();
+}
+
+static void writeReactions(JsonWriter& w, const std::vector<InstaReaction>* reactions)
+{
+    if (!reactions || reactions->empty())
+        return;
+
+    w.key("reactions");
+    w.beginArray();
+    for (const auto& r : *reactions)
+    {
+        w.beginObject();
+        w.field("actor", r.actor);
+        w.field("reaction", r.reaction);
+        w.endObject();
+    }
+    w.endArray();
+}
+
+// Keys are written in sorted order, like the rest of the chunk.
+static void writeMessage(JsonWriter& w, const ExportChunkOptions& options,
+                         std::string_view sender, long long timestampMs,
+                         std::string_view content,
+                         const std::vector<InstaAttachment>* attachments,
+                         const std::vector<InstaReaction>*   reactions,
+                         std::string_view messageId, std::string_view replyTo)
+{
+    w.beginObject();
+    writeAttachments(w, "audio_files", attachments, InstaAttachment::Audio);
+    w.field("content", content);
+    writeAttachments(w, "files", attachments, InstaAttachment::File);
+    if (options.viewerFlags)
+    {
+        w.field("is_geoblocked_for_viewer", false);
+        w.field("is_unsent_image_by_messenger_kid_parent", false);
+    }
+    if (!messageId.empty())
+        w.field("message_id", messageId);
+    writeAttachments(w, "photos", attachments, InstaAttachment::Photo);
+    writeReactions(w, reactions);
+    if (!replyTo.empty())
+        w.field("reply_to", replyTo);
+    w.field("sender_name", sender);
+    w.field("timestamp_ms", timestampMs);
+    writeAttachments(w, "videos", attachments, InstaAttachment::Video);
+    w.endObject();
+}
+
+// Everything after the messages array, up to the closing brace.
+template <typename NameSet>
+static void writeChunkTrailer(JsonWriter& w, const ExportChunkOptions& options,
+                              const NameSet& participants)
+{
+    w.key("participants");
+    w.beginArray();
+    for (const auto& name : participants)
+    {
+        w.beginObject();
+        w.field("name", name);
+        w.endObject();
+    }
+    w.endArray();
+
+    w.field("thread_path", options.threadPath);
+    if (!options.threadType.empty())
+        w.field("thread_type", options.threadType);
+    w.field("title", options.title);
+    w.endObject();
+}
+
+template <typename NameSet>
+static void endChunk(JsonWriter& w, const ExportChunkOptions& options, const NameSet& participants)
+{
+    w.endArray();
+    writeChunkTrailer(w, options, participants);
+}
+
+// The text writeChunkTrailer() appends to a chunk, rendered on its own: the
+// same chunk written without messages, minus its head.
+template <typename NameSet>
+static std::string renderChunkTrailer(const ExportChunkOptions& options, const NameSet& participants)
+{
+    JsonWriter head(2);
+    beginChunk(head);
+    head.endArray();
+    const std::size_t skip = head.take().size();
+
+    JsonWriter w(2);
+    beginChunk(w);
+    endChunk(w, options, participants);
+    return w.take().substr(skip);
+}
+
+static fs::path chunkPath(const std::string& outFolder, std::size_t index)
+{
+    return fs::u8path(outFolder) / fs::u8path("message_" + std::to_string(index + 1) + ".json");
+}
+
+// -------------------------------------------------------------
+// ChunkedExportWriter
+// -------------------------------------------------------------
+
+ChunkedExportWriter::ChunkedExportWriter(const std::string& outFolder, ExportChunkOptions options)
+    : m_outFolder(outFolder), m_options(std::move(options))
+{
+    m_chunkCount = m_options.existingChunks;
+    if (m_options.chunkSize == 0)
+        m_options.chunkSize = DEFAULT_EXPORT_CHUNK_SIZE;
+}
+
+ChunkedExportWriter::~ChunkedExportWriter() = default;
+
+void ChunkedExportWriter::addParticipant(std::string_view name)
+{
+    if (m_participants.find(name) == m_participants.end())
+        m_participants.emplace(name);
+}
+
+bool ChunkedExportWriter::openChunk(std::string& errorOut)
+{
+    if (!m_createdFolder)
+    {
+        fs::create_directories(fs::u8path(m_outFolder));
+        m_createdFolder = true;
+    }
+
+    fs::path outPath = chunkPath(m_outFolder, m_chunkCount);
+    m_filePath = outPath.string();
+    m_file.open(outPath, std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+        errorOut = "Failed to open output file: " + m_filePath;
+        return false;
+    }
+
+    m_json.reset(new JsonWriter(m_file, 2));
+    beginChunk(*m_json);
+
+    ++m_chunkCount;
+    m_inChunk = 0;
+    return true;
+}
+
+bool ChunkedExportWriter::closeChunk(std::string& errorOut)
+{
+    m_json->endArray();
+    m_json->flush();
+    const std::streamoff trailerAt = m_file.tellp();
+    writeChunkTrailer(*m_json, m_options, m_participants);
+    m_json->flush();
+    m_json.reset();
+
+    m_file.close();
+    if (m_file.fail())
+    {
+        m_file.clear();
+        errorOut = "Failed to write output file: " + m_filePath;
+        return false;
+    }
+    m_closed.push_back({ m_chunkCount - 1, trailerAt, m_participants.size() });
+    m_inChunk = 0;
+    return true;
+}
+
+bool ChunkedExportWriter::add(std::string_view sender, long long timestampMs,
+                              std::string_view content,
+                              const std::vector<InstaAttachment>* attachments,
+                              const std::vector<InstaReaction>*   reactions,
+                              std::string_view messageId, std::string_view replyTo,
+                              std::string& errorOut)
+{
+    // Consecutive messages usually share a sender; skip the set lookup then.
+    if (sender != m_lastSender)
+    {
+        addParticipant(sender);
+        m_lastSender.assign(sender.data(), sender.size());
+    }
+
+    if (!m_json && !openChunk(errorOut))
+        return false;
+
+    writeMessage(*m_json, m_options, sender, timestampMs, content, attachments, reactions,
+                 messageId, replyTo);
+
+    ++m_messageCount;
+    if (++m_inChunk == m_options.chunkSize)
+        return closeChunk(errorOut);
+    return true;
+}
+
+bool ChunkedExportWriter::finish(std::string& errorOut)
+{
+    if (m_json && !closeChunk(errorOut))
+        return false;
+    return completeParticipants(errorOut);
+}
+
+// Names only ever get added, so a chunk that listed fewer than there are now
+// is cut back to its messages and given the full trailer.
+bool ChunkedExportWriter::completeParticipants(std::string& errorOut)
+{
+    std::string trailer;
+    for (const auto& chunk : m_closed)
+    {
+        if (chunk.names == m_participants.size())
+            continue;
+        if (trailer.empty())
+            trailer = renderChunkTrailer(m_options, m_participants);
+
+        const fs::path outPath = chunkPath(m_outFolder, chunk.index);
+        std::error_code ec;
+        fs::resize_file(outPath, static_cast<std::uintmax_t>(chunk.trailerAt), ec);
+        std::ofstream file;
+        if (!ec)
+        {
+            file.open(outPath, std::ios::binary | std::ios::app);
+            file.write(trailer.data(), static_cast<std::streamsize>(trailer.size()));
+            file.close();
+        }
+        if (ec || !file)
+        {
+            errorOut = "Failed to write output file: " + outPath.string();
+            return false;
+        }
+    }
+    m_closed.clear();
+    return true;
+}
+
+// -------------------------------------------------------------
+// Parallel serialization of an in-memory chat
+// -------------------------------------------------------------
+
+bool WriteInstagramChunks(const std::string&               outFolder,
+                          const ExportChunkOptions&        options,
+                          const std::set<std::string>&     participants,
+                          const std::vector<InstaMessage>& messages,
+                          std::string&                     errorOut)
+{
+    const std::size_t chunkSize = options.chunkSize ? options.chunkSize : DEFAULT_EXPORT_CHUNK_SIZE;
+    const std::size_t chunks    = (messages.size() + chunkSize - 1) / chunkSize;
+    const unsigned    threads   = std::max(1u, std::thread::hardware_concurrency());
+
+    if (chunks < 2 || threads < 2)
+    {
+        ChunkedExportWriter writer(outFolder, options);
+        for (const auto& name : participants)
+            writer.addParticipant(name);
+
+        for (const auto& m : messages)
+        {
+            if (!writer.add(m, errorOut))
+                return false;
+        }
+        if (!writer.finish(errorOut))
+            return false;
+
+        errorOut.clear();
+        return true;
+    }
+
+    // Every chunk lists the full participant set, since all of it is known.
+    std::set<std::string, std::less<>> names(participants.begin(), participants.end());
+    const std::string* lastSender = nullptr;
+    for (const auto& m : messages)
+    {
+        if (!lastSender || *lastSender != m.sender_name)
+        {
+            if (names.find(m.sender_name) == names.end())
+                names.insert(m.sender_name);
+            lastSender = &m.sender_name;
+        }
+    }
+
+    fs::create_directories(fs::u8path(outFolder));
+
+    // Chunks are rendered on the workers and written to disk in order.
+    auto render = [&](std::size_t c)
+    {
+        JsonWriter w(2);
+        beginChunk(w);
+        const std::size_t end = std::min(messages.size(), (c + 1) * chunkSize);
+        for (std::size_t i = c * chunkSize; i < end; ++i)
+        {
+            const auto& m = messages[i];
+            writeMessage(w, options, m.sender_name, m.timestamp_ms, m.content,
+                         &m.attachments, &m.reactions, m.message_id, m.reply_to);
+        }
+        endChunk(w, options, names);
+        return w.take();
+    };
+    std::size_t written = 0;
+    auto write = [&](std::size_t c, std::string text)
+    {
+        const fs::path outPath = chunkPath(outFolder, options.existingChunks + c);
+        std::ofstream ofs(outPath, std::ios::binary | std::ios::trunc);
+        ofs.write(text.data(), static_cast<std::streamsize>(text.size()));
+        ofs.close();
+        if (!ofs)
+        {
+            errorOut = "Failed to write output file: " + outPath.string();
+            return false;
+        }
+        ++written;
+        return true;
+    };
+
+    WorkStealingPool pool(threads);
+    try
+    {
+        if (!pool.runOrdered(chunks, render, write))
+            return false;
+    }
+    catch (...)
+    {
+        errorOut = "Failed to serialize chunk " + std::to_string(written + 1);
+        return false;
+    }
+
+    errorOut.clear();
+    return true;
+}
@@ -0,0 +1,150 @@
+// export_writer.hpp
+// Streaming writer for the Instagram-style message_#.json chunks that every
+// converter produces. Messages are written straight to the current chunk file
+// as they arrive, so memory stays flat however long the chat is.
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JsonWriter;
+
+// Media attached to a message. Written the way Instagram exports list it:
+// one "photos" / "videos" / "audio_files" / "files" array per kind, holding a
+// {"uri": ...} object per attachment. The media itself is never exported.
+struct InstaAttachment
+{
+    enum Kind { Photo, Video, Audio, File };
+
+    Kind        kind = File;
+    std::string uri;   // original file name, when the source has one
+};
+
+// A reaction to a message, as Instagram's "reactions": [{"actor", "reaction"}].
+struct InstaReaction
+{
+    std::string actor;
+    std::string reaction;   // usually a single emoji
+};
+
+// Simple representation of an Instagram-style message, shared by the
+// converters.
+//
+// message_id / reply_to are extensions of the Instagram layout for sources
+// that thread replies (Discord): reply_to names the message_id of the message
+// being answered. Both are optional and written only when set.
+struct InstaMessage
+{
+    std::string sender_name;
+    long long   timestamp_ms = 0;
+    std::string content;
+    std::vector<InstaAttachment> attachments;
+    std::vector<InstaReaction>   reactions;
+    std::string message_id;
+    std::string reply_to;
+};
+
+constexpr std::size_t DEFAULT_EXPORT_CHUNK_SIZE = 5000;
+
+struct ExportChunkOptions
+{
+    std::string title;
+    std::string threadPath;            // e.g. "whatsapp/converted"
+    std::string threadType;            // omitted when empty
+    bool        viewerFlags = false;   // per-message is_geoblocked_for_viewer /
+                                       // is_unsent_image_by_messenger_kid_parent
+    std::size_t chunkSize = DEFAULT_EXPORT_CHUNK_SIZE;   // messages per file
+    std::size_t existingChunks = 0;    // chunk files already in the folder;
+                                       // new ones are numbered after them
+};
+
+// Chunk layout (keys in the same order nlohmann::json used to emit them):
+//
+//   { "is_still_participant": true, "magic_words": [], "messages": [...],
+//     "participants": [{"name": ...}], "thread_path": ..., ["thread_type": ...,]
+//     "title": ... }
+//
+// "participants" follows "messages", so it is written when a chunk closes and
+// lists every addParticipant() name plus every sender seen so far. finish()
+// rewrites the end of the chunks closed before the set was complete, so in
+// the end every chunk lists all of it (the analyzer turns each file's names
+// into stop words). Callers that know the full set up front should still add
+// it first: then there is nothing to rewrite.
+class ChunkedExportWriter
+{
+public:
+    ChunkedExportWriter(const std::string& outFolder, ExportChunkOptions options);
+    ~ChunkedExportWriter();
+
+    ChunkedExportWriter(const ChunkedExportWriter&) = delete;
+    ChunkedExportWriter& operator=(const ChunkedExportWriter&) = delete;
+
+    void addParticipant(std::string_view name);
+
+    // Messages must arrive in chronological order.
+    bool add(std::string_view sender, long long timestampMs, std::string_view content,
+             std::string& errorOut)
+    {
+        return add(sender, timestampMs, content, nullptr, nullptr, {}, {}, errorOut);
+    }
+    bool add(std::string_view sender, long long timestampMs, std::string_view content,
+             const std::vector<InstaAttachment>* attachments,
+             const std::vector<InstaReaction>*   reactions,
+             std::string_view messageId, std::string_view replyTo,
+             std::string& errorOut);
+    bool add(const InstaMessage& message, std::string& errorOut)
+    {
+        return add(message.sender_name, message.timestamp_ms, message.content,
+                   &message.attachments, &message.reactions,
+                   message.message_id, message.reply_to, errorOut);
+    }
+
+    // Close the last chunk and complete the participants of earlier ones.
+    // Writes nothing if no message was added.
+    bool finish(std::string& errorOut);
+
+    std::size_t messageCount() const { return m_messageCount; }
+    std::size_t chunkCount() const { return m_chunkCount; }   // incl. existingChunks
+
+private:
+    // A chunk closed by this writer, and where its participants start.
+    struct ClosedChunk
+    {
+        std::size_t    index;
+        std::streamoff trailerAt;
+        std::size_t    names;   // participants it lists
+    };
+
+    bool openChunk(std::string& errorOut);
+    bool closeChunk(std::string& errorOut);
+    bool completeParticipants(std::string& errorOut);
+
+    std::string           m_outFolder;
+    ExportChunkOptions    m_options;
+    std::set<std::string, std::less<>> m_participants;
+    std::string           m_lastSender;
+    std::vector<ClosedChunk> m_closed;
+
+    std::ofstream               m_file;
+    std::unique_ptr<JsonWriter> m_json;
+    std::string                 m_filePath;
+    std::size_t                 m_inChunk      = 0;
+    std::size_t                 m_messageCount = 0;
+    std::size_t                 m_chunkCount   = 0;
+    bool                        m_createdFolder = false;
+};
+
+// Write an in-memory, already sorted message list in one go. Chunks are
+// rendered in parallel on a WorkStealingPool, each into its own buffer, and
+// written to disk strictly in order; every chunk lists the full participant
+// set (`participants` plus all senders).
+bool WriteInstagramChunks(const std::string&               outFolder,
+                          const ExportChunkOptions&        options,
+                          const std::set<std::string>&     participants,
+                          const std::vector<InstaMessage>& messages,
+                          std::string&                     errorOut);
@@ -15,126 +15,21 @@
 #include <vector>
 #include <map>
 
-#include <fstream>
-#include <set>
 #include <filesystem>
 
+#include "chat_analyzer.hpp"
+#include "whatsapp_convert.hpp"
+#include "discord_convert.hpp"
 #include "imessage_convert.hpp"
 #include "android_sms_convert.hpp"
 
 namespace fs = std::filesystem;
 
-// Analysis entry point
-std::string runAnalysisToString(const std::string& inputPathStr);
-
-// Discord conversion
-bool ConvertDiscordToInstagramFolder(const std::string& inputPathStr,
-                                     const std::string& outputPathStr,
-                                     const std::string& chatTitle,
-                                     std::string&      errorOut);
-// Whatsapp conversion 
-bool ConvertWhatsAppToInstagramFolder(
-    const std::string& inputPathStr,
-    const std::string& outputPathStr,
-    const std::string& chatTitle,
-    std::string&       errorOut
-    );             
-// ============================================================================
-// Shared analytics types 
-// ============================================================================
-struct MonthlyEmotionPoint
-{
-    int year;
-    int month;
-    double avgCompound;
-};
-
-struct MonthlyCountPoint
-{
-    int year;
-    int month;
-    long long totalMessages;
-};
-
-struct MonthlyResponsePoint
-{
-    int year;
-    int month;
-    double avgMinutes;
-};
-
-struct MonthlyRomanticPoint
-{
-    int year;
-    int month;
-    long long romanticMessages;
-};
-
-struct MonthlyAvgLengthPoint
-{
-    int year;
-    int month;
-    double avgWords;
-};
-
-// Per-user series for charts
-struct UserMonthlyCountPoint
-{
-    int year;
-    int month;
-    long long totalMessages;
-};
-
-struct UserMonthlyEmotionPoint
-{
-    int year;
-    int month;
-    double avgCompound;
-};
-
-struct UserMonthlyResponsePoint
-{
-    int year;
-    int month;
-    double avgMinutes;
-};
-
-struct UserMonthlyRomanticPoint
-{
-    int year;
-    int month;
-    long long romanticMessages;
-};
-
-struct UserMonthlyAvgLengthPoint
-{
-    int year;
-    int month;
-    double avgWords;
-};
-
-// Global analytics 
-extern int  g_heatmapCounts[7][24];
-extern bool g_heatmapReady;
-
-extern std::vector<MonthlyEmotionPoint>        g_monthlyEmotionPoints;
-extern std::vector<MonthlyCountPoint>          g_monthlyCountPoints;
-extern std::vector<MonthlyResponsePoint>       g_monthlyResponsePoints;
-extern std::vector<MonthlyRomanticPoint>       g_monthlyRomanticPoints;
-extern std::vector<MonthlyAvgLengthPoint>      g_monthlyAvgLengthPoints;
-
-extern std::vector<std::string>                g_chartUserNames;
-
-extern std::vector<std::vector<UserMonthlyCountPoint>>      g_userMonthlyCountSeries;
-extern std::vector<std::vector<UserMonthlyEmotionPoint>>    g_userMonthlyEmotionSeries;
-extern std::vector<std::vector<UserMonthlyResponsePoint>>   g_userMonthlyResponseSeries;
-extern std::vector<std::vector<UserMonthlyRomanticPoint>>   g_userMonthlyRomanticSeries;
-extern std::vector<std::vector<UserMonthlyAvgLengthPoint>>  g_userMonthlyAvgLengthSeries;
-
 // ============================================================================
 // Control IDs / custom messages
 // ============================================================================
 #define IDM_CONTACT_BASE 5000   // base command ID for Android contact menu items
+#define IDM_CONTACT_ALL  4999   // Android contact menu: export every thread
 
 enum
 {
@@ -330,115 +225,57 @@ struct AndroidContactInfo
 {
     std::string address;
     std::string contactName;
+    std::size_t messageCount = 0;
 };
 
-// simple attribute parser: attrName="value"
-static bool ExtractXmlAttribute(const std::string& src,
-                                const std::string& attrName,
-                                std::string&       out)
-{
-    std::string pattern = attrName + "=\"";
-    std::size_t pos = src.find(pattern);
-    if (pos == std::string::npos)
-        return false;
-
-    pos += pattern.size();
-    std::size_t end = src.find('"', pos);
-    if (end == std::string::npos)
-        return false;
-
-    out.assign(src.begin() + static_cast<std::ptrdiff_t>(pos),
-               src.begin() + static_cast<std::ptrdiff_t>(end));
-    return true;
-}
-
-static bool IsNullOrEmptyAttr(const std::string& s)
-{
-    return s.empty() || s == "null";
-}
-
-// Scan the XML once and collect unique (address, contact_name) pairs.
+// Unique (address, contact_name) pairs, from the backup's contact index
+// (cached next to the XML, so reopening a large backup is instant).
 static bool GetAndroidContactsFromXml(
     const std::wstring& xmlPathW,
     std::vector<AndroidContactInfo>& outContacts,
     std::wstring& errorOutW)
 {
-    std::string xmlPathUtf8 = WideToUtf8(xmlPathW);
-    std::ifstream in(xmlPathUtf8, std::ios::binary);
-    if (!in)
+    AndroidSmsIndex index;
+    std::string indexErr;
+    if (!LoadAndroidSmsIndex(WideToUtf8(xmlPathW), index, indexErr))
     {
         errorOutW = L"Failed to open Android SMS XML file.";
+        if (!indexErr.empty())
+            errorOutW += L"\n" + Utf8ToWide(indexErr);
         return false;
     }
 
-    std::vector<AndroidContactInfo> contacts;
-    std::set<std::pair<std::string,std::string>> seen;
+    auto isNullOrEmpty = [](const std::string& s) { return s.empty() || s == "null"; };
 
-    std::string line;
-    bool inSms = false;
-    std::string smsChunk;
+    std::vector<AndroidContactInfo> contacts;
+    std::map<std::pair<std::string,std::string>, std::size_t> seen;
 
-    // Limit: we don't want millionsof contacts; but we'll scan entire file
-    // for correctness. If performance is an issue, we can later add a cap.
-    while (std::getline(in, line))
+    for (const auto& entry : index.contacts)
     {
-        if (!line.empty() && line.back() == '\r')
-            line.pop_back();
-
-        if (!inSms)
-        {
-            std::size_t pos = line.find("<sms ");
-            if (pos == std::string::npos)
-                continue;
-
-            inSms = true;
-            smsChunk.clear();
-            smsChunk.append(line.substr(pos));
-            smsChunk.push_back('\n');
-
-            if (smsChunk.find("/>") != std::string::npos)
-            {
-                inSms = false;
-            }
-            else
-            {
-                continue;
-            }
-        }
-        else
-        {
-            smsChunk.append(line);
-            smsChunk.push_back('\n');
+        std::string address     = entry.address;
+        std::string contactName = entry.contactName;
 
-            if (line.find("/>") == std::string::npos)
-                continue;
-
-            inSms = false;
-        }
-
-       
-        std::string address;
-        std::string contactName;
-
-        ExtractXmlAttribute(smsChunk, "address",      address);
-        ExtractXmlAttribute(smsChunk, "contact_name", contactName);
-
-        if (IsNullOrEmptyAttr(address) && IsNullOrEmptyAttr(contactName))
+        if (isNullOrEmpty(address) && isNullOrEmpty(contactName))
             continue;
 
-        if (!IsNullOrEmptyAttr(contactName) && contactName == "(Unknown)")
-        {
+        if (contactName == "(Unknown)")
             contactName.clear();
-        }
 
         std::pair<std::string,std::string> key { address, contactName };
-        if (seen.insert(key).second)
+        auto it = seen.find(key);
+        if (it != seen.end())
         {
-            AndroidContactInfo info;
-            info.address     = address;
-            info.contactName = contactName;
-            contacts.push_back(std::move(info));
+            contacts[it->second].messageCount += entry.messageCount;
+            continue;
         }
+
+        seen.emplace(std::move(key), contacts.size());
+
+        AndroidContactInfo info;
+        info.address      = std::move(address);
+        info.contactName  = std::move(contactName);
+        info.messageCount = entry.messageCount;
+        contacts.push_back(std::move(info));
     }
 
     if (contacts.empty())
@@ -631,11 +468,11 @@ std::wstring PickWhatsAppTxtFile(HWND hWnd)
     OPENFILENAMEW ofn{};
     ofn.lStructSize = sizeof(ofn);
     ofn.hwndOwner   = hWnd;
-    ofn.lpstrFilter = L"WhatsApp exports (*.txt)\0*.txt\0All files (*.*)\0*.*\0";
+    ofn.lpstrFilter = L"WhatsApp exports (*.txt;*.zip)\0*.txt;*.zip\0All files (*.*)\0*.*\0";
     ofn.lpstrFile   = fileBuf;
     ofn.nMaxFile    = MAX_PATH;
     ofn.Flags       = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
-    ofn.lpstrTitle  = L"Select WhatsApp _chat.txt file";
+    ofn.lpstrTitle  = L"Select WhatsApp _chat.txt or export .zip";
 
     if (GetOpenFileNameW(&ofn))
         return std::wstring(fileBuf);
@@ -2442,7 +2279,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg,
 
                 "   WhatsApp:\n"
                 "   - In the chat: Export Chat -> WITHOUT media (recommended).\n"
-                "   - Click 'WhatsApp File Convert' and select the exported _chat.txt.\n"
+                "   - Click 'WhatsApp File Convert' and select the exported _chat.txt or .zip.\n"
                 "   - The app creates a 'whatsapp_converted' folder.\n\n"
 
                 "   Android SMS:\n"
@@ -2636,7 +2473,39 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg,
                 break;
             }
 
-            // 3) Let the user choose a chat via a simple Yes/No sequence
+            // 3) Offer to export every chat in one pass
+            if (chats.size() > 1)
+            {
+                std::wstring allPrompt = L"Export all " + std::to_wstring(chats.size()) +
+                                         L" chats at once (one folder per chat)?\n\n"
+                                         L"Choose No to pick a single chat for analysis.";
+                int res = MessageBoxW(hWnd, allPrompt.c_str(), L"iMessage",
+                                      MB_YESNOCANCEL | MB_ICONQUESTION);
+                if (res == IDCANCEL)
+                    break;
+
+                if (res == IDYES)
+                {
+                    std::wstring outRootW = backupFolder + L"\\imessage_chats";
+                    std::vector<ImessageExportSummary> exported;
+                    if (!ConvertImessageChatsToInstagramFolders(backupUtf8, WideToUtf8(outRootW),
+                                                                exported, error))
+                    {
+                        std::wstring dialogText = L"iMessage conversion failed:\n" + Utf8ToWide(error);
+                        MessageBoxW(hWnd, dialogText.c_str(), L"Conversion Error", MB_OK | MB_ICONERROR);
+                    }
+                    else
+                    {
+                        std::wstring status = L"iMessage: " + std::to_wstring(exported.size()) +
+                                              L" chats converted into " + outRootW +
+                                              L". Pick one with \"Select Folder\".";
+                        SetWindowTextW(g_hStatus, status.c_str());
+                    }
+                    break;
+                }
+            }
+
+            // 4) Let the user choose a chat via a simple Yes/No sequence
             ImessageChatInfo chosen;
             bool haveChoice = false;
 
@@ -2765,6 +2634,9 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg,
                     break;
                 }
 
+                AppendMenuW(hMenu, MF_STRING, IDM_CONTACT_ALL, L"All conversations (one folder each)");
+                AppendMenuW(hMenu, MF_SEPARATOR, 0, nullptr);
+
                 for (size_t i = 0; i < contacts.size(); ++i)
                 {
                     const auto& c = contacts[i];
@@ -2790,6 +2662,8 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg,
                         item += L"(Unknown)";
                     }
 
+                    item += L"  [" + std::to_wstring(c.messageCount) + L"]";
+
                     UINT cmdId = IDM_CONTACT_BASE + static_cast<UINT>(i);
                     AppendMenuW(hMenu, MF_STRING, cmdId, item.c_str());
                 }
@@ -2825,6 +2699,29 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg,
                     break;
                 }
 
+                if (chosenCmd == IDM_CONTACT_ALL)
+                {
+                    // One scan of the backup, one sub-folder per phone number.
+                    fs::path outRoot = fs::u8path(WideToUtf8(xmlPathW)).parent_path() / "android_sms_threads";
+
+                    std::vector<AndroidSmsThreadSummary> threads;
+                    std::string error;
+                    if (!ConvertAndroidSmsXmlToInstagramFolders(WideToUtf8(xmlPathW), outRoot.u8string(),
+                                                                threads, error))
+                    {
+                        std::wstring dialogText = L"Android SMS conversion failed:\n" + Utf8ToWide(error);
+                        MessageBoxW(hWnd, dialogText.c_str(), L"Conversion Error", MB_OK | MB_ICONERROR);
+                    }
+                    else
+                    {
+                        std::wstring status = L"Android SMS: " + std::to_wstring(threads.size()) +
+                                              L" conversations converted into " + Utf8ToWide(outRoot.u8string()) +
+                                              L". Pick one with \"Select Folder\".";
+                        SetWindowTextW(g_hStatus, status.c_str());
+                    }
+                    break;
+                }
+
                 size_t chosenIndex = static_cast<size_t>(chosenCmd - IDM_CONTACT_BASE);
                 if (chosenIndex >= contacts.size())
                     break;
@@ -2,35 +2,33 @@
 // - Discovers chats (with GUIDs + participants).
 // - Exports ONE chosen chat in Instagram-style JSON chunks so the existing
 //   analyzer can consume it just like Instagram/Discord exports.
+// - Or exports many chats (or all of them) at once, one folder per chat,
+//   in parallel over per-thread read-only connections.
 
 #include "imessage_convert.hpp"
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <stdexcept>
 #include <filesystem>
-#include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
-#include "json.hpp"
+#include "export_writer.hpp"
 #include "sqlite3.h"
+#include "thread_pool.hpp"
 
 namespace fs = std::filesystem;
-using json   = nlohmann::json;
-
-// ---------------------------
-// Shared "Instagram-style" message shape
-// (mirrors discord_convert.cpp)
-// ---------------------------
-struct InstaMessage
-{
-    std::string sender_name;
-    long long   timestamp_ms = 0;
-    std::string content;
-};
 
 // ---------------------------
 // RAII wrappers for sqlite3
@@ -41,12 +39,30 @@ struct SqliteDb
 
     explicit SqliteDb(const std::string& path)
     {
-        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        const std::string uri = readOnlyUri(path);
+        if (sqlite3_open_v2(uri.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, nullptr) != SQLITE_OK)
         {
+            if (db)
+            {
+                sqlite3_close(db);
+                db = nullptr;
+            }
             std::string msg = "Failed to open SQLite DB: ";
             msg += path;
             throw std::runtime_error(msg);
         }
+
+        // Everything here is a read-only, mostly sequential scan: map the
+        // file instead of copying pages through read(), and give the page
+        // cache room for the join's indexes. Best effort; a build without
+        // mmap support just ignores mmap_size. temp_store stays at its
+        // default: the all-chats ORDER BY sorts every message, and the
+        // sorter must be free to spill that to temp files.
+        sqlite3_exec(db,
+                     "PRAGMA query_only = 1;"
+                     "PRAGMA mmap_size = 1073741824;"
+                     "PRAGMA cache_size = -65536;",
+                     nullptr, nullptr, nullptr);
     }
 
     ~SqliteDb()
@@ -56,6 +72,48 @@ struct SqliteDb
             sqlite3_close(db);
         }
     }
+
+    SqliteDb(const SqliteDb&) = delete;
+    SqliteDb& operator=(const SqliteDb&) = delete;
+
+private:
+    // "file:<path>?immutable=1": the database is a backup copy nobody writes
+    // to, so SQLite can skip file locking and change detection entirely,
+    // and any number of connections can read it side by side. A live
+    // chat.db with a non-empty write-ahead log is opened "mode=ro" instead,
+    // so messages still sitting in the -wal file are seen.
+    static std::string readOnlyUri(const std::string& path)
+    {
+        std::error_code ec;
+        const auto walSize = fs::file_size(fs::u8path(path + "-wal"), ec);
+        const bool hasWal  = !ec && walSize > 0;
+
+        std::string uri = "file:";
+#ifdef _WIN32
+        if (path.size() >= 2 && path[1] == ':')
+            uri += '/';   // file:/C:/...
+#endif
+        static const char HEX[] = "0123456789ABCDEF";
+        for (char c : path)
+        {
+#ifdef _WIN32
+            if (c == '\\')
+                c = '/';
+#endif
+            if (c == '?' || c == '#' || c == '%')
+            {
+                uri += '%';
+                uri += HEX[(static_cast<unsigned char>(c) >> 4) & 0xF];
+                uri += HEX[static_cast<unsigned char>(c) & 0xF];
+            }
+            else
+            {
+                uri += c;
+            }
+        }
+        uri += hasWal ? "?mode=ro" : "?immutable=1";
+        return uri;
+    }
 };
 
 struct SqliteStmt
@@ -84,29 +142,67 @@ struct SqliteStmt
 // ---------------------------
 // Apple time → Unix ms
 // ---------------------------
+
+// Apple stores timestamps as seconds (old) or nanoseconds (new) since
+// 2001-01-01 00:00:00 UTC; values above this are nanoseconds.
+constexpr long long APPLE_NANOSECOND_DATE_MIN = 1000000000000LL;
+constexpr long long APPLE_TO_UNIX_OFFSET_MS   = 978307200000LL;
+constexpr long long APPLE_SECONDS_DATE_MIN    = -APPLE_TO_UNIX_OFFSET_MS / 1000;   // 1970
+
 static long long appleTimeToUnixMs(long long raw)
 {
-    // Apple stores timestamps as seconds (old) or nanoseconds (new)
-    // since 2001-01-01 00:00:00 UTC.
-    constexpr long long APPLE_TO_UNIX_OFFSET_SEC = 978307200LL;
+    // Integer math throughout: a double holds only ~15-16 significant
+    // digits, less than a nanosecond date has.
+    if (raw > APPLE_NANOSECOND_DATE_MIN)
+        return raw / 1'000'000 + APPLE_TO_UNIX_OFFSET_MS;   // raw > 0: division floors
+    if (raw <= APPLE_SECONDS_DATE_MIN)
+        return 0;
+    return raw * 1000 + APPLE_TO_UNIX_OFFSET_MS;
+}
+
+// Smallest nanosecond date whose Unix ms is >= unixMs (saturating).
+static long long unixMsToAppleNanos(long long unixMs)
+{
+    const long long sinceApple = unixMs - APPLE_TO_UNIX_OFFSET_MS;
+    constexpr long long LIMIT = std::numeric_limits<long long>::max() / 1'000'000;
+    if (sinceApple >= LIMIT)  return std::numeric_limits<long long>::max();
+    if (sinceApple <= -LIMIT) return std::numeric_limits<long long>::min();
+    return sinceApple * 1'000'000;
+}
+
+// Smallest seconds date whose Unix ms is >= unixMs.
+static long long unixMsToAppleSeconds(long long unixMs)
+{
+    const long long sinceApple = unixMs - APPLE_TO_UNIX_OFFSET_MS;
+    return sinceApple / 1000 + (sinceApple % 1000 > 0 ? 1 : 0);   // ceil
+}
 
-    double secondsSince2001;
-    if (raw > 1000000000000LL)
+// SQL condition on message.date selecting exactly the rows whose
+// appleTimeToUnixMs() falls in `range`, or "" when it is unbounded. A date
+// is in seconds or in nanoseconds depending on its magnitude, so there is
+// one plain range per unit; each is served by an index on message.date.
+// `lowerOnly` keeps just the fromMs side (tapbacks come after their message).
+static std::string appleDateRangeSql(const ImessageTimeRange& range, bool lowerOnly = false)
+{
+    const bool from = range.hasFrom;
+    const bool to   = range.hasTo && !lowerOnly;
+    if (!from && !to)
+        return {};
+
+    const std::string threshold = std::to_string(APPLE_NANOSECOND_DATE_MIN);
+    std::string nanos   = "message.date > " + threshold;
+    std::string seconds = "message.date <= " + threshold;
+    if (from)
     {
-        // Looks like nanoseconds
-        secondsSince2001 = static_cast<double>(raw) / 1'000'000'000.0;
+        nanos   += " AND message.date >= " + std::to_string(unixMsToAppleNanos(range.fromMs));
+        seconds += " AND message.date >= " + std::to_string(unixMsToAppleSeconds(range.fromMs));
     }
-    else
+    if (to)
     {
-        // Treat as seconds
-        secondsSince2001 = static_cast<double>(raw);
+        nanos   += " AND message.date < " + std::to_string(unixMsToAppleNanos(range.toMs));
+        seconds += " AND message.date < " + std::to_string(unixMsToAppleSeconds(range.toMs));
     }
-
-    double unixSeconds = secondsSince2001 + static_cast<double>(APPLE_TO_UNIX_OFFSET_SEC);
-    if (unixSeconds < 0) unixSeconds = 0;
-
-    long long unixMs = static_cast<long long>(unixSeconds * 1000.0);
-    return unixMs < 0 ? 0 : unixMs;
+    return "((" + nanos + ") OR (" + seconds + "))";
 }
 
 // ---------------------------
@@ -187,33 +283,36 @@ static std::string resolveDbPath(const std::string& backupRootOrDbPath)
 // Chat discovery
 // ---------------------------
 
-// Fill a vector with basic info on every chat (conversation) in the DB.
-static void discoverChatsFromDb(
-    const std::string& dbPath,
-    std::vector<ImessageChatInfo>& outChats)
+// Separator for the GROUP_CONCAT of participant handles (ASCII unit
+// separator; never part of a phone number or e-mail address).
+static constexpr char PARTICIPANT_SEPARATOR = '\x1f';
+
+struct ChatRow
 {
-    SqliteDb db(dbPath);
+    long long        rowid = 0;
+    ImessageChatInfo info;
+};
 
-    // 1) Get all chats with display names & GUIDs.
+// Fill a vector with basic info on every chat (conversation) in the DB, with
+// one grouped query for the chats and their participants.
+static void discoverChatRows(sqlite3* db, std::vector<ChatRow>& outRows)
+{
     const char* SQL_CHATS = R"SQL(
         SELECT
-            ROWID,
-            guid,
-            COALESCE(display_name, chat_identifier, guid) AS disp
+            chat.ROWID,
+            chat.guid,
+            COALESCE(chat.display_name, chat.chat_identifier, chat.guid) AS disp,
+            GROUP_CONCAT(handle.id, char(31))
         FROM chat
-        ORDER BY ROWID
+        LEFT JOIN chat_handle_join ON chat_handle_join.chat_id = chat.ROWID
+        LEFT JOIN handle ON handle.ROWID = chat_handle_join.handle_id
+        GROUP BY chat.ROWID
+        ORDER BY chat.ROWID
     )SQL";
 
-    SqliteStmt stmtChats(db.db, SQL_CHATS);
+    SqliteStmt stmtChats(db, SQL_CHATS);
 
-    struct ChatRow
-    {
-        long long rowid = 0;
-        std::string guid;
-        std::string display;
-    };
-
-    std::vector<ChatRow> chatRows;
+    outRows.clear();
     while (true)
     {
         int rc = sqlite3_step(stmtChats.stmt);
@@ -221,112 +320,504 @@ static void discoverChatsFromDb(
         if (rc != SQLITE_ROW)
         {
             std::string msg = "SQLite step error while reading chats: ";
-            msg += sqlite3_errmsg(db.db);
+            msg += sqlite3_errmsg(db);
             throw std::runtime_error(msg);
         }
 
-        ChatRow cr;
-        cr.rowid = sqlite3_column_int64(stmtChats.stmt, 0);
+        const unsigned char* guid_c  = sqlite3_column_text(stmtChats.stmt, 1);
+        const unsigned char* disp_c  = sqlite3_column_text(stmtChats.stmt, 2);
+        const unsigned char* parts_c = sqlite3_column_text(stmtChats.stmt, 3);
 
-        const unsigned char* guid_c = sqlite3_column_text(stmtChats.stmt, 1);
-        const unsigned char* disp_c = sqlite3_column_text(stmtChats.stmt, 2);
-
-        cr.guid    = guid_c ? reinterpret_cast<const char*>(guid_c) : "";
-        cr.display = disp_c ? reinterpret_cast<const char*>(disp_c) : cr.guid;
+        ChatRow cr;
+        cr.rowid            = sqlite3_column_int64(stmtChats.stmt, 0);
+        cr.info.guid        = guid_c ? reinterpret_cast<const char*>(guid_c) : "";
+        cr.info.displayName = disp_c ? reinterpret_cast<const char*>(disp_c) : cr.info.guid;
+        if (cr.info.guid.empty())
+            continue;
 
-        if (!cr.guid.empty())
+        // Sorted and de-duplicated, as the per-chat lookup used to give.
+        std::set<std::string> partSet;
+        if (parts_c)
         {
-            chatRows.push_back(std::move(cr));
+            std::string_view list = reinterpret_cast<const char*>(parts_c);
+            while (!list.empty())
+            {
+                const std::size_t sep = list.find(PARTICIPANT_SEPARATOR);
+                partSet.emplace(list.substr(0, sep));
+                if (sep == std::string_view::npos)
+                    break;
+                list.remove_prefix(sep + 1);
+            }
         }
+
+        cr.info.participants.assign(partSet.begin(), partSet.end());
+        cr.info.isGroup = (cr.info.participants.size() > 1);
+
+        outRows.push_back(std::move(cr));
     }
+}
 
-    // 2) For each chat, find its participants via chat_handle_join + handle.id.
-    const char* SQL_PARTICIPANTS = R"SQL(
-        SELECT handle.id
-        FROM chat_handle_join
-        JOIN handle ON handle.ROWID = chat_handle_join.handle_id
-        WHERE chat_handle_join.chat_id = ?
-    )SQL";
+static void discoverChatsFromDb(
+    const std::string& dbPath,
+    std::vector<ImessageChatInfo>& outChats)
+{
+    SqliteDb db(dbPath);
 
-    SqliteStmt stmtParts(db.db, SQL_PARTICIPANTS);
+    std::vector<ChatRow> rows;
+    discoverChatRows(db.db, rows);
 
     outChats.clear();
-    outChats.reserve(chatRows.size());
+    outChats.reserve(rows.size());
+    for (auto& cr : rows)
+        outChats.push_back(std::move(cr.info));
+}
+
+bool GetImessageChats(
+    const std::string& backupRootOrDbPath,
+    std::vector<ImessageChatInfo>& outChats,
+    std::string& errorOut)
+{
+    try
+    {
+        std::string dbPath = resolveDbPath(backupRootOrDbPath);
+        discoverChatsFromDb(dbPath, outChats);
+        errorOut.clear();
+        return true;
+    }
+    catch (const std::exception& ex)
+    {
+        errorOut = ex.what();
+        outChats.clear();
+        return false;
+    }
+}
 
-    for (const auto& cr : chatRows)
+// ---------------------------
+// Message schema
+// ---------------------------
+
+static bool hasColumn(sqlite3* db, const char* table, const char* column)
+{
+    SqliteStmt stmt(db, "SELECT 1 FROM pragma_table_info(?) WHERE name = ?");
+    sqlite3_bind_text(stmt.stmt, 1, table, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.stmt, 2, column, -1, SQLITE_STATIC);
+    return sqlite3_step(stmt.stmt) == SQLITE_ROW;
+}
+
+// Optional message columns. Older databases (and sms.db from early iOS
+// backups) lack some of them; the queries below only name what exists.
+struct MessageSchema
+{
+    bool attributedBody = false;   // iOS 16+: body kept only here when text is NULL
+    bool reactions      = false;   // associated_message_guid / _type (tapbacks)
+    bool reactionEmoji  = false;   // associated_message_emoji (iOS 17 custom tapbacks)
+};
+
+static MessageSchema detectMessageSchema(sqlite3* db)
+{
+    MessageSchema schema;
+    schema.attributedBody = hasColumn(db, "message", "attributedBody");
+    schema.reactions      = hasColumn(db, "message", "associated_message_guid") &&
+                            hasColumn(db, "message", "associated_message_type");
+    schema.reactionEmoji  = schema.reactions && hasColumn(db, "message", "associated_message_emoji");
+    return schema;
+}
+
+// The per-message columns every export query selects, read by addMessageRow:
+//   +0 is_from_me, +1 date, +2 text, +3 handle.id, +4 ROWID,
+//   +5 attributedBody (NULL when absent), +6 guid
+static std::string messageColumnsSql(const MessageSchema& schema)
+{
+    std::string sql =
+        "message.is_from_me, message.date, message.text, handle.id, message.ROWID, ";
+    sql += schema.attributedBody ? "message.attributedBody" : "NULL";
+    sql += ", message.guid";
+    return sql;
+}
+
+// Rows worth exporting: those with a body inside `range`, minus tapbacks
+// (which become "reactions" on the message they point at).
+static std::string messageFilterSql(const MessageSchema& schema, const ImessageTimeRange& range)
+{
+    std::string sql = schema.attributedBody
+        ? "(message.text <> '' OR message.attributedBody IS NOT NULL)"
+        : "message.text <> ''";
+    if (schema.reactions)
+        sql += " AND COALESCE(message.associated_message_type, 0) NOT BETWEEN 2000 AND 3999";
+    const std::string dates = appleDateRangeSql(range);
+    if (!dates.empty())
+        sql += " AND " + dates;
+    return sql;
+}
+
+// Join order of the message queries. Left alone, SQLite walks the chat's
+// rows of chat_message_join and looks each message up. For a time slice it
+// is far cheaper to range-scan message's date index and check each hit's
+// chat membership; CROSS JOIN pins that order.
+static const char* messageJoinSql(const ImessageTimeRange& range)
+{
+    return range.bounded()
+        ? " FROM message CROSS JOIN chat_message_join ON chat_message_join.message_id = message.ROWID"
+        : " FROM chat_message_join JOIN message ON message.ROWID = chat_message_join.message_id";
+}
+
+// ---------------------------
+// attributedBody decoding
+// ---------------------------
+
+// attributedBody is an NSAttributedString archived with NSArchiver's
+// "typedstream" format. Its plain string is the first NSString object:
+//
+//   ... "NSString" <class version...> 0x84 0x01 '+' <length> <UTF-8 bytes> ...
+//
+// where <length> is one byte below 0x80, or 0x81 + int16 LE, or 0x82 +
+// int32 LE. Rather than unarchiving the object graph, find that marker and
+// return a view of the bytes that follow (no allocation). Returns an empty
+// view when the blob does not have the expected shape.
+static std::string_view decodeAttributedBody(const void* blob, int blobSize)
+{
+    if (!blob || blobSize <= 0)
+        return {};
+
+    const std::string_view data(static_cast<const char*>(blob), static_cast<std::size_t>(blobSize));
+    const auto* bytes = reinterpret_cast<const unsigned char*>(data.data());
+
+    const std::size_t cls = data.find("NSString");
+    if (cls == std::string_view::npos)
+        return {};
+
+    // The string marker follows the class name within a few bytes.
+    constexpr std::size_t MARKER_WINDOW = 16;
+    const std::string_view marker("\x84\x01+", 3);
+    const std::size_t from = cls + 8;
+    const std::size_t hit  = data.substr(from, MARKER_WINDOW + marker.size()).find(marker);
+    if (hit == std::string_view::npos)
+        return {};
+
+    std::size_t p = from + hit + marker.size();
+    if (p >= data.size())
+        return {};
+
+    std::size_t length = 0;
+    const unsigned char lead = bytes[p++];
+    if (lead < 0x80)
+    {
+        length = lead;
+    }
+    else if (lead == 0x81 && p + 2 <= data.size())
+    {
+        length = static_cast<std::size_t>(bytes[p] | (bytes[p + 1] << 8));
+        p += 2;
+    }
+    else if (lead == 0x82 && p + 4 <= data.size())
+    {
+        length = static_cast<std::size_t>(bytes[p]) |
+                 (static_cast<std::size_t>(bytes[p + 1]) << 8) |
+                 (static_cast<std::size_t>(bytes[p + 2]) << 16) |
+                 (static_cast<std::size_t>(bytes[p + 3]) << 24);
+        p += 4;
+    }
+    else
     {
-        ImessageChatInfo info;
-        info.guid         = cr.guid;
-        info.displayName  = cr.display;
-        info.isGroup      = false;
-        info.participants = {};
+        return {};
+    }
 
-        // Bind chat_id = cr.rowid
-        sqlite3_reset(stmtParts.stmt);
-        sqlite3_clear_bindings(stmtParts.stmt);
-        sqlite3_bind_int64(stmtParts.stmt, 1, cr.rowid);
+    if (length > data.size() - p)
+        return {};
+    return data.substr(p, length);
+}
 
-        std::set<std::string> partSet;
+// ---------------------------
+// Tapback reactions
+// ---------------------------
+
+// Tapbacks are messages of their own: associated_message_type 2000-2007 adds
+// a reaction to the message whose GUID is in associated_message_guid (with a
+// "p:<part>/" or "bp:" prefix), 3000-3007 removes it again.
+static const char* tapbackEmoji(int type)
+{
+    switch (type % 1000)
+    {
+    case 0: return "\xE2\x9D\xA4\xEF\xB8\x8F";    // loved
+    case 1: return "\xF0\x9F\x91\x8D";            // liked
+    case 2: return "\xF0\x9F\x91\x8E";            // disliked
+    case 3: return "\xF0\x9F\x98\x82";            // laughed
+    case 4: return "\xE2\x80\xBC\xEF\xB8\x8F";    // emphasized
+    case 5: return "\xE2\x9D\x93";                // questioned
+    default: return nullptr;
+    }
+}
+
+static std::string_view tapbackTargetGuid(std::string_view guid)
+{
+    if (guid.compare(0, 3, "bp:") == 0)
+        return guid.substr(3);
+    if (guid.compare(0, 2, "p:") == 0)
+    {
+        const std::size_t slash = guid.find('/');
+        if (slash != std::string_view::npos)
+            return guid.substr(slash + 1);
+    }
+    return guid;
+}
+
+// Current reactions per target message GUID, after replaying every tapback
+// (and its removal) in order. Each actor keeps at most one reaction per
+// message, as in Messages.
+class ReactionIndex
+{
+public:
+    // Tapbacks with ROWID above `afterRowId` and not older than the start
+    // of `range`, of one chat (chatRowId >= 0) or of the whole database.
+    void load(sqlite3* db, const MessageSchema& schema, long long chatRowId, long long afterRowId,
+              const ImessageTimeRange& range)
+    {
+        m_byGuid.clear();
+        if (!schema.reactions)
+            return;
+
+        std::string sql =
+            "SELECT message.associated_message_guid, message.associated_message_type, "
+            "message.is_from_me, handle.id, ";
+        sql += schema.reactionEmoji ? "message.associated_message_emoji" : "NULL";
+        sql += " FROM message LEFT JOIN handle ON handle.ROWID = message.handle_id";
+        if (chatRowId >= 0)
+            sql += " JOIN chat_message_join ON chat_message_join.message_id = message.ROWID"
+                   " AND chat_message_join.chat_id = ?2";
+        sql += " WHERE message.associated_message_type BETWEEN 2000 AND 3999"
+               " AND message.ROWID > ?1";
+        const std::string dates = appleDateRangeSql(range, true);
+        if (!dates.empty())
+            sql += " AND " + dates;
+        sql += " ORDER BY message.date, message.ROWID";
+
+        SqliteStmt stmt(db, sql.c_str());
+        sqlite3_bind_int64(stmt.stmt, 1, afterRowId);
+        if (chatRowId >= 0)
+            sqlite3_bind_int64(stmt.stmt, 2, chatRowId);
 
         while (true)
         {
-            int rc = sqlite3_step(stmtParts.stmt);
+            const int rc = sqlite3_step(stmt.stmt);
             if (rc == SQLITE_DONE) break;
             if (rc != SQLITE_ROW)
             {
-                std::string msg = "SQLite step error while reading chat participants: ";
-                msg += sqlite3_errmsg(db.db);
+                std::string msg = "SQLite step error while reading reactions: ";
+                msg += sqlite3_errmsg(db);
                 throw std::runtime_error(msg);
             }
 
-            const unsigned char* id_c = sqlite3_column_text(stmtParts.stmt, 0);
-            if (id_c)
+            const unsigned char* guid_c = sqlite3_column_text(stmt.stmt, 0);
+            if (!guid_c || !*guid_c)
+                continue;
+            const int type = sqlite3_column_int(stmt.stmt, 1);
+
+            std::string actor = "Me";
+            if (sqlite3_column_int(stmt.stmt, 2) == 0)
             {
-                partSet.insert(reinterpret_cast<const char*>(id_c));
+                const unsigned char* handle_c = sqlite3_column_text(stmt.stmt, 3);
+                actor = (handle_c && *handle_c) ? reinterpret_cast<const char*>(handle_c) : "Unknown";
             }
+
+            const std::string_view target = tapbackTargetGuid(reinterpret_cast<const char*>(guid_c));
+            std::vector<InstaReaction>& list = m_byGuid[std::string(target)];
+            list.erase(std::remove_if(list.begin(), list.end(),
+                                      [&](const InstaReaction& r) { return r.actor == actor; }),
+                       list.end());
+            if (type >= 3000)
+                continue;   // removal
+
+            std::string reaction;
+            if (const char* emoji = tapbackEmoji(type))
+                reaction = emoji;
+            else if (const unsigned char* custom = sqlite3_column_text(stmt.stmt, 4))
+                reaction = reinterpret_cast<const char*>(custom);
+            if (reaction.empty())
+                continue;   // stickers and unknown kinds
+
+            list.push_back({ std::move(actor), std::move(reaction) });
         }
+    }
+
+    // Reactions on the message with this GUID, or null.
+    const std::vector<InstaReaction>* find(std::string_view guid)
+    {
+        if (m_byGuid.empty() || guid.empty())
+            return nullptr;
+        m_key.assign(guid.data(), guid.size());
+        auto it = m_byGuid.find(m_key);
+        return (it == m_byGuid.end() || it->second.empty()) ? nullptr : &it->second;
+    }
 
-        info.participants.assign(partSet.begin(), partSet.end());
-        info.isGroup = (info.participants.size() > 1);
+private:
+    std::unordered_map<std::string, std::vector<InstaReaction>> m_byGuid;
+    std::string m_key;   // lookup buffer, reused across rows
+};
 
-        outChats.push_back(std::move(info));
+// ---------------------------
+// Per-chat export
+// ---------------------------
+
+// Append one row (see messageColumnsSql), starting at column `col`, to the
+// chunk writer. The body is `text`, or the string decoded from
+// attributedBody when text is empty; rows with neither are skipped.
+static void addMessageRow(sqlite3_stmt* stmt, int col, ReactionIndex& reactions,
+                          ChunkedExportWriter& writer)
+{
+    std::string_view text;
+    if (const unsigned char* text_c = sqlite3_column_text(stmt, col + 2))
+        text = std::string_view(reinterpret_cast<const char*>(text_c),
+                                static_cast<std::size_t>(sqlite3_column_bytes(stmt, col + 2)));
+    if (text.empty())
+    {
+        const void* blob = sqlite3_column_blob(stmt, col + 5);
+        text = decodeAttributedBody(blob, sqlite3_column_bytes(stmt, col + 5));
+        if (text.empty())
+            return;
+    }
+
+    const bool      isFromMe = sqlite3_column_int(stmt, col) != 0;
+    const long long rawDate  = sqlite3_column_int64(stmt, col + 1);
+
+    // For now, treat "me" as a fixed name "Me".
+    // If you later map this to the actual Instagram-style profile name,
+    // just change this string.
+    std::string_view sender = "Me";
+    if (!isFromMe)
+    {
+        const unsigned char* handle_c = sqlite3_column_text(stmt, col + 3);
+        sender = (handle_c && *handle_c) ? std::string_view(reinterpret_cast<const char*>(handle_c))
+                                         : std::string_view("Unknown");
     }
+
+    const std::vector<InstaReaction>* rowReactions = nullptr;
+    if (const unsigned char* guid_c = sqlite3_column_text(stmt, col + 6))
+        rowReactions = reactions.find(reinterpret_cast<const char*>(guid_c));
+
+    std::string error;
+    if (!writer.add(sender, appleTimeToUnixMs(rawDate), text, nullptr, rowReactions, {}, {}, error))
+        throw std::runtime_error(error);
 }
 
-bool GetImessageChats(
-    const std::string& backupRootOrDbPath,
-    std::vector<ImessageChatInfo>& outChats,
-    std::string& errorOut)
+// ---------------------------
+// Incremental export state
+// ---------------------------
+
+// Each export leaves "imessage_export.state" next to its chunks (not .json,
+// so the analyzer ignores it): the highest message.ROWID exported and how
+// many chunk files exist. An incremental run exports only rows above that
+// ROWID and appends them as new chunks. ROWIDs only grow (AUTOINCREMENT), and
+// the watermark message's GUID is re-checked so a different database, or a
+// rebuilt one, falls back to a full export.
+static const char* const WATERMARK_FILE = "imessage_export.state";
+
+struct ExportWatermark
 {
-    try
+    std::string chatGuid;
+    long long   lastRowId = 0;
+    std::string lastMessageGuid;
+    std::size_t chunks = 0;
+};
+
+static bool loadWatermark(const fs::path& folder, ExportWatermark& out)
+{
+    std::ifstream in(folder / WATERMARK_FILE, std::ios::binary);
+    if (!in)
+        return false;
+
+    ExportWatermark w;
+    std::string line;
+    while (std::getline(in, line))
     {
-        std::string dbPath = resolveDbPath(backupRootOrDbPath);
-        discoverChatsFromDb(dbPath, outChats);
-        errorOut.clear();
-        return true;
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            continue;
+        const std::string key   = line.substr(0, eq);
+        const std::string value = line.substr(eq + 1);
+        if (key == "chat_guid")              w.chatGuid = value;
+        else if (key == "last_rowid")        w.lastRowId = std::strtoll(value.c_str(), nullptr, 10);
+        else if (key == "last_message_guid") w.lastMessageGuid = value;
+        else if (key == "chunks")            w.chunks = static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10));
     }
-    catch (const std::exception& ex)
+    if (w.chatGuid.empty() || w.lastRowId <= 0 || w.chunks == 0)
+        return false;
+
+    out = std::move(w);
+    return true;
+}
+
+static void saveWatermark(const fs::path& folder, const ExportWatermark& w)
+{
+    const fs::path finalPath = folder / WATERMARK_FILE;
+    const fs::path tmpPath   = folder / (std::string(WATERMARK_FILE) + ".tmp");
     {
-        errorOut = ex.what();
-        outChats.clear();
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out << "chat_guid="         << w.chatGuid        << "\n"
+            << "last_rowid="        << w.lastRowId       << "\n"
+            << "last_message_guid=" << w.lastMessageGuid << "\n"
+            << "chunks="            << w.chunks          << "\n";
+        if (!out.flush())
+            throw std::runtime_error("Failed to write export state: " + tmpPath.u8string());
+    }
+    fs::rename(tmpPath, finalPath);
+}
+
+static std::string messageGuidForRowId(sqlite3* db, long long rowId)
+{
+    SqliteStmt stmt(db, "SELECT guid FROM message WHERE ROWID = ?");
+    sqlite3_bind_int64(stmt.stmt, 1, rowId);
+    if (sqlite3_step(stmt.stmt) != SQLITE_ROW)
+        return {};
+    const unsigned char* guid_c = sqlite3_column_text(stmt.stmt, 0);
+    return guid_c ? reinterpret_cast<const char*>(guid_c) : "";
+}
+
+// A watermark can be resumed when it belongs to this chat, its message still
+// carries the same GUID in this database, and the chunks it counts are there.
+static bool canResume(sqlite3* db, const fs::path& folder, const std::string& chatGuid,
+                      const ExportWatermark& w)
+{
+    if (w.chatGuid != chatGuid)
         return false;
+    if (messageGuidForRowId(db, w.lastRowId) != w.lastMessageGuid)
+        return false;
+    for (std::size_t i = 1; i <= w.chunks; ++i)
+    {
+        if (!fs::exists(folder / ("message_" + std::to_string(i) + ".json")))
+            return false;
     }
+    return true;
+}
+
+// Where the next export of `chatGuid` into `folder` starts: after the saved
+// watermark when resuming, otherwise from scratch.
+static ExportWatermark startingWatermark(sqlite3* db, const fs::path& folder,
+                                         const std::string& chatGuid, bool incremental)
+{
+    ExportWatermark w;
+    if (incremental && loadWatermark(folder, w) && canResume(db, folder, chatGuid, w))
+        return w;
+
+    w = ExportWatermark{};
+    w.chatGuid = chatGuid;
+    return w;
+}
+
+static void recordWatermark(sqlite3* db, const fs::path& folder, ExportWatermark w,
+                            long long maxRowId, const ChunkedExportWriter& writer)
+{
+    w.lastRowId       = maxRowId;
+    w.lastMessageGuid = messageGuidForRowId(db, maxRowId);
+    w.chunks          = writer.chunkCount();
+    saveWatermark(folder, w);
 }
 
 // ---------------------------
 // Per-chat export
 // ---------------------------
 
-// Load messages for a single chat GUID from the DB into InstaMessage array + participants set.
-static void loadMessagesForChat(
-    const std::string& dbPath,
-    const std::string& chatGuid,
-    std::vector<InstaMessage>& outMessages,
-    std::set<std::string>&     participants)
+static long long findChatRowId(sqlite3* db, const std::string& chatGuid)
 {
-    SqliteDb db(dbPath);
-
-    // 1) Look up the chat's ROWID by GUID.
     const char* SQL_FIND_CHAT = R"SQL(
         SELECT ROWID
         FROM chat
@@ -334,197 +825,425 @@ static void loadMessagesForChat(
         LIMIT 1
     )SQL";
 
-    SqliteStmt stmtFindChat(db.db, SQL_FIND_CHAT);
+    SqliteStmt stmtFindChat(db, SQL_FIND_CHAT);
     sqlite3_bind_text(stmtFindChat.stmt, 1, chatGuid.c_str(), -1, SQLITE_TRANSIENT);
 
-    int rc = sqlite3_step(stmtFindChat.stmt);
-    if (rc != SQLITE_ROW)
+    if (sqlite3_step(stmtFindChat.stmt) != SQLITE_ROW)
     {
         throw std::runtime_error("Chat GUID not found in chat table: " + chatGuid);
     }
+    return sqlite3_column_int64(stmtFindChat.stmt, 0);
+}
 
-    long long chatRowId = sqlite3_column_int64(stmtFindChat.stmt, 0);
-
-    // 2) Query all messages for that chat.
-    const char* SQL_MESSAGES = R"SQL(
-        SELECT
-            message.is_from_me,
-            message.date,
-            message.text,
-            handle.id
-        FROM chat_message_join
-        JOIN message ON message.ROWID = chat_message_join.message_id
-        LEFT JOIN handle ON handle.ROWID = message.handle_id
-        WHERE chat_message_join.chat_id = ?
-        ORDER BY message.date
-    )SQL";
-
-    SqliteStmt stmtMsgs(db.db, SQL_MESSAGES);
+// Stream the messages of one chat with ROWID above `afterRowId` and inside
+// `range`, oldest first, into the chunk writer. Returns the highest ROWID
+// read (`afterRowId` if there was nothing new).
+static long long exportMessagesForChat(
+    sqlite3*                 db,
+    const MessageSchema&     schema,
+    long long                chatRowId,
+    long long                afterRowId,
+    const ImessageTimeRange& range,
+    ChunkedExportWriter&     writer)
+{
+    // 1) Replay the chat's tapbacks, to attach them to their messages.
+    ReactionIndex reactions;
+    reactions.load(db, schema, chatRowId, afterRowId, range);
+
+    // 2) Query the chat's messages (all of them, or those after the watermark).
+    const std::string SQL_MESSAGES =
+        "SELECT " + messageColumnsSql(schema) + messageJoinSql(range) +
+        " LEFT JOIN handle ON handle.ROWID = message.handle_id"
+        " WHERE chat_message_join.chat_id = ?"
+        "   AND message.ROWID > ?"
+        "   AND " + messageFilterSql(schema, range) +
+        " ORDER BY message.date, message.ROWID";
+
+    SqliteStmt stmtMsgs(db, SQL_MESSAGES.c_str());
     sqlite3_bind_int64(stmtMsgs.stmt, 1, chatRowId);
+    sqlite3_bind_int64(stmtMsgs.stmt, 2, afterRowId);
 
+    long long maxRowId = afterRowId;
     while (true)
     {
-        rc = sqlite3_step(stmtMsgs.stmt);
+        const int rc = sqlite3_step(stmtMsgs.stmt);
         if (rc == SQLITE_DONE) break;
         if (rc != SQLITE_ROW)
         {
             std::string msg = "SQLite step error while reading messages: ";
-            msg += sqlite3_errmsg(db.db);
+            msg += sqlite3_errmsg(db);
             throw std::runtime_error(msg);
         }
 
-        int isFromMeInt = sqlite3_column_int(stmtMsgs.stmt, 0);
-        long long rawDate = sqlite3_column_int64(stmtMsgs.stmt, 1);
-        const unsigned char* text_c   = sqlite3_column_text(stmtMsgs.stmt, 2);
-        const unsigned char* handle_c = sqlite3_column_text(stmtMsgs.stmt, 3);
+        addMessageRow(stmtMsgs.stmt, 0, reactions, writer);
+        maxRowId = std::max(maxRowId, static_cast<long long>(sqlite3_column_int64(stmtMsgs.stmt, 4)));
+    }
+    return maxRowId;
+}
 
-        std::string text     = text_c   ? reinterpret_cast<const char*>(text_c)   : "";
-        std::string handleId = handle_c ? reinterpret_cast<const char*>(handle_c) : "";
-        bool isFromMe        = (isFromMeInt != 0);
+// Output sub-folder for a chat: its GUID with everything but letters,
+// digits, '-', '_', '.' and '+' replaced ("iMessage;+;chat123" becomes
+// "iMessage_+_chat123").
+static std::string chatFolderName(const std::string& guid)
+{
+    std::string out;
+    for (char c : guid)
+    {
+        const bool safe = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+                          (c >= 'A' && c <= 'Z') || c == '-' || c == '_' ||
+                          c == '.' || c == '+' || c == '@';
+        out.push_back(safe ? c : '_');
+    }
+    return out.empty() ? std::string("chat") : out;
+}
 
-        if (text.empty())
+bool ConvertImessageChatToInstagramFolder(
+    const std::string&       backupRootOrDbPath,
+    const std::string&       chatGuid,
+    const std::string&       outFolder,
+    std::string&             errorOut,
+    std::size_t              chunkSize,
+    bool                     incremental,
+    const ImessageTimeRange& range)
+{
+    try
+    {
+        if (chatGuid.empty())
         {
-            // Skip system/reaction messages with no text.
-            continue;
+            errorOut = "chatGuid is empty.";
+            return false;
         }
 
-        InstaMessage msgOut;
-
-        // For now, treat "me" as a fixed name "Me".
-        // If you later map this to the actual Instagram-style profile name,
-        // just change this string.
-        if (isFromMe)
-        {
-            msgOut.sender_name = "Me";
-        }
-        else
+        std::string dbPath = resolveDbPath(backupRootOrDbPath);
+        SqliteDb db(dbPath);
+
+        const fs::path folder = fs::u8path(outFolder);
+        // A time slice is a one-off: it neither resumes nor leaves state.
+        const bool keepState = !range.bounded();
+        const ExportWatermark mark = startingWatermark(db.db, folder, chatGuid, incremental && keepState);
+
+        // The query already returns messages oldest first, so rows go
+        // straight from the cursor into the chunk files.
+        ExportChunkOptions chunkOptions;
+        chunkOptions.threadPath     = "imessage/converted";
+        chunkOptions.threadType     = "Regular";
+        chunkOptions.chunkSize      = chunkSize;
+        chunkOptions.existingChunks = mark.chunks;
+        ChunkedExportWriter writer(outFolder, chunkOptions);
+
+        const long long maxRowId = exportMessagesForChat(db.db, detectMessageSchema(db.db),
+                                                         findChatRowId(db.db, chatGuid),
+                                                         mark.lastRowId, range, writer);
+
+        if (writer.messageCount() == 0)
         {
-            msgOut.sender_name = handleId.empty() ? "Unknown" : handleId;
+            if (mark.chunks > 0)
+            {
+                errorOut.clear();   // up to date: nothing new since the last export
+                return true;
+            }
+            errorOut = keepState ? "Selected chat has no text messages."
+                                 : "Selected chat has no text messages in the time range.";
+            return false;
         }
 
-        participants.insert(msgOut.sender_name);
+        if (!writer.finish(errorOut))
+            return false;
 
-        msgOut.timestamp_ms = appleTimeToUnixMs(rawDate);
-        msgOut.content      = text;
+        if (keepState)
+            recordWatermark(db.db, folder, mark, maxRowId, writer);
 
-        outMessages.push_back(std::move(msgOut));
+        errorOut.clear();
+        return true;
     }
+    catch (const std::exception& ex)
+    {
+        errorOut = ex.what();
+        return false;
+    }
+}
+
+// ---------------------------
+// Multi-chat export
+// ---------------------------
+
+// One chat of a multi-chat export and where it goes.
+struct ChatExport
+{
+    const ChatRow*        row = nullptr;
+    std::string           folder;          // sub-folder of outRoot
+    ExportWatermark       mark;            // where a previous export stopped
+    long long             rowCount = 0;    // chat_message_join rows, for scheduling
+    bool                  keepState = true;   // write imessage_export.state
+    ImessageExportSummary summary;
+    bool                  exported = false;
+};
+
+static ExportChunkOptions chatChunkOptions(const ChatExport& chat, std::size_t chunkSize)
+{
+    ExportChunkOptions options;
+    options.title          = chat.row->info.displayName;
+    options.threadPath     = "imessage/" + chat.folder;
+    options.threadType     = "Regular";
+    options.chunkSize      = chunkSize;
+    options.existingChunks = chat.mark.chunks;
+    return options;
 }
 
-// Write Instagram-style JSON chunks into outFolder.
-static bool writeInstagramStyleJson(
-    const std::vector<InstaMessage>& allMessages,
-    const std::set<std::string>&     participants,
-    const std::string&               outFolder,
-    std::string&                     errorOut)
+static void finishChatExport(sqlite3* db, ChatExport& chat, const fs::path& outFolder,
+                             long long maxRowId, ChunkedExportWriter& writer)
 {
-    try
+    std::string error;
+    if (!writer.finish(error))
+        throw std::runtime_error(error);
+    if (chat.keepState)
+        recordWatermark(db, outFolder, chat.mark, maxRowId, writer);
+    chat.summary.messageCount = writer.messageCount();
+    chat.exported = true;
+}
+
+// One thread: a single pass over every message. Rows come grouped by chat
+// and oldest first within a chat, so only one chat's writer is open at a
+// time. Rows at or below a chat's own watermark are dropped as they arrive.
+static void exportChatsSinglePass(sqlite3* db, std::vector<ChatExport>& chats,
+                                  const std::string& outRoot, std::size_t chunkSize,
+                                  const ImessageTimeRange& range)
+{
+    // chat ROWID -> position in `chats`
+    std::vector<std::pair<long long, std::size_t>> byRowId;
+    byRowId.reserve(chats.size());
+    long long minWatermark = 0;
+    for (std::size_t i = 0; i < chats.size(); ++i)
     {
-        fs::path outDir = fs::u8path(outFolder);
-        if (!fs::exists(outDir))
+        byRowId.emplace_back(chats[i].row->rowid, i);
+        minWatermark = (i == 0) ? chats[i].mark.lastRowId : std::min(minWatermark, chats[i].mark.lastRowId);
+    }
+    std::sort(byRowId.begin(), byRowId.end());
+
+    // Tapbacks point at messages by GUID, which is unique database-wide,
+    // so one index serves every chat.
+    const MessageSchema schema = detectMessageSchema(db);
+    ReactionIndex reactions;
+    reactions.load(db, schema, -1, minWatermark, range);
+
+    const std::string SQL_ALL_MESSAGES =
+        "SELECT chat_message_join.chat_id, " + messageColumnsSql(schema) + messageJoinSql(range) +
+        " LEFT JOIN handle ON handle.ROWID = message.handle_id"
+        " WHERE message.ROWID > ?"
+        "   AND " + messageFilterSql(schema, range) +
+        " ORDER BY chat_message_join.chat_id, message.date, message.ROWID";
+
+    SqliteStmt stmtMsgs(db, SQL_ALL_MESSAGES.c_str());
+    sqlite3_bind_int64(stmtMsgs.stmt, 1, minWatermark);
+
+    std::unique_ptr<ChunkedExportWriter> writer;
+    fs::path    outFolder;
+    long long   currentChat = -1;
+    ChatExport* chat        = nullptr;   // null for rows of chats not exported
+    long long   maxRowId    = 0;
+
+    auto finishChat = [&]()
+    {
+        if (!writer)
+            return;
+        finishChatExport(db, *chat, outFolder, maxRowId, *writer);
+        writer.reset();
+    };
+
+    while (true)
+    {
+        const int rc = sqlite3_step(stmtMsgs.stmt);
+        if (rc == SQLITE_DONE) break;
+        if (rc != SQLITE_ROW)
         {
-            fs::create_directories(outDir);
+            std::string msg = "SQLite step error while reading messages: ";
+            msg += sqlite3_errmsg(db);
+            throw std::runtime_error(msg);
         }
 
-        // Build participants array.
-        json participantsJson = json::array();
-        for (const auto& name : participants)
+        const long long chatId = sqlite3_column_int64(stmtMsgs.stmt, 0);
+        if (chatId != currentChat)
         {
-            json p;
-            p["name"] = name;
-            participantsJson.push_back(p);
+            finishChat();
+            currentChat = chatId;
+
+            auto it = std::lower_bound(byRowId.begin(), byRowId.end(),
+                                       std::make_pair(chatId, std::size_t(0)));
+            chat = (it == byRowId.end() || it->first != chatId) ? nullptr : &chats[it->second];
         }
 
-        const std::size_t CHUNK_SIZE = 5000;
-        std::size_t total  = allMessages.size();
-        std::size_t chunks = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (chunks == 0) chunks = 1;
+        const long long rowId = sqlite3_column_int64(stmtMsgs.stmt, 5);
+        if (!chat || rowId <= chat->mark.lastRowId)
+            continue;
 
-        for (std::size_t c = 0; c < chunks; ++c)
+        if (!writer)
         {
-            std::size_t start = c * CHUNK_SIZE;
-            std::size_t end   = std::min(start + CHUNK_SIZE, total);
-
-            json out;
-            out["participants"]         = participantsJson;
-            out["messages"]             = json::array();
-            out["title"]                = "";  // optional: fill in later if you want
-            out["is_still_participant"] = true;
-            out["thread_type"]          = "Regular";
-            out["thread_path"]          = "imessage/converted";
-            out["magic_words"]          = json::array();
-
-            for (std::size_t i = start; i < end; ++i)
-            {
-                const auto& im = allMessages[i];
-                json m;
-                m["sender_name"]  = im.sender_name;
-                m["timestamp_ms"] = im.timestamp_ms;
-                m["content"]      = im.content;
-                out["messages"].push_back(std::move(m));
-            }
-
-            std::ostringstream oss;
-            oss << "message_" << (c + 1) << ".json";
-            fs::path outPath = outDir / fs::u8path(oss.str());
+            outFolder = fs::u8path(outRoot) / fs::u8path(chat->folder);
+            writer.reset(new ChunkedExportWriter(outFolder.u8string(), chatChunkOptions(*chat, chunkSize)));
+            maxRowId = 0;
+        }
 
-            std::ofstream ofs(outPath, std::ios::binary);
-            if (!ofs)
-            {
-                errorOut = "Failed to open output file: " + outPath.string();
-                return false;
-            }
+        addMessageRow(stmtMsgs.stmt, 1, reactions, *writer);
+        maxRowId = std::max(maxRowId, rowId);
+    }
+    finishChat();
+}
 
-            ofs << out.dump(2);
-        }
+static void countChatRows(sqlite3* db, std::vector<ChatExport>& chats)
+{
+    std::vector<std::pair<long long, long long>> counts;   // chat ROWID, rows
+    SqliteStmt stmt(db, "SELECT chat_id, COUNT(*) FROM chat_message_join GROUP BY chat_id ORDER BY chat_id");
+    while (sqlite3_step(stmt.stmt) == SQLITE_ROW)
+        counts.emplace_back(sqlite3_column_int64(stmt.stmt, 0), sqlite3_column_int64(stmt.stmt, 1));
 
-        errorOut.clear();
-        return true;
+    for (auto& chat : chats)
+    {
+        auto it = std::lower_bound(counts.begin(), counts.end(),
+                                   std::make_pair(chat.row->rowid, 0LL));
+        chat.rowCount = (it != counts.end() && it->first == chat.row->rowid) ? it->second : 0;
     }
-    catch (const std::exception& ex)
+}
+
+// Several threads: each worker opens its own read-only connection to the
+// database and exports whole chats, one query per chat, into their own
+// writers. Chats are handed out largest first so a huge chat picked up
+// last cannot leave the other cores idle at the end.
+static void exportChatsInParallel(const std::string& dbPath, sqlite3* db,
+                                  std::vector<ChatExport>& chats,
+                                  const std::string& outRoot, std::size_t chunkSize,
+                                  const ImessageTimeRange& range, unsigned threads)
+{
+    countChatRows(db, chats);
+
+    std::vector<std::size_t> order(chats.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
     {
-        errorOut = ex.what();
-        return false;
+        return chats[a].rowCount > chats[b].rowCount;
+    });
+
+    fs::create_directories(fs::u8path(outRoot));
+
+    const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threads, chats.size()));
+    std::atomic<std::size_t> next{ 0 };
+    std::atomic<bool>        failed{ false };
+
+    WorkStealingPool pool(workers);
+    for (unsigned w = 0; w < workers; ++w)
+    {
+        pool.submit([&]
+        {
+            try
+            {
+                SqliteDb conn(dbPath);
+                const MessageSchema schema = detectMessageSchema(conn.db);
+
+                for (std::size_t i; !failed && (i = next++) < order.size(); )
+                {
+                    ChatExport& chat = chats[order[i]];
+                    const fs::path outFolder = fs::u8path(outRoot) / fs::u8path(chat.folder);
+
+                    ChunkedExportWriter writer(outFolder.u8string(), chatChunkOptions(chat, chunkSize));
+                    const long long maxRowId = exportMessagesForChat(conn.db, schema, chat.row->rowid,
+                                                                     chat.mark.lastRowId, range, writer);
+                    if (writer.messageCount() > 0)
+                        finishChatExport(conn.db, chat, outFolder, maxRowId, writer);
+                }
+            }
+            catch (...)
+            {
+                failed = true;   // let the other workers stop early
+                throw;           // rethrown by wait()
+            }
+        });
     }
+    pool.wait();
 }
 
-bool ConvertImessageChatToInstagramFolder(
-    const std::string& backupRootOrDbPath,
-    const std::string& chatGuid,
-    const std::string& outFolder,
-    std::string&       errorOut)
+// Export `selection` (chat GUIDs), or every chat when it is null.
+static bool exportImessageChats(
+    const std::string&                  backupRootOrDbPath,
+    const std::vector<std::string>*     selection,
+    const std::string&                  outRoot,
+    std::vector<ImessageExportSummary>& chatsOut,
+    std::string&                        errorOut,
+    std::size_t                         chunkSize,
+    bool                                incremental,
+    const ImessageTimeRange&            range)
 {
     try
     {
-        if (chatGuid.empty())
+        std::string dbPath = resolveDbPath(backupRootOrDbPath);
+        SqliteDb db(dbPath);
+
+        std::vector<ChatRow> rows;
+        discoverChatRows(db.db, rows);
+
+        std::vector<char> picked(rows.size(), selection ? 0 : 1);
+        if (selection)
         {
-            errorOut = "chatGuid is empty.";
-            return false;
+            for (const auto& guid : *selection)
+            {
+                auto it = std::find_if(rows.begin(), rows.end(),
+                                       [&](const ChatRow& r) { return r.info.guid == guid; });
+                if (it == rows.end())
+                    throw std::runtime_error("Chat GUID not found in chat table: " + guid);
+                picked[static_cast<std::size_t>(it - rows.begin())] = 1;
+            }
         }
 
-        std::string dbPath = resolveDbPath(backupRootOrDbPath);
+        // Output folders are named over every chat in ROWID order, so a chat
+        // keeps its folder whichever subset is exported. An incremental run
+        // also needs each chat's previous watermark.
+        std::set<std::string>   usedFolders;
+        std::vector<ChatExport> chats;
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            std::string folder = chatFolderName(rows[i].info.guid);
+            for (int n = 2; !usedFolders.insert(folder).second; ++n)
+                folder = chatFolderName(rows[i].info.guid) + "_" + std::to_string(n);
+            if (!picked[i])
+                continue;
+
+            ChatExport chat;
+            chat.row       = &rows[i];
+            chat.keepState = !range.bounded();
+            chat.mark      = startingWatermark(db.db, fs::u8path(outRoot) / fs::u8path(folder),
+                                               rows[i].info.guid, incremental && chat.keepState);
+            chat.summary.guid        = rows[i].info.guid;
+            chat.summary.displayName = rows[i].info.displayName;
+            chat.summary.folder      = folder;
+            chat.folder = std::move(folder);
+            chats.push_back(std::move(chat));
+        }
 
-        std::vector<InstaMessage> allMessages;
-        std::set<std::string>     participants;
+        const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        if (!chats.empty())
+        {
+            if (threads < 2 && !selection)
+                exportChatsSinglePass(db.db, chats, outRoot, chunkSize, range);
+            else
+                exportChatsInParallel(dbPath, db.db, chats, outRoot, chunkSize, range, threads);
+        }
 
-        loadMessagesForChat(dbPath, chatGuid, allMessages, participants);
+        std::vector<ImessageExportSummary> summaries;
+        for (auto& chat : chats)
+        {
+            if (chat.exported)
+                summaries.push_back(std::move(chat.summary));
+        }
 
-        if (allMessages.empty())
+        if (summaries.empty() && !incremental)
         {
-            errorOut = "Selected chat has no text messages.";
+            errorOut = selection ? "None of the selected chats has text messages."
+                                 : "No chat in the database has text messages.";
             return false;
         }
 
-        // Ensure chronological order (just in case).
-        std::sort(
-            allMessages.begin(),
-            allMessages.end(),
-            [](const InstaMessage& a, const InstaMessage& b)
-            {
-                return a.timestamp_ms < b.timestamp_ms;
-            });
-
-        return writeInstagramStyleJson(allMessages, participants, outFolder, errorOut);
+        chatsOut = std::move(summaries);
+        errorOut.clear();
+        return true;
     }
     catch (const std::exception& ex)
     {
@@ -532,3 +1251,30 @@ bool ConvertImessageChatToInstagramFolder(
         return false;
     }
 }
+
+bool ConvertImessageChatsToInstagramFolders(
+    const std::string&                     backupRootOrDbPath,
+    const std::string&                     outRoot,
+    std::vector<ImessageExportSummary>&    chatsOut,
+    std::string&                           errorOut,
+    std::size_t                            chunkSize,
+    bool                                   incremental,
+    const ImessageTimeRange&               range)
+{
+    return exportImessageChats(backupRootOrDbPath, nullptr, outRoot, chatsOut, errorOut,
+                               chunkSize, incremental, range);
+}
+
+bool ConvertImessageChatsToInstagramFolders(
+    const std::string&                     backupRootOrDbPath,
+    const std::vector<std::string>&        chatGuids,
+    const std::string&                     outRoot,
+    std::vector<ImessageExportSummary>&    chatsOut,
+    std::string&                           errorOut,
+    std::size_t                            chunkSize,
+    bool                                   incremental,
+    const ImessageTimeRange&               range)
+{
+    return exportImessageChats(backupRootOrDbPath, &chatGuids, outRoot, chatsOut, errorOut,
+                               chunkSize, incremental, range);
+}
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+#include "export_writer.hpp"
+
 // Basic info about an iMessage chat (conversation) discovered in chat.db.
 struct ImessageChatInfo
 {
@@ -31,6 +34,19 @@ bool GetImessageChats(
     std::string& errorOut
 );
 
+// Optional time window for an export, in Unix milliseconds: the messages
+// with fromMs <= timestamp_ms < toMs. A side is open unless its has* flag
+// is set, so 0 (1970-01-01) is a bound like any other.
+struct ImessageTimeRange
+{
+    long long fromMs  = 0;
+    long long toMs    = 0;
+    bool      hasFrom = false;
+    bool      hasTo   = false;
+
+    bool bounded() const { return hasFrom || hasTo; }
+};
+
 // Export a single chat (chosen by GUID) into an Instagram-style folder that
 // Count_Messages.cpp can consume.
 //
@@ -43,9 +59,71 @@ bool GetImessageChats(
 // outFolder:
 //   - Folder to create/write Instagram-style message_#.json files into.
 //
+// chunkSize:
+//   - Messages per output message_#.json file.
+//
+// incremental:
+//   - Every export records the highest message ROWID it wrote in
+//     outFolder/imessage_export.state. With incremental set, a previous
+//     export of the same chat from the same database is resumed: only newer
+//     messages are read, and they are appended as new message_#.json chunks
+//     (an up-to-date folder is left untouched). Otherwise, or when the state
+//     does not match, the chat is exported in full.
+//
+// range:
+//   - Only export messages inside this window. The bounds are turned into
+//     message.date conditions, so the database's date index does the
+//     filtering. A windowed export is a one-off slice: it neither resumes
+//     from nor records imessage_export.state.
+//
 bool ConvertImessageChatToInstagramFolder(
-    const std::string& backupRootOrDbPath,
-    const std::string& chatGuid,
-    const std::string& outFolder,
-    std::string&       errorOut
+    const std::string&       backupRootOrDbPath,
+    const std::string&       chatGuid,
+    const std::string&       outFolder,
+    std::string&             errorOut,
+    std::size_t              chunkSize = DEFAULT_EXPORT_CHUNK_SIZE,
+    bool                     incremental = false,
+    const ImessageTimeRange& range = ImessageTimeRange()
+);
+
+struct ImessageExportSummary
+{
+    std::string guid;
+    std::string displayName;
+    std::string folder;          // sub-folder of outRoot holding the chunks
+    std::size_t messageCount = 0;   // written by this run
+};
+
+// Export every chat with text messages. Each chat gets a sub-folder of
+// outRoot named after its GUID (see chatsOut), and is streamed into its own
+// chunk writer. On a multi-core machine the chats are spread over one worker
+// per core, largest first, each worker with its own read-only connection to
+// the database; on a single core one query joining
+// chat_message_join/message/handle, ordered by chat and date, does it in a
+// single pass.
+//
+// incremental and range work per chat folder as for
+// ConvertImessageChatToInstagramFolder; chatsOut then lists only the chats
+// that had new messages (or messages in the range).
+bool ConvertImessageChatsToInstagramFolders(
+    const std::string&                  backupRootOrDbPath,
+    const std::string&                  outRoot,
+    std::vector<ImessageExportSummary>& chatsOut,
+    std::string&                        errorOut,
+    std::size_t                         chunkSize = DEFAULT_EXPORT_CHUNK_SIZE,
+    bool                                incremental = false,
+    const ImessageTimeRange&            range = ImessageTimeRange()
+);
+
+// Same, for the chats picked from GetImessageChats (by GUID), always
+// exported in parallel. Folder names match the all-chats export.
+bool ConvertImessageChatsToInstagramFolders(
+    const std::string&                  backupRootOrDbPath,
+    const std::vector<std::string>&     chatGuids,
+    const std::string&                  outRoot,
+    std::vector<ImessageExportSummary>& chatsOut,
+    std::string&                        errorOut,
+    std::size_t                         chunkSize = DEFAULT_EXPORT_CHUNK_SIZE,
+    bool                                incremental = false,
+    const ImessageTimeRange&            range = ImessageTimeRange()
 );
@@ -0,0 +1,273 @@
+// json_writer.cpp
+#include "json_writer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+
+JsonWriter::JsonWriter(std::ostream& out, int indent)
+    : m_out(&out), m_indent(indent)
+{
+    m_buf.reserve(FLUSH_THRESHOLD + 4096);
+}
+
+JsonWriter::JsonWriter(int indent)
+    : m_out(nullptr), m_indent(indent)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+void JsonWriter::flush()
+{
+    if (m_out && !m_buf.empty())
+    {
+        m_out->write(m_buf.data(), static_cast<std::streamsize>(m_buf.size()));
+        m_buf.clear();
+    }
+}
+
+void JsonWriter::maybeFlush()
+{
+    if (m_out && m_buf.size() >= FLUSH_THRESHOLD)
+        flush();
+}
+
+void JsonWriter::newline()
+{
+    if (m_indent <= 0)
+        return;
+    m_buf.push_back('\n');
+    m_buf.append(m_stack.size() * static_cast<std::size_t>(m_indent), ' ');
+}
+
+void JsonWriter::beforeValue()
+{
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+    if (!m_stack.empty())
+    {
+        if (m_stack.back().count++ > 0)
+            m_buf.push_back(',');
+        newline();
+    }
+}
+
+void JsonWriter::key(std::string_view name)
+{
+    if (!m_stack.empty() && m_stack.back().count++ > 0)
+        m_buf.push_back(',');
+    newline();
+    appendEscaped(m_buf, name);
+    m_buf.push_back(':');
+    if (m_indent > 0)
+        m_buf.push_back(' ');
+    m_afterKey = true;
+}
+
+void JsonWriter::beginObject()
+{
+    beforeValue();
+    m_buf.push_back('{');
+    m_stack.push_back({ true, 0 });
+}
+
+void JsonWriter::endObject()
+{
+    bool hadItems = m_stack.back().count > 0;
+    m_stack.pop_back();
+    if (hadItems)
+        newline();
+    m_buf.push_back('}');
+    if (m_stack.empty() && m_indent > 0)
+        m_buf.push_back('\n');
+    maybeFlush();
+}
+
+void JsonWriter::beginArray()
+{
+    beforeValue();
+    m_buf.push_back('[');
+    m_stack.push_back({ false, 0 });
+}
+
+void JsonWriter::endArray()
+{
+    bool hadItems = m_stack.back().count > 0;
+    m_stack.pop_back();
+    if (hadItems)
+        newline();
+    m_buf.push_back(']');
+    maybeFlush();
+}
+
+void JsonWriter::value(std::string_view s)
+{
+    beforeValue();
+    appendEscaped(m_buf, s);
+    maybeFlush();
+}
+
+void JsonWriter::value(long long v)
+{
+    beforeValue();
+    char tmp[32];
+    int n = std::snprintf(tmp, sizeof(tmp), "%lld", v);
+    m_buf.append(tmp, static_cast<std::size_t>(n));
+}
+
+void JsonWriter::value(unsigned long long v)
+{
+    beforeValue();
+    char tmp[32];
+    int n = std::snprintf(tmp, sizeof(tmp), "%llu", v);
+    m_buf.append(tmp, static_cast<std::size_t>(n));
+}
+
+void JsonWriter::value(double v)
+{
+    beforeValue();
+    if (!std::isfinite(v))
+    {
+        m_buf.append("null");
+        return;
+    }
+
+    // Shortest of %.15g / %.17g that round-trips.
+    char tmp[40];
+    int n = std::snprintf(tmp, sizeof(tmp), "%.15g", v);
+    if (std::strtod(tmp, nullptr) != v)
+        n = std::snprintf(tmp, sizeof(tmp), "%.17g", v);
+    m_buf.append(tmp, static_cast<std::size_t>(n));
+}
+
+void JsonWriter::value(bool v)
+{
+    beforeValue();
+    m_buf.append(v ? "true" : "false");
+}
+
+void JsonWriter::null()
+{
+    beforeValue();
+    m_buf.append("null");
+}
+
+// Length of the valid UTF-8 sequence starting at s[i] (lead byte >= 0x80),
+// or 0 if it is malformed, overlong, a surrogate or out of range.
+static std::size_t validUtf8Length(std::string_view s, std::size_t i)
+{
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    std::size_t len = 0;
+    unsigned char lo = 0x80, hi = 0xBF;   // allowed range of the second byte
+    if (c >= 0xC2 && c <= 0xDF)      len = 2;
+    else if (c == 0xE0)            { len = 3; lo = 0xA0; }
+    else if (c == 0xED)            { len = 3; hi = 0x9F; }
+    else if (c >= 0xE1 && c <= 0xEF) len = 3;
+    else if (c == 0xF0)            { len = 4; lo = 0x90; }
+    else if (c == 0xF4)            { len = 4; hi = 0x8F; }
+    else if (c >= 0xF1 && c <= 0xF3) len = 4;
+    else
+        return 0;
+
+    if (s.size() - i < len)
+        return 0;
+    const unsigned char c1 = static_cast<unsigned char>(s[i + 1]);
+    if (c1 < lo || c1 > hi)
+        return 0;
+    for (std::size_t k = 2; k < len; ++k)
+    {
+        if ((static_cast<unsigned char>(s[i + k]) & 0xC0) != 0x80)
+            return 0;
+    }
+    return len;
+}
+
+// True if any of the 8 bytes in w is < 0x20, '"', '\\' or >= 0x80.
+static inline bool wordNeedsAttention(std::uint64_t w)
+{
+    constexpr std::uint64_t ONES  = 0x0101010101010101ull;
+    constexpr std::uint64_t HIGHS = 0x8080808080808080ull;
+    auto hasZero = [](std::uint64_t v) { return (v - ONES) & ~v & HIGHS; };
+
+    const std::uint64_t control = (w - ONES * 0x20) & ~w & HIGHS;
+    return (control | hasZero(w ^ (ONES * '"')) | hasZero(w ^ (ONES * '\\')) | (w & HIGHS)) != 0;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view s)
+{
+    static const char HEX[] = "0123456789abcdef";
+
+    out.push_back('"');
+
+    // Copy runs of plain bytes in one go, scanning eight at a time; only stop
+    // at '"', '\\', controls and non-ASCII (which is validated as UTF-8).
+    std::size_t runStart = 0;
+    std::size_t i = 0;
+    while (i < s.size())
+    {
+        if (s.size() - i >= 8)
+        {
+            std::uint64_t w;
+            std::memcpy(&w, s.data() + i, 8);
+            if (!wordNeedsAttention(w))
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+        {
+            ++i;
+            continue;
+        }
+
+        if (c >= 0x80)
+        {
+            std::size_t len = validUtf8Length(s, i);
+            if (len)
+            {
+                i += len;
+                continue;
+            }
+            out.append(s.data() + runStart, i - runStart);
+            out.append("\xEF\xBF\xBD");   // U+FFFD
+            runStart = ++i;
+            continue;
+        }
+
+        out.append(s.data() + runStart, i - runStart);
+        runStart = ++i;
+
+        switch (c)
+        {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n");  break;
+        case '\r': out.append("\\r");  break;
+        case '\t': out.append("\\t");  break;
+        case '\b': out.append("\\b");  break;
+        case '\f': out.append("\\f");  break;
+        default:
+            out.append("\\u00");
+            out.push_back(HEX[c >> 4]);
+            out.push_back(HEX[c & 0xF]);
+            break;
+        }
+    }
+    out.append(s.data() + runStart, s.size() - runStart);
+
+    out.push_back('"');
+}
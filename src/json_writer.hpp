@@ -0,0 +1,83 @@
+// json_writer.hpp
+// Streaming JSON writer: emits text directly into a buffer that is flushed to
+// an std::ostream, without building a DOM first.
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class JsonWriter
+{
+public:
+    // indent == 0 writes compact single-line JSON (suitable for JSONL);
+    // indent > 0 pretty-prints with that many spaces per level.
+    explicit JsonWriter(std::ostream& out, int indent = 0);
+
+    // In-memory writer: nothing is flushed; collect the text with take().
+    explicit JsonWriter(int indent);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Inside an object, every value must be preceded by key().
+    void key(std::string_view name);
+
+    void value(std::string_view s);
+    void value(const char* s) { value(std::string_view(s)); }
+    void value(const std::string& s) { value(std::string_view(s)); }
+    void value(long long v);
+    void value(long v) { value(static_cast<long long>(v)); }
+    void value(int v) { value(static_cast<long long>(v)); }
+    void value(unsigned long long v);
+    void value(unsigned long v) { value(static_cast<unsigned long long>(v)); }
+    void value(unsigned v) { value(static_cast<unsigned long long>(v)); }
+    void value(double v);   // NaN / infinity are written as null
+    void value(bool v);
+    void null();
+
+    // key() + value() in one call.
+    template <typename T>
+    void field(std::string_view name, const T& v)
+    {
+        key(name);
+        value(v);
+    }
+
+    // Push buffered text to the stream (no-op for an in-memory writer).
+    void flush();
+
+    // Hand over everything written so far (in-memory writers only).
+    std::string take() { return std::move(m_buf); }
+
+    // Append `s` to `out` as a quoted JSON string. Valid UTF-8 is copied
+    // through unchanged; malformed bytes become U+FFFD so the output always
+    // parses.
+    static void appendEscaped(std::string& out, std::string_view s);
+
+private:
+    struct Scope
+    {
+        bool        isObject;
+        std::size_t count;
+    };
+
+    void beforeValue();
+    void newline();
+    void maybeFlush();
+
+    std::ostream*      m_out;
+    int                m_indent;
+    std::string        m_buf;
+    std::vector<Scope> m_stack;
+    bool               m_afterKey = false;
+};
@@ -0,0 +1,37 @@
+// mapped_file.hpp
+// Read-only memory-mapped view of a whole file (Win32 and POSIX).
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map `path` (UTF-8). An empty file maps successfully with size() == 0.
+    // Returns false and fills errorOut on failure.
+    bool open(const std::string& path, std::string& errorOut);
+    void close();
+
+    const char*      data() const { return m_data; }
+    std::size_t      size() const { return m_size; }
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file    = nullptr;   // HANDLE
+    void* m_mapping = nullptr;   // HANDLE
+#else
+    int   m_fd      = -1;
+#endif
+};
@@ -0,0 +1,413 @@
+// message_scores.cpp
+#include "message_scores.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const char MAGIC[8] = { 'C','H','A','T','C','O','L','1' };
+static const char* LATENCY_COLUMN = "reply_latency_ms";
+
+// The format is little-endian and written straight from memory.
+static bool HostIsLittleEndian()
+{
+    const std::uint16_t probe = 1;
+    return *reinterpret_cast<const std::uint8_t*>(&probe) == 1;
+}
+
+struct ColumnSpec
+{
+    std::string                     name;
+    MessageScoreWriter::ColumnType  type;
+};
+
+static std::vector<ColumnSpec> ScoreColumns()
+{
+    std::vector<ColumnSpec> cols = {
+        { "timestamp_ms",   MessageScoreWriter::COL_I64 },
+        { "sender_id",      MessageScoreWriter::COL_U32 },
+        { "word_count",     MessageScoreWriter::COL_U32 },
+        { "romantic",       MessageScoreWriter::COL_U8  },
+        { "vader_neg",      MessageScoreWriter::COL_F64 },
+        { "vader_neu",      MessageScoreWriter::COL_F64 },
+        { "vader_pos",      MessageScoreWriter::COL_F64 },
+        { "vader_compound", MessageScoreWriter::COL_F64 },
+    };
+    for (int i = 0; i < NrcEmotionLexicon::DIMENSIONS; ++i)
+        cols.push_back({ std::string("nrc_") + NrcEmotionLexicon::CATEGORY_NAMES[i],
+                         MessageScoreWriter::COL_F32 });
+    return cols;
+}
+
+static std::size_t ColumnWidth(std::uint8_t type)
+{
+    switch (type)
+    {
+    case MessageScoreWriter::COL_I64: return 8;
+    case MessageScoreWriter::COL_U32: return 4;
+    case MessageScoreWriter::COL_U8:  return 1;
+    case MessageScoreWriter::COL_F64: return 8;
+    case MessageScoreWriter::COL_F32: return 4;
+    default:                          return 0;
+    }
+}
+
+// ------------------------------------------------------------
+// Writer
+// ------------------------------------------------------------
+bool MessageScoreWriter::open(const std::string& path, std::string& errorOut)
+{
+    if (!HostIsLittleEndian())
+    {
+        errorOut = "Per-message score files are only supported on little-endian hosts.";
+        return false;
+    }
+
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_out)
+    {
+        errorOut = "Could not open per-message score file: " + path;
+        return false;
+    }
+    m_path = path;
+
+    const std::vector<ColumnSpec> cols = ScoreColumns();
+    m_out.write(MAGIC, sizeof(MAGIC));
+    writeRaw(static_cast<std::uint32_t>(cols.size()));
+    for (const auto& c : cols)
+    {
+        writeRaw(static_cast<std::uint8_t>(c.type));
+        writeRaw(static_cast<std::uint16_t>(c.name.size()));
+        m_out.write(c.name.data(), static_cast<std::streamsize>(c.name.size()));
+    }
+
+    m_timestamp.reserve(ROWS_PER_GROUP);
+    m_sender.reserve(ROWS_PER_GROUP);
+    m_words.reserve(ROWS_PER_GROUP);
+    m_romantic.reserve(ROWS_PER_GROUP);
+    for (auto& v : m_vader) v.reserve(ROWS_PER_GROUP);
+    for (auto& v : m_nrc)   v.reserve(ROWS_PER_GROUP);
+    return true;
+}
+
+std::uint64_t MessageScoreWriter::append(const MessageScoreRow& row)
+{
+    std::uint32_t senderId = 0;
+    if (row.sender)
+    {
+        auto it = m_senderIds.find(*row.sender);
+        if (it == m_senderIds.end())
+        {
+            it = m_senderIds.emplace(*row.sender,
+                                     static_cast<std::uint32_t>(m_senderNames.size())).first;
+            m_senderNames.push_back(&it->first);
+        }
+        senderId = it->second;
+    }
+
+    m_timestamp.push_back(row.timestampMs);
+    m_sender.push_back(senderId);
+    m_words.push_back(static_cast<std::uint32_t>(row.wordCount));
+    m_romantic.push_back(row.romantic ? 1 : 0);
+    m_vader[0].push_back(row.vaderNeg);
+    m_vader[1].push_back(row.vaderNeu);
+    m_vader[2].push_back(row.vaderPos);
+    m_vader[3].push_back(row.vaderCompound);
+    for (int i = 0; i < NrcEmotionLexicon::DIMENSIONS; ++i)
+        m_nrc[i].push_back(static_cast<float>(row.nrc[i]));
+
+    if (m_timestamp.size() >= ROWS_PER_GROUP)
+        flushGroup();
+
+    return m_rows++;
+}
+
+void MessageScoreWriter::flushGroup()
+{
+    if (m_timestamp.empty())
+        return;
+
+    m_out.write("RGRP", 4);
+    writeRaw(static_cast<std::uint32_t>(m_timestamp.size()));
+    writeColumn(m_timestamp);
+    writeColumn(m_sender);
+    writeColumn(m_words);
+    writeColumn(m_romantic);
+    for (const auto& v : m_vader) writeColumn(v);
+    for (const auto& v : m_nrc)   writeColumn(v);
+
+    m_timestamp.clear();
+    m_sender.clear();
+    m_words.clear();
+    m_romantic.clear();
+    for (auto& v : m_vader) v.clear();
+    for (auto& v : m_nrc)   v.clear();
+}
+
+bool MessageScoreWriter::finish(const std::vector<long long>& replyLatencyMs, std::string& errorOut)
+{
+    flushGroup();
+
+    const std::uint64_t tcolOffset = static_cast<std::uint64_t>(m_out.tellp());
+    m_out.write("TCOL", 4);
+    writeRaw(static_cast<std::uint8_t>(COL_I64));
+    writeRaw(static_cast<std::uint16_t>(std::strlen(LATENCY_COLUMN)));
+    m_out.write(LATENCY_COLUMN, static_cast<std::streamsize>(std::strlen(LATENCY_COLUMN)));
+    writeRaw(m_rows);
+    for (std::uint64_t r = 0; r < m_rows; ++r)
+    {
+        std::int64_t v = (r < replyLatencyMs.size()) ? replyLatencyMs[r] : -1;
+        writeRaw(v);
+    }
+
+    const std::uint64_t dictOffset = static_cast<std::uint64_t>(m_out.tellp());
+    m_out.write("DICT", 4);
+    writeRaw(static_cast<std::uint32_t>(m_senderNames.size()));
+    for (const std::string* name : m_senderNames)
+    {
+        writeRaw(static_cast<std::uint32_t>(name->size()));
+        m_out.write(name->data(), static_cast<std::streamsize>(name->size()));
+    }
+
+    writeRaw(tcolOffset);
+    writeRaw(dictOffset);
+    m_out.write(MAGIC, sizeof(MAGIC));
+
+    m_out.close();
+    if (!m_out)
+    {
+        errorOut = "Failed while writing per-message score file: " + m_path;
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// CSV export
+// ------------------------------------------------------------
+template <typename T>
+static bool ReadRaw(std::istream& in, T& v)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+static void AppendCsvText(std::string& line, const std::string& field)
+{
+    if (field.find_first_of(",\"\r\n") == std::string::npos)
+    {
+        line += field;
+        return;
+    }
+    line.push_back('"');
+    for (char c : field)
+    {
+        if (c == '"') line.push_back('"');
+        line.push_back(c);
+    }
+    line.push_back('"');
+}
+
+static void AppendCsvNumber(std::string& line, const unsigned char* p, std::uint8_t type)
+{
+    char tmp[40];
+    int n = 0;
+    switch (type)
+    {
+    case MessageScoreWriter::COL_I64:
+    {
+        std::int64_t v; std::memcpy(&v, p, 8);
+        n = std::snprintf(tmp, sizeof(tmp), "%lld", static_cast<long long>(v));
+        break;
+    }
+    case MessageScoreWriter::COL_U32:
+    {
+        std::uint32_t v; std::memcpy(&v, p, 4);
+        n = std::snprintf(tmp, sizeof(tmp), "%u", static_cast<unsigned>(v));
+        break;
+    }
+    case MessageScoreWriter::COL_U8:
+        n = std::snprintf(tmp, sizeof(tmp), "%u", static_cast<unsigned>(*p));
+        break;
+    case MessageScoreWriter::COL_F64:
+    {
+        double v; std::memcpy(&v, p, 8);
+        n = std::snprintf(tmp, sizeof(tmp), "%.15g", v);
+        if (std::strtod(tmp, nullptr) != v)
+            n = std::snprintf(tmp, sizeof(tmp), "%.17g", v);
+        break;
+    }
+    case MessageScoreWriter::COL_F32:
+    {
+        float v; std::memcpy(&v, p, 4);
+        n = std::snprintf(tmp, sizeof(tmp), "%.9g", static_cast<double>(v));
+        break;
+    }
+    }
+    line.append(tmp, static_cast<std::size_t>(n > 0 ? n : 0));
+}
+
+bool ConvertMessageScoresToCsv(
+    const std::string& columnarPath,
+    const std::string& csvPath,
+    std::string&       errorOut)
+{
+    std::ifstream in(columnarPath, std::ios::binary);
+    std::ifstream latencyIn(columnarPath, std::ios::binary);
+    if (!in || !latencyIn)
+    {
+        errorOut = "Could not open per-message score file: " + columnarPath;
+        return false;
+    }
+
+    auto corrupt = [&]() {
+        errorOut = "Corrupt per-message score file: " + columnarPath;
+        return false;
+    };
+
+    // Trailer -> sender dictionary and the latency column.
+    char magic[8];
+    std::uint64_t tcolOffset = 0, dictOffset = 0;
+    in.seekg(-static_cast<std::streamoff>(8 + 16), std::ios::end);
+    if (!ReadRaw(in, tcolOffset) || !ReadRaw(in, dictOffset) ||
+        !in.read(magic, 8) || std::memcmp(magic, MAGIC, 8) != 0)
+        return corrupt();
+
+    std::vector<std::string> senders;
+    {
+        in.seekg(static_cast<std::streamoff>(dictOffset));
+        char tag[4];
+        std::uint32_t count = 0;
+        if (!in.read(tag, 4) || std::memcmp(tag, "DICT", 4) != 0 || !ReadRaw(in, count))
+            return corrupt();
+        senders.resize(count);
+        for (auto& name : senders)
+        {
+            std::uint32_t len = 0;
+            if (!ReadRaw(in, len))
+                return corrupt();
+            name.resize(len);
+            if (len && !in.read(&name[0], len))
+                return corrupt();
+        }
+    }
+
+    std::uint64_t latencyRows = 0;
+    {
+        latencyIn.seekg(static_cast<std::streamoff>(tcolOffset));
+        char tag[4];
+        std::uint8_t type = 0;
+        std::uint16_t nameLen = 0;
+        if (!latencyIn.read(tag, 4) || std::memcmp(tag, "TCOL", 4) != 0 ||
+            !ReadRaw(latencyIn, type) || !ReadRaw(latencyIn, nameLen))
+            return corrupt();
+        latencyIn.seekg(nameLen, std::ios::cur);
+        if (type != MessageScoreWriter::COL_I64 || !ReadRaw(latencyIn, latencyRows))
+            return corrupt();
+    }
+
+    // Header
+    in.seekg(0);
+    std::vector<ColumnSpec> cols;
+    {
+        std::uint32_t count = 0;
+        if (!in.read(magic, 8) || std::memcmp(magic, MAGIC, 8) != 0 || !ReadRaw(in, count))
+            return corrupt();
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            std::uint8_t type = 0;
+            std::uint16_t len = 0;
+            if (!ReadRaw(in, type) || !ReadRaw(in, len) || ColumnWidth(type) == 0)
+                return corrupt();
+            std::string name(len, '\0');
+            if (len && !in.read(&name[0], len))
+                return corrupt();
+            cols.push_back({ std::move(name), static_cast<MessageScoreWriter::ColumnType>(type) });
+        }
+    }
+
+    std::ofstream out(csvPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        errorOut = "Could not open output file: " + csvPath;
+        return false;
+    }
+
+    std::string line;
+    for (const auto& c : cols)
+    {
+        line += (c.name == "sender_id") ? "sender" : c.name;
+        line.push_back(',');
+    }
+    line += LATENCY_COLUMN;
+    line += "\r\n";
+
+    std::vector<std::vector<unsigned char>> chunk(cols.size());
+    std::vector<std::int64_t> latency;
+    std::uint64_t rowsSeen = 0;
+
+    for (;;)
+    {
+        char tag[4];
+        if (!in.read(tag, 4))
+            return corrupt();
+        if (std::memcmp(tag, "TCOL", 4) == 0)
+            break;
+        if (std::memcmp(tag, "RGRP", 4) != 0)
+            return corrupt();
+
+        std::uint32_t rows = 0;
+        if (!ReadRaw(in, rows))
+            return corrupt();
+        for (std::size_t c = 0; c < cols.size(); ++c)
+        {
+            chunk[c].resize(rows * ColumnWidth(cols[c].type));
+            if (!chunk[c].empty() &&
+                !in.read(reinterpret_cast<char*>(chunk[c].data()),
+                         static_cast<std::streamsize>(chunk[c].size())))
+                return corrupt();
+        }
+
+        latency.resize(rows);
+        if (rowsSeen + rows > latencyRows ||
+            (rows && !latencyIn.read(reinterpret_cast<char*>(latency.data()),
+                                     static_cast<std::streamsize>(rows * sizeof(std::int64_t)))))
+            return corrupt();
+
+        for (std::uint32_t r = 0; r < rows; ++r)
+        {
+            for (std::size_t c = 0; c < cols.size(); ++c)
+            {
+                const unsigned char* p = chunk[c].data() + r * ColumnWidth(cols[c].type);
+                if (cols[c].name == "sender_id")
+                {
+                    std::uint32_t id; std::memcpy(&id, p, 4);
+                    AppendCsvText(line, id < senders.size() ? senders[id] : std::string());
+                }
+                else
+                {
+                    AppendCsvNumber(line, p, cols[c].type);
+                }
+                line.push_back(',');
+            }
+            line += std::to_string(static_cast<long long>(latency[r]));
+            line += "\r\n";
+
+            if (line.size() >= 64 * 1024)
+            {
+                out.write(line.data(), static_cast<std::streamsize>(line.size()));
+                line.clear();
+            }
+        }
+        rowsSeen += rows;
+    }
+
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    out.close();
+    if (!out)
+    {
+        errorOut = "Failed while writing " + csvPath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+// message_scores.hpp
+// Per-message scores (VADER, NRC, word count, romantic hit, reply latency)
+// streamed to a columnar binary file, with an optional CSV export.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nrc_emotion.hpp"
+
+// File layout (all integers little-endian):
+//
+//   "CHATCOL1"                                  magic
+//   u32 columnCount, then per column: u8 type, u16 nameLen, name
+//   row groups, each:  "RGRP" u32 rows, then every column's values
+//                      for those rows back to back, in header order
+//   "TCOL" u8 type u16 nameLen name u64 rows values
+//                                               reply_latency_ms for every row;
+//                                               only known once the whole chat
+//                                               is in time order (explicit
+//                                               replies: the gap to the message
+//                                               answered)
+//   "DICT" u32 count (u32 len, bytes)*          sender names, by sender_id
+//   u64 offset of "TCOL", u64 offset of "DICT", "CHATCOL1"
+//                                               trailer
+//
+// Rows are in input order; sort by timestamp_ms for a timeline.
+struct MessageScoreRow {
+    long long          timestampMs   = 0;
+    const std::string* sender        = nullptr;
+    long long          wordCount     = 0;
+    bool               romantic      = false;
+    double             vaderNeg      = 0.0;
+    double             vaderNeu      = 0.0;
+    double             vaderPos      = 0.0;
+    double             vaderCompound = 0.0;
+    double             nrc[NrcEmotionLexicon::DIMENSIONS] = {};
+};
+
+class MessageScoreWriter
+{
+public:
+    enum ColumnType : std::uint8_t {
+        COL_I64 = 1,
+        COL_U32 = 2,
+        COL_U8  = 3,
+        COL_F64 = 4,
+        COL_F32 = 5,
+    };
+
+    static constexpr std::size_t ROWS_PER_GROUP = 64 * 1024;
+
+    MessageScoreWriter() = default;
+    MessageScoreWriter(const MessageScoreWriter&) = delete;
+    MessageScoreWriter& operator=(const MessageScoreWriter&) = delete;
+
+    bool open(const std::string& path, std::string& errorOut);
+
+    // Returns the row index assigned to this message.
+    std::uint64_t append(const MessageScoreRow& row);
+
+    // replyLatencyMs is indexed by row; -1 = not a reply (same sender as the
+    // previous message, or first message).
+    bool finish(const std::vector<long long>& replyLatencyMs, std::string& errorOut);
+
+    std::uint64_t rowCount() const { return m_rows; }
+
+private:
+    void flushGroup();
+
+    template <typename T>
+    void writeRaw(const T& v) { m_out.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+
+    template <typename T>
+    void writeColumn(const std::vector<T>& values)
+    {
+        m_out.write(reinterpret_cast<const char*>(values.data()),
+                    static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    std::ofstream m_out;
+    std::string   m_path;
+    std::uint64_t m_rows = 0;
+
+    std::unordered_map<std::string, std::uint32_t> m_senderIds;
+    std::vector<const std::string*>                m_senderNames;
+
+    // Current row group, one vector per column
+    std::vector<std::int64_t>  m_timestamp;
+    std::vector<std::uint32_t> m_sender;
+    std::vector<std::uint32_t> m_words;
+    std::vector<std::uint8_t>  m_romantic;
+    std::vector<double>        m_vader[4];   // neg, neu, pos, compound
+    std::vector<float>         m_nrc[NrcEmotionLexicon::DIMENSIONS];
+};
+
+// Stream a columnar score file into CSV (one row per message, header first).
+bool ConvertMessageScoresToCsv(
+    const std::string& columnarPath,
+    const std::string& csvPath,
+    std::string&       errorOut
+);
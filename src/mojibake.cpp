@@ -0,0 +1,147 @@
+// mojibake.cpp
+#include "mojibake.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+static constexpr std::uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+// Offset of the first byte >= 0x80 at or after `from`, or s.size().
+static std::size_t findNonAscii(std::string_view s, std::size_t from)
+{
+    std::size_t i = from;
+    for (; s.size() - i >= 8; i += 8)
+    {
+        std::uint64_t w;
+        std::memcpy(&w, s.data() + i, 8);
+        if (w & HIGH_BITS)
+            break;
+    }
+    for (; i < s.size(); ++i)
+    {
+        if (static_cast<unsigned char>(s[i]) >= 0x80)
+            return i;
+    }
+    return s.size();
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
+    if (c >= 'A' && c <= 'F') return 10 + (c - 'A');
+    return -1;
+}
+
+bool LooksLikeMetaMojibake(std::string_view raw)
+{
+    if (findNonAscii(raw, 0) != raw.size())
+        return false;
+
+    bool found = false;
+    std::size_t i = 0;
+    while (i < raw.size())
+    {
+        const void* hit = std::memchr(raw.data() + i, '\\', raw.size() - i);
+        if (!hit)
+            break;
+        i = static_cast<std::size_t>(static_cast<const char*>(hit) - raw.data());
+        if (i + 1 >= raw.size())
+            break;
+        if (raw[i + 1] != 'u')
+        {
+            i += 2;   // \" \\ \n ...
+            continue;
+        }
+        if (raw.size() - i < 6)
+            break;
+
+        int value = 0;
+        for (std::size_t k = 2; k < 6; ++k)
+        {
+            const int hv = hexValue(raw[i + k]);
+            if (hv < 0)
+                return false;   // not valid JSON; leave it to the parser
+            value = value * 16 + hv;
+        }
+        if (value > 0xFF)
+            return false;
+        if (value >= 0x80)
+            found = true;
+        i += 6;
+    }
+    return found;
+}
+
+// Length of the valid UTF-8 sequence starting at s[i] (lead byte >= 0x80),
+// or 0 if it is malformed, overlong, a surrogate or out of range.
+static std::size_t validUtf8Length(std::string_view s, std::size_t i)
+{
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    std::size_t len = 0;
+    unsigned char lo = 0x80, hi = 0xBF;   // allowed range of the second byte
+    if (c >= 0xC2 && c <= 0xDF)      len = 2;
+    else if (c == 0xE0)            { len = 3; lo = 0xA0; }
+    else if (c == 0xED)            { len = 3; hi = 0x9F; }
+    else if (c >= 0xE1 && c <= 0xEF) len = 3;
+    else if (c == 0xF0)            { len = 4; lo = 0x90; }
+    else if (c == 0xF4)            { len = 4; hi = 0x8F; }
+    else if (c >= 0xF1 && c <= 0xF3) len = 4;
+    else
+        return 0;
+
+    if (s.size() - i < len)
+        return 0;
+    const unsigned char c1 = static_cast<unsigned char>(s[i + 1]);
+    if (c1 < lo || c1 > hi)
+        return 0;
+    for (std::size_t k = 2; k < len; ++k)
+    {
+        if ((static_cast<unsigned char>(s[i + k]) & 0xC0) != 0x80)
+            return 0;
+    }
+    return len;
+}
+
+bool RepairMetaMojibake(std::string& s)
+{
+    std::size_t i = findNonAscii(s, 0);
+    if (i == s.size())
+        return false;
+
+    // U+0080-U+00FF is C2/C3 plus one continuation byte in UTF-8; each pair
+    // becomes the single byte it encodes. ASCII runs in between are copied
+    // whole, found eight bytes at a time.
+    std::string out;
+    out.reserve(s.size());
+    out.append(s, 0, i);
+    while (i < s.size())
+    {
+        const unsigned char lead = static_cast<unsigned char>(s[i]);
+        if (lead < 0x80)
+        {
+            const std::size_t end = findNonAscii(s, i);
+            out.append(s, i, end - i);
+            i = end;
+            continue;
+        }
+        if ((lead != 0xC2 && lead != 0xC3) || i + 1 >= s.size())
+            return false;
+        const unsigned char next = static_cast<unsigned char>(s[i + 1]);
+        if ((next & 0xC0) != 0x80)
+            return false;
+        out.push_back(static_cast<char>(((lead & 0x03) << 6) | (next & 0x3F)));
+        i += 2;
+    }
+
+    for (std::size_t k = findNonAscii(out, 0); k < out.size(); k = findNonAscii(out, k))
+    {
+        const std::size_t len = validUtf8Length(out, k);
+        if (len == 0)
+            return false;
+        k += len;
+    }
+
+    s.swap(out);
+    return true;
+}
@@ -0,0 +1,21 @@
+// mojibake.hpp
+// Repair for Meta (Instagram / Messenger) JSON exports, which write the UTF-8
+// bytes of every string as Latin-1 code points: "é" is exported as
+// "\u00c3\u00a9" and decodes to "Ã©"; emoji come out as "ð\u009f\u0098\u0082".
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Decide once per file, on the raw JSON text, whether its strings need
+// repairing: the text is pure ASCII, has at least one \u0080-\u00ff escape
+// and no escape above \u00ff. Files written by the converters (raw UTF-8)
+// never match; genuine Latin-1 text in a file that does is caught by the
+// UTF-8 check in RepairMetaMojibake.
+bool LooksLikeMetaMojibake(std::string_view rawJson);
+
+// Turn a decoded string back into the UTF-8 it stood for: every code point
+// U+0080-U+00FF becomes the byte of the same value. `s` is left untouched,
+// and false returned, if it holds a code point above U+00FF or the bytes
+// are not valid UTF-8. An ASCII string costs one scan, eight bytes at a time.
+bool RepairMetaMojibake(std::string& s);
@@ -1,4 +1,5 @@
 #include "nrc_emotion.hpp"
+#include "utf8_text.hpp"
 
 #include <fstream>
 #include <sstream>
@@ -19,13 +20,6 @@ const char* NrcEmotionLexicon::CATEGORY_NAMES[DIMENSIONS] = {
     "positive"
 };
 
-static std::string toLowerAscii(std::string s)
-{
-    for (char& c : s)
-        c = (char)std::tolower((unsigned char)c);
-    return s;
-}
-
 bool NrcEmotionLexicon::loadFromFile(const std::string& path)
 {
     m_wordToMaskIndex.clear();
@@ -54,8 +48,8 @@ bool NrcEmotionLexicon::loadFromFile(const std::string& path)
         if (!std::getline(iss, cat,  '\t')) continue;
         if (!std::getline(iss, flagStr))    continue;
 
-        word = toLowerAscii(word);
-        cat  = toLowerAscii(cat);
+        word = Utf8ToLower(word);
+        cat  = Utf8ToLower(cat);
 
         int flag = 0;
         try { flag = std::stoi(flagStr); } catch (...) { flag = 0; }
@@ -108,7 +102,7 @@ void NrcEmotionLexicon::scoreWords(const std::vector<std::string>& words, Scores
     {
         if (raw.empty()) continue;
 
-        std::string w = toLowerAscii(raw);
+        std::string w = Utf8ToLower(raw);
 
         auto it = m_wordToMaskIndex.find(w);
         if (it == m_wordToMaskIndex.end())
@@ -0,0 +1,262 @@
+// static_lexicon.hpp
+// Fixed word tables built by the compiler: perfect-hash sets and maps over
+// string literals. They need no initialization at startup, and a lookup
+// hashes the word once and compares it with a single candidate.
+//
+//   static constexpr auto STOP_WORDS = MakeStaticStringSet({ "a", "about" });
+//   static constexpr auto BOOSTERS   = MakeStaticStringMap<double>({ { "very", 0.293 } });
+//
+// WordSetOverrides layers runtime additions and removals over a fixed set.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 64-bit FNV-1a of a word.
+constexpr std::uint64_t StaticLexiconHash(std::string_view s)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (char c : s)
+    {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Slot of a hashed word in a table of mask + 1 entries under `seed`
+// (seed 0 picks the bucket): the SplitMix64 finalizer of the hash offset
+// by the seed, so every seed scatters the words differently.
+constexpr std::size_t StaticLexiconSlot(std::uint64_t h, std::uint32_t seed, std::size_t mask)
+{
+    std::uint64_t z = h + seed * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return static_cast<std::size_t>(z) & mask;
+}
+
+// Power of two with room for n words at a load of at most one half.
+constexpr std::size_t StaticLexiconSlots(std::size_t n)
+{
+    std::size_t slots = 2;
+    while (slots < 2 * n)
+        slots *= 2;
+    return slots;
+}
+
+// Perfect hash over N distinct words ("hash and displace"). Words are
+// grouped into buckets by one hash; each bucket, largest first, then gets
+// the smallest seed that sends all of its words to free slots. find() is
+// one hash of the word, two table reads and one string compare.
+template <std::size_t N>
+class StaticStringIndex
+{
+public:
+    static constexpr std::size_t   SLOTS = StaticLexiconSlots(N);
+    static constexpr std::size_t   NPOS  = static_cast<std::size_t>(-1);
+    static constexpr std::uint16_t EMPTY = 0xFFFF;
+    static_assert(N < EMPTY, "static lexicon too large");
+
+    constexpr explicit StaticStringIndex(const std::array<std::string_view, N>& words)
+        : m_words(words)
+    {
+        constexpr std::size_t MASK = SLOTS - 1;
+
+        // Bucket the words, then list them bucket by bucket (counting sort).
+        std::uint64_t hashes[N]            = {};
+        std::size_t   bucketOf[N]          = {};
+        std::size_t   bucketStart[SLOTS + 1] = {};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            hashes[i]   = StaticLexiconHash(words[i]);
+            bucketOf[i] = StaticLexiconSlot(hashes[i], 0, MASK);
+            ++bucketStart[bucketOf[i] + 1];
+        }
+        std::size_t largest = 0;
+        for (std::size_t b = 0; b < SLOTS; ++b)
+        {
+            if (bucketStart[b + 1] > largest)
+                largest = bucketStart[b + 1];
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        std::size_t members[N]   = {};
+        std::size_t filled[SLOTS] = {};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            const std::size_t b = bucketOf[i];
+            members[bucketStart[b] + filled[b]++] = i;
+        }
+
+        for (std::size_t s = 0; s < SLOTS; ++s)
+            m_slots[s] = EMPTY;
+
+        for (std::size_t size = largest; size > 0; --size)
+        {
+            for (std::size_t b = 0; b < SLOTS; ++b)
+            {
+                if (bucketStart[b + 1] - bucketStart[b] == size)
+                    place(b, members + bucketStart[b], size, hashes);
+            }
+        }
+    }
+
+    // Position of `word` in the list the index was built from, or NPOS.
+    constexpr std::size_t find(std::string_view word) const
+    {
+        const std::uint64_t h    = StaticLexiconHash(word);
+        const std::uint32_t seed = m_seeds[StaticLexiconSlot(h, 0, SLOTS - 1)];
+        const std::uint16_t k    = m_slots[StaticLexiconSlot(h, seed, SLOTS - 1)];
+        return (k != EMPTY && m_words[k] == word) ? k : NPOS;
+    }
+
+    constexpr std::string_view word(std::size_t i) const { return m_words[i]; }
+
+private:
+    constexpr void place(std::size_t bucket, const std::size_t* words, std::size_t count,
+                         const std::uint64_t* hashes)
+    {
+        // Equal words always share a bucket and could never be separated.
+        for (std::size_t k = 1; k < count; ++k)
+        {
+            for (std::size_t j = 0; j < k; ++j)
+            {
+                if (m_words[words[j]] == m_words[words[k]])
+                    throw std::logic_error("duplicate word in a static lexicon");
+            }
+        }
+
+        for (std::uint32_t seed = 1;; ++seed)
+        {
+            bool free = true;
+            for (std::size_t k = 0; k < count && free; ++k)
+            {
+                const std::size_t slot = StaticLexiconSlot(hashes[words[k]], seed, SLOTS - 1);
+                free = m_slots[slot] == EMPTY;
+                for (std::size_t j = 0; j < k && free; ++j)
+                    free = StaticLexiconSlot(hashes[words[j]], seed, SLOTS - 1) != slot;
+            }
+            if (!free)
+                continue;
+
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                const std::size_t slot = StaticLexiconSlot(hashes[words[k]], seed, SLOTS - 1);
+                m_slots[slot] = static_cast<std::uint16_t>(words[k]);
+            }
+            m_seeds[bucket] = seed;
+            return;
+        }
+    }
+
+    std::array<std::string_view, N> m_words{};
+    std::uint32_t                   m_seeds[SLOTS] = {};
+    std::uint16_t                   m_slots[SLOTS] = {};
+};
+
+template <std::size_t N>
+class StaticStringSet
+{
+public:
+    constexpr explicit StaticStringSet(const std::array<std::string_view, N>& words)
+        : m_index(words) {}
+
+    constexpr bool contains(std::string_view word) const
+    {
+        return m_index.find(word) != StaticStringIndex<N>::NPOS;
+    }
+
+    static constexpr std::size_t size() { return N; }
+
+private:
+    StaticStringIndex<N> m_index;
+};
+
+template <typename V>
+struct StaticStringMapEntry
+{
+    std::string_view key;
+    V                value;
+};
+
+template <typename V, std::size_t N>
+class StaticStringMap
+{
+public:
+    constexpr explicit StaticStringMap(const StaticStringMapEntry<V> (&entries)[N])
+        : m_index(keysOf(entries)), m_values(valuesOf(entries)) {}
+
+    // Value stored for `key`, or nullptr.
+    constexpr const V* find(std::string_view key) const
+    {
+        const std::size_t i = m_index.find(key);
+        return i == StaticStringIndex<N>::NPOS ? nullptr : &m_values[i];
+    }
+
+    static constexpr std::size_t size() { return N; }
+
+private:
+    static constexpr std::array<std::string_view, N> keysOf(const StaticStringMapEntry<V> (&entries)[N])
+    {
+        std::array<std::string_view, N> keys{};
+        for (std::size_t i = 0; i < N; ++i)
+            keys[i] = entries[i].key;
+        return keys;
+    }
+
+    static constexpr std::array<V, N> valuesOf(const StaticStringMapEntry<V> (&entries)[N])
+    {
+        std::array<V, N> values{};
+        for (std::size_t i = 0; i < N; ++i)
+            values[i] = entries[i].value;
+        return values;
+    }
+
+    StaticStringIndex<N> m_index;
+    std::array<V, N>     m_values;
+};
+
+template <std::size_t N>
+constexpr StaticStringSet<N> MakeStaticStringSet(const std::string_view (&words)[N])
+{
+    std::array<std::string_view, N> list{};
+    for (std::size_t i = 0; i < N; ++i)
+        list[i] = words[i];
+    return StaticStringSet<N>(list);
+}
+
+template <typename V, std::size_t N>
+constexpr StaticStringMap<V, N> MakeStaticStringMap(const StaticStringMapEntry<V> (&entries)[N])
+{
+    return StaticStringMap<V, N>(entries);
+}
+
+// Words added to or taken out of a fixed set at runtime. Lookups only
+// touch the overrides when there are any.
+class WordSetOverrides
+{
+public:
+    void add(std::string word)    { m_words[std::move(word)] = true; }
+    void remove(std::string word) { m_words[std::move(word)] = false; }
+    bool empty() const            { return m_words.empty(); }
+
+    template <typename FixedSet>
+    bool contains(const FixedSet& fixed, std::string_view word) const
+    {
+        if (!m_words.empty())
+        {
+            auto it = m_words.find(std::string(word));
+            if (it != m_words.end())
+                return it->second;
+        }
+        return fixed.contains(word);
+    }
+
+private:
+    std::unordered_map<std::string, bool> m_words;
+};
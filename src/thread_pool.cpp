@@ -0,0 +1,148 @@
+// thread_pool.cpp
+#include "thread_pool.hpp"
+
+#include <utility>
+
+namespace
+{
+    // Identifies the pool/worker running on the current thread so nested
+    // submit() calls can push to the local deque.
+    thread_local const WorkStealingPool* t_pool        = nullptr;
+    thread_local unsigned                t_workerIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    m_queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_queues.push_back(std::make_unique<Queue>());
+
+    m_workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_idleMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers)
+        t.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task)
+{
+    Queue& q = (t_pool == this) ? *m_queues[t_workerIndex] : m_shared;
+
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lk(q.mutex);
+        q.tasks.push_back(std::move(task));
+        m_queued.fetch_add(1);
+    }
+
+    {
+        // Taking the idle lock orders this notify after any worker's
+        // predicate check, so the wake-up cannot be lost.
+        std::lock_guard<std::mutex> lk(m_idleMutex);
+    }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    {
+        std::unique_lock<std::mutex> lk(m_idleMutex);
+        m_done.wait(lk, [this] { return m_pending.load() == 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lk(m_errorMutex);
+        error = std::exchange(m_firstError, nullptr);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+bool WorkStealingPool::popLocal(unsigned index, std::function<void()>& task)
+{
+    Queue& q = *m_queues[index];
+    std::lock_guard<std::mutex> lk(q.mutex);
+    if (q.tasks.empty())
+        return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::popShared(std::function<void()>& task)
+{
+    std::lock_guard<std::mutex> lk(m_shared.mutex);
+    if (m_shared.tasks.empty())
+        return false;
+    task = std::move(m_shared.tasks.front());
+    m_shared.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, std::function<void()>& task)
+{
+    const unsigned n = size();
+    for (unsigned k = 1; k < n; ++k)
+    {
+        Queue& q = *m_queues[(thief + k) % n];
+        std::lock_guard<std::mutex> lk(q.mutex);
+        if (q.tasks.empty())
+            continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index)
+{
+    t_pool        = this;
+    t_workerIndex = index;
+
+    for (;;)
+    {
+        std::function<void()> task;
+        if (popLocal(index, task) || popShared(task) || steal(index, task))
+        {
+            m_queued.fetch_sub(1);
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lk(m_errorMutex);
+                if (!m_firstError)
+                    m_firstError = std::current_exception();
+            }
+
+            if (m_pending.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lk(m_idleMutex);
+                m_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(m_idleMutex);
+        m_wake.wait(lk, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0)
+            return;
+    }
+}
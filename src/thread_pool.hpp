@@ -0,0 +1,164 @@
+// thread_pool.hpp
+// Small work-stealing thread pool shared by the batch runner and the
+// parallel converters.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Tasks submitted from outside go to a shared FIFO queue, so they start in
+// submission order (the batch runner relies on this for largest-first).
+// Tasks submitted from inside a worker go to that worker's own deque, which
+// it pops from the back (LIFO, cache friendly). A worker with nothing local
+// takes the next shared task, then steals from the front of the other
+// workers' deques.
+//
+// The first exception thrown by a task is captured and rethrown by wait().
+class WorkStealingPool
+{
+public:
+    // threadCount == 0 uses std::thread::hardware_concurrency().
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished.
+    void wait();
+
+    // Ordered pipeline: produce(i) runs on the workers for i in [0, count),
+    // and the caller receives each result through consume(i, result)
+    // strictly in index order. Only ITEMS_IN_FLIGHT_PER_THREAD results per
+    // worker are produced ahead of the one being consumed, which bounds
+    // memory while keeping every core busy. consume returns false to stop
+    // early (runOrdered then returns false). An exception from produce or
+    // consume is rethrown here once the items already started have
+    // finished. Ends with wait().
+    template <typename Produce, typename Consume>
+    bool runOrdered(std::size_t count, Produce produce, Consume consume);
+
+    static constexpr std::size_t ITEMS_IN_FLIGHT_PER_THREAD = 2;
+
+    // m_queues is complete before the first worker starts, so workers can
+    // read its size while the constructor is still filling m_workers.
+    unsigned size() const { return static_cast<unsigned>(m_queues.size()); }
+
+private:
+    struct Queue
+    {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, std::function<void()>& task);
+    bool popShared(std::function<void()>& task);
+    bool steal(unsigned thief, std::function<void()>& task);
+
+    Queue                               m_shared;   // outside submits, FIFO
+    std::vector<std::unique_ptr<Queue>> m_queues;   // one per worker
+    std::vector<std::thread>            m_workers;
+
+    std::mutex              m_idleMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    std::atomic<std::size_t> m_queued{ 0 };   // sitting in a deque
+    std::atomic<std::size_t> m_pending{ 0 };  // submitted, not yet finished
+    bool                     m_stop = false;
+
+    std::mutex         m_errorMutex;
+    std::exception_ptr m_firstError;
+};
+
+template <typename Produce, typename Consume>
+bool WorkStealingPool::runOrdered(std::size_t count, Produce produce, Consume consume)
+{
+    using Result = std::decay_t<decltype(produce(std::size_t{}))>;
+    struct Slot
+    {
+        Result             value{};
+        std::exception_ptr error;
+        bool               ready = false;
+    };
+
+    // Workers fill their own slots; this thread takes them in order and
+    // starts one more item for every result it takes.
+    std::vector<Slot>       slots(count);
+    std::mutex              mutex;
+    std::condition_variable readyCv;
+    auto start = [&](std::size_t i)
+    {
+        submit([&, i]
+        {
+            Result             value{};
+            std::exception_ptr error;
+            try
+            {
+                value = produce(i);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                slots[i].value = std::move(value);
+                slots[i].error = error;
+                slots[i].ready = true;
+            }
+            readyCv.notify_all();
+        });
+    };
+
+    const std::size_t window = std::min<std::size_t>(count, size() * ITEMS_IN_FLIGHT_PER_THREAD);
+    std::size_t next = 0;
+    for (; next < window; ++next)
+        start(next);
+
+    bool               completed = true;
+    std::exception_ptr error;
+    try
+    {
+        for (std::size_t i = 0; i < count && completed; ++i)
+        {
+            Result value;
+            {
+                std::unique_lock<std::mutex> lk(mutex);
+                readyCv.wait(lk, [&] { return slots[i].ready; });
+                error = slots[i].error;
+                value = std::move(slots[i].value);
+            }
+            if (error)
+                break;
+
+            if (next < count)
+                start(next++);
+            completed = consume(i, std::move(value));
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    wait();   // started items still write to `slots`
+    if (error)
+        std::rethrow_exception(error);
+    return completed;
+}
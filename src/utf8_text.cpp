@@ -0,0 +1,753 @@
+// utf8_text.cpp
+#include "utf8_text.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define UTF8_TEXT_X86_64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// -------------------------------------------------------------
+// ASCII block kernels
+// -------------------------------------------------------------
+
+// One block of `width` bytes, written to `lowered` (which may alias `p`)
+// with A-Z lowercased and every other byte, non-ASCII ones included, as is.
+// Bit k of `alnum` says whether byte k is an ASCII letter or digit; the
+// return value has bit k set where byte k is >= 0x80 (0: all ASCII).
+using AsciiBlockFn = std::uint32_t (*)(const char* p, char* lowered, std::uint32_t& alnum);
+
+struct AsciiKernel
+{
+    std::size_t  width;
+    AsciiBlockFn block;
+    const char*  name;
+};
+
+#ifdef UTF8_TEXT_X86_64
+
+// Bytes >= 0x80 are negative as signed chars, so the signed range checks
+// below leave them alone.
+static std::uint32_t asciiBlockSse2(const char* p, char* lowered, std::uint32_t& alnum)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    const __m128i low   = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(low, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmplt_epi8(low, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lowered), low);
+    alnum = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(alpha, digit)));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(v));
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx2")))
+#endif
+static std::uint32_t asciiBlockAvx2(const char* p, char* lowered, std::uint32_t& alnum)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    const __m256i low   = _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(low, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), low));
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lowered), low);
+    alnum = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(alpha, digit)));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+}
+
+static bool cpuHasAvx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)   // OS saves the YMM state
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#else
+
+// Portable kernel: the same contract, one byte at a time over 8 bytes.
+static std::uint32_t asciiBlockScalar(const char* p, char* lowered, std::uint32_t& alnum)
+{
+    std::uint32_t high = 0, mask = 0;
+    for (int k = 0; k < 8; ++k)
+    {
+        char c = p[k];
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c + ('a' - 'A'));
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+            mask |= 1u << k;
+        if (static_cast<unsigned char>(c) >= 0x80)
+            high |= 1u << k;
+        lowered[k] = c;
+    }
+    alnum = mask;
+    return high;
+}
+
+#endif // UTF8_TEXT_X86_64
+
+static AsciiKernel pickAsciiKernel()
+{
+#ifdef UTF8_TEXT_X86_64
+    if (cpuHasAvx2())
+        return { 32, asciiBlockAvx2, "avx2" };
+    return { 16, asciiBlockSse2, "sse2" };
+#else
+    return { 8, asciiBlockScalar, "scalar" };
+#endif
+}
+
+static const AsciiKernel& asciiKernel()
+{
+    static const AsciiKernel kernel = pickAsciiKernel();
+    return kernel;
+}
+
+const char* Utf8TextKernelName()
+{
+    return asciiKernel().name;
+}
+
+static inline int countTrailingZeros(std::uint64_t v)   // v != 0
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return static_cast<int>(index);
+#else
+    int n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// -------------------------------------------------------------
+// Code points
+// -------------------------------------------------------------
+
+// Decode the UTF-8 sequence at s[i] (lead byte >= 0x80). Returns its length,
+// or 0 if it is malformed, overlong, a surrogate or out of range.
+static std::size_t decodeUtf8(std::string_view s, std::size_t i, char32_t& cp)
+{
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    std::size_t len = 0;
+    unsigned char lo = 0x80, hi = 0xBF;   // allowed range of the second byte
+    if (c >= 0xC2 && c <= 0xDF)      { len = 2; cp = c & 0x1F; }
+    else if (c == 0xE0)            { len = 3; cp = c & 0x0F; lo = 0xA0; }
+    else if (c == 0xED)            { len = 3; cp = c & 0x0F; hi = 0x9F; }
+    else if (c >= 0xE1 && c <= 0xEF) { len = 3; cp = c & 0x0F; }
+    else if (c == 0xF0)            { len = 4; cp = c & 0x07; lo = 0x90; }
+    else if (c == 0xF4)            { len = 4; cp = c & 0x07; hi = 0x8F; }
+    else if (c >= 0xF1 && c <= 0xF3) { len = 4; cp = c & 0x07; }
+    else
+        return 0;
+
+    if (s.size() - i < len)
+        return 0;
+    const unsigned char c1 = static_cast<unsigned char>(s[i + 1]);
+    if (c1 < lo || c1 > hi)
+        return 0;
+    cp = (cp << 6) | (c1 & 0x3F);
+    for (std::size_t k = 2; k < len; ++k)
+    {
+        const unsigned char ck = static_cast<unsigned char>(s[i + k]);
+        if ((ck & 0xC0) != 0x80)
+            return 0;
+        cp = (cp << 6) | (ck & 0x3F);
+    }
+    return len;
+}
+
+// Code point at s[i] and its length; a malformed byte reads as itself.
+static std::size_t codePointAt(std::string_view s, std::size_t i, char32_t& cp)
+{
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c < 0x80)
+    {
+        cp = c;
+        return 1;
+    }
+    const std::size_t len = decodeUtf8(s, i, cp);
+    if (len == 0)
+    {
+        cp = 0xFFFD;
+        return 1;
+    }
+    return len;
+}
+
+static void appendUtf8(std::string& out, char32_t cp)
+{
+    if (cp <= 0x7F)
+    {
+        out.push_back(static_cast<char>(cp));
+    }
+    else if (cp <= 0x7FF)
+    {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else if (cp <= 0xFFFF)
+    {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Lowercase for the blocks chat text mostly uses; only mappings that keep
+// the UTF-8 length.
+static char32_t lowerCodePoint(char32_t cp)
+{
+    if (cp < 0x80)
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7)         // Latin-1
+        return cp + 0x20;
+
+    if (cp >= 0x100 && cp <= 0x17F)                      // Latin Extended-A
+    {
+        if (cp == 0x130 || cp == 0x138 || cp == 0x149)   // İ ĸ ŉ
+            return cp;
+        if (cp == 0x178)                                 // Ÿ
+            return 0xFF;
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E))
+            return (cp & 1) ? cp + 1 : cp;
+        return (cp & 1) ? cp : cp + 1;
+    }
+
+    if (cp >= 0x386 && cp <= 0x3AB)                      // Greek
+    {
+        if (cp >= 0x391 && cp != 0x3A2) return cp + 0x20;
+        if (cp == 0x386)                return 0x3AC;
+        if (cp >= 0x388 && cp <= 0x38A) return cp + 0x25;
+        if (cp == 0x38C)                return 0x3CC;
+        if (cp == 0x38E || cp == 0x38F) return cp + 0x3F;
+        return cp;
+    }
+
+    if (cp >= 0x400 && cp <= 0x52F)                      // Cyrillic
+    {
+        if (cp <= 0x40F) return cp + 0x50;
+        if (cp <= 0x42F) return cp + 0x20;
+        if (cp < 0x460)  return cp;
+        if (cp <= 0x481 || (cp >= 0x48A && cp <= 0x4BF) || cp >= 0x4D0)
+            return (cp & 1) ? cp : cp + 1;
+        if (cp == 0x4C0) return 0x4CF;
+        if (cp >= 0x4C1 && cp <= 0x4CE)
+            return (cp & 1) ? cp + 1 : cp;
+        return cp;
+    }
+
+    if (cp >= 0x531 && cp <= 0x556)                      // Armenian
+        return cp + 0x30;
+
+    if ((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF))
+        return (cp & 1) ? cp : cp + 1;                   // Latin Extended Additional
+
+    if (cp >= 0xFF21 && cp <= 0xFF3A)                    // fullwidth A-Z
+        return cp + 0x20;
+
+    return cp;
+}
+
+// Letters, digits and combining marks of the scripts below, as sorted
+// inclusive ranges. Punctuation inside a block (Hebrew maqaf, Devanagari
+// danda, ...) is carved out so it still separates words.
+static const char32_t WORD_RANGES[][2] = {
+    { 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 }, { 0x00BA, 0x00BA },
+    { 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x02C1 },   // Latin, IPA
+    { 0x02C6, 0x02D1 }, { 0x02E0, 0x02E4 },
+    { 0x0300, 0x036F },                                           // combining marks
+    { 0x0370, 0x0374 }, { 0x0376, 0x037D }, { 0x037F, 0x037F },   // Greek
+    { 0x0386, 0x0386 }, { 0x0388, 0x03FF },
+    { 0x0400, 0x0481 }, { 0x0483, 0x052F },                       // Cyrillic
+    { 0x0531, 0x0556 }, { 0x0560, 0x0588 },                       // Armenian
+    { 0x0591, 0x05BD }, { 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 },   // Hebrew
+    { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x05D0, 0x05EA }, { 0x05EF, 0x05F2 },
+    { 0x0610, 0x061A }, { 0x0620, 0x0669 }, { 0x066E, 0x06D3 },   // Arabic
+    { 0x06D5, 0x06DC }, { 0x06DF, 0x06E8 }, { 0x06EA, 0x06FC }, { 0x06FF, 0x06FF },
+    { 0x0900, 0x0963 }, { 0x0966, 0x096F }, { 0x0971, 0x0DF3 },   // Indic
+    { 0x0E01, 0x0E3A }, { 0x0E40, 0x0E4E }, { 0x0E50, 0x0E59 },   // Thai
+    { 0x0E81, 0x0EDF },                                           // Lao
+    { 0x10A0, 0x10FA }, { 0x10FC, 0x10FF },                       // Georgian
+    { 0x1100, 0x11FF },                                           // Hangul Jamo
+    { 0x1200, 0x135A },                                           // Ethiopic
+    { 0x1780, 0x17D3 },                                           // Khmer
+    { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF },                       // combining marks
+    { 0x1E00, 0x1FBC }, { 0x1FC2, 0x1FCC }, { 0x1FD0, 0x1FDB },   // Latin / Greek ext.
+    { 0x1FE0, 0x1FEC }, { 0x1FF2, 0x1FFC },
+    { 0x20D0, 0x20DC },                                           // combining marks
+    { 0x2C60, 0x2C7F },                                           // Latin Extended-C
+    { 0x2DE0, 0x2DFF },                                           // Cyrillic Extended-A
+    { 0x3041, 0x3096 }, { 0x3099, 0x309F },                       // Hiragana
+    { 0x30A1, 0x30FA }, { 0x30FC, 0x30FF },                       // Katakana
+    { 0x3400, 0x4DBF }, { 0x4E00, 0x9FFF },                       // CJK
+    { 0xA640, 0xA69F },                                           // Cyrillic Extended-B
+    { 0xA720, 0xA7FF },                                           // Latin Extended-D
+    { 0xAC00, 0xD7A3 },                                           // Hangul
+    { 0xF900, 0xFAFF },                                           // CJK compatibility
+    { 0xFE20, 0xFE2F },                                           // combining half marks
+    { 0xFF10, 0xFF19 }, { 0xFF21, 0xFF3A }, { 0xFF41, 0xFF5A },   // fullwidth
+    { 0xFF66, 0xFFDC },                                           // halfwidth kana, Hangul
+    { 0x20000, 0x2FA1F },                                         // CJK extensions
+};
+
+static bool isWordCodePoint(char32_t cp)
+{
+    if (cp < 0x80)
+        return (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z') || (cp >= '0' && cp <= '9');
+
+    auto it = std::upper_bound(std::begin(WORD_RANGES), std::end(WORD_RANGES), cp,
+                               [](char32_t c, const char32_t (&r)[2]) { return c < r[0]; });
+    return it != std::begin(WORD_RANGES) && cp <= (*(it - 1))[1];
+}
+
+static bool isRegionalIndicator(char32_t cp) { return cp >= 0x1F1E6 && cp <= 0x1F1FF; }
+static bool isSkinTone(char32_t cp)          { return cp >= 0x1F3FB && cp <= 0x1F3FF; }
+static bool isVariationSelector(char32_t cp) { return cp == 0xFE0E || cp == 0xFE0F; }
+static bool isEmojiTag(char32_t cp)          { return cp >= 0xE0020 && cp <= 0xE007F; }
+
+constexpr char32_t ZWJ         = 0x200D;
+constexpr char32_t KEYCAP_MARK = 0x20E3;
+
+// Pictographs and symbols that start an emoji sequence.
+static bool isEmojiBase(char32_t cp)
+{
+    return (cp >= 0x1F000 && cp <= 0x1FAFF) ||
+           (cp >= 0x2600 && cp <= 0x27BF) ||   // misc symbols, dingbats
+           (cp >= 0x2300 && cp <= 0x23FF) ||   // ⌚ ⏰ ...
+           (cp >= 0x2B00 && cp <= 0x2BFF) ||   // ⬆ ⭐ ⭕ ...
+           cp == 0x203C || cp == 0x2049 ||     // ‼ ⁉
+           cp == 0x3030 || cp == 0x303D || cp == 0x3297 || cp == 0x3299;
+}
+
+// End of the keycap ("1️⃣", "#⃣") completed by the variation selector or
+// U+20E3 at s[i], or 0 if there is none: the byte before must be 0-9, #
+// or *, and a selector must be followed by the mark.
+static std::size_t keycapEnd(std::string_view s, std::size_t i, char32_t cp, std::size_t len)
+{
+    std::size_t end = i + len;
+    if (cp != KEYCAP_MARK)
+    {
+        char32_t next;
+        if (end >= s.size() || codePointAt(s, end, next) != 3 || next != KEYCAP_MARK)
+            return 0;
+        end += 3;
+    }
+
+    const char base = i > 0 ? s[i - 1] : '\0';
+    if (!((base >= '0' && base <= '9') || base == '#' || base == '*'))
+        return 0;
+    return end;
+}
+
+// Append the emoji starting at s[i] (an emoji base or regional indicator)
+// to `token`, with its modifiers, tags and ZWJ-joined parts, or both
+// halves of a flag. Variation selectors are dropped. Returns the offset
+// past it.
+static std::size_t scanEmoji(std::string_view s, std::size_t i, std::string& token)
+{
+    char32_t cp;
+    std::size_t len = codePointAt(s, i, cp);
+    token.append(s.data() + i, len);
+    i += len;
+
+    if (isRegionalIndicator(cp))
+    {
+        char32_t next;
+        if (i < s.size() && (len = codePointAt(s, i, next)) > 1 && isRegionalIndicator(next))
+        {
+            token.append(s.data() + i, len);
+            i += len;
+        }
+        return i;
+    }
+
+    while (i < s.size())
+    {
+        len = codePointAt(s, i, cp);
+        if (isVariationSelector(cp))
+        {
+            i += len;
+        }
+        else if (isSkinTone(cp) || isEmojiTag(cp) || cp == KEYCAP_MARK)
+        {
+            token.append(s.data() + i, len);
+            i += len;
+        }
+        else if (cp == ZWJ)
+        {
+            char32_t joined;
+            const std::size_t after = i + len;
+            std::size_t joinedLen = 0;
+            if (after < s.size())
+                joinedLen = codePointAt(s, after, joined);
+            if (joinedLen < 2 || !isEmojiBase(joined))
+                break;
+            token.append(s.data() + i, len + joinedLen);
+            i = after + joinedLen;
+        }
+        else
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+// -------------------------------------------------------------
+// Lowercasing
+// -------------------------------------------------------------
+
+// Lowercase the code point at s[i] in place; returns its length.
+static std::size_t lowerCodePointInPlace(std::string& s, std::size_t i)
+{
+    char32_t cp;
+    const std::size_t len = codePointAt(s, i, cp);
+    if (len < 2)
+    {
+        if (len == 1 && cp < 0x80)
+            s[i] = static_cast<char>(lowerCodePoint(cp));
+        return 1;
+    }
+
+    const char32_t low = lowerCodePoint(cp);
+    if (low != cp)
+    {
+        std::string encoded;
+        appendUtf8(encoded, low);
+        std::memcpy(&s[i], encoded.data(), len);   // same length by construction
+    }
+    return len;
+}
+
+void Utf8ToLowerInPlace(std::string& s)
+{
+    const AsciiKernel& kernel = asciiKernel();
+    std::uint32_t alnum;
+    std::size_t i = 0;
+
+    // Whole blocks: ASCII is lowered by the kernel, then each non-ASCII code
+    // point is handled on its own before the next block starts after it.
+    while (s.size() - i >= kernel.width)
+    {
+        const std::uint32_t high = kernel.block(&s[i], &s[i], alnum);
+        if (high == 0)
+        {
+            i += kernel.width;
+            continue;
+        }
+        i += countTrailingZeros(high);
+        i += lowerCodePointInPlace(s, i);
+    }
+
+    while (i < s.size())
+    {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c < 0x80)
+        {
+            if (c >= 'A' && c <= 'Z')
+                s[i] = static_cast<char>(c + ('a' - 'A'));
+            ++i;
+            continue;
+        }
+        i += lowerCodePointInPlace(s, i);
+    }
+}
+
+std::string Utf8ToLower(std::string_view s)
+{
+    std::string out(s);
+    Utf8ToLowerInPlace(out);
+    return out;
+}
+
+// -------------------------------------------------------------
+// Word splitting
+// -------------------------------------------------------------
+
+// Splits one text into words; see Utf8ExtractWords.
+class WordSplitter
+{
+public:
+    WordSplitter(std::string_view text, std::vector<std::string>& out)
+        : m_text(text), m_out(out) {}
+
+    void run()
+    {
+        const AsciiKernel& kernel = asciiKernel();
+        char lowered[32];
+        char tail[32];
+        std::uint32_t alnum;
+
+        std::size_t i = 0;
+        while (i < m_text.size())
+        {
+            // The last partial block is padded with spaces, which only end
+            // the word the real bytes leave open, and that is flushed anyway.
+            const char* block = m_text.data() + i;
+            std::size_t width = kernel.width;
+            if (m_text.size() - i < width)
+            {
+                width = m_text.size() - i;
+                std::memcpy(tail, block, width);
+                std::memset(tail + width, ' ', kernel.width - width);
+                block = tail;
+            }
+
+            const std::uint32_t high = kernel.block(block, lowered, alnum);
+            if (high == 0)
+            {
+                asciiBlock(lowered, alnum, width);
+                i += width;
+                continue;
+            }
+
+            // ASCII up to the first non-ASCII byte, then that code point.
+            const std::size_t ascii = countTrailingZeros(high);
+            asciiBlock(lowered, alnum, ascii);
+            i = codePoint(i + ascii);
+        }
+        flush();
+    }
+
+private:
+    void flush()
+    {
+        if (!m_word.empty())
+        {
+            m_out.push_back(std::move(m_word));
+            m_word.clear();
+        }
+    }
+
+    // Append every run of set bits among the first `width` to the current
+    // word, ending it at each gap. A run that reaches `width` stays open.
+    void asciiBlock(const char* lowered, std::uint32_t alnum, std::size_t width)
+    {
+        const std::uint64_t bits = alnum & ((std::uint64_t(1) << width) - 1);
+        std::size_t pos = 0;
+        while (pos < width)
+        {
+            const std::uint64_t rest = bits >> pos;
+            if (rest & 1)
+            {
+                const std::size_t run = countTrailingZeros(~rest);   // bit `width` is clear
+                if (m_word.empty() && pos + run < width)
+                    m_out.emplace_back(lowered + pos, run);   // whole word in this block
+                else
+                    m_word.append(lowered + pos, run);
+                pos += run;
+            }
+            else
+            {
+                flush();
+                if (rest == 0)
+                    return;
+                pos += countTrailingZeros(rest);
+            }
+        }
+    }
+
+    // Handle the code point at i; returns the offset past it (and past
+    // the rest of an emoji sequence).
+    std::size_t codePoint(std::size_t i)
+    {
+        char32_t cp;
+        const std::size_t len = codePointAt(m_text, i, cp);
+
+        if (cp < 0x80)
+        {
+            if (isWordCodePoint(cp))
+                m_word.push_back(static_cast<char>(lowerCodePoint(cp)));
+            else
+                flush();
+            return i + len;
+        }
+
+        if (isVariationSelector(cp) || cp == KEYCAP_MARK)
+            return keycap(i, cp, len);
+
+        if (isEmojiBase(cp) || isRegionalIndicator(cp))
+        {
+            flush();
+            return emoji(i);
+        }
+
+        if (isWordCodePoint(cp))
+        {
+            appendUtf8(m_word, lowerCodePoint(cp));
+            return i + len;
+        }
+
+        flush();
+        return i + len;
+    }
+
+    // A keycap's selector and mark; the ASCII base is taken back from the
+    // word it was added to. A stray selector or mark is dropped.
+    std::size_t keycap(std::size_t i, char32_t cp, std::size_t len)
+    {
+        const std::size_t end = keycapEnd(m_text, i, cp, len);
+        if (end == 0)
+            return i + len;
+
+        // A digit base was taken as (the end of) a word already.
+        const char base = m_text[i - 1];
+        if (!m_word.empty() && m_word.back() == base)
+            m_word.pop_back();
+        flush();
+
+        std::string token(1, base);
+        appendUtf8(token, KEYCAP_MARK);
+        m_out.push_back(std::move(token));
+        return end;
+    }
+
+    std::size_t emoji(std::size_t i)
+    {
+        std::string token;
+        i = scanEmoji(m_text, i, token);
+        m_out.push_back(std::move(token));
+        return i;
+    }
+
+    std::string_view          m_text;
+    std::vector<std::string>& m_out;
+    std::string               m_word;
+};
+
+void Utf8ExtractWords(std::string_view text, std::vector<std::string>& out)
+{
+    WordSplitter(text, out).run();
+}
+
+// -------------------------------------------------------------
+// Emoji
+// -------------------------------------------------------------
+
+bool Utf8IsEmoji(std::string_view token)
+{
+    if (token.empty())
+        return false;
+    const unsigned char c = static_cast<unsigned char>(token[0]);
+    if (c < 0x80)
+        return token.size() == 4 && token.substr(1) == "\xE2\x83\xA3";   // keycap
+    if (c < 0xE2)
+        return false;   // nothing below U+2000 starts an emoji
+
+    char32_t cp;
+    codePointAt(token, 0, cp);
+    return isEmojiBase(cp) || isRegionalIndicator(cp);
+}
+
+std::string_view Utf8EmojiBase(std::string_view emoji)
+{
+    if (emoji.empty())
+        return emoji;
+    char32_t cp;
+    const std::size_t len = codePointAt(emoji, 0, cp);
+    if (!isEmojiBase(cp))
+        return emoji;   // flag or keycap
+    return emoji.substr(0, len);
+}
+
+void Utf8SplitEmoji(std::string_view text, std::vector<std::string>& out)
+{
+    std::string run;
+    auto flushRun = [&]()
+    {
+        if (!run.empty())
+        {
+            out.push_back(std::move(run));
+            run.clear();
+        }
+    };
+
+    std::size_t i = 0;
+    while (i < text.size())
+    {
+        if (static_cast<unsigned char>(text[i]) < 0x80)
+        {
+            run.push_back(text[i++]);
+            continue;
+        }
+
+        char32_t cp;
+        const std::size_t len = codePointAt(text, i, cp);
+        if (isVariationSelector(cp) || cp == KEYCAP_MARK)
+        {
+            // The keycap's ASCII base is the last byte of the run.
+            const std::size_t end = keycapEnd(text, i, cp, len);
+            if (end != 0)
+            {
+                const char base = run.back();
+                run.pop_back();
+                flushRun();
+
+                std::string token(1, base);
+                appendUtf8(token, KEYCAP_MARK);
+                out.push_back(std::move(token));
+                i = end;
+                continue;
+            }
+            if (isVariationSelector(cp))
+            {
+                i += len;
+                continue;
+            }
+        }
+        else if (isEmojiBase(cp) || isRegionalIndicator(cp))
+        {
+            flushRun();
+            std::string token;
+            i = scanEmoji(text, i, token);
+            out.push_back(std::move(token));
+            continue;
+        }
+
+        run.append(text.data() + i, len);
+        i += len;
+    }
+    flushRun();
+}
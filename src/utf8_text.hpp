@@ -0,0 +1,43 @@
+// utf8_text.hpp
+// UTF-8 lowercasing and word splitting shared by the analyzer, VADER and NRC.
+// Pure-ASCII stretches, the bulk of most chats, go through a SIMD kernel
+// (AVX2 or SSE2 on x86-64, picked at runtime; 8-byte scalar blocks
+// elsewhere); everything else is decoded one code point at a time.
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Lowercase ASCII and the cased letters of Latin-1, Latin Extended-A and
+// Additional, Greek, Cyrillic, Armenian and fullwidth Latin. Mappings that
+// would change the encoded length (İ, ẞ) are left out, so the result is
+// always the same size as the input. Other text, including malformed UTF-8,
+// is copied unchanged.
+std::string Utf8ToLower(std::string_view s);
+void Utf8ToLowerInPlace(std::string& s);
+
+// Append the words of `text`, lowercased, to `out`. A word is a run of
+// letters and digits (ASCII or any of the scripts listed in utf8_text.cpp)
+// with combining marks kept on it. Every emoji is a token of its own,
+// together with its skin tone, ZWJ sequence, flag pair or keycap;
+// variation selectors are dropped so "❤️" and "❤" count as one. Anything
+// else separates words. Scripts written without spaces (CJK, Thai) give
+// one token per run.
+void Utf8ExtractWords(std::string_view text, std::vector<std::string>& out);
+
+// True if `token`, as produced by Utf8ExtractWords or Utf8SplitEmoji, is an
+// emoji rather than a word.
+bool Utf8IsEmoji(std::string_view token);
+
+// The first emoji of an emoji token, without skin tone, tags or ZWJ-joined
+// parts ("👍🏽" -> "👍", "❤‍🔥" -> "❤"). Flags and keycaps come back whole.
+std::string_view Utf8EmojiBase(std::string_view emoji);
+
+// Split `text` around the emoji in it: "love😂😂!" gives "love", "😂", "😂",
+// "!". Emoji are normalized as in Utf8ExtractWords; everything else is
+// copied unchanged.
+void Utf8SplitEmoji(std::string_view text, std::vector<std::string>& out);
+
+// Name of the ASCII kernel in use ("avx2", "sse2" or "scalar").
+const char* Utf8TextKernelName();
@@ -1,4 +1,6 @@
 #include "vader_sentiment.hpp"
+#include "utf8_text.hpp"
+#include "static_lexicon.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -17,14 +19,6 @@ static constexpr double N_SCALAR = -0.74;
 // Helpers
 // ---------------------------------------------------------------------------
 
-std::string VaderSentiment::toLower(const std::string& s)
-{
-    std::string out = s;
-    for (char& ch : out)
-        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-    return out;
-}
-
 bool VaderSentiment::isUpper(const std::string& s)
 {
     bool hasAlpha = false;
@@ -63,16 +57,44 @@ static std::string stripPuncIfWord(const std::string& token)
     return stripped;
 }
 
+// Whitespace-separated tokens; emoji are split off whatever they are glued
+// to ("love😂😂" -> "love", "😂", "😂") so they can match the lexicon.
 std::vector<std::string> VaderSentiment::tokenizeWordsAndEmoticons(const std::string& text)
 {
     std::vector<std::string> tokens;
-    std::istringstream iss(text);
-    std::string token;
+    std::vector<std::string> pieces;
+    auto isSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
 
-    while (iss >> token)
+    std::size_t i = 0;
+    while (i < text.size())
     {
-        std::string t = stripPuncIfWord(token);
-        tokens.push_back(t);
+        while (i < text.size() && isSpace(text[i]))
+            ++i;
+        const std::size_t start = i;
+        bool ascii = true;
+        while (i < text.size() && !isSpace(text[i]))
+        {
+            ascii = ascii && static_cast<unsigned char>(text[i]) < 0x80;
+            ++i;
+        }
+        if (i == start)
+            break;
+
+        if (ascii)
+        {
+            tokens.push_back(stripPuncIfWord(text.substr(start, i - start)));
+            continue;
+        }
+
+        pieces.clear();
+        Utf8SplitEmoji(std::string_view(text).substr(start, i - start), pieces);
+        for (std::string& piece : pieces)
+        {
+            if (Utf8IsEmoji(piece))
+                tokens.push_back(std::move(piece));
+            else
+                tokens.push_back(stripPuncIfWord(piece));
+        }
     }
     return tokens;
 }
@@ -90,33 +112,36 @@ bool VaderSentiment::allCapDifferential(const std::vector<std::string>& words)
     return (capDiff > 0 && capDiff < static_cast<int>(words.size()));
 }
 
-const std::vector<std::string>& VaderSentiment::negationWords()
+static constexpr auto NEGATIONS = MakeStaticStringSet({
+    "aint","arent","cannot","cant","couldnt","darent","didnt","doesnt",
+    "ain't","aren't","can't","couldn't","daren't","didn't","doesn't",
+    "dont","hadnt","hasnt","havent","isnt","mightnt","mustnt","neither",
+    "don't","hadn't","hasn't","haven't","isn't","mightn't","mustn't",
+    "neednt","needn't","never","none","nope","nor","not","nothing","nowhere",
+    "oughtnt","shant","shouldnt","uhuh","wasnt","werent",
+    "oughtn't","shan't","shouldn't","uh-uh","wasn't","weren't",
+    "without","wont","wouldnt","won't","wouldn't","rarely","seldom","despite"
+});
+
+bool VaderSentiment::isNegationWord(std::string_view lower) const
 {
-    static const std::vector<std::string> NEGATE = {
-        "aint","arent","cannot","cant","couldnt","darent","didnt","doesnt",
-        "ain't","aren't","can't","couldn't","daren't","didn't","doesn't",
-        "dont","hadnt","hasnt","havent","isnt","mightnt","mustnt","neither",
-        "don't","hadn't","hasn't","haven't","isn't","mightn't","mustn't",
-        "neednt","needn't","never","none","nope","nor","not","nothing","nowhere",
-        "oughtnt","shant","shouldnt","uhuh","wasnt","werent",
-        "oughtn't","shan't","shouldn't","uh-uh","wasn't","weren't",
-        "without","wont","wouldnt","won't","wouldn't","rarely","seldom","despite"
-    };
-    return NEGATE;
+    if (!negationOverrides_.empty() &&
+        negationOverrides_.find(std::string(lower)) != negationOverrides_.end())
+        return true;
+    return NEGATIONS.contains(lower);
 }
 
 bool VaderSentiment::isNegated(const std::vector<std::string>& words,
-                               bool includeNt)
+                               bool includeNt) const
 {
     std::vector<std::string> lower;
     lower.reserve(words.size());
     for (const auto& w : words)
-        lower.push_back(toLower(w));
+        lower.push_back(Utf8ToLower(w));
 
-    const auto& negs = negationWords();
-    for (const auto& n : negs)
+    for (const auto& w : lower)
     {
-        if (std::find(lower.begin(), lower.end(), n) != lower.end())
+        if (isNegationWord(w))
             return true;
     }
 
@@ -140,41 +165,208 @@ double VaderSentiment::normalizeScore(double score, double alpha)
     return norm;
 }
 
-const std::unordered_map<std::string, double>& VaderSentiment::boosterDict()
+static constexpr auto BOOSTERS = MakeStaticStringMap<double>({
+    // boosters
+    {"absolutely", B_INCR}, {"amazingly", B_INCR}, {"awfully", B_INCR},
+    {"completely", B_INCR}, {"decidedly", B_INCR}, {"deeply", B_INCR},
+    {"enormously", B_INCR}, {"entirely", B_INCR}, {"especially", B_INCR},
+    {"extremely", B_INCR}, {"fabulously", B_INCR}, {"highly", B_INCR},
+    {"incredibly", B_INCR}, {"intensely", B_INCR}, {"really", B_INCR},
+    {"remarkably", B_INCR}, {"so", B_INCR}, {"thoroughly", B_INCR},
+    {"totally", B_INCR}, {"tremendously", B_INCR}, {"uber", B_INCR},
+    {"unbelievably", B_INCR}, {"utterly", B_INCR}, {"very", B_INCR},
+
+    // dampeners
+    {"almost", B_DECR}, {"barely", B_DECR}, {"hardly", B_DECR},
+    {"just enough", B_DECR}, {"kind of", B_DECR}, {"kinda", B_DECR},
+    {"less", B_DECR}, {"little", B_DECR}, {"marginally", B_DECR},
+    {"occasionally", B_DECR}, {"partly", B_DECR}, {"scarcely", B_DECR},
+    {"slightly", B_DECR}, {"somewhat", B_DECR}, {"sort of", B_DECR}
+});
+
+const double* VaderSentiment::boosterScalar(std::string_view lower) const
 {
-    static const std::unordered_map<std::string, double> BOOSTERS = {
-        // boosters
-        {"absolutely", B_INCR}, {"amazingly", B_INCR}, {"awfully", B_INCR},
-        {"completely", B_INCR}, {"decidedly", B_INCR}, {"deeply", B_INCR},
-        {"enormously", B_INCR}, {"entirely", B_INCR}, {"especially", B_INCR},
-        {"extremely", B_INCR}, {"fabulously", B_INCR}, {"highly", B_INCR},
-        {"incredibly", B_INCR}, {"intensely", B_INCR}, {"really", B_INCR},
-        {"remarkably", B_INCR}, {"so", B_INCR}, {"thoroughly", B_INCR},
-        {"totally", B_INCR}, {"tremendously", B_INCR}, {"uber", B_INCR},
-        {"unbelievably", B_INCR}, {"utterly", B_INCR}, {"very", B_INCR},
-
-        // dampeners
-        {"almost", B_DECR}, {"barely", B_DECR}, {"hardly", B_DECR},
-        {"just enough", B_DECR}, {"kind of", B_DECR}, {"kinda", B_DECR},
-        {"less", B_DECR}, {"little", B_DECR}, {"marginally", B_DECR},
-        {"occasionally", B_DECR}, {"partly", B_DECR}, {"scarcely", B_DECR},
-        {"slightly", B_DECR}, {"somewhat", B_DECR}, {"sort of", B_DECR}
-    };
-    return BOOSTERS;
+    if (!boosterOverrides_.empty())
+    {
+        auto it = boosterOverrides_.find(std::string(lower));
+        if (it != boosterOverrides_.end())
+            return &it->second;
+    }
+    return BOOSTERS.find(lower);
 }
 
+// Valences on the lexicon's -4..4 scale for emoji common in chats, keyed
+// the way Utf8SplitEmoji emits them (no variation selectors). Skin tones
+// fall back to the base emoji in sentimentValence. Entries in the lexicon
+// file take precedence.
+static constexpr StaticStringMapEntry<double> EMOJI_VALENCES[] = {
+    // faces: joy / affection
+    {"\xF0\x9F\x98\x82",         1.8},   // 😂
+    {"\xF0\x9F\xA4\xA3",         1.9},   // 🤣
+    {"\xF0\x9F\x98\x86",         1.7},   // 😆
+    {"\xF0\x9F\x98\x84",         2.0},   // 😄
+    {"\xF0\x9F\x98\x83",         2.0},   // 😃
+    {"\xF0\x9F\x98\x80",         1.9},   // 😀
+    {"\xF0\x9F\x98\x81",         1.9},   // 😁
+    {"\xF0\x9F\x98\x8A",         2.2},   // 😊
+    {"\xE2\x98\xBA",             2.0},   // ☺
+    {"\xF0\x9F\x99\x82",         1.2},   // 🙂
+    {"\xF0\x9F\x98\x89",         1.3},   // 😉
+    {"\xF0\x9F\x98\x8D",         2.9},   // 😍
+    {"\xF0\x9F\xA5\xB0",         3.0},   // 🥰
+    {"\xF0\x9F\x98\x98",         2.5},   // 😘
+    {"\xF0\x9F\x98\x97",         1.3},   // 😗
+    {"\xF0\x9F\x98\x99",         1.5},   // 😙
+    {"\xF0\x9F\x98\x9A",         1.8},   // 😚
+    {"\xF0\x9F\x98\x8B",         1.8},   // 😋
+    {"\xF0\x9F\x98\x9B",         1.2},   // 😛
+    {"\xF0\x9F\x98\x9C",         1.3},   // 😜
+    {"\xF0\x9F\x98\x9D",         1.3},   // 😝
+    {"\xF0\x9F\xA4\x97",         2.2},   // 🤗
+    {"\xF0\x9F\xA4\xA9",         2.6},   // 🤩
+    {"\xF0\x9F\x98\x8E",         1.7},   // 😎
+    {"\xF0\x9F\xA5\xB3",         2.6},   // 🥳
+    {"\xF0\x9F\x98\x87",         1.9},   // 😇
+    {"\xF0\x9F\x98\x8C",         1.3},   // 😌
+    {"\xF0\x9F\xA5\xB2",         0.4},   // 🥲
+    {"\xF0\x9F\xA5\xBA",         0.5},   // 🥺
+    {"\xF0\x9F\x98\x85",         0.8},   // 😅
+    {"\xF0\x9F\x98\x8F",         0.6},   // 😏
+    {"\xF0\x9F\xA4\xAD",         0.9},   // 🤭
+    {"\xF0\x9F\x99\x83",         0.3},   // 🙃
+    {"\xF0\x9F\x98\x88",         0.5},   // 😈
+    {"\xF0\x9F\x99\x88",         0.4},   // 🙈
+    {"\xF0\x9F\x98\xBA",         1.5},   // 😺
+    {"\xF0\x9F\x98\xB8",         1.7},   // 😸
+    {"\xF0\x9F\x98\xB9",         1.7},   // 😹
+    {"\xF0\x9F\x98\xBB",         2.6},   // 😻
+    {"\xF0\x9F\x98\xBD",         1.9},   // 😽
+
+    // faces: sadness / anger / disgust / fear
+    {"\xF0\x9F\x98\xA2",        -2.2},   // 😢
+    {"\xF0\x9F\x98\xAD",        -0.9},   // 😭
+    {"\xF0\x9F\x98\x9E",        -2.1},   // 😞
+    {"\xF0\x9F\x98\x94",        -1.9},   // 😔
+    {"\xF0\x9F\x98\x9F",        -1.8},   // 😟
+    {"\xF0\x9F\x98\x95",        -1.3},   // 😕
+    {"\xF0\x9F\x99\x81",        -1.6},   // 🙁
+    {"\xE2\x98\xB9",            -1.9},   // ☹
+    {"\xF0\x9F\x98\xA3",        -1.9},   // 😣
+    {"\xF0\x9F\x98\x96",        -2.0},   // 😖
+    {"\xF0\x9F\x98\xAB",        -2.0},   // 😫
+    {"\xF0\x9F\x98\xA9",        -1.7},   // 😩
+    {"\xF0\x9F\x98\xBF",        -2.1},   // 😿
+    {"\xF0\x9F\x98\xA0",        -2.5},   // 😠
+    {"\xF0\x9F\x98\xA1",        -2.9},   // 😡
+    {"\xF0\x9F\xA4\xAC",        -3.2},   // 🤬
+    {"\xF0\x9F\x98\xA4",        -1.6},   // 😤
+    {"\xF0\x9F\x91\xBF",        -2.4},   // 👿
+    {"\xF0\x9F\x98\xBE",        -1.9},   // 😾
+    {"\xF0\x9F\x98\x92",        -1.7},   // 😒
+    {"\xF0\x9F\x99\x84",        -1.4},   // 🙄
+    {"\xF0\x9F\x98\x91",        -0.8},   // 😑
+    {"\xF0\x9F\x98\x90",        -0.4},   // 😐
+    {"\xF0\x9F\x98\xAC",        -0.8},   // 😬
+    {"\xF0\x9F\x98\xB1",        -1.5},   // 😱
+    {"\xF0\x9F\x98\xA8",        -2.0},   // 😨
+    {"\xF0\x9F\x98\xB0",        -2.0},   // 😰
+    {"\xF0\x9F\x98\xA5",        -1.7},   // 😥
+    {"\xF0\x9F\x98\x93",        -1.5},   // 😓
+    {"\xF0\x9F\x98\xAA",        -1.0},   // 😪
+    {"\xF0\x9F\x98\xB3",        -0.5},   // 😳
+    {"\xF0\x9F\x98\xB5",        -1.3},   // 😵
+    {"\xF0\x9F\xA4\xAF",        -0.5},   // 🤯
+    {"\xF0\x9F\xAB\xA0",        -0.4},   // 🫠
+    {"\xF0\x9F\xA4\xA2",        -2.3},   // 🤢
+    {"\xF0\x9F\xA4\xAE",        -2.6},   // 🤮
+    {"\xF0\x9F\xA4\x92",        -1.6},   // 🤒
+    {"\xF0\x9F\xA4\x95",        -1.7},   // 🤕
+    {"\xF0\x9F\x98\xB7",        -1.0},   // 😷
+    {"\xF0\x9F\xA5\xB1",        -0.6},   // 🥱
+    {"\xF0\x9F\xA5\xB5",        -0.5},   // 🥵
+    {"\xF0\x9F\xA5\xB6",        -0.7},   // 🥶
+    {"\xF0\x9F\x92\x80",        -0.3},   // 💀
+    {"\xF0\x9F\xA4\xA1",        -1.0},   // 🤡
+    {"\xF0\x9F\x92\xA9",        -1.4},   // 💩
+    {"\xF0\x9F\x98\xAE\xE2\x80\x8D\xF0\x9F\x92\xA8", -0.9},   // 😮‍💨
+
+    // hearts
+    {"\xE2\x9D\xA4",             3.0},   // ❤
+    {"\xF0\x9F\xA7\xA1",         2.7},   // 🧡
+    {"\xF0\x9F\x92\x9B",         2.7},   // 💛
+    {"\xF0\x9F\x92\x9A",         2.7},   // 💚
+    {"\xF0\x9F\x92\x99",         2.7},   // 💙
+    {"\xF0\x9F\x92\x9C",         2.7},   // 💜
+    {"\xF0\x9F\xA4\x8D",         2.3},   // 🤍
+    {"\xF0\x9F\xA4\x8E",         2.3},   // 🤎
+    {"\xF0\x9F\x96\xA4",         1.2},   // 🖤
+    {"\xF0\x9F\x92\x95",         2.9},   // 💕
+    {"\xF0\x9F\x92\x9E",         2.8},   // 💞
+    {"\xF0\x9F\x92\x93",         2.8},   // 💓
+    {"\xF0\x9F\x92\x97",         2.8},   // 💗
+    {"\xF0\x9F\x92\x96",         2.9},   // 💖
+    {"\xF0\x9F\x92\x98",         2.6},   // 💘
+    {"\xF0\x9F\x92\x9D",         2.6},   // 💝
+    {"\xF0\x9F\x92\x9F",         2.4},   // 💟
+    {"\xE2\x9D\xA3",             2.5},   // ❣
+    {"\xF0\x9F\x92\x8B",         2.2},   // 💋
+    {"\xF0\x9F\xAB\xB6",         2.6},   // 🫶
+    {"\xE2\x9D\xA4\xE2\x80\x8D\xF0\x9F\x94\xA5",  3.0},   // ❤‍🔥
+    {"\xE2\x9D\xA4\xE2\x80\x8D\xF0\x9F\xA9\xB9",  1.2},   // ❤‍🩹
+    {"\xF0\x9F\x92\x94",        -2.9},   // 💔
+
+    // gestures
+    {"\xF0\x9F\x91\x8D",         1.6},   // 👍
+    {"\xF0\x9F\x91\x8E",        -1.6},   // 👎
+    {"\xF0\x9F\x91\x8F",         1.8},   // 👏
+    {"\xF0\x9F\x99\x8C",         2.1},   // 🙌
+    {"\xF0\x9F\x99\x8F",         1.5},   // 🙏
+    {"\xF0\x9F\x92\xAA",         1.8},   // 💪
+    {"\xE2\x9C\x8C",             1.2},   // ✌
+    {"\xF0\x9F\x91\x8C",         1.4},   // 👌
+    {"\xF0\x9F\xA4\x9D",         1.3},   // 🤝
+    {"\xF0\x9F\xA4\x9E",         1.1},   // 🤞
+    {"\xF0\x9F\x91\x8B",         0.6},   // 👋
+    {"\xF0\x9F\x96\x95",        -2.9},   // 🖕
+
+    // objects and symbols
+    {"\xE2\x9C\xA8",             1.5},   // ✨
+    {"\xF0\x9F\x8E\x89",         2.5},   // 🎉
+    {"\xF0\x9F\x8E\x8A",         2.3},   // 🎊
+    {"\xF0\x9F\xA5\x82",         1.8},   // 🥂
+    {"\xF0\x9F\x8D\xBE",         1.8},   // 🍾
+    {"\xF0\x9F\x8E\x82",         1.8},   // 🎂
+    {"\xF0\x9F\x8E\x81",         1.8},   // 🎁
+    {"\xF0\x9F\x8C\xB9",         1.8},   // 🌹
+    {"\xF0\x9F\x92\x90",         1.9},   // 💐
+    {"\xF0\x9F\x8C\xB8",         1.3},   // 🌸
+    {"\xF0\x9F\x8C\x9E",         1.5},   // 🌞
+    {"\xE2\x98\x80",             1.2},   // ☀
+    {"\xF0\x9F\x8C\x88",         1.6},   // 🌈
+    {"\xE2\xAD\x90",             1.4},   // ⭐
+    {"\xF0\x9F\x8C\x9F",         1.7},   // 🌟
+    {"\xF0\x9F\x92\xAB",         1.2},   // 💫
+    {"\xF0\x9F\x94\xA5",         1.5},   // 🔥
+    {"\xF0\x9F\x92\xAF",         2.0},   // 💯
+    {"\xF0\x9F\x8F\x86",         2.0},   // 🏆
+    {"\xF0\x9F\xA5\x87",         2.0},   // 🥇
+    {"\xF0\x9F\x91\x91",         1.4},   // 👑
+    {"\xE2\x9C\x85",             1.0},   // ✅
+    {"\xE2\x9D\x8C",            -1.2},   // ❌
+    {"\xF0\x9F\x9A\xAB",        -1.3},   // 🚫
+    {"\xE2\x9A\xA0",            -1.0},   // ⚠
+};
+
 double VaderSentiment::scalarIncDec(const std::string& word,
                                     double valence,
-                                    bool isCapDiff)
+                                    bool isCapDiff) const
 {
     double scalar = 0.0;
-    std::string lower = toLower(word);
+    std::string lower = Utf8ToLower(word);
 
-    const auto& boosters = boosterDict();
-    auto it = boosters.find(lower);
-    if (it != boosters.end())
+    if (const double* booster = boosterScalar(lower))
     {
-        scalar = it->second;
+        scalar = *booster;
 
         if (valence < 0.0)
             scalar *= -1.0;
@@ -240,7 +432,7 @@ void VaderSentiment::butCheck(const std::vector<std::string>& words,
     std::vector<std::string> lower;
     lower.reserve(words.size());
     for (const auto& w : words)
-        lower.push_back(toLower(w));
+        lower.push_back(Utf8ToLower(w));
 
     auto it = std::find(lower.begin(), lower.end(), "but");
     if (it == lower.end())
@@ -268,7 +460,7 @@ double VaderSentiment::leastCheck(double valence,
     std::vector<std::string> lower;
     lower.reserve(words.size());
     for (const auto& w : words)
-        lower.push_back(toLower(w));
+        lower.push_back(Utf8ToLower(w));
 
     if (lower[i - 1] == "least")
     {
@@ -289,12 +481,12 @@ double VaderSentiment::leastCheck(double valence,
 double VaderSentiment::negationCheck(double valence,
                                      const std::vector<std::string>& words,
                                      int start_i,
-                                     std::size_t i)
+                                     std::size_t i) const
 {
     std::vector<std::string> lower;
     lower.reserve(words.size());
     for (const auto& w : words)
-        lower.push_back(toLower(w));
+        lower.push_back(Utf8ToLower(w));
 
     if (start_i == 0)
     {
@@ -344,33 +536,36 @@ double VaderSentiment::negationCheck(double valence,
     return valence;
 }
 
+static constexpr auto SPECIAL_CASES = MakeStaticStringMap<double>({
+    {"the shit",       3.0},
+    {"the bomb",       3.0},
+    {"bad ass",        1.5},
+    {"badass",         1.5},
+    {"bus stop",       0.0},
+    {"yeah right",    -2.0},
+    {"kiss of death", -1.5},
+    {"to die for",     3.0},
+    {"beating heart",  3.1},
+    {"broken heart",  -2.9}
+});
+
 double VaderSentiment::specialIdiomsCheck(double valence,
                                           const std::vector<std::string>& words,
-                                          std::size_t i)
+                                          std::size_t i) const
 {
-    static const std::unordered_map<std::string, double> SPECIAL_CASES = {
-        {"the shit",       3.0},
-        {"the bomb",       3.0},
-        {"bad ass",        1.5},
-        {"badass",         1.5},
-        {"bus stop",       0.0},
-        {"yeah right",    -2.0},
-        {"kiss of death", -1.5},
-        {"to die for",     3.0},
-        {"beating heart",  3.1},
-        {"broken heart",  -2.9}
-    };
-
     std::vector<std::string> lower;
     lower.reserve(words.size());
     for (const auto& w : words)
-        lower.push_back(toLower(w));
+        lower.push_back(Utf8ToLower(w));
 
     auto findSeq = [&](const std::string& seq) -> double {
-        auto it = SPECIAL_CASES.find(seq);
-        if (it != SPECIAL_CASES.end())
-            return it->second;
-        return 0.0;
+        if (!specialCaseOverrides_.empty()) {
+            auto it = specialCaseOverrides_.find(seq);
+            if (it != specialCaseOverrides_.end())
+                return it->second;
+        }
+        const double* v = SPECIAL_CASES.find(seq);
+        return v ? *v : 0.0;
     };
 
     if (i >= 1)
@@ -417,13 +612,11 @@ double VaderSentiment::specialIdiomsCheck(double valence,
     }
 
     // Booster bigrams behind the current token.
-    const auto& boosters = boosterDict();
     if (i >= 2)
     {
         std::string twoone = lower[i - 2] + " " + lower[i - 1];
-        auto it = boosters.find(twoone);
-        if (it != boosters.end())
-            valence += it->second;
+        if (const double* booster = boosterScalar(twoone))
+            valence += *booster;
     }
 
     return valence;
@@ -441,9 +634,11 @@ void VaderSentiment::sentimentValence(double& valence,
 {
     bool isCapDiff = allCapDifferential(words);
     const std::string& item = words[i];
-    std::string lowerItem   = toLower(item);
+    std::string lowerItem   = Utf8ToLower(item);
 
     auto itLex = lexicon_.find(lowerItem);
+    if (itLex == lexicon_.end() && Utf8IsEmoji(item))
+        itLex = lexicon_.find(std::string(Utf8EmojiBase(item)));
     if (itLex == lexicon_.end())
     {
         sentiments.push_back(0.0);
@@ -454,19 +649,19 @@ void VaderSentiment::sentimentValence(double& valence,
 
     if (lowerItem == "no" && i + 1 < words.size())
     {
-        std::string nextLower = toLower(words[i + 1]);
+        std::string nextLower = Utf8ToLower(words[i + 1]);
         if (lexicon_.find(nextLower) != lexicon_.end())
             valence = 0.0;
     }
 
-    if (i > 0 && toLower(words[i - 1]) == "no")
+    if (i > 0 && Utf8ToLower(words[i - 1]) == "no")
         valence = itLex->second * N_SCALAR;
-    else if (i > 1 && toLower(words[i - 2]) == "no")
+    else if (i > 1 && Utf8ToLower(words[i - 2]) == "no")
         valence = itLex->second * N_SCALAR;
     else if (i > 2 &&
-             toLower(words[i - 3]) == "no" &&
-             (toLower(words[i - 1]) == "or" ||
-              toLower(words[i - 1]) == "nor"))
+             Utf8ToLower(words[i - 3]) == "no" &&
+             (Utf8ToLower(words[i - 1]) == "or" ||
+              Utf8ToLower(words[i - 1]) == "nor"))
         valence = itLex->second * N_SCALAR;
 
     if (isUpper(item) && isCapDiff)
@@ -481,7 +676,7 @@ void VaderSentiment::sentimentValence(double& valence,
         {
             std::size_t backIdx = i - (start_i + 1);
             std::string prev     = words[backIdx];
-            std::string prevLower = toLower(prev);
+            std::string prevLower = Utf8ToLower(prev);
 
             if (lexicon_.find(prevLower) == lexicon_.end())
             {
@@ -524,13 +719,11 @@ void VaderSentiment::polarityScores(const std::string& text,
     std::vector<double> sentiments;
     sentiments.reserve(words.size());
 
-    const auto& boosters = boosterDict();
-
     for (std::size_t i = 0; i < words.size(); ++i)
     {
-        std::string lower = toLower(words[i]);
+        std::string lower = Utf8ToLower(words[i]);
 
-        if (boosters.find(lower) != boosters.end())
+        if (boosterScalar(lower))
         {
             sentiments.push_back(0.0);
             continue;
@@ -538,7 +731,7 @@ void VaderSentiment::polarityScores(const std::string& text,
 
         if (i < words.size() - 1 &&
             lower == "kind" &&
-            toLower(words[i + 1]) == "of")
+            Utf8ToLower(words[i + 1]) == "of")
         {
             sentiments.push_back(0.0);
             continue;
@@ -621,8 +814,28 @@ bool VaderSentiment::loadLexicon(const std::string& filepath)
         if (!(iss >> word >> score))
             continue;
 
-        lexicon_[toLower(word)] = score;
+        lexicon_[Utf8ToLower(word)] = score;
     }
 
-    return !lexicon_.empty();
+    if (lexicon_.empty())
+        return false;
+
+    for (const auto& e : EMOJI_VALENCES)
+        lexicon_.emplace(e.key, e.value);
+    return true;
+}
+
+void VaderSentiment::setBooster(const std::string& word, double scalar)
+{
+    boosterOverrides_[Utf8ToLower(word)] = scalar;
+}
+
+void VaderSentiment::addNegationWord(const std::string& word)
+{
+    negationOverrides_.insert(Utf8ToLower(word));
+}
+
+void VaderSentiment::setSpecialCase(const std::string& phrase, double valence)
+{
+    specialCaseOverrides_[Utf8ToLower(phrase)] = valence;
 }
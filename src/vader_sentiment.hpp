@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Lightweight VADER-style sentiment analyzer.
@@ -13,6 +15,8 @@ public:
 
     // Load lexicon from a VADER-style file:
     // word <whitespace> score
+    // Built-in valences for common emoji are added for any emoji the file
+    // does not list.
     bool loadLexicon(const std::string& filepath);
 
     // Convenience: return only the compound score in [-1, 1].
@@ -27,24 +31,35 @@ public:
                         double& pos,
                         double& compound) const;
 
+    // Runtime additions to the built-in booster/dampener, negation and
+    // idiom tables; an entry here wins over a built-in one. Phrases are
+    // lowercase words separated by single spaces ("kind of").
+    void setBooster(const std::string& word, double scalar);
+    void addNegationWord(const std::string& word);
+    void setSpecialCase(const std::string& phrase, double valence);
+
 private:
     // Lexicon entries are stored in lowercase.
     std::unordered_map<std::string, double> lexicon_;
 
+    // Overrides of the built-in tables (see setBooster etc.), lowercase.
+    std::unordered_map<std::string, double> boosterOverrides_;
+    std::unordered_set<std::string>         negationOverrides_;
+    std::unordered_map<std::string, double> specialCaseOverrides_;
+
     // Text helpers
-    static std::string toLower(const std::string& s);
     static bool isUpper(const std::string& s);
     static bool allCapDifferential(const std::vector<std::string>& words);
     static std::vector<std::string> tokenizeWordsAndEmoticons(const std::string& text);
-    static bool isNegated(const std::vector<std::string>& words, bool includeNt = true);
+    bool isNegated(const std::vector<std::string>& words, bool includeNt = true) const;
 
     // Map summed score into [-1, 1].
     static double normalizeScore(double score, double alpha = 15.0);
 
     // Booster/dampener effect for words such as "very", "barely", etc.
-    static double scalarIncDec(const std::string& word,
-                               double valence,
-                               bool isCapDiff);
+    double scalarIncDec(const std::string& word,
+                        double valence,
+                        bool isCapDiff) const;
 
     // Sentence-level punctuation emphasis.
     static double amplifyExclamation(const std::string& text);
@@ -66,15 +81,15 @@ private:
                              std::size_t i);
 
     // Apply negation rules within a small window behind the current token.
-    static double negationCheck(double valence,
-                                const std::vector<std::string>& words,
-                                int start_i,
-                                std::size_t i);
+    double negationCheck(double valence,
+                         const std::vector<std::string>& words,
+                         int start_i,
+                         std::size_t i) const;
 
     // Override valence for special multi-word expressions.
-    static double specialIdiomsCheck(double valence,
-                                     const std::vector<std::string>& words,
-                                     std::size_t i);
+    double specialIdiomsCheck(double valence,
+                              const std::vector<std::string>& words,
+                              std::size_t i) const;
 
     // Compute valence for a single token.
     void sentimentValence(double& valence,
@@ -82,7 +97,8 @@ private:
                           std::size_t i,
                           std::vector<double>& sentiments) const;
 
-    // Booster/dampener table and negation list.
-    static const std::unordered_map<std::string, double>& boosterDict();
-    static const std::vector<std::string>& negationWords();
+    // Booster/dampener scalar of a lowercase word or bigram (nullptr if
+    // none) and negation test; built-in tables plus overrides.
+    const double* boosterScalar(std::string_view lower) const;
+    bool isNegationWord(std::string_view lower) const;
 };
@@ -2,95 +2,94 @@
 // Convert exported WhatsApp text chats into Instagram-style
 // message_X.json files that the analyzer can consume.
 
+#include "whatsapp_convert.hpp"
+
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <set>
 #include <filesystem>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
 #include <algorithm>
-#include <cctype>
-
-#include "json.hpp"
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "export_writer.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include "zip_reader.hpp"
 
 namespace fs = std::filesystem;
-using json = nlohmann::json;
-
-// Simple representation of an Instagram-style message.
-// (Identical layout to discord_convert.cpp)
-struct InstaMessage
-{
-    std::string sender_name;
-    long long   timestamp_ms = 0;
-    std::string content;
-};
 
 // -------------------------------------------------------------
-// Generic string helpers
+// Generic string helpers (all on views into the mapped file)
 // -------------------------------------------------------------
 
-static inline void rtrimInPlace(std::string& s)
+static inline bool isAsciiSpace(unsigned char c)
 {
-    while (!s.empty() && (s.back() == '\r' || s.back() == '\n'))
-        s.pop_back();
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
 }
 
-static std::string trimCopy(const std::string& s)
+static inline char asciiLower(char c)
 {
-    std::size_t start = 0;
-    std::size_t end   = s.size();
-
-    while (start < end &&
-           std::isspace(static_cast<unsigned char>(s[start])))
-        ++start;
-    while (end > start &&
-           std::isspace(static_cast<unsigned char>(s[end - 1])))
-        --end;
-
-    return s.substr(start, end - start);
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
 }
 
-static std::string toLowerCopy(const std::string& s)
+// Strip trailing CR/LF.
+static inline std::string_view rtrimView(std::string_view s)
 {
-    std::string out = s;
-    for (char& ch : out)
-        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-    return out;
+    while (!s.empty() && (s.back() == '\r' || s.back() == '\n'))
+        s.remove_suffix(1);
+    return s;
 }
 
-// Strip leading left-to-right mark (U+200E) if present.
-static std::string stripBidiMarks(const std::string& s)
+static std::string_view trimView(std::string_view s)
 {
-    std::string out;
-    out.reserve(s.size());
-
-    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
-    std::size_t i = 0;
-    bool skippingPrefixMarks = true;
+    while (!s.empty() && isAsciiSpace(static_cast<unsigned char>(s.front())))
+        s.remove_prefix(1);
+    while (!s.empty() && isAsciiSpace(static_cast<unsigned char>(s.back())))
+        s.remove_suffix(1);
+    return s;
+}
 
-    while (i < s.size())
-    {
-        unsigned char c = p[i];
+// Strip leading left-to-right marks (U+200E, encoded as E2 80 8E).
+static std::string_view stripBidiMarks(std::string_view s)
+{
+    while (s.size() >= 3 &&
+           static_cast<unsigned char>(s[0]) == 0xE2 &&
+           static_cast<unsigned char>(s[1]) == 0x80 &&
+           static_cast<unsigned char>(s[2]) == 0x8E)
+        s.remove_prefix(3);
+    return s;
+}
 
-        if (skippingPrefixMarks && c == 0xE2)
-        {
-            // U+200E encoded as E2 80 8E in UTF-8.
-            if (i + 2 < s.size() && p[i+1] == 0x80 && p[i+2] == 0x8E)
-            {
-                i += 3;
-                continue;
-            }
-        }
+// ASCII case-insensitive comparisons; `lower` must already be lowercase.
+static bool equalsLower(std::string_view s, std::string_view lower)
+{
+    if (s.size() != lower.size())
+        return false;
+    for (std::size_t i = 0; i < s.size(); ++i)
+        if (asciiLower(s[i]) != lower[i])
+            return false;
+    return true;
+}
 
-        skippingPrefixMarks = false;
-        out.push_back(static_cast<char>(c));
-        ++i;
-    }
+static bool startsWithLower(std::string_view s, std::string_view lower)
+{
+    return s.size() >= lower.size() && equalsLower(s.substr(0, lower.size()), lower);
+}
 
-    return out;
+static bool containsLower(std::string_view s, std::string_view lower)
+{
+    if (lower.size() > s.size())
+        return false;
+    for (std::size_t i = 0; i + lower.size() <= s.size(); ++i)
+        if (equalsLower(s.substr(i, lower.size()), lower))
+            return true;
+    return false;
 }
 
 // -------------------------------------------------------------
@@ -109,86 +108,91 @@ static long long daysFromCivil(int y, unsigned m, unsigned d)
     return static_cast<long long>(era * 146097 + static_cast<int>(doe) - 719468);
 }
 
-// Parse WhatsApp timestamp into milliseconds since epoch.
-//
-// Typical examples from your export (_chat.txt):
-//   "11/7/17, 9:20:04 PM"
-//   "11/8/17, 6:47:25 AM"
-//
-// We assume US-style month/day/year and 12-hour clock with AM/PM.
-// If parsing fails, we return 0 and let the analyzer treat it as unknown.
-static long long parseWhatsAppTimestampMs(const std::string& tsRaw)
+// Minimal cursor over a timestamp. Non-ASCII bytes (narrow no-break spaces,
+// bidi marks) count as whitespace, like plain spaces.
+struct TsScanner
 {
-    if (tsRaw.empty())
-        return 0;
+    const char* p;
+    const char* end;
 
-    // Replace any non-ASCII bytes with spaces so we don't have to
-    // reason about narrow no-break spaces, bidi marks, etc.
-    std::string s;
-    s.reserve(tsRaw.size());
-    for (unsigned char ch : tsRaw)
+    void skipSpace()
     {
-        if (ch < 0x80)
-            s.push_back(static_cast<char>(ch));
-        else
-            s.push_back(' ');
+        while (p < end && (isAsciiSpace(static_cast<unsigned char>(*p)) ||
+                           static_cast<unsigned char>(*p) >= 0x80))
+            ++p;
     }
 
-    // Example now looks like: "11/7/17, 9:20:04  PM"
-    std::size_t commaPos = s.find(',');
-    if (commaPos == std::string::npos)
-        return 0;
-
-    std::string datePart = trimCopy(s.substr(0, commaPos));
-    std::string timePart = trimCopy(s.substr(commaPos + 1));
-
-    // Parse date: mm/dd/yy
-    int month = 0, day = 0, year2 = 0;
-    char sep1 = 0, sep2 = 0;
+    bool number(int& out, int maxDigits = 4)
     {
-        std::istringstream ds(datePart);
-        ds >> month >> sep1 >> day >> sep2 >> year2;
-        if (!ds || sep1 != '/' || sep2 != '/')
-            return 0;
+        skipSpace();
+        int digits = 0;
+        int v = 0;
+        while (p < end && *p >= '0' && *p <= '9' && digits < maxDigits)
+        {
+            v = v * 10 + (*p - '0');
+            ++p;
+            ++digits;
+        }
+        out = v;
+        return digits > 0;
     }
 
-    int year = (year2 >= 70 ? 1900 + year2 : 2000 + year2);
-
-    // timePart: "9:20:04 PM" (maybe with double spaces)
-    int hour = 0, minute = 0, second = 0;
-    std::string ampm;
-
+    bool expect(char c)
     {
-        std::istringstream ts(timePart);
-        std::string clockStr;
-        ts >> clockStr >> ampm;
-
-        if (clockStr.empty() || ampm.empty())
+        skipSpace();
+        if (p < end && *p == c)
         {
-            // Fallback: last two characters are AM/PM, the rest is time.
-            if (timePart.size() >= 2)
-            {
-                ampm = timePart.substr(timePart.size() - 2);
-                clockStr = trimCopy(timePart.substr(0, timePart.size() - 2));
-            }
+            ++p;
+            return true;
         }
+        return false;
+    }
 
-        char c1 = 0, c2 = 0;
-        std::istringstream cs(clockStr);
-        cs >> hour >> c1 >> minute >> c2 >> second;
-        if (!cs || c1 != ':' || c2 != ':')
-            return 0;
+    // Optional single character (e.g. the '.' after "31.12.17" or ',').
+    void accept(char c)
+    {
+        skipSpace();
+        if (p < end && *p == c)
+            ++p;
     }
+};
 
-    std::string ampmLow = toLowerCopy(ampm);
-    bool isPM = (ampmLow == "pm");
-    bool isAM = (ampmLow == "am");
-    if (!isPM && !isAM)
-        return 0;
+static inline int expandYear(int year, int digits)
+{
+    if (digits > 2)
+        return year;
+    return year >= 70 ? 1900 + year : 2000 + year;
+}
 
-    // Convert to 24-hour clock
-    if (isPM && hour < 12) hour += 12;
-    if (isAM && hour == 12) hour = 0;
+// AM/PM marker: "AM", "pm", "a.m.", "p. m." ... Sets isPM; false if absent.
+static bool scanAmPm(TsScanner& sc, bool& isPM)
+{
+    sc.skipSpace();
+    if (sc.p >= sc.end)
+        return false;
+    char a = asciiLower(*sc.p);
+    if (a != 'a' && a != 'p')
+        return false;
+    ++sc.p;
+    sc.accept('.');
+    sc.skipSpace();
+    if (sc.p >= sc.end || asciiLower(*sc.p) != 'm')
+        return false;
+    ++sc.p;
+    if (sc.p < sc.end && *sc.p == '.')
+        ++sc.p;
+    if (sc.p < sc.end && static_cast<unsigned char>(*sc.p) < 0x80 &&
+        !isAsciiSpace(static_cast<unsigned char>(*sc.p)))
+        return false; // "PMx" is not an AM/PM marker
+    isPM = (a == 'p');
+    return true;
+}
+
+static long long civilToMs(int year, int month, int day, int hour, int minute, int second)
+{
+    if (month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60)
+        return 0;
 
     long long days = daysFromCivil(year,
                                    static_cast<unsigned>(month),
@@ -200,6 +204,197 @@ static long long parseWhatsAppTimestampMs(const std::string& tsRaw)
     return seconds * 1000LL;
 }
 
+// -------------------------------------------------------------
+// Timestamp formats
+// -------------------------------------------------------------
+//
+// Exports follow the phone's locale, e.g.
+//   "11/7/17, 9:20:04 PM"      iOS, US
+//   "07.11.17, 21:20"          Android, German
+//   "07/11/2017, 21:20:04"     iOS, UK
+//   "2017-11-07, 21:20"        ISO-style locales
+//
+// The format is detected once per file (detectWhatsAppLayout) and every
+// line is then parsed by a parser instantiated for exactly that format.
+
+enum class WhatsAppDateOrder { MDY, DMY, YMD };
+
+// Returns milliseconds since epoch, or 0 if the text does not match.
+template <WhatsAppDateOrder Order, char Sep, bool Seconds, bool TwelveHour>
+static long long parseWhatsAppTimestampAs(std::string_view ts)
+{
+    TsScanner sc{ ts.data(), ts.data() + ts.size() };
+
+    int f[3] = {};
+    const char* fieldStart[3] = {};
+    const char* fieldEnd[3] = {};
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i > 0 && !sc.expect(Sep))
+            return 0;
+        sc.skipSpace();
+        fieldStart[i] = sc.p;
+        if (!sc.number(f[i]))
+            return 0;
+        fieldEnd[i] = sc.p;
+    }
+
+    int year, month, day, yearDigits;
+    if constexpr (Order == WhatsAppDateOrder::YMD)
+    {
+        year = f[0]; month = f[1]; day = f[2];
+        yearDigits = static_cast<int>(fieldEnd[0] - fieldStart[0]);
+    }
+    else if constexpr (Order == WhatsAppDateOrder::MDY)
+    {
+        month = f[0]; day = f[1]; year = f[2];
+        yearDigits = static_cast<int>(fieldEnd[2] - fieldStart[2]);
+    }
+    else
+    {
+        day = f[0]; month = f[1]; year = f[2];
+        yearDigits = static_cast<int>(fieldEnd[2] - fieldStart[2]);
+    }
+    year = expandYear(year, yearDigits);
+
+    if constexpr (Sep == '.')
+        sc.accept('.');
+    sc.accept(',');
+
+    int hour = 0, minute = 0, second = 0;
+    if (!sc.number(hour, 2) || !sc.expect(':') || !sc.number(minute, 2))
+        return 0;
+    if constexpr (Seconds)
+    {
+        if (!sc.expect(':') || !sc.number(second, 2))
+            return 0;
+    }
+
+    if constexpr (TwelveHour)
+    {
+        bool isPM = false;
+        if (!scanAmPm(sc, isPM) || hour > 12)
+            return 0;
+
+        // Convert to 24-hour clock
+        if (isPM && hour < 12) hour += 12;
+        if (!isPM && hour == 12) hour = 0;
+    }
+
+    return civilToMs(year, month, day, hour, minute, second);
+}
+
+using WhatsAppTsParser = long long (*)(std::string_view);
+
+template <WhatsAppDateOrder Order, char Sep>
+static WhatsAppTsParser pickClockParser(bool seconds, bool twelveHour)
+{
+    if (seconds)
+        return twelveHour ? &parseWhatsAppTimestampAs<Order, Sep, true, true>
+                          : &parseWhatsAppTimestampAs<Order, Sep, true, false>;
+    return twelveHour ? &parseWhatsAppTimestampAs<Order, Sep, false, true>
+                      : &parseWhatsAppTimestampAs<Order, Sep, false, false>;
+}
+
+template <WhatsAppDateOrder Order>
+static WhatsAppTsParser pickSepParser(char sep, bool seconds, bool twelveHour)
+{
+    switch (sep)
+    {
+    case '.': return pickClockParser<Order, '.'>(seconds, twelveHour);
+    case '-': return pickClockParser<Order, '-'>(seconds, twelveHour);
+    default:  return pickClockParser<Order, '/'>(seconds, twelveHour);
+    }
+}
+
+static WhatsAppTsParser pickTimestampParser(WhatsAppDateOrder order, char sep,
+                                            bool seconds, bool twelveHour)
+{
+    switch (order)
+    {
+    case WhatsAppDateOrder::DMY: return pickSepParser<WhatsAppDateOrder::DMY>(sep, seconds, twelveHour);
+    case WhatsAppDateOrder::YMD: return pickSepParser<WhatsAppDateOrder::YMD>(sep, seconds, twelveHour);
+    default:                     return pickSepParser<WhatsAppDateOrder::MDY>(sep, seconds, twelveHour);
+    }
+}
+
+// Format-agnostic reading of a timestamp, used only while sniffing.
+struct WhatsAppTsFields
+{
+    int  num[3]    = {};
+    int  digits[3] = {};
+    char sep       = 0;
+    int  hour = 0, minute = 0, second = 0;
+    bool hasSeconds = false;
+    bool hasAmPm    = false;
+    bool isPM       = false;
+};
+
+static bool scanTimestampFields(std::string_view ts, WhatsAppTsFields& out)
+{
+    TsScanner sc{ ts.data(), ts.data() + ts.size() };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (i > 0)
+        {
+            sc.skipSpace();
+            if (sc.p >= sc.end)
+                return false;
+            char c = *sc.p;
+            if (c != '/' && c != '.' && c != '-')
+                return false;
+            if (i == 1)
+                out.sep = c;
+            else if (c != out.sep)
+                return false;
+            ++sc.p;
+        }
+        sc.skipSpace();
+        const char* start = sc.p;
+        if (!sc.number(out.num[i]))
+            return false;
+        out.digits[i] = static_cast<int>(sc.p - start);
+    }
+
+    if (out.sep == '.')
+        sc.accept('.');
+    sc.accept(',');
+
+    if (!sc.number(out.hour, 2) || !sc.expect(':') || !sc.number(out.minute, 2))
+        return false;
+    if (sc.expect(':'))
+    {
+        if (!sc.number(out.second, 2))
+            return false;
+        out.hasSeconds = true;
+    }
+    out.hasAmPm = scanAmPm(sc, out.isPM);
+    return true;
+}
+
+static long long fieldsToMs(const WhatsAppTsFields& f, WhatsAppDateOrder order)
+{
+    int year, month, day, yearDigits;
+    switch (order)
+    {
+    case WhatsAppDateOrder::YMD:
+        year = f.num[0]; month = f.num[1]; day = f.num[2]; yearDigits = f.digits[0]; break;
+    case WhatsAppDateOrder::MDY:
+        month = f.num[0]; day = f.num[1]; year = f.num[2]; yearDigits = f.digits[2]; break;
+    default:
+        day = f.num[0]; month = f.num[1]; year = f.num[2]; yearDigits = f.digits[2]; break;
+    }
+
+    int hour = f.hour;
+    if (f.hasAmPm)
+    {
+        if (f.isPM && hour < 12) hour += 12;
+        if (!f.isPM && hour == 12) hour = 0;
+    }
+    return civilToMs(expandYear(year, yearDigits), month, day, hour, f.minute, f.second);
+}
+
 // -------------------------------------------------------------
 // Content filtering: skip WhatsApp system / media messages
 // -------------------------------------------------------------
@@ -210,55 +405,57 @@ static long long parseWhatsAppTimestampMs(const std::string& tsRaw)
 //   - "This message was deleted"
 //   - The WhatsApp end-to-end-encryption banner
 
-static bool isWhatsAppSystemOrOmitted(const std::string& rawContent)
+static bool isWhatsAppSystemOrOmitted(std::string_view rawContent)
 {
-    std::string s = stripBidiMarks(rawContent);
-    s = trimCopy(s);
-    std::string low = toLowerCopy(s);
+    std::string_view s = trimView(stripBidiMarks(rawContent));
 
-    if (low.empty())
+    if (s.empty())
         return true;
 
-    // Media / attachment placeholders
-    static const char* MEDIA_PLACEHOLDERS[] = {
-        "<media omitted>",
-        "image omitted",
-        "video omitted",
-        "audio omitted",
-        "document omitted",
-        "sticker omitted",
-        "sticker ommitted", // common typo
-        "gif omitted"
-    };
-
-    for (const char* p : MEDIA_PLACEHOLDERS)
+    // Every placeholder below is short; real messages rarely are.
+    if (s.size() <= 24)
     {
-        if (low == p)
-            return true;
-    }
+        // Media / attachment placeholders
+        static const char* MEDIA_PLACEHOLDERS[] = {
+            "<media omitted>",
+            "image omitted",
+            "video omitted",
+            "audio omitted",
+            "document omitted",
+            "sticker omitted",
+            "sticker ommitted", // common typo
+            "gif omitted"
+        };
+
+        for (const char* p : MEDIA_PLACEHOLDERS)
+        {
+            if (equalsLower(s, p))
+                return true;
+        }
 
-    // Call events
-    static const char* CALL_EVENTS[] = {
-        "voice call",
-        "missed voice call",
-        "missed voicee call", // typo from your prompt
-        "video call",
-        "missed video call"
-    };
+        // Call events
+        static const char* CALL_EVENTS[] = {
+            "voice call",
+            "missed voice call",
+            "missed voicee call", // typo from your prompt
+            "video call",
+            "missed video call"
+        };
 
-    for (const char* p : CALL_EVENTS)
-    {
-        if (low == p)
+        for (const char* p : CALL_EVENTS)
+        {
+            if (equalsLower(s, p))
+                return true;
+        }
+
+        // Deleted messages
+        if (equalsLower(s, "this message was deleted"))
             return true;
     }
 
-    // Deleted messages
-    if (low == "this message was deleted")
-        return true;
-
     // End-to-end encryption notice.
-    if (low.find("messages and calls are") == 0 &&
-        low.find("end-to-end encrypted") != std::string::npos)
+    if (startsWithLower(s, "messages and calls are") &&
+        containsLower(s, "end-to-end encrypted"))
     {
         return true;
     }
@@ -270,129 +467,435 @@ static bool isWhatsAppSystemOrOmitted(const std::string& rawContent)
 // Line parsing
 // -------------------------------------------------------------
 
-// Try to parse a single WhatsApp line that starts a new message.
-// Returns true on success and fills sender / timestamp / content.
-// Lines that are continuations of previous messages return false.
-static bool parseWhatsAppHeaderLine(const std::string& rawLine,
-                                    long long&        outTimestampMs,
-                                    std::string&      outSender,
-                                    std::string&      outContent)
+// iOS exports bracket the timestamp:      "[11/7/17, 9:20:04 PM] Name: text"
+// Android exports use a dash separator:   "07.11.17, 21:20 - Name: text"
+enum class WhatsAppHeaderStyle { Bracketed, Dashed };
+
+struct WhatsAppLayout
 {
-    std::string line = rawLine;
-    rtrimInPlace(line);
+    WhatsAppHeaderStyle style   = WhatsAppHeaderStyle::Bracketed;
+    WhatsAppTsParser    parseTs = &parseWhatsAppTimestampAs<WhatsAppDateOrder::MDY, '/', true, true>;
+};
 
-    // Strip leading bidi marks before checking for '['
-    line = stripBidiMarks(line);
+// Split a line (without its newline) that starts a new message into its
+// timestamp and the "Name: message" remainder. Lines that are
+// continuations of previous messages return false.
+static bool splitWhatsAppHeaderLine(const WhatsAppLayout& layout,
+                                    std::string_view      rawLine,
+                                    long long&            outTimestampMs,
+                                    std::string_view&     outRest)
+{
+    // Strip leading bidi marks before checking the header shape
+    std::string_view line = stripBidiMarks(rtrimView(rawLine));
 
-    if (line.empty() || line[0] != '[')
+    if (line.empty())
         return false;
 
-    std::size_t closeBracket = line.find(']');
-    if (closeBracket == std::string::npos)
-        return false;
+    if (layout.style == WhatsAppHeaderStyle::Bracketed)
+    {
+        if (line[0] != '[')
+            return false;
+
+        std::size_t closeBracket = line.find(']');
+        if (closeBracket == std::string_view::npos)
+            return false;
 
-    // Extract timestamp portion between '[' and ']'
-    std::string ts = line.substr(1, closeBracket - 1);
+        // After "] " we expect "Name: message..."
+        std::size_t afterBracket = closeBracket + 1;
+        if (afterBracket < line.size() && line[afterBracket] == ' ')
+            ++afterBracket;
 
-    // After "] " we expect "Name: message..."
-    std::size_t afterBracket = closeBracket + 1;
-    if (afterBracket < line.size() && line[afterBracket] == ' ')
-        ++afterBracket;
+        if (afterBracket >= line.size())
+            return false;
+
+        outTimestampMs = layout.parseTs(line.substr(1, closeBracket - 1));
+        outRest        = line.substr(afterBracket);
+        return true;
+    }
 
-    if (afterBracket >= line.size())
+    // Dashed: nothing marks the header except a timestamp that parses, so
+    // require one (a continuation line may well start with a digit).
+    if (line[0] < '0' || line[0] > '9')
         return false;
 
-    std::string rest = line.substr(afterBracket);
+    std::size_t dash = line.find(" - ");
+    if (dash == std::string_view::npos || dash + 3 >= line.size())
+        return false;
+
+    long long ts = layout.parseTs(line.substr(0, dash));
+    if (ts == 0)
+        return false;
+
+    outTimestampMs = ts;
+    outRest        = line.substr(dash + 3);
+    return true;
+}
+
+// Sniff the header style and timestamp format from the first few hundred
+// header lines. Day-first vs month-first is decided by the field ranges
+// when they settle it, otherwise by which reading keeps time moving forward.
+static WhatsAppLayout detectWhatsAppLayout(std::string_view text)
+{
+    static constexpr std::size_t SNIFF_HEADERS = 400;
+    static constexpr std::size_t SNIFF_LINES   = 20000;
+
+    std::vector<WhatsAppTsFields> bracketed, dashed;
+
+    std::size_t pos = 0;
+    for (std::size_t n = 0; pos < text.size() && n < SNIFF_LINES; ++n)
+    {
+        std::size_t nl = text.find('\n', pos);
+        std::size_t end = (nl == std::string_view::npos) ? text.size() : nl;
+        std::string_view line = stripBidiMarks(rtrimView(text.substr(pos, end - pos)));
+        pos = (nl == std::string_view::npos) ? text.size() : nl + 1;
+
+        WhatsAppTsFields f;
+        if (!line.empty() && line[0] == '[')
+        {
+            std::size_t close = line.find(']');
+            if (close != std::string_view::npos && scanTimestampFields(line.substr(1, close - 1), f))
+                bracketed.push_back(f);
+        }
+        else if (!line.empty() && line[0] >= '0' && line[0] <= '9')
+        {
+            std::size_t dash = line.find(" - ");
+            if (dash != std::string_view::npos && scanTimestampFields(line.substr(0, dash), f))
+                dashed.push_back(f);
+        }
+
+        if (bracketed.size() >= SNIFF_HEADERS || dashed.size() >= SNIFF_HEADERS)
+            break;
+    }
+
+    WhatsAppLayout layout;
+    layout.style = (dashed.size() > bracketed.size()) ? WhatsAppHeaderStyle::Dashed
+                                                      : WhatsAppHeaderStyle::Bracketed;
+    const std::vector<WhatsAppTsFields>& samples =
+        (layout.style == WhatsAppHeaderStyle::Dashed) ? dashed : bracketed;
+    if (samples.empty())
+        return layout;
+
+    std::size_t slash = 0, dot = 0, dashSep = 0, seconds = 0, ampm = 0, yearFirst = 0;
+    for (const auto& f : samples)
+    {
+        slash   += (f.sep == '/');
+        dot     += (f.sep == '.');
+        dashSep += (f.sep == '-');
+        seconds += f.hasSeconds;
+        ampm    += f.hasAmPm;
+        yearFirst += (f.digits[0] > 2);
+    }
+    const std::size_t half = samples.size() / 2;
+
+    char sep = '/';
+    if (dot > slash && dot >= dashSep)      sep = '.';
+    else if (dashSep > slash && dashSep > dot) sep = '-';
 
-    std::size_t colonPos = rest.find(':');
-    if (colonPos == std::string::npos)
+    const bool hasSeconds = seconds > half;
+    const bool twelveHour = ampm > half;
+
+    WhatsAppDateOrder order;
+    if (yearFirst > half)
     {
-        // No sender delimiter; treat as system message with unknown sender.
-        outSender   = "Unknown";
-        outContent  = trimCopy(rest);
+        order = WhatsAppDateOrder::YMD;
     }
     else
     {
-        outSender  = trimCopy(rest.substr(0, colonPos));
-        std::size_t msgStart = colonPos + 1;
-        if (msgStart < rest.size() && rest[msgStart] == ' ')
-            ++msgStart;
-        outContent = (msgStart < rest.size())
-            ? rest.substr(msgStart)
-            : std::string();
+        // Score each reading: unparseable dates count heavily, then
+        // timestamps that jump backwards.
+        auto score = [&](WhatsAppDateOrder o)
+        {
+            std::size_t bad = 0, backwards = 0;
+            long long prev = 0;
+            for (const auto& f : samples)
+            {
+                long long t = fieldsToMs(f, o);
+                if (t == 0)
+                {
+                    ++bad;
+                    continue;
+                }
+                if (t < prev)
+                    ++backwards;
+                prev = t;
+            }
+            return bad * samples.size() + backwards;
+        };
+
+        std::size_t mdy = score(WhatsAppDateOrder::MDY);
+        std::size_t dmy = score(WhatsAppDateOrder::DMY);
+        if (mdy != dmy)
+            order = (mdy < dmy) ? WhatsAppDateOrder::MDY : WhatsAppDateOrder::DMY;
+        else
+            order = twelveHour ? WhatsAppDateOrder::MDY : WhatsAppDateOrder::DMY;
     }
 
-    outTimestampMs = parseWhatsAppTimestampMs(ts);
-    return true;
+    layout.parseTs = pickTimestampParser(order, sep, hasSeconds, twelveHour);
+    return layout;
 }
 
 // -------------------------------------------------------------
 // Core processing
 // -------------------------------------------------------------
 
-static void processWhatsAppChatFile(
-    const std::string&   filename,
-    std::vector<InstaMessage>& outMessages,
-    std::set<std::string>&     participants)
+// Parsed output of one shard of the file.
+struct WhatsAppShard
 {
-    std::ifstream in(filename);
-    if (!in)
-    {
-        throw std::runtime_error("Could not open WhatsApp chat file: " + filename);
-    }
+    std::vector<InstaMessage> messages;
+    std::set<std::string>     participants;
+};
 
-    std::string line;
+static std::string_view nextLine(std::string_view text, std::size_t& pos)
+{
+    std::size_t nl  = text.find('\n', pos);
+    std::size_t end = (nl == std::string_view::npos) ? text.size() : nl;
+    std::string_view line = text.substr(pos, end - pos);
+    pos = (nl == std::string_view::npos) ? text.size() : nl + 1;
+    return line;
+}
+
+// Parse [begin, end) of the file. Every shard except the first starts on a
+// message header, so multi-line messages never straddle two shards.
+static void parseWhatsAppShard(const WhatsAppLayout& layout,
+                               std::string_view      text,
+                               WhatsAppShard&        shard)
+{
     bool hasCurrent = false;
     InstaMessage current{};
 
-    while (std::getline(in, line))
+    auto flush = [&]()
     {
-        long long   ts      = 0;
-        std::string sender;
-        std::string content;
+        if (hasCurrent && !isWhatsAppSystemOrOmitted(current.content))
+            shard.messages.push_back(std::move(current));
+        current = InstaMessage{};
+    };
+
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+        std::string_view line = nextLine(text, pos);
 
-        if (parseWhatsAppHeaderLine(line, ts, sender, content))
+        long long ts = 0;
+        std::string_view rest;
+        if (splitWhatsAppHeaderLine(layout, line, ts, rest))
         {
             // Flush previous message (if any)
-            if (hasCurrent)
+            flush();
+
+            std::size_t colonPos = rest.find(':');
+            if (colonPos == std::string_view::npos)
             {
-                if (!isWhatsAppSystemOrOmitted(current.content))
-                {
-                    outMessages.push_back(current);
-                }
+                // No sender delimiter; treat as system message with unknown sender.
+                current.sender_name = "Unknown";
+                current.content.assign(trimView(rest));
+            }
+            else
+            {
+                current.sender_name.assign(trimView(rest.substr(0, colonPos)));
+                std::size_t msgStart = colonPos + 1;
+                if (msgStart < rest.size() && rest[msgStart] == ' ')
+                    ++msgStart;
+                current.content.assign(rest.substr(msgStart));
             }
 
-            current.sender_name = sender;
             current.timestamp_ms = ts;
-            current.content      = content;
             hasCurrent = true;
 
-            participants.insert(sender);
+            shard.participants.insert(current.sender_name);
         }
-        else
+        else if (hasCurrent)
         {
             // Continuation of previous message (multi-line message).
-            if (hasCurrent)
+            line = rtrimView(line);
+            if (!line.empty())
             {
-                rtrimInPlace(line);
-                if (!line.empty())
-                {
-                    if (!current.content.empty())
-                        current.content.push_back('\n');
-                    current.content += line;
-                }
+                if (!current.content.empty())
+                    current.content.push_back('\n');
+                current.content.append(line);
             }
         }
     }
 
     // Flush last message
-    if (hasCurrent)
+    flush();
+}
+
+// Move `pos` forward to the start of the next message header line.
+static std::size_t alignToHeader(const WhatsAppLayout& layout,
+                                 std::string_view      text,
+                                 std::size_t           pos)
+{
+    if (pos == 0)
+        return 0;
+
+    std::size_t nl = text.find('\n', pos - 1);
+    while (nl != std::string_view::npos)
     {
-        if (!isWhatsAppSystemOrOmitted(current.content))
+        std::size_t lineStart = nl + 1;
+        std::size_t lineEnd   = text.find('\n', lineStart);
+        std::string_view line = text.substr(lineStart,
+            (lineEnd == std::string_view::npos ? text.size() : lineEnd) - lineStart);
+
+        long long ts = 0;
+        std::string_view rest;
+        if (splitWhatsAppHeaderLine(layout, line, ts, rest))
+            return lineStart;
+        nl = lineEnd;
+    }
+    return text.size();
+}
+
+// Shards smaller than this are not worth a thread.
+static constexpr std::size_t MIN_SHARD_BYTES = 1u << 20;
+
+static void processWhatsAppText(
+    std::string_view           text,
+    std::vector<InstaMessage>& outMessages,
+    std::set<std::string>&     participants)
+{
+    const WhatsAppLayout layout = detectWhatsAppLayout(text);
+
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t shardCount = std::min<std::size_t>(threads * 4, text.size() / MIN_SHARD_BYTES);
+    if (shardCount < 2)
+    {
+        WhatsAppShard shard;
+        parseWhatsAppShard(layout, text, shard);
+        outMessages = std::move(shard.messages);
+        participants = std::move(shard.participants);
+        return;
+    }
+
+    // Cut at roughly equal byte offsets, then slide each cut to a header.
+    std::vector<std::size_t> cuts(shardCount + 1);
+    cuts[0] = 0;
+    cuts[shardCount] = text.size();
+    for (std::size_t i = 1; i < shardCount; ++i)
+        cuts[i] = std::max(cuts[i - 1], alignToHeader(layout, text, text.size() / shardCount * i));
+
+    std::vector<WhatsAppShard> shards(shardCount);
+    {
+        WorkStealingPool pool(threads);
+        for (std::size_t i = 0; i < shardCount; ++i)
         {
-            outMessages.push_back(current);
+            pool.submit([&, i]
+            {
+                parseWhatsAppShard(layout, text.substr(cuts[i], cuts[i + 1] - cuts[i]), shards[i]);
+            });
         }
+        pool.wait();
+    }
+
+    // Stitch the shards back together in file order.
+    std::size_t total = 0;
+    for (const auto& sh : shards)
+        total += sh.messages.size();
+    outMessages.clear();
+    outMessages.reserve(total);
+    for (auto& sh : shards)
+    {
+        std::move(sh.messages.begin(), sh.messages.end(), std::back_inserter(outMessages));
+        participants.insert(sh.participants.begin(), sh.participants.end());
+    }
+}
+
+// Parse `text` and write its messages straight into `writer` in file order.
+// Shards of MIN_SHARD_BYTES are parsed on a pool a few at a time and dropped
+// once written, so memory stays flat however long the chat is. Returns false,
+// with only part of the chat written, at the first message older than the
+// one before it.
+static bool streamWhatsAppText(std::string_view text, ChunkedExportWriter& writer)
+{
+    const WhatsAppLayout layout = detectWhatsAppLayout(text);
+
+    const std::size_t shardCount = std::max<std::size_t>(1, text.size() / MIN_SHARD_BYTES);
+    std::vector<std::size_t> cuts(shardCount + 1);
+    cuts[0] = 0;
+    cuts[shardCount] = text.size();
+    for (std::size_t i = 1; i < shardCount; ++i)
+        cuts[i] = std::max(cuts[i - 1], alignToHeader(layout, text, text.size() / shardCount * i));
+
+    auto parse = [&](std::size_t i)
+    {
+        WhatsAppShard shard;
+        parseWhatsAppShard(layout, text.substr(cuts[i], cuts[i + 1] - cuts[i]), shard);
+        return shard;
+    };
+
+    long long lastTs = std::numeric_limits<long long>::min();
+    auto write = [&](std::size_t, WhatsAppShard shard)
+    {
+        // Senders of filtered lines (media omitted, system notes) are
+        // participants too, though none of their messages is written.
+        for (const auto& name : shard.participants)
+            writer.addParticipant(name);
+
+        std::string error;
+        for (const auto& m : shard.messages)
+        {
+            if (m.timestamp_ms < lastTs)
+                return false;
+            if (!writer.add(m, error))
+                throw std::runtime_error(error);
+            lastTs = m.timestamp_ms;
+        }
+        return true;
+    };
+
+    if (shardCount < 2)
+        return write(0, parse(0));
+
+    WorkStealingPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool.runOrdered(shardCount, parse, write);
+}
+
+// The chat text inside an "Export chat" archive: iOS names it _chat.txt,
+// Android "WhatsApp Chat with <name>.txt". Media entries are never touched.
+static const ZipEntry* findWhatsAppChatEntry(const ZipArchive& archive)
+{
+    const ZipEntry* best = nullptr;
+    for (const auto& e : archive.entries())
+    {
+        if (e.isDirectory() || !e.hasExtension(".txt") || e.name.rfind("__MACOSX/", 0) == 0)
+            continue;
+        if (e.baseName() == "_chat.txt")
+            return &e;
+        if (!best || e.uncompressedSize > best->uncompressedSize)
+            best = &e;
     }
+    return best;
+}
+
+// Hand the chat text of `filename` (a _chat.txt or the .zip archive) to
+// `use` while it is extracted or mapped.
+static void withWhatsAppChatText(
+    const std::string&                           filename,
+    const std::function<void(std::string_view)>& use)
+{
+    std::string error;
+    if (IsZipArchive(filename))
+    {
+        ZipArchive archive;
+        if (!archive.open(filename, error))
+            throw std::runtime_error(error);
+
+        const ZipEntry* entry = findWhatsAppChatEntry(archive);
+        if (!entry)
+            throw std::runtime_error("No chat text (.txt) found in WhatsApp archive: " + filename);
+
+        std::string text;
+        if (!archive.extract(*entry, text, error))
+            throw std::runtime_error(error);
+        use(text);
+        return;
+    }
+
+    MappedFile file;
+    if (!file.open(filename, error))
+    {
+        throw std::runtime_error("Could not open WhatsApp chat file: " + filename);
+    }
+    use(file.view());
 }
 
 // -------------------------------------------------------------
@@ -403,7 +906,8 @@ bool ConvertWhatsAppToInstagramFolder(
     const std::string& inputPathStr,
     const std::string& outputPathStr,
     const std::string& chatTitle,
-    std::string&       errorOut
+    std::string&       errorOut,
+    std::size_t        chunkSize
 )
 {
     try
@@ -425,89 +929,53 @@ bool ConvertWhatsAppToInstagramFolder(
 
         if (!fs::exists(inputPath) || !fs::is_regular_file(inputPath))
         {
-            errorOut = "Input path must be a WhatsApp text export (.txt file).";
+            errorOut = "Input path must be a WhatsApp export (_chat.txt or the .zip archive).";
             return false;
         }
 
         fs::create_directories(outputDir);
 
-        std::vector<InstaMessage> allMessages;
-        std::set<std::string>     participants;
-
-        processWhatsAppChatFile(inputPath.string(), allMessages, participants);
+        ExportChunkOptions chunkOptions;
+        chunkOptions.title       = chatTitle;
+        chunkOptions.threadPath  = "whatsapp/converted";
+        chunkOptions.viewerFlags = true;
+        chunkOptions.chunkSize   = chunkSize;
 
-        if (allMessages.empty())
+        bool ok = false;
+        withWhatsAppChatText(inputPath.string(), [&](std::string_view text)
         {
-            errorOut = "No messages found in WhatsApp chat file (after filtering).";
-            return false;
-        }
-
-        // Sort messages chronologically.
-        std::sort(allMessages.begin(), allMessages.end(),
-                  [](const InstaMessage& a, const InstaMessage& b)
-                  {
-                      return a.timestamp_ms < b.timestamp_ms;
-                  });
-
-        // Build participants array.
-        json participantsJson = json::array();
-        for (const auto& name : participants)
-        {
-            json p;
-            p["name"] = name;
-            participantsJson.push_back(p);
-        }
-
-        const std::size_t CHUNK_SIZE = 5000;
-        std::size_t total  = allMessages.size();
-        std::size_t chunks = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
-        if (chunks == 0) chunks = 1;
-
-        for (std::size_t c = 0; c < chunks; ++c)
-        {
-            std::size_t start = c * CHUNK_SIZE;
-            std::size_t end   = std::min(start + CHUNK_SIZE, total);
-
-            json out;
-            out["participants"] = participantsJson;
-
-            json msgs = json::array();
-            for (std::size_t i = start; i < end; ++i)
-            {
-                const auto& im = allMessages[i];
-                json m;
-                m["sender_name"]  = im.sender_name;
-                m["timestamp_ms"] = im.timestamp_ms;
-                m["content"]      = im.content;
-                m["is_geoblocked_for_viewer"]                = false;
-                m["is_unsent_image_by_messenger_kid_parent"] = false;
-                msgs.push_back(std::move(m));
-            }
-
-            out["messages"]             = std::move(msgs);
-            out["title"]                = chatTitle;
-            out["is_still_participant"] = true;
-            out["thread_path"]          = "whatsapp/converted";
-            out["magic_words"]          = json::array();
-
-            std::size_t fileIndex = c + 1;
-            std::ostringstream ossName;
-            ossName << "message_" << fileIndex << ".json";
-            std::string fileName = ossName.str();
-
-            fs::path outFilePath = outputDir / fs::u8path(fileName);
-
-            std::ofstream ofs(outFilePath.string(), std::ios::binary);
-            if (!ofs)
+            // Exports are normally in chronological order, so the chat is
+            // streamed straight into the chunk files.
             {
-                errorOut = "Failed to open output file: " + outFilePath.string();
-                return false;
+                ChunkedExportWriter writer(outputPathStr, chunkOptions);
+                if (streamWhatsAppText(text, writer))
+                {
+                    if (writer.messageCount() == 0)
+                        errorOut = "No messages found in WhatsApp chat file (after filtering).";
+                    else if (writer.finish(errorOut))
+                    {
+                        errorOut.clear();
+                        ok = true;
+                    }
+                    return;
+                }
             }
-            ofs << out.dump(2);
-        }
 
-        errorOut.clear();
-        return true;
+            // A message older than the one before it: parse the whole chat,
+            // sort it and rewrite every chunk. A stable sort keeps
+            // same-second messages in file order.
+            std::vector<InstaMessage> allMessages;
+            std::set<std::string>     participants;
+            processWhatsAppText(text, allMessages, participants);
+
+            std::stable_sort(allMessages.begin(), allMessages.end(),
+                             [](const InstaMessage& a, const InstaMessage& b)
+                             {
+                                 return a.timestamp_ms < b.timestamp_ms;
+                             });
+            ok = WriteInstagramChunks(outputPathStr, chunkOptions, participants, allMessages, errorOut);
+        });
+        return ok;
     }
     catch (const std::exception& ex)
     {
@@ -0,0 +1,30 @@
+// whatsapp_convert.hpp
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "export_writer.hpp"
+
+// inputPathStr:
+//   - Path to the WhatsApp "Export chat" text file (_chat.txt), or to the
+//     exported .zip archive (the chat text is read from it in memory; media
+//     entries are skipped).
+//
+// outputPathStr:
+//   - Destination folder where message_#.json files will be written.
+//
+// chatTitle:
+//   - Stored as "title" in every output chunk.
+//
+// chunkSize:
+//   - Messages per output message_#.json file.
+//
+// Returns true on success; on failure returns false and fills errorOut.
+bool ConvertWhatsAppToInstagramFolder(
+    const std::string& inputPathStr,
+    const std::string& outputPathStr,
+    const std::string& chatTitle,
+    std::string&       errorOut,
+    std::size_t        chunkSize = DEFAULT_EXPORT_CHUNK_SIZE
+);
@@ -0,0 +1,300 @@
+// xml_scanner.cpp
+#include "xml_scanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static inline bool isXmlSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline std::size_t findChar(std::string_view text, std::size_t from, char c)
+{
+    if (from >= text.size())
+        return std::string_view::npos;
+    const void* hit = std::memchr(text.data() + from, c, text.size() - from);
+    return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - text.data())
+               : std::string_view::npos;
+}
+
+// -------------------------------------------------------------
+// XmlElementScanner
+// -------------------------------------------------------------
+
+bool XmlElementScanner::next()
+{
+    for (;;)
+    {
+        const std::size_t lt = findChar(m_text, m_pos, '<');
+        if (lt == std::string_view::npos || lt + 1 >= m_text.size())
+        {
+            m_pos = m_text.size();
+            return false;
+        }
+
+        const char c = m_text[lt + 1];
+        if (c == '!' || c == '?')
+        {
+            // Comment, CDATA, DOCTYPE or processing instruction.
+            std::string_view close = ">";
+            if (m_text.compare(lt, 4, "<!--") == 0)
+                close = "-->";
+            else if (c == '?')
+                close = "?>";
+            const std::size_t end = m_text.find(close, lt + 2);
+            m_pos = end == std::string_view::npos ? m_text.size() : end + close.size();
+            continue;
+        }
+        if (c == '/')
+        {
+            const std::size_t gt = findChar(m_text, lt + 2, '>');
+            m_pos = gt == std::string_view::npos ? m_text.size() : gt + 1;
+            continue;
+        }
+
+        if (parseTag(lt))
+            return true;
+        m_pos = lt + 1;   // not a tag after all (stray '<'); keep looking
+    }
+}
+
+bool XmlElementScanner::parseTag(std::size_t lt)
+{
+    const std::string_view t = m_text;
+    const std::size_t n = t.size();
+
+    std::size_t p = lt + 1;
+    const std::size_t nameBegin = p;
+    while (p < n && !isXmlSpace(t[p]) && t[p] != '>' && t[p] != '/')
+        ++p;
+    if (p == nameBegin)
+        return false;
+
+    m_tagBegin    = lt;
+    m_name        = t.substr(nameBegin, p - nameBegin);
+    m_selfClosing = false;
+    m_attrs.clear();
+
+    for (;;)
+    {
+        while (p < n && isXmlSpace(t[p]))
+            ++p;
+        if (p >= n)
+            return false;
+
+        if (t[p] == '>')
+        {
+            m_pos = p + 1;
+            return true;
+        }
+        if (t[p] == '/')
+        {
+            if (p + 1 < n && t[p + 1] == '>')
+            {
+                m_selfClosing = true;
+                m_pos = p + 2;
+                return true;
+            }
+            return false;
+        }
+
+        const std::size_t attrBegin = p;
+        while (p < n && t[p] != '=' && !isXmlSpace(t[p]) && t[p] != '>' && t[p] != '/')
+            ++p;
+        const std::string_view attrName = t.substr(attrBegin, p - attrBegin);
+
+        while (p < n && isXmlSpace(t[p]))
+            ++p;
+        if (p >= n || t[p] != '=' || attrName.empty())
+            return false;
+        ++p;
+        while (p < n && isXmlSpace(t[p]))
+            ++p;
+        if (p >= n || (t[p] != '"' && t[p] != '\''))
+            return false;
+
+        const char quote = t[p];
+        const std::size_t valueEnd = findChar(t, p + 1, quote);
+        if (valueEnd == std::string_view::npos)
+            return false;
+
+        m_attrs.push_back({ attrName, t.substr(p + 1, valueEnd - p - 1) });
+        p = valueEnd + 1;
+    }
+}
+
+std::string_view XmlElementScanner::attribute(std::string_view attrName) const
+{
+    for (const auto& a : m_attrs)
+    {
+        if (a.name == attrName)
+            return a.value;
+    }
+    return {};
+}
+
+// -------------------------------------------------------------
+// Entity decoding
+// -------------------------------------------------------------
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return 10 + (c - 'a');
+    if (c >= 'A' && c <= 'F') return 10 + (c - 'A');
+    return -1;
+}
+
+// Parses the body of a numeric entity ("#123" or "#x1A").
+// Returns -1 if it is not a valid number.
+static long long parseNumericEntity(std::string_view token)
+{
+    if (token.size() < 2 || token[0] != '#')
+        return -1;
+
+    long long value = 0;
+    if (token[1] == 'x' || token[1] == 'X')
+    {
+        if (token.size() < 3)
+            return -1;
+        for (std::size_t k = 2; k < token.size(); ++k)
+        {
+            int hv = hexValue(token[k]);
+            if (hv < 0 || value > 0x10FFFF) return -1;
+            value = (value * 16) + hv;
+        }
+        return value;
+    }
+
+    for (std::size_t k = 1; k < token.size(); ++k)
+    {
+        if (token[k] < '0' || token[k] > '9' || value > 0x10FFFF)
+            return -1;
+        value = (value * 10) + (token[k] - '0');
+    }
+    return value;
+}
+
+static void appendUtf8(std::string& out, long long codePoint)
+{
+    if (codePoint <= 0x7F)
+    {
+        out.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint <= 0x7FF)
+    {
+        out.push_back(static_cast<char>(0xC0 | ((codePoint >> 6) & 0x1F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint <= 0xFFFF)
+    {
+        out.push_back(static_cast<char>(0xE0 | ((codePoint >> 12) & 0x0F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | ((codePoint >> 18) & 0x07)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Longest entity body we look for a ';' in ("#x10FFFF" is 8).
+static constexpr std::size_t MAX_ENTITY_LENGTH = 10;
+
+// Entity body starting after the '&' at `amp`, or empty if there is no ';'
+// close enough for this to be an entity.
+static std::string_view entityAt(std::string_view s, std::size_t amp)
+{
+    const std::size_t limit = std::min(s.size(), amp + 2 + MAX_ENTITY_LENGTH);
+    for (std::size_t k = amp + 1; k < limit; ++k)
+    {
+        if (s[k] == ';')
+            return s.substr(amp + 1, k - amp - 1);
+    }
+    return {};
+}
+
+void AppendXmlUnescaped(std::string& out, std::string_view s)
+{
+    std::size_t i = 0;
+    while (i < s.size())
+    {
+        const std::size_t amp = findChar(s, i, '&');
+        if (amp == std::string_view::npos)
+        {
+            out.append(s.data() + i, s.size() - i);
+            return;
+        }
+        out.append(s.data() + i, amp - i);
+        i = amp;
+
+        const std::string_view token = entityAt(s, amp);
+        std::size_t next = amp + token.size() + 2;   // past ';'
+
+        char named = 0;
+        if (token == "amp")       named = '&';
+        else if (token == "lt")   named = '<';
+        else if (token == "gt")   named = '>';
+        else if (token == "quot") named = '"';
+        else if (token == "apos") named = '\'';
+        if (named)
+        {
+            out.push_back(named);
+            i = next;
+            continue;
+        }
+
+        long long codePoint = token.empty() ? -1 : parseNumericEntity(token);
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+        {
+            // SMS Backup & Restore writes emoji as two UTF-16 surrogate
+            // entities (e.g. &#55357;&#56832;). Join them into one code point.
+            long long low = -1;
+            std::string_view lowToken;
+            if (next < s.size() && s[next] == '&')
+            {
+                lowToken = entityAt(s, next);
+                if (!lowToken.empty() && lowToken[0] == '#')
+                    low = parseNumericEntity(lowToken);
+            }
+
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                next += lowToken.size() + 2;
+            }
+            else
+            {
+                codePoint = 0xFFFD;
+            }
+        }
+        else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+        {
+            codePoint = 0xFFFD;
+        }
+
+        if (codePoint >= 0 && codePoint <= 0x10FFFF)
+        {
+            appendUtf8(out, codePoint);
+            i = next;
+            continue;
+        }
+
+        // Not an entity we know; keep the '&' and carry on after it.
+        out.push_back('&');
+        ++i;
+    }
+}
+
+std::string_view XmlUnescapedView(std::string_view raw, std::string& scratch)
+{
+    if (raw.find('&') == std::string_view::npos)
+        return raw;
+    scratch.clear();
+    AppendXmlUnescaped(scratch, raw);
+    return scratch;
+}
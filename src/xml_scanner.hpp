@@ -0,0 +1,64 @@
+// xml_scanner.hpp
+// Forward-only scanner over the start tags of an XML document held in memory
+// (typically a MappedFile). Built for SMS Backup & Restore files: no DOM, no
+// copies, attribute values are views into the input.
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct XmlAttribute
+{
+    std::string_view name;
+    std::string_view value;   // raw: entities are not decoded
+};
+
+// Only start tags are reported; end tags, comments, processing instructions
+// and text are skipped. Nesting is not tracked. Every jump (to the next '<',
+// to the closing quote of a value) is a single memchr, so a multi-megabyte
+// base64 attribute such as <part data="..."> is passed over at memory
+// bandwidth without being copied or decoded.
+class XmlElementScanner
+{
+public:
+    explicit XmlElementScanner(std::string_view text, std::size_t pos = 0)
+        : m_text(text), m_pos(pos) {}
+
+    // Advance to the next start tag. Returns false at the end of the input.
+    bool next();
+
+    std::string_view name() const { return m_name; }
+    const std::vector<XmlAttribute>& attributes() const { return m_attrs; }
+
+    // Raw value of the first attribute called `attrName`, or empty.
+    std::string_view attribute(std::string_view attrName) const;
+
+    // Byte range of the current start tag: [begin, end), end just past '>'.
+    std::size_t tagBegin() const { return m_tagBegin; }
+    std::size_t tagEnd() const { return m_pos; }
+    bool selfClosing() const { return m_selfClosing; }
+
+    // Continue scanning from `pos` (e.g. to jump past a known subtree).
+    void seek(std::size_t pos) { m_pos = pos; }
+
+private:
+    bool parseTag(std::size_t lt);
+
+    std::string_view          m_text;
+    std::size_t               m_pos = 0;
+    std::size_t               m_tagBegin = 0;
+    std::string_view          m_name;
+    std::vector<XmlAttribute> m_attrs;
+    bool                      m_selfClosing = false;
+};
+
+// Append `raw` to `out` with XML entities decoded: the five named entities
+// and numeric ones (&#10; &#x1F600;), joining UTF-16 surrogate pairs written
+// as two entities. Unknown or malformed entities are kept verbatim.
+void AppendXmlUnescaped(std::string& out, std::string_view raw);
+
+// `raw` itself when it contains no '&' (the common case, no copy); otherwise
+// the decoded text, stored in `scratch`.
+std::string_view XmlUnescapedView(std::string_view raw, std::string& scratch);
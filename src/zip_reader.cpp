@@ -0,0 +1,755 @@
+// zip_reader.cpp
+// Central-directory zip reader and a table-driven raw DEFLATE decoder.
+
+#include "zip_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+// -------------------------------------------------------------
+// Little-endian field access
+// -------------------------------------------------------------
+
+static inline std::uint16_t readLe16(const unsigned char* p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+static inline std::uint32_t readLe32(const unsigned char* p)
+{
+    return static_cast<std::uint32_t>(p[0]) |
+           (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) |
+           (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+static inline std::uint64_t readLe64(const unsigned char* p)
+{
+    return static_cast<std::uint64_t>(readLe32(p)) |
+           (static_cast<std::uint64_t>(readLe32(p + 4)) << 32);
+}
+
+// -------------------------------------------------------------
+// CRC-32 (IEEE 802.3, reflected)
+// -------------------------------------------------------------
+
+namespace
+{
+struct Crc32Table
+{
+    std::uint32_t v[256];
+
+    constexpr Crc32Table() : v()
+    {
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            v[i] = c;
+        }
+    }
+};
+
+constexpr Crc32Table CRC32_TABLE;
+}
+
+std::uint32_t Crc32(const unsigned char* data, std::size_t size, std::uint32_t crc)
+{
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i)
+        crc = CRC32_TABLE.v[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// -------------------------------------------------------------
+// Raw DEFLATE decoder (RFC 1951)
+// -------------------------------------------------------------
+
+namespace
+{
+
+// LSB-first bit reader. Past the end of the input it feeds zero bytes and
+// counts them, so a truncated stream is reported instead of over-read.
+class BitReader
+{
+public:
+    BitReader(const unsigned char* p, std::size_t n) : m_p(p), m_end(p + n) {}
+
+    void refill()
+    {
+        while (m_count <= 56)
+        {
+            if (m_p < m_end)
+                m_buf |= static_cast<std::uint64_t>(*m_p++) << m_count;
+            else
+                ++m_padBytes;
+            m_count += 8;
+        }
+    }
+
+    // n <= 32, and refill() must have been called since enough bits were used.
+    std::uint32_t peek(unsigned n) const
+    {
+        return static_cast<std::uint32_t>(m_buf & ((1ull << n) - 1));
+    }
+
+    void consume(unsigned n)
+    {
+        m_buf >>= n;
+        m_count -= n;
+    }
+
+    std::uint32_t bits(unsigned n)
+    {
+        if (m_count < n)
+            refill();
+        std::uint32_t v = peek(n);
+        consume(n);
+        return v;
+    }
+
+    unsigned count() const { return m_count; }
+
+    // True once bits that were never in the input have been consumed.
+    bool overrun() const { return m_padBytes * 8 > m_count; }
+
+    // Drop to the next byte boundary and hand back the byte position, so a
+    // stored block can be copied straight from the input.
+    bool alignToByte(const unsigned char*& pos)
+    {
+        consume(m_count & 7);
+        std::size_t buffered = m_count / 8;
+        if (buffered < m_padBytes)
+            return false;
+        pos = m_p - (buffered - m_padBytes);
+        return true;
+    }
+
+    void resetTo(const unsigned char* pos)
+    {
+        m_p = pos;
+        m_buf = 0;
+        m_count = 0;
+        m_padBytes = 0;
+    }
+
+    const unsigned char* end() const { return m_end; }
+
+private:
+    const unsigned char* m_p;
+    const unsigned char* m_end;
+    std::uint64_t m_buf = 0;
+    unsigned      m_count = 0;
+    std::size_t   m_padBytes = 0;
+};
+
+// Canonical Huffman decoder: codes up to FAST_BITS long resolve with one
+// table lookup; longer (rare) codes fall back to a count-based walk.
+class Huffman
+{
+public:
+    static constexpr unsigned FAST_BITS = 10;
+    static constexpr unsigned MAX_BITS  = 15;
+
+    bool build(const unsigned char* lengths, unsigned n)
+    {
+        std::memset(m_count, 0, sizeof(m_count));
+        for (unsigned i = 0; i < n; ++i)
+            ++m_count[lengths[i]];
+        m_count[0] = 0;
+
+        int left = 1;
+        for (unsigned len = 1; len <= MAX_BITS; ++len)
+        {
+            left = (left << 1) - m_count[len];
+            if (left < 0)
+                return false;   // over-subscribed
+        }
+
+        std::uint16_t offs[MAX_BITS + 2] = {};
+        for (unsigned len = 1; len <= MAX_BITS; ++len)
+            offs[len + 1] = static_cast<std::uint16_t>(offs[len] + m_count[len]);
+        for (unsigned sym = 0; sym < n; ++sym)
+        {
+            if (lengths[sym])
+                m_symbols[offs[lengths[sym]]++] = static_cast<std::uint16_t>(sym);
+        }
+
+        std::memset(m_fast, 0, sizeof(m_fast));
+        unsigned code = 0;
+        unsigned k = 0;
+        for (unsigned len = 1; len <= FAST_BITS; ++len)
+        {
+            for (unsigned j = 0; j < m_count[len]; ++j, ++code)
+            {
+                unsigned rev = 0;
+                for (unsigned b = 0; b < len; ++b)
+                    rev |= ((code >> b) & 1u) << (len - 1 - b);
+                const std::uint16_t entry = static_cast<std::uint16_t>((len << 9) | m_symbols[k++]);
+                for (unsigned r = rev; r < (1u << FAST_BITS); r += 1u << len)
+                    m_fast[r] = entry;
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    // Returns the symbol, or -1 for a code that is not in the table.
+    // The caller guarantees at least MAX_BITS buffered bits.
+    int decode(BitReader& br) const
+    {
+        const std::uint16_t e = m_fast[br.peek(FAST_BITS)];
+        if (e)
+        {
+            br.consume(e >> 9);
+            return e & 0x1FF;
+        }
+
+        const std::uint32_t bits = br.peek(MAX_BITS);
+        int code = 0, first = 0, index = 0;
+        for (unsigned len = 1; len <= MAX_BITS; ++len)
+        {
+            code |= static_cast<int>((bits >> (len - 1)) & 1u);
+            const int cnt = m_count[len];
+            if (code - first < cnt)
+            {
+                br.consume(len);
+                return m_symbols[index + (code - first)];
+            }
+            index += cnt;
+            first = (first + cnt) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+private:
+    std::uint16_t m_fast[1u << FAST_BITS];
+    std::uint16_t m_count[MAX_BITS + 1];
+    std::uint16_t m_symbols[288];
+};
+
+const std::uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const std::uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const std::uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577 };
+const std::uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+struct FixedTables
+{
+    Huffman lit;
+    Huffman dist;
+
+    FixedTables()
+    {
+        unsigned char lengths[288];
+        std::fill(lengths,       lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        lit.build(lengths, 288);
+        std::fill(lengths, lengths + 30, 5);
+        dist.build(lengths, 30);
+    }
+};
+
+const FixedTables& fixedTables()
+{
+    static const FixedTables tables;
+    return tables;
+}
+
+bool readDynamicTables(BitReader& br, Huffman& lit, Huffman& dist, std::string& errorOut)
+{
+    static const unsigned char ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    br.refill();
+    const unsigned nlen  = br.bits(5) + 257;
+    const unsigned ndist = br.bits(5) + 1;
+    const unsigned ncode = br.bits(4) + 4;
+    if (nlen > 286 || ndist > 30)
+    {
+        errorOut = "corrupt deflate stream (bad table sizes)";
+        return false;
+    }
+
+    unsigned char lengths[286 + 30] = {};
+    br.refill();
+    for (unsigned i = 0; i < ncode; ++i)
+        lengths[ORDER[i]] = static_cast<unsigned char>(br.bits(3));
+
+    Huffman codeLen;
+    if (!codeLen.build(lengths, 19))
+    {
+        errorOut = "corrupt deflate stream (bad code-length table)";
+        return false;
+    }
+
+    std::memset(lengths, 0, sizeof(lengths));
+    unsigned i = 0;
+    while (i < nlen + ndist)
+    {
+        br.refill();
+        const int sym = codeLen.decode(br);
+        if (sym < 0)
+        {
+            errorOut = "corrupt deflate stream (bad code length)";
+            return false;
+        }
+        if (sym < 16)
+        {
+            lengths[i++] = static_cast<unsigned char>(sym);
+            continue;
+        }
+
+        unsigned char value = 0;
+        unsigned repeat = 0;
+        if (sym == 16)
+        {
+            if (i == 0)
+            {
+                errorOut = "corrupt deflate stream (repeat with no previous length)";
+                return false;
+            }
+            value  = lengths[i - 1];
+            repeat = 3 + br.bits(2);
+        }
+        else if (sym == 17)
+            repeat = 3 + br.bits(3);
+        else
+            repeat = 11 + br.bits(7);
+
+        if (i + repeat > nlen + ndist)
+        {
+            errorOut = "corrupt deflate stream (too many code lengths)";
+            return false;
+        }
+        std::fill(lengths + i, lengths + i + repeat, value);
+        i += repeat;
+    }
+
+    if (lengths[256] == 0)
+    {
+        errorOut = "corrupt deflate stream (no end-of-block code)";
+        return false;
+    }
+    if (!lit.build(lengths, nlen) || !dist.build(lengths + nlen, ndist))
+    {
+        errorOut = "corrupt deflate stream (bad literal/distance table)";
+        return false;
+    }
+    return true;
+}
+
+bool inflateCodes(BitReader& br, const Huffman& lit, const Huffman& dist,
+                  unsigned char* dst, std::size_t dstSize, std::size_t& pos,
+                  std::string& errorOut)
+{
+    for (;;)
+    {
+        // One length/distance pair needs at most 15 + 5 + 15 + 13 bits.
+        if (br.count() < 48)
+        {
+            br.refill();
+            if (br.overrun())
+            {
+                errorOut = "truncated deflate stream";
+                return false;
+            }
+        }
+
+        int sym = lit.decode(br);
+        if (sym < 256)
+        {
+            if (sym < 0)
+            {
+                errorOut = "corrupt deflate stream (bad literal/length code)";
+                return false;
+            }
+            if (pos >= dstSize)
+            {
+                errorOut = "deflate stream is larger than the recorded size";
+                return false;
+            }
+            dst[pos++] = static_cast<unsigned char>(sym);
+            continue;
+        }
+        if (sym == 256)
+            return true;
+
+        sym -= 257;
+        if (sym >= 29)
+        {
+            errorOut = "corrupt deflate stream (bad length symbol)";
+            return false;
+        }
+        const std::size_t len = LENGTH_BASE[sym] + br.bits(LENGTH_EXTRA[sym]);
+
+        const int dsym = dist.decode(br);
+        if (dsym < 0 || dsym >= 30)
+        {
+            errorOut = "corrupt deflate stream (bad distance code)";
+            return false;
+        }
+        const std::size_t distance = DIST_BASE[dsym] + br.bits(DIST_EXTRA[dsym]);
+
+        if (distance > pos)
+        {
+            errorOut = "corrupt deflate stream (distance before start)";
+            return false;
+        }
+        if (len > dstSize - pos)
+        {
+            errorOut = "deflate stream is larger than the recorded size";
+            return false;
+        }
+
+        unsigned char* out = dst + pos;
+        const unsigned char* from = out - distance;
+        if (distance >= len)
+            std::memcpy(out, from, len);
+        else
+            for (std::size_t k = 0; k < len; ++k)   // overlapping run
+                out[k] = from[k];
+        pos += len;
+    }
+}
+
+} // namespace
+
+bool InflateRaw(const unsigned char* src, std::size_t srcSize,
+                unsigned char* dst, std::size_t dstSize, std::string& errorOut)
+{
+    BitReader br(src, srcSize);
+    std::size_t pos = 0;
+    Huffman lit, dist;
+
+    bool last = false;
+    while (!last)
+    {
+        br.refill();
+        last = br.bits(1) != 0;
+        const unsigned type = br.bits(2);
+
+        if (type == 0)
+        {
+            const unsigned char* p = nullptr;
+            if (!br.alignToByte(p) || br.end() - p < 4)
+            {
+                errorOut = "truncated deflate stream";
+                return false;
+            }
+            const std::uint16_t len  = readLe16(p);
+            const std::uint16_t nlen = readLe16(p + 2);
+            p += 4;
+            if (len != static_cast<std::uint16_t>(~nlen))
+            {
+                errorOut = "corrupt deflate stream (stored length check)";
+                return false;
+            }
+            if (static_cast<std::size_t>(br.end() - p) < len)
+            {
+                errorOut = "truncated deflate stream";
+                return false;
+            }
+            if (len > dstSize - pos)
+            {
+                errorOut = "deflate stream is larger than the recorded size";
+                return false;
+            }
+            std::memcpy(dst + pos, p, len);
+            pos += len;
+            br.resetTo(p + len);
+        }
+        else if (type == 1)
+        {
+            const FixedTables& fixed = fixedTables();
+            if (!inflateCodes(br, fixed.lit, fixed.dist, dst, dstSize, pos, errorOut))
+                return false;
+        }
+        else if (type == 2)
+        {
+            if (!readDynamicTables(br, lit, dist, errorOut) ||
+                !inflateCodes(br, lit, dist, dst, dstSize, pos, errorOut))
+                return false;
+        }
+        else
+        {
+            errorOut = "corrupt deflate stream (bad block type)";
+            return false;
+        }
+
+        if (br.overrun())
+        {
+            errorOut = "truncated deflate stream";
+            return false;
+        }
+    }
+
+    if (pos != dstSize)
+    {
+        errorOut = "deflate stream is smaller than the recorded size";
+        return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+// ZipEntry
+// -------------------------------------------------------------
+
+std::string ZipEntry::baseName() const
+{
+    std::size_t slash = name.find_last_of("/\\");
+    return slash == std::string::npos ? name : name.substr(slash + 1);
+}
+
+bool ZipEntry::hasExtension(const char* ext) const
+{
+    const std::size_t n = std::strlen(ext);
+    if (name.size() < n)
+        return false;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        char c = name[name.size() - n + i];
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c - 'A' + 'a');
+        if (c != ext[i])
+            return false;
+    }
+    return true;
+}
+
+// -------------------------------------------------------------
+// ZipArchive
+// -------------------------------------------------------------
+
+static constexpr std::uint32_t SIG_LOCAL       = 0x04034b50;
+static constexpr std::uint32_t SIG_CENTRAL     = 0x02014b50;
+static constexpr std::uint32_t SIG_EOCD        = 0x06054b50;
+static constexpr std::uint32_t SIG_EOCD64      = 0x06064b50;
+static constexpr std::uint32_t SIG_EOCD64_LOC  = 0x07064b50;
+
+static constexpr std::size_t EOCD_SIZE         = 22;
+static constexpr std::size_t EOCD64_LOC_SIZE   = 20;
+static constexpr std::size_t EOCD64_SIZE       = 56;
+static constexpr std::size_t CENTRAL_SIZE      = 46;
+static constexpr std::size_t LOCAL_SIZE        = 30;
+
+// DEFLATE cannot expand by more than ~1032:1; anything beyond is corrupt
+// (or hostile) and must not drive a huge allocation.
+static constexpr std::uint64_t MAX_DEFLATE_RATIO = 1032;
+
+bool ZipArchive::open(const std::string& path, std::string& errorOut)
+{
+    m_entries.clear();
+    if (!m_file.open(path, errorOut))
+        return false;
+
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(m_file.data());
+    const std::size_t size = m_file.size();
+    if (size < EOCD_SIZE)
+    {
+        errorOut = "Not a zip archive: " + path;
+        return false;
+    }
+
+    // The end-of-central-directory record sits at the very end, followed
+    // only by an optional comment of up to 64 KB.
+    std::size_t eocd = std::string::npos;
+    const std::size_t lowest = size > EOCD_SIZE + 0xFFFF ? size - EOCD_SIZE - 0xFFFF : 0;
+    for (std::size_t p = size - EOCD_SIZE + 1; p-- > lowest; )
+    {
+        if (readLe32(base + p) == SIG_EOCD)
+        {
+            eocd = p;
+            break;
+        }
+    }
+    if (eocd == std::string::npos)
+    {
+        errorOut = "Not a zip archive (no central directory): " + path;
+        return false;
+    }
+
+    std::uint64_t entryCount = readLe16(base + eocd + 10);
+    std::uint64_t cdSize     = readLe32(base + eocd + 12);
+    std::uint64_t cdOffset   = readLe32(base + eocd + 16);
+
+    if (eocd >= EOCD64_LOC_SIZE &&
+        readLe32(base + eocd - EOCD64_LOC_SIZE) == SIG_EOCD64_LOC)
+    {
+        const std::uint64_t eocd64 = readLe64(base + eocd - EOCD64_LOC_SIZE + 8);
+        if (eocd64 > size - EOCD64_SIZE || readLe32(base + eocd64) != SIG_EOCD64)
+        {
+            errorOut = "Corrupt Zip64 directory in " + path;
+            return false;
+        }
+        entryCount = readLe64(base + eocd64 + 32);
+        cdSize     = readLe64(base + eocd64 + 40);
+        cdOffset   = readLe64(base + eocd64 + 48);
+    }
+
+    if (cdOffset > size || cdSize > size - cdOffset)
+    {
+        errorOut = "Corrupt central directory in " + path;
+        return false;
+    }
+
+    m_entries.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(entryCount, cdSize / CENTRAL_SIZE)));
+
+    const unsigned char* p   = base + cdOffset;
+    const unsigned char* end = p + cdSize;
+    for (std::uint64_t i = 0; i < entryCount; ++i)
+    {
+        if (end - p < static_cast<std::ptrdiff_t>(CENTRAL_SIZE) || readLe32(p) != SIG_CENTRAL)
+        {
+            errorOut = "Corrupt central directory in " + path;
+            return false;
+        }
+
+        ZipEntry e;
+        e.flags             = readLe16(p + 8);
+        e.method            = readLe16(p + 10);
+        e.crc32             = readLe32(p + 16);
+        e.compressedSize    = readLe32(p + 20);
+        e.uncompressedSize  = readLe32(p + 24);
+        const std::size_t nameLen    = readLe16(p + 28);
+        const std::size_t extraLen   = readLe16(p + 30);
+        const std::size_t commentLen = readLe16(p + 32);
+        e.localHeaderOffset = readLe32(p + 42);
+
+        if (static_cast<std::size_t>(end - p) < CENTRAL_SIZE + nameLen + extraLen + commentLen)
+        {
+            errorOut = "Corrupt central directory in " + path;
+            return false;
+        }
+        e.name.assign(reinterpret_cast<const char*>(p + CENTRAL_SIZE), nameLen);
+
+        // Zip64 extended information: present fields replace the 0xFFFFFFFF
+        // placeholders, in this fixed order.
+        const unsigned char* x    = p + CENTRAL_SIZE + nameLen;
+        const unsigned char* xEnd = x + extraLen;
+        while (xEnd - x >= 4)
+        {
+            const std::uint16_t id  = readLe16(x);
+            const std::uint16_t len = readLe16(x + 2);
+            const unsigned char* field    = x + 4;
+            const unsigned char* fieldEnd = field + std::min<std::ptrdiff_t>(len, xEnd - field);
+            if (id == 0x0001)
+            {
+                auto take = [&](std::uint64_t& v)
+                {
+                    if (v == 0xFFFFFFFFu && fieldEnd - field >= 8)
+                    {
+                        v = readLe64(field);
+                        field += 8;
+                    }
+                };
+                take(e.uncompressedSize);
+                take(e.compressedSize);
+                take(e.localHeaderOffset);
+            }
+            x = fieldEnd;
+        }
+
+        m_entries.push_back(std::move(e));
+        p += CENTRAL_SIZE + nameLen + extraLen + commentLen;
+    }
+
+    errorOut.clear();
+    return true;
+}
+
+bool ZipArchive::extract(const ZipEntry& entry, std::string& out, std::string& errorOut) const
+{
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(m_file.data());
+    const std::uint64_t size = m_file.size();
+
+    if (entry.flags & 1)
+    {
+        errorOut = "Encrypted zip entries are not supported: " + entry.name;
+        return false;
+    }
+    if (entry.localHeaderOffset > size || size - entry.localHeaderOffset < LOCAL_SIZE ||
+        readLe32(base + entry.localHeaderOffset) != SIG_LOCAL)
+    {
+        errorOut = "Corrupt local header for zip entry: " + entry.name;
+        return false;
+    }
+
+    const unsigned char* local = base + entry.localHeaderOffset;
+    const std::uint64_t dataOffset = entry.localHeaderOffset + LOCAL_SIZE +
+                                     readLe16(local + 26) + readLe16(local + 28);
+    if (dataOffset > size || size - dataOffset < entry.compressedSize)
+    {
+        errorOut = "Truncated zip entry: " + entry.name;
+        return false;
+    }
+    const unsigned char* data = base + dataOffset;
+
+    if (entry.method == 0)
+    {
+        if (entry.compressedSize != entry.uncompressedSize)
+        {
+            errorOut = "Corrupt stored zip entry: " + entry.name;
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data), static_cast<std::size_t>(entry.compressedSize));
+    }
+    else if (entry.method == 8)
+    {
+        if (entry.uncompressedSize > entry.compressedSize * MAX_DEFLATE_RATIO + 1024)
+        {
+            errorOut = "Implausible uncompressed size for zip entry: " + entry.name;
+            return false;
+        }
+        out.resize(static_cast<std::size_t>(entry.uncompressedSize));
+        std::string inflateError;
+        if (!InflateRaw(data, static_cast<std::size_t>(entry.compressedSize),
+                        reinterpret_cast<unsigned char*>(&out[0]), out.size(), inflateError))
+        {
+            out.clear();
+            errorOut = "Could not decompress zip entry " + entry.name + ": " + inflateError;
+            return false;
+        }
+    }
+    else
+    {
+        errorOut = "Unsupported compression method " + std::to_string(entry.method) +
+                   " for zip entry: " + entry.name;
+        return false;
+    }
+
+    if (Crc32(reinterpret_cast<const unsigned char*>(out.data()), out.size()) != entry.crc32)
+    {
+        out.clear();
+        errorOut = "CRC mismatch in zip entry: " + entry.name;
+        return false;
+    }
+    return true;
+}
+
+bool IsZipArchive(const std::string& path)
+{
+    std::ifstream in(fs::u8path(path), std::ios::binary);
+    unsigned char sig[4] = {};
+    if (!in.read(reinterpret_cast<char*>(sig), 4))
+        return false;
+    const std::uint32_t v = readLe32(sig);
+    return v == SIG_LOCAL || v == SIG_EOCD;
+}
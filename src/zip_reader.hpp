@@ -0,0 +1,58 @@
+// zip_reader.hpp
+// Minimal, dependency-free reader for .zip archives (stored and deflate
+// entries, Zip64). Used to read WhatsApp and Discord exports in place.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+struct ZipEntry
+{
+    std::string   name;                 // path inside the archive, '/' separated
+    std::uint16_t method = 0;           // 0 = stored, 8 = deflate
+    std::uint16_t flags  = 0;
+    std::uint32_t crc32  = 0;
+    std::uint64_t compressedSize   = 0;
+    std::uint64_t uncompressedSize = 0;
+    std::uint64_t localHeaderOffset = 0;
+
+    bool isDirectory() const { return !name.empty() && name.back() == '/'; }
+
+    // Last path component ("media/IMG_0001.jpg" -> "IMG_0001.jpg").
+    std::string baseName() const;
+
+    // Case-insensitive extension test, e.g. hasExtension(".json").
+    bool hasExtension(const char* ext) const;
+};
+
+// The archive is memory-mapped and only the central directory is parsed on
+// open(), so entries that are never extracted (photos, videos, voice notes)
+// are never read from disk, let alone inflated.
+class ZipArchive
+{
+public:
+    // Returns false and fills errorOut if the file is not a readable archive.
+    bool open(const std::string& path, std::string& errorOut);
+
+    const std::vector<ZipEntry>& entries() const { return m_entries; }
+
+    // Decompress one entry into `out` and verify its CRC-32.
+    bool extract(const ZipEntry& entry, std::string& out, std::string& errorOut) const;
+
+private:
+    MappedFile            m_file;
+    std::vector<ZipEntry> m_entries;
+};
+
+// True if the file starts with a zip signature (regardless of extension).
+bool IsZipArchive(const std::string& path);
+
+// Raw DEFLATE (RFC 1951) decoder. `dst` must be exactly the uncompressed size.
+bool InflateRaw(const unsigned char* src, std::size_t srcSize,
+                unsigned char* dst, std::size_t dstSize, std::string& errorOut);
+
+std::uint32_t Crc32(const unsigned char* data, std::size_t size, std::uint32_t crc = 0);